@@ -1,11 +1,21 @@
-
 uniform sampler2D bloomTexture;
 
 uniform float _bloom_bloomFactor = 0.7;
 
 vec4 bloom(vec4 color) {
-    vec3 blurred = texture(bloomTexture, texCoord).rgb;
+    // last upsampling step, 3x3 tent filter
+    vec2 offset = 1.0 / vec2(textureSize(bloomTexture, 0));
+    vec3 blurred = texture(bloomTexture, texCoord).rgb * 4.0;
+    blurred += texture(bloomTexture, texCoord + vec2(-offset.x, 0.0)).rgb * 2.0;
+    blurred += texture(bloomTexture, texCoord + vec2( offset.x, 0.0)).rgb * 2.0;
+    blurred += texture(bloomTexture, texCoord + vec2(0.0, -offset.y)).rgb * 2.0;
+    blurred += texture(bloomTexture, texCoord + vec2(0.0,  offset.y)).rgb * 2.0;
+    blurred += texture(bloomTexture, texCoord + vec2(-offset.x, -offset.y)).rgb;
+    blurred += texture(bloomTexture, texCoord + vec2( offset.x, -offset.y)).rgb;
+    blurred += texture(bloomTexture, texCoord + vec2(-offset.x,  offset.y)).rgb;
+    blurred += texture(bloomTexture, texCoord + vec2( offset.x,  offset.y)).rgb;
+    blurred /= 16.0;
 
     color.rgb += blurred * _bloom_bloomFactor;
     return color;
-}
\ No newline at end of file
+}
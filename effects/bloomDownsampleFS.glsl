@@ -0,0 +1,63 @@
+const vec3 BLOOM_LUMA = vec3(0.299, 0.587, 0.114);
+
+in vec2 texCoord;
+out vec4 FragColor;
+
+uniform sampler2D src;
+
+// the first downsample also extracts the bright parts of the image
+uniform bool firstPass = false;
+
+vec3 extract(vec3 color) {
+    float luma = dot(color, BLOOM_LUMA);
+    return color * luma * luma;
+}
+
+// weight of a group of samples, bright groups are attenuated to avoid flickering
+float karisWeight(vec3 color) {
+    return 1.0 / (1.0 + dot(color, BLOOM_LUMA));
+}
+
+vec3 sampleSrc(vec2 offset, vec2 texelSize) {
+    vec3 color = texture(src, texCoord + offset * texelSize).rgb;
+    return firstPass ? extract(color) : color;
+}
+
+void main() {
+    vec2 texelSize = 1.0 / vec2(textureSize(src, 0));
+
+    // 13 bilinear taps covering a 6x6 texel area
+    vec3 a = sampleSrc(vec2(-2.0,  2.0), texelSize);
+    vec3 b = sampleSrc(vec2( 0.0,  2.0), texelSize);
+    vec3 c = sampleSrc(vec2( 2.0,  2.0), texelSize);
+    vec3 d = sampleSrc(vec2(-2.0,  0.0), texelSize);
+    vec3 e = sampleSrc(vec2( 0.0,  0.0), texelSize);
+    vec3 f = sampleSrc(vec2( 2.0,  0.0), texelSize);
+    vec3 g = sampleSrc(vec2(-2.0, -2.0), texelSize);
+    vec3 h = sampleSrc(vec2( 0.0, -2.0), texelSize);
+    vec3 i = sampleSrc(vec2( 2.0, -2.0), texelSize);
+    vec3 j = sampleSrc(vec2(-1.0,  1.0), texelSize);
+    vec3 k = sampleSrc(vec2( 1.0,  1.0), texelSize);
+    vec3 l = sampleSrc(vec2(-1.0, -1.0), texelSize);
+    vec3 m = sampleSrc(vec2( 1.0, -1.0), texelSize);
+
+    // 5 overlapping 2x2 boxes, the central one counts for half of the result
+    vec3 groups[5] = vec3[5](
+        (j + k + l + m) * 0.25,
+        (a + b + d + e) * 0.25,
+        (b + c + e + f) * 0.25,
+        (d + e + g + h) * 0.25,
+        (e + f + h + i) * 0.25
+    );
+    float weights[5] = float[5](0.5, 0.125, 0.125, 0.125, 0.125);
+
+    vec3 color = vec3(0.0);
+    float totalWeight = 0.0;
+    for (int n = 0; n < 5; ++n) {
+        float weight = weights[n] * (firstPass ? karisWeight(groups[n]) : 1.0);
+        color += groups[n] * weight;
+        totalWeight += weight;
+    }
+
+    FragColor = vec4(color / totalWeight, 1.0);
+}
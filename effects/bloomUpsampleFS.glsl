@@ -0,0 +1,24 @@
+in vec2 texCoord;
+out vec4 FragColor;
+
+uniform sampler2D src;
+
+// distance of the samples in texels of src
+uniform float radius = 1.0;
+
+void main() {
+    vec2 offset = radius / vec2(textureSize(src, 0));
+
+    // 3x3 tent filter
+    vec3 color = texture(src, texCoord).rgb * 4.0;
+    color += texture(src, texCoord + vec2(-offset.x, 0.0)).rgb * 2.0;
+    color += texture(src, texCoord + vec2( offset.x, 0.0)).rgb * 2.0;
+    color += texture(src, texCoord + vec2(0.0, -offset.y)).rgb * 2.0;
+    color += texture(src, texCoord + vec2(0.0,  offset.y)).rgb * 2.0;
+    color += texture(src, texCoord + vec2(-offset.x, -offset.y)).rgb;
+    color += texture(src, texCoord + vec2( offset.x, -offset.y)).rgb;
+    color += texture(src, texCoord + vec2(-offset.x,  offset.y)).rgb;
+    color += texture(src, texCoord + vec2( offset.x,  offset.y)).rgb;
+
+    FragColor = vec4(color / 16.0, 1.0);
+}
@@ -6,6 +6,12 @@ uniform int _ssao_blurSize = 2;
 vec4 ssao(vec4 color) {
     float ao = 0.0;
 
+    // at low resolution the occlusion has already been blurred and upsampled
+    if (_ssao_blurSize == 0) {
+        ao = texture(_ssao_texture, texCoord).r;
+        return vec4(color.rgb * pow(1.0 - ao, _ssao_darkenFactor), 1.0);
+    }
+
     vec2 texelSize = 1.0 / vec2(textureSize(_ssao_texture, 0));
     for (int x = -_ssao_blurSize; x < _ssao_blurSize; ++x) {
         for (int y = -_ssao_blurSize; y < _ssao_blurSize; ++y) {
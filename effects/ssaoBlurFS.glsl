@@ -0,0 +1,32 @@
+in vec2 texCoord;
+out vec2 FragColor;
+
+uniform sampler2D src; 			// ambient occlusion in r, view depth in g
+uniform vec2 direction;
+uniform int blurSize = 2;
+
+// how fast the weight of a sample decreases with its relative depth difference
+const float depthSharpness = 20.0;
+
+void main() {
+	vec2 texelSize = 1.0 / vec2(textureSize(src, 0));
+	vec2 center = texture(src, texCoord).rg;
+
+	float sigma = float(blurSize) * 0.5 + 0.5;
+	float ao = 0.0;
+	float totalWeight = 0.0;
+
+	for (int i = -blurSize; i <= blurSize; ++i) {
+		vec2 samp = texture(src, texCoord + direction * texelSize * float(i)).rg;
+
+		// do not blur across edges
+		float gaussian = exp(-float(i * i) / (2.0 * sigma * sigma));
+		float depthWeight = exp(-abs(samp.g - center.g) / max(center.g, 0.001) * depthSharpness);
+
+		float weight = gaussian * depthWeight;
+		ao += samp.r * weight;
+		totalWeight += weight;
+	}
+
+	FragColor = vec2(ao / totalWeight, center.g);
+}
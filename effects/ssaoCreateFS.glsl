@@ -1,6 +1,8 @@
 
 in vec2 texCoord;
-out float FragColor;
+
+// ambient occlusion in r, view depth in g (only used at low resolution)
+out vec2 FragColor;
 
 uniform int kernelSize = 12;
 uniform float radius = 2.5;
@@ -8,12 +10,14 @@ uniform float radius = 2.5;
 const float noiseResolution = 4.0f; // see res in SSAO::createNoise
 const float minBias = 0.05;
 const float maxBias = 0.2;
+const float noDepth = 100000.0; // see ssaoDownsampleFS
 
 layout (std140) uniform CommonMat {
     mat4 projection;
     mat4 view;
 	mat4 projectionView;
 	vec4 clipPlane;
+	mat4 inverseProjectionView;
 };
 
 layout (std140) uniform Camera {
@@ -21,25 +25,47 @@ layout (std140) uniform Camera {
     vec3 cameraDirection;
 };
 
-uniform sampler2D src; 			// the position data
+uniform sampler2D DepthData;
 uniform sampler2D NormalData; 
 uniform sampler2D noise;
 
+/* At low resolution sample depths are read from a downsampled
+ * linear depth texture instead of the full resolution positions
+ * and sample rotations come from an interleaved pattern */
+uniform bool lowResolution = false;
+uniform sampler2D depth;
+
 uniform vec3 samples[64];
 
+// interleaved gradient noise, neighbouring pixels get very different values
+float interleavedNoise(vec2 pixel) {
+	return fract(52.9829189 * fract(dot(pixel, vec2(0.06711056, 0.00583715))));
+}
+
 void main() {
-	vec2 screenSize = textureSize(src, 0);
+	vec2 screenSize = textureSize(DepthData, 0);
 	vec2 tiledTexCoord = texCoord * (screenSize / noiseResolution);
+	ivec2 fullResCoord = ivec2(texCoord * screenSize);
+
+	/* avoid applying this effect to fragments not rendered
+	 * using deferred rendering, they have no depth */
+	float fragDepth = texelFetch(DepthData, fullResCoord, 0).r;
+	if (!hasGeometry(fragDepth)) {
+		FragColor = vec2(0.0, noDepth);
+		return;
+	}
 
-	vec3 position = texture(src, texCoord).xyz;
-	vec3 normal = texture(NormalData, texCoord).xyz;
-
-	/* Dirty trick to avoid applying this effect to fragment
-	 * for which this information is not existent. That is,
-	 * fragments not rendered using deferred rendering */
-	if (normal == vec3(0.0)) discard;
+	vec3 position = reconstructPosition((vec2(fullResCoord) + 0.5) / screenSize, fragDepth, inverseProjectionView);
+	vec3 normal = decodeNormal(texelFetch(NormalData, fullResCoord, 0).xy);
 
-	vec3 randomVec = texture(noise, tiledTexCoord).xyz;
+	vec3 randomVec;
+	if (lowResolution) {
+		float angle = 6.2831853 * interleavedNoise(gl_FragCoord.xy);
+		randomVec = vec3(cos(angle), sin(angle), 0.0);
+	}
+	else {
+		randomVec = texture(noise, tiledTexCoord).xyz;
+	}
 
 	vec3 tangent = normalize(randomVec - normal * dot(normal, randomVec));
 	vec3 bitangent = cross(normal, tangent);
@@ -65,8 +91,16 @@ void main() {
 		projected.xy = clamp(projected.xy, vec2(0.001), vec2(0.999));
 
 		// get the z value where the sample lies
-		vec3 toOriginal = texture(src, projected.xy).xyz - cameraPosition;
-		float originalZ = dot(cameraDirection, toOriginal);
+		float originalZ;
+		if (lowResolution) {
+			originalZ = texelFetch(depth, ivec2(projected.xy * textureSize(depth, 0)), 0).r;
+		}
+		else {
+			vec2 texel = floor(projected.xy * screenSize);
+			float sampleDepth = texelFetch(DepthData, ivec2(texel), 0).r;
+			vec3 toOriginal = reconstructPosition((texel + 0.5) / screenSize, sampleDepth, inverseProjectionView) - cameraPosition;
+			originalZ = dot(cameraDirection, toOriginal);
+		}
 
 		// add 1 to penetration if the sampleDepth is greater then sample.z
 		// which would mean that sample is inside some object
@@ -78,5 +112,5 @@ void main() {
 		occlusion += penetration * rangeCheck;
 	}
 
-	FragColor = occlusion / kernelSize;
+	FragColor = vec2(occlusion / kernelSize, dot(position - cameraPosition, cameraDirection));
 }
@@ -0,0 +1,35 @@
+in vec2 texCoord;
+out float FragColor;
+
+// depth written for fragments without deferred data, far from everything
+const float noDepth = 100000.0;
+
+layout (std140) uniform CommonMat {
+    mat4 projection;
+    mat4 view;
+	mat4 projectionView;
+	vec4 clipPlane;
+	mat4 inverseProjectionView;
+};
+
+layout (std140) uniform Camera {
+    vec3 cameraPosition;
+    vec3 cameraDirection;
+};
+
+uniform sampler2D DepthData;
+
+void main() {
+	// point sampling, the same texel is used as center by ssaoCreateFS
+	vec2 screenSize = textureSize(DepthData, 0);
+	ivec2 fullResCoord = ivec2(texCoord * screenSize);
+
+	float depth = texelFetch(DepthData, fullResCoord, 0).r;
+	if (!hasGeometry(depth)) {
+		FragColor = noDepth;
+		return;
+	}
+
+	vec3 position = reconstructPosition((vec2(fullResCoord) + 0.5) / screenSize, depth, inverseProjectionView);
+	FragColor = dot(position - cameraPosition, cameraDirection);
+}
@@ -0,0 +1,43 @@
+in vec2 texCoord;
+out float FragColor;
+
+layout (std140) uniform CommonMat {
+    mat4 projection;
+    mat4 view;
+	mat4 projectionView;
+	vec4 clipPlane;
+	mat4 inverseProjectionView;
+};
+
+layout (std140) uniform Camera {
+    vec3 cameraPosition;
+    vec3 cameraDirection;
+};
+
+uniform sampler2D src; 			// low resolution ambient occlusion in r, view depth in g
+uniform sampler2D DepthData;
+
+void main() {
+	float fragDepth = texture(DepthData, texCoord).r;
+	if (!hasGeometry(fragDepth)) {
+		FragColor = 0.0;
+		return;
+	}
+
+	float depth = dot(reconstructPosition(texCoord, fragDepth, inverseProjectionView) - cameraPosition, cameraDirection);
+
+	// the 4 low resolution texels around this fragment
+	vec2 lowResSize = vec2(textureSize(src, 0));
+	vec2 coord = texCoord * lowResSize - 0.5;
+	vec2 f = fract(coord);
+	vec2 gatherCoord = (floor(coord) + 1.0) / lowResSize;
+
+	vec4 occlusions = textureGather(src, gatherCoord, 0);
+	vec4 depths = textureGather(src, gatherCoord, 1);
+
+	// bilinear weights (in the order used by textureGather) reduced by the depth difference
+	vec4 bilinear = vec4((1.0 - f.x) * f.y, f.x * f.y, f.x * (1.0 - f.y), (1.0 - f.x) * (1.0 - f.y));
+	vec4 weights = bilinear / (abs(depths - depth) + 0.001);
+
+	FragColor = dot(occlusions, weights) / dot(weights, vec4(1.0));
+}
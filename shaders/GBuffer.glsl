@@ -0,0 +1,59 @@
+/**
+  * Encoding of the data stored in the deferred rendering buffers (see DeferredRenderingFBO):
+  * 0: RGBA8  diffuse color or albedo (gamma space)
+  * 1: RGBA8  specular color and shininess, or roughness, metalness and ambient occlusion
+  * 2: RG16   world space normal, octahedral encoding
+  * world space positions are not stored, they are reconstructed from the depth buffer */
+
+// shininess is stored normalized in 8 bits
+const float GBUFFER_MAX_SHININESS = 255.0;
+
+vec2 _octahedronWrap(vec2 v) {
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+/**
+  * @param normal a normal, it does not need to be normalized
+  * @return the normal in [0, 1] to be stored in the normal buffer */
+vec2 encodeNormal(vec3 normal) {
+    normal /= max(abs(normal.x) + abs(normal.y) + abs(normal.z), 0.0001);
+    normal.xy = normal.z >= 0.0 ? normal.xy : _octahedronWrap(normal.xy);
+    return normal.xy * 0.5 + 0.5;
+}
+
+/**
+  * @param encoded a value of the normal buffer
+  * @return the normalized world space normal */
+vec3 decodeNormal(vec2 encoded) {
+    encoded = encoded * 2.0 - 1.0;
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = clamp(-normal.z, 0.0, 1.0);
+    normal.xy += vec2(normal.x >= 0.0 ? -t : t, normal.y >= 0.0 ? -t : t);
+    return normalize(normal);
+}
+
+float encodeShininess(float shininess) {
+    return clamp(shininess / GBUFFER_MAX_SHININESS, 0.0, 1.0);
+}
+
+float decodeShininess(float encoded) {
+    return encoded * GBUFFER_MAX_SHININESS;
+}
+
+/**
+  * @param depth a value of the depth buffer, 1 where nothing has been rendered
+  * @return true if a deferred fragment has been rendered */
+bool hasGeometry(float depth) {
+    return depth < 1.0;
+}
+
+/**
+  * @param texCoord the screen coordinates of the fragment in [0, 1]
+  * @param depth the value of the depth buffer
+  * @param inverseProjectionView the inverse of the projection * view matrix used to render the depth
+  * @return the world space position of the fragment */
+vec3 reconstructPosition(vec2 texCoord, float depth, mat4 inverseProjectionView) {
+    vec4 clip = vec4(vec3(texCoord, depth) * 2.0 - 1.0, 1.0);
+    vec4 position = inverseProjectionView * clip;
+    return position.xyz / position.w;
+}
@@ -5,7 +5,7 @@ const uint LIGHT_TYPE_SPOT = 2;
 
 struct Light {
 						   // where data ends			where data starts
-    uint type;             // 16 + 196 * lightIndex		0
+    uint type;             // 16 + 128 * lightIndex		0
     vec3 position;         // 32						16
     vec3 direction;        // 48						32
 
@@ -14,7 +14,6 @@ struct Light {
     vec3 specularColor;    // 96						80
     vec3 attenuations;     // 112						96
 
-    vec2 spotAngles;       // 128						112
-	mat4 toLightSpace;     // 192						128
-	bool castShadow;	   // 208						192	
+    vec2 spotAngles;       // 120						112
+	bool castShadow;	   // 128						120	
 };
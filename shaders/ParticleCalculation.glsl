@@ -0,0 +1,20 @@
+// Functions shared by particle vertex shaders
+
+/** @return the texture offset of the top-left corner of a frame in the atlas */
+vec2 particleFrameOffset(int frame, int cols, vec2 frameSize) {
+    int col = frame % cols;
+    int row = frame / cols;
+    return vec2(col * frameSize.x, 1.0 - row * frameSize.y);
+}
+
+/** @return the world position of a quad vertex rotated and scaled on the view plane */
+vec3 particleBillboard(vec3 center, vec2 vertex, float rotation, float scale, mat4 view) {
+    float s = sin(rotation);
+    float c = cos(rotation);
+    vec2 corner = scale * vec2(c * vertex.x - s * vertex.y, s * vertex.x + c * vertex.y);
+
+    // camera right and up vectors in world space are the rows of the view matrix
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    return center + right * corner.x + up * corner.y;
+}
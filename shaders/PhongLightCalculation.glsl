@@ -1,9 +1,8 @@
 /** 
   * Lights should be imported
   * ShadowMapingCalulation should be imported
-  * All positions and directions are expected to be in world space except for lightSpacePos
-  * which is in light space */
-vec3 phongComputeColor(Light light, vec3 diffuseColor, vec3 specularColor, float shininess, vec3 fragPosition, vec3 fragNormal, vec3 cameraPosition, vec4 lightSpacePos, bool calcShadow) {
+  * All positions and directions are expected to be in world space */
+vec3 phongComputeColor(Light light, vec3 diffuseColor, vec3 specularColor, float shininess, vec3 fragPosition, vec3 fragNormal, vec3 cameraPosition, vec3 cameraDirection, bool calcShadow) {
     vec3 outcolor = vec3(0.0f);
 
     fragNormal = normalize(fragNormal);
@@ -28,7 +27,7 @@ vec3 phongComputeColor(Light light, vec3 diffuseColor, vec3 specularColor, float
 	// shadow mapping
 	float inShadow = 0.0;
 	if (calcShadow)
-		inShadow = shadowMapIsInShadow(lightSpacePos, -rayToLight, fragNormal, distance(fragPosition, cameraPosition));
+		inShadow = shadowMapIsInShadow(fragPosition, -rayToLight, fragNormal, dot(fragPosition - cameraPosition, cameraDirection));
 
     float diffuseIntensity = max(dot(fragNormal, rayToLight), 0.0f);
     outcolor += light.diffuseColor * diffuseColor * diffuseIntensity * (1.0 - inShadow);
@@ -1,9 +1,12 @@
 /**
-  * Requires that a samplerCube named shadowCube is available */
+  * Requires that a sampler2D named shadowAtlas is available */
 
-uniform samplerCube shadowCube;
+uniform sampler2D shadowAtlas;
 uniform float lightRadius;
 
+/** region of shadowAtlas containing each face of the shadow cube (xy: offset, zw: size), zw is 0 if the face has no casters */
+uniform vec4 shadowFaceRects[6];
+
 const float BIAS = 0.1;
 
 vec3 sampleOffsetDirections[20] = vec3[]
@@ -15,6 +18,43 @@ vec3 sampleOffsetDirections[20] = vec3[]
    vec3( 0,  1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0,  1, -1)
 );  
 
+/**
+  * Returns the depth stored in the shadow atlas along a direction.
+  * Faces are selected and mapped as the faces of a cube map.
+  * @param direction the direction from the light (world space)
+  * @return the distance of the closest caster divided by the light radius */
+float pointMapDepth(vec3 direction) {
+	vec3 absDirection = abs(direction);
+	int face;
+	float majorAxis;
+	vec2 st;
+
+	if (absDirection.x >= absDirection.y && absDirection.x >= absDirection.z) {
+		face = direction.x > 0.0 ? 0 : 1;
+		majorAxis = absDirection.x;
+		st = vec2(direction.x > 0.0 ? -direction.z : direction.z, -direction.y);
+	}
+	else if (absDirection.y >= absDirection.z) {
+		face = direction.y > 0.0 ? 2 : 3;
+		majorAxis = absDirection.y;
+		st = vec2(direction.x, direction.y > 0.0 ? direction.z : -direction.z);
+	}
+	else {
+		face = direction.z > 0.0 ? 4 : 5;
+		majorAxis = absDirection.z;
+		st = vec2(direction.z > 0.0 ? direction.x : -direction.x, -direction.y);
+	}
+
+	vec4 rect = shadowFaceRects[face];
+	if (rect.z == 0.0)
+		return 1.0;
+
+	// texels outside the rect belong to other tiles
+	vec2 halfTexel = 0.5 / textureSize(shadowAtlas, 0);
+	vec2 uv = rect.xy + rect.zw * (st / majorAxis + 1.0) * 0.5;
+	return texture(shadowAtlas, clamp(uv, rect.xy + halfTexel, rect.xy + rect.zw - halfTexel)).r;
+}
+
 float pointMapIsInShadow(vec3 position, vec3 lightPosition, vec3 cameraPosition) {
 	
 	vec3 sampleRay = position - lightPosition; 
@@ -25,7 +65,7 @@ float pointMapIsInShadow(vec3 position, vec3 lightPosition, vec3 cameraPosition)
 	float pcfRadius = (1.0 + length(position - cameraPosition) / lightRadius) / 25.0;
 
 	for (int i = 0; i < 20; i++) {
-		float closestDepth = texture(shadowCube, sampleRay + sampleOffsetDirections[i] * pcfRadius).r * lightRadius;
+		float closestDepth = pointMapDepth(sampleRay + sampleOffsetDirections[i] * pcfRadius) * lightRadius;
 		
 		shadow += currentDepth -  BIAS > closestDepth ? 1.0 : 0.0;
 	}
@@ -1,10 +1,14 @@
 /**
-  * Requires that a sampler2D named shadowMap is available */
+  * Requires that a sampler2DArray named shadowMap is available */
 
-uniform sampler2D shadowMap;
+const int MAX_SHADOW_CASCADES = 4;
+
+uniform sampler2DArray shadowMap;
 
 layout (std140) uniform ShadowMapParams {
-    vec4 _shadowParams; // x: distance, y: fade out range, z: shadow strength, w: outside shadow map (shadow or light?)
+    vec4 _shadowParams; // x: distance, y: fade out range, z: shadow strength, w: number of cascades
+    vec4 _cascadeFarDistances; // view space depth at which each cascade ends
+    mat4 _cascadeToLightSpace[MAX_SHADOW_CASCADES];
 };
 
 const float SHADOWMAP_MIN_BIAS = 0.0001;
@@ -14,18 +18,25 @@ const int SMOOTH_RANGE = 1;
 
 /**
   * Return 1 if the fragment is in shadow, 0 otherwise.
-  * @param lightSpacePos the position of the current fragment in light space
+  * @param fragPosition the position of the current fragment (world space)
   * @param lightDirection the direction of the light casting shadows (world space)
   * @param the normal of the current fragment (world space)
-  * @param distance the distance of the current fragment from the camera
+  * @param viewDepth the depth of the current fragment along the camera direction
   * @return 1 if in shadow, 0 otherwise */
-float shadowMapIsInShadow(vec4 lightSpacePos, vec3 lightDirection, vec3 normal, float dist) {
+float shadowMapIsInShadow(vec3 fragPosition, vec3 lightDirection, vec3 normal, float viewDepth) {
 	float shadowStrength = _shadowParams[2];
 	if (shadowStrength == 0.0)
 		return 0.0f;
 
-	vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+	// cascades cover consecutive slices of the view frustum, use the first one containing the fragment
+	int cascadesNumber = int(_shadowParams.w);
+	int cascade = 0;
+	while (cascade < cascadesNumber - 1 && viewDepth > _cascadeFarDistances[cascade])
+		cascade++;
+
+	vec2 texelSize = 1.0 / textureSize(shadowMap, 0).xy;
 
+	vec4 lightSpacePos = _cascadeToLightSpace[cascade] * vec4(fragPosition, 1.0);
 	vec3 shadowSampleCoord = lightSpacePos.xyz / lightSpacePos.w;
 	shadowSampleCoord = (shadowSampleCoord + vec3(1.0)) / 2.0;
 
@@ -38,7 +49,7 @@ float shadowMapIsInShadow(vec4 lightSpacePos, vec3 lightDirection, vec3 normal,
 	float inShadow = 0.0;
 	for (int i = -SMOOTH_RANGE; i <= SMOOTH_RANGE; i++) {
 		for (int j = -SMOOTH_RANGE; j <= SMOOTH_RANGE; j++) {
-			float depthInShadowMap = texture(shadowMap, shadowSampleCoord.xy + texelSize * vec2(i, j)).r;
+			float depthInShadowMap = texture(shadowMap, vec3(shadowSampleCoord.xy + texelSize * vec2(i, j), cascade)).r;
 			inShadow += float(shadowSampleCoord.z - bias > depthInShadowMap);
 		}
 	}
@@ -46,7 +57,7 @@ float shadowMapIsInShadow(vec4 lightSpacePos, vec3 lightDirection, vec3 normal,
 	const float shadowDistance = _shadowParams.x;
 	const float fadeOutRange = _shadowParams.y;
 
-	float disappearFactor = (dist - shadowDistance + fadeOutRange) / fadeOutRange;
+	float disappearFactor = (viewDepth - shadowDistance + fadeOutRange) / fadeOutRange;
 	disappearFactor = clamp(disappearFactor, 0.0, 1.0);
 
 
@@ -1,22 +1,21 @@
 layout (location = 0) out vec4 Diffuse;
 layout (location = 1) out vec4 Specular;
-layout (location = 2) out vec3 Position;
-layout (location = 3) out vec3 Normal;
+layout (location = 2) out vec2 Normal;
 
-struct PhongMaterial {
-    bool useDiffuseMap;
-    sampler2D diffuse;
+// the values of a BlinnPhongMaterial are in its uniform buffer, see BlinnPhongMaterial::use
+layout (std140) uniform BlinnPhongMaterialData {
     vec3 diffuseColor;
-
-    bool useSpecularMap;
-    sampler2D specular;
+    bool useDiffuseMap;
     vec3 specularColor;
-
-    sampler2D bump;
-
+    bool useSpecularMap;
     float shininess;
-
     float opacity;
+} materialData;
+
+struct PhongMaterial {
+    sampler2D diffuse;
+    sampler2D specular;
+    sampler2D bump;
 };
 
 in vec2 texCoord;
@@ -32,17 +31,16 @@ void main() {
     vec3 normal = (texture(material.bump, texCoord).rgb) * 2.0 - 1.0;
     normal = normalize(tangentToWorldSpace * normal);
 
-	Position = position;
-	Normal = normal;
+	Normal = encodeNormal(normal);
 
 	vec4 sampledDiffuseColor = texture(material.diffuse, texCoord);
-	if (material.opacity == 0.0f || sampledDiffuseColor.a < 0.5) discard;
+	if (materialData.opacity == 0.0f || sampledDiffuseColor.a < 0.5) discard;
 
-    Diffuse = vec4(material.diffuseColor, 1.0);
-    if (material.useDiffuseMap)
+    Diffuse = vec4(materialData.diffuseColor, 1.0);
+    if (materialData.useDiffuseMap)
         Diffuse.rgb *= sampledDiffuseColor.rgb;
 
-    Specular = vec4(material.specularColor, material.shininess);
-    if (material.useSpecularMap)
+    Specular = vec4(materialData.specularColor, encodeShininess(materialData.shininess));
+    if (materialData.useSpecularMap)
         Specular.rgb *= vec3(texture(material.specular, texCoord));
 }
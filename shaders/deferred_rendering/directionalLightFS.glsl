@@ -5,6 +5,14 @@ layout (std140) uniform Lights {
     Light lights[10];
 };
 
+layout (std140) uniform CommonMat {
+    mat4 projection;
+    mat4 view;
+    mat4 projectionView;
+    vec4 clipPlane;
+    mat4 inverseProjectionView;
+};
+
 layout (std140) uniform Camera {
     vec3 cameraPosition;
     vec3 cameraDirection;
@@ -25,10 +33,8 @@ vec3 phongComputeColor(Light light, vec3 diffuseColor, vec3 specularColor, float
     
 	// shadow mapping
 	float inShadow = 0.0;
-	if (light.castShadow) {
-		vec4 lightSpacePos = light.toLightSpace * vec4(fragPosition, 1.0);
-		inShadow = shadowMapIsInShadow(lightSpacePos, -rayToLight, fragNormal, distance(fragPosition, cameraPosition));
-	}
+	if (light.castShadow)
+		inShadow = shadowMapIsInShadow(fragPosition, -rayToLight, fragNormal, dot(fragPosition - cameraPosition, cameraDirection));
 
     float diffuseIntensity = max(dot(fragNormal, rayToLight), 0.0f);
     outcolor += light.diffuseColor * diffuseColor * diffuseIntensity * (1.0 - inShadow);
@@ -47,7 +53,7 @@ vec3 phongComputeColor(Light light, vec3 diffuseColor, vec3 specularColor, float
 
 uniform sampler2D DiffuseData;
 uniform sampler2D SpecularData;
-uniform sampler2D PositionData;
+uniform sampler2D DepthData;
 uniform sampler2D NormalData;
 
 uniform int lightIndex;
@@ -62,9 +68,9 @@ void main() {
     vec3 specularColor = specularSample.rgb;
 	specularColor = pow(specularColor, vec3(2.2));
 
-    float shininess = specularSample.a;
-    vec3 normal = texture(NormalData, texCoord).xyz;
-    vec3 position = texture(PositionData, texCoord).xyz;
+    float shininess = decodeShininess(specularSample.a);
+    vec3 normal = decodeNormal(texture(NormalData, texCoord).xy);
+    vec3 position = reconstructPosition(texCoord, texture(DepthData, texCoord).r, inverseProjectionView);
 
     vec3 color = phongComputeColor(lights[lightIndex], diffuseColor, specularColor, shininess, position, normal, cameraPosition);
     FragColor = vec4(color, 1.0);
@@ -5,6 +5,14 @@ layout (std140) uniform Lights {
     Light lights[10];
 };
 
+layout (std140) uniform CommonMat {
+    mat4 projection;
+    mat4 view;
+    mat4 projectionView;
+    vec4 clipPlane;
+    mat4 inverseProjectionView;
+};
+
 layout (std140) uniform Camera {
     vec3 cameraPosition;
     vec3 cameraDirection;
@@ -49,10 +57,11 @@ vec3 phongComputeColor(Light light, vec3 diffuseColor, vec3 specularColor, float
 
 uniform sampler2D DiffuseData;
 uniform sampler2D SpecularData;
-uniform sampler2D PositionData;
+uniform sampler2D DepthData;
 uniform sampler2D NormalData;
 
-uniform int lightIndex;
+flat in int fragLightIndex;
+flat in float fragLightRadius;
 
 void main() {
     vec2 texCoord = gl_FragCoord.xy / textureSize(DiffuseData, 0);
@@ -64,10 +73,16 @@ void main() {
     vec3 specularColor = specularSample.rgb;
 	specularColor = pow(specularColor, vec3(2.2));
 
-    float shininess = specularSample.a;
-    vec3 normal = texture(NormalData, texCoord).xyz;
-    vec3 position = texture(PositionData, texCoord).xyz;
-    vec3 color = phongComputeColor(lights[lightIndex], diffuseColor, specularColor, shininess, position, normal, cameraPosition);
+    float shininess = decodeShininess(specularSample.a);
+    vec3 normal = decodeNormal(texture(NormalData, texCoord).xy);
+    vec3 position = reconstructPosition(texCoord, texture(DepthData, texCoord).r, inverseProjectionView);
+
+    // light volumes drawn by their back faces also cover the fragments in front of them
+    Light light = lights[fragLightIndex];
+    if (distance(position, light.position) > fragLightRadius)
+        discard;
+
+    vec3 color = phongComputeColor(light, diffuseColor, specularColor, shininess, position, normal, cameraPosition);
 
     FragColor = vec4(color, 1.0);
 }
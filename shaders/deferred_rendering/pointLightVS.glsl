@@ -2,6 +2,14 @@
   * the volume of influence of a point light in deferred rendering */
 layout (location = 0) in vec2 vPos;
 
+uniform int lightIndex;
+uniform float lightRadius;
+
+flat out int fragLightIndex;
+flat out float fragLightRadius;
+
 void main() {
+    fragLightIndex = lightIndex;
+    fragLightRadius = lightRadius;
     gl_Position = vec4(vPos, 0.0, 1.0);
 }
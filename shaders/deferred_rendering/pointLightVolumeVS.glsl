@@ -0,0 +1,34 @@
+/** This shader is used to draw the spheres representing the volumes of influence
+  * of many point lights with a single instanced draw call, one instance for each light */
+layout (location = 0) in vec3 vPos;
+
+layout (std140) uniform CommonMat {
+    mat4 projection;
+    mat4 view;
+	mat4 projectionView;
+};
+
+layout (std140) uniform Lights {
+    int numLights;
+    Light lights[10];
+};
+
+// see RenderSystem::MAX_LIGHT_NUMBER
+const int MAX_BATCHED_LIGHTS = 32;
+
+// the faces of the low poly sphere are inside the unit sphere
+const float SPHERE_MESH_SCALE = 1.1;
+
+uniform int lightIndices[MAX_BATCHED_LIGHTS];
+uniform float lightRadii[MAX_BATCHED_LIGHTS];
+
+flat out int fragLightIndex;
+flat out float fragLightRadius;
+
+void main() {
+    fragLightIndex = lightIndices[gl_InstanceID];
+    fragLightRadius = lightRadii[gl_InstanceID];
+
+    vec3 position = lights[fragLightIndex].position + fragLightRadius * SPHERE_MESH_SCALE * vPos;
+    gl_Position = projectionView * vec4(position, 1.0);
+}
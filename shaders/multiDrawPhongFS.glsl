@@ -0,0 +1,33 @@
+layout (location = 0) out vec4 Diffuse;
+layout (location = 1) out vec4 Specular;
+layout (location = 2) out vec2 Normal;
+
+// arrays of the textures of the materials drawn together, see TextureArrayPool
+uniform sampler2DArray diffuseMaps;
+uniform sampler2DArray specularMaps;
+
+in vec2 texCoord;
+in vec3 position;
+in vec3 normal;
+
+// layers are negative for materials without the map
+flat in vec3 diffuseColor;
+flat in float diffuseLayer;
+flat in vec3 specularColor;
+flat in float specularLayer;
+flat in float shininess;
+
+void main() {
+	Normal = encodeNormal(normal);
+
+    Diffuse = vec4(diffuseColor, 1.0);
+    if (diffuseLayer >= 0.0) {
+        vec4 sampledDiffuseColor = texture(diffuseMaps, vec3(texCoord, diffuseLayer));
+        if (sampledDiffuseColor.a < 0.5) discard;
+        Diffuse.rgb *= sampledDiffuseColor.rgb;
+    }
+
+    Specular = vec4(specularColor, encodeShininess(shininess));
+    if (specularLayer >= 0.0)
+        Specular.rgb *= texture(specularMaps, vec3(texCoord, specularLayer)).rgb;
+}
@@ -0,0 +1,70 @@
+#extension GL_ARB_shader_storage_buffer_object : require
+
+layout (location = 0) in vec3 vPos;
+layout (location = 1) in vec3 vNorm;
+layout (location = 2) in vec2 vTexCoord;
+// per instance attribute, the base instance of each draw command is the index of the draw
+layout (location = 3) in uint vDrawId;
+
+layout (std140) uniform CommonMat {
+    mat4 projection;
+    mat4 view;
+	mat4 projectionView;
+	vec4 clipPlane;
+};
+
+struct DrawData {
+    mat4 model;
+    mat4 normalModel;
+    uint material;
+};
+
+// see MultiDrawRenderer::MaterialData
+struct MaterialData {
+    vec3 diffuseColor;
+    float diffuseLayer;
+    vec3 specularColor;
+    float specularLayer;
+    float shininess;
+};
+
+layout (std430, binding = 0) readonly buffer Draws {
+    DrawData draws[];
+};
+
+layout (std430, binding = 1) readonly buffer Materials {
+    MaterialData materials[];
+};
+
+// the depth must match the one of the depth pre-pass (see shadowMapVS)
+invariant gl_Position;
+
+out vec2 texCoord;
+out vec3 position;
+out vec3 normal;
+
+flat out vec3 diffuseColor;
+flat out float diffuseLayer;
+flat out vec3 specularColor;
+flat out float specularLayer;
+flat out float shininess;
+
+void main() {
+    DrawData draw = draws[vDrawId];
+    MaterialData material = materials[draw.material];
+
+    texCoord = vTexCoord;
+
+    position = (draw.model * vec4(vPos, 1.0f)).xyz;
+    normal = normalize(mat3(draw.normalModel) * vNorm);
+
+    diffuseColor = material.diffuseColor;
+    diffuseLayer = material.diffuseLayer;
+    specularColor = material.specularColor;
+    specularLayer = material.specularLayer;
+    shininess = material.shininess;
+
+	gl_ClipDistance[0] = dot(vec4(position, 1.0), clipPlane);
+
+    gl_Position = projectionView * vec4(position, 1.0f);
+}
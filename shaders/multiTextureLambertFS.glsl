@@ -1,7 +1,6 @@
 layout (location = 0) out vec4 Diffuse;
 layout (location = 1) out vec4 Specular;
-layout (location = 2) out vec3 Position;
-layout (location = 3) out vec3 Normal;
+layout (location = 2) out vec2 Normal;
 
 in vec2 texCoord;
 in vec3 position;
@@ -29,6 +28,5 @@ void main() {
     Diffuse.rgb = base * baseFactor + red * channels.r + green * channels.g + blue * channels.b;
 	Diffuse.a = 1.0;
 	Specular = vec4(0.0);
-	Position = position;
-	Normal = normal;
+	Normal = encodeNormal(normal);
 }
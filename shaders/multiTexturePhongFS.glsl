@@ -1,7 +1,6 @@
 layout (location = 0) out vec4 Diffuse;
 layout (location = 1) out vec4 Specular;
-layout (location = 2) out vec3 Position;
-layout (location = 3) out vec3 Normal;
+layout (location = 2) out vec2 Normal;
 
 uniform sampler2D baseTexture;
 uniform sampler2D baseTextureBump;
@@ -48,8 +47,7 @@ void main() {
 
     float shininess = redShininess * channels.r + greenShininess * channels.g;
 
-	Position = position;
-	Normal = normal;
+	Normal = encodeNormal(normal);
 	Diffuse = vec4(diffuseColor, 1.0);
-	Specular = vec4(specularColor, shininess);
+	Specular = vec4(specularColor, encodeShininess(shininess));
 }
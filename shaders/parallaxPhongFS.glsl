@@ -1,7 +1,6 @@
 layout (location = 0) out vec4 Diffuse;
 layout (location = 1) out vec4 Specular;
-layout (location = 2) out vec3 Position;
-layout (location = 3) out vec3 Normal;
+layout (location = 2) out vec2 Normal;
 
 const float PARALLAX_HEIGHT = 0.115;
 const float MIN_LAYERS = 8.0f;
@@ -13,21 +12,21 @@ const float PARALLAX_MIN_DISTANCE = 13.5;
 // when distance is greater than this value parallax mapping is fully operative
 const float PARALLAX_FULL_DISTANCE = 18.5;
 
-struct PhongMaterial {
-    bool useDiffuseMap;
-    sampler2D diffuse;
+// the values of a BlinnPhongMaterial are in its uniform buffer, see BlinnPhongMaterial::use
+layout (std140) uniform BlinnPhongMaterialData {
     vec3 diffuseColor;
-
-    bool useSpecularMap;
-    sampler2D specular;
+    bool useDiffuseMap;
     vec3 specularColor;
+    bool useSpecularMap;
+    float shininess;
+    float opacity;
+} materialData;
 
+struct PhongMaterial {
+    sampler2D diffuse;
+    sampler2D specular;
     sampler2D bump;
     sampler2D parallax;
-
-    float shininess;
-
-    float opacity;
 };
 
 in vec2 texCoord;
@@ -80,17 +79,16 @@ void main() {
     // from tangent space to world space
     normal = normalize(tangentToWorldSpace * normal);
 
-	Position = position;
-	Normal = normal;
+	Normal = encodeNormal(normal);
 
 	vec4 sampledDiffuseColor = texture(material.diffuse, parallaxTexCoord);
-	if (material.opacity == 0.0f || sampledDiffuseColor.a < 0.5) discard;
+	if (materialData.opacity == 0.0f || sampledDiffuseColor.a < 0.5) discard;
 
-    Diffuse = vec4(material.diffuseColor, 1.0);
-    if (material.useDiffuseMap)
+    Diffuse = vec4(materialData.diffuseColor, 1.0);
+    if (materialData.useDiffuseMap)
         Diffuse.rgb *= sampledDiffuseColor.rgb;
 
-    Specular = vec4(material.specularColor, material.shininess);
-    if (material.useSpecularMap)
+    Specular = vec4(materialData.specularColor, encodeShininess(materialData.shininess));
+    if (materialData.useSpecularMap)
         Specular.rgb *= vec3(texture(material.specular, parallaxTexCoord));
 }
@@ -0,0 +1,50 @@
+/** Renders the particles of a GPUParticleSimulation.
+  * Particles are billboarded using the view matrix, no per particle
+  * data is computed on the cpu. */
+layout (location = 0) in vec3 vPos;
+layout (location = 1) in vec4 iPositionElapsed;
+layout (location = 2) in vec4 iVelocityDuration;
+layout (location = 3) in vec4 iRotationScale;
+
+layout (std140) uniform CommonMat {
+    mat4 projection;
+    mat4 view;
+	mat4 projectionView;
+};
+
+uniform int frames;
+uniform int cols;
+uniform vec2 frameSize;
+
+out vec2 texCoord;
+out float blend;
+out vec4 offsets;
+
+void main() {
+    texCoord = vPos.xy + 0.5;
+    texCoord.y = 1.0 - texCoord.y;
+
+    float elapsed = iPositionElapsed.w;
+    float duration = iVelocityDuration.w;
+
+    // dead particle: move it outside the clip volume
+    if (elapsed >= duration) {
+        blend = 0.0;
+        offsets = vec4(0.0);
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    float lifePercent = elapsed / duration;
+    float rotation = mix(iRotationScale.x, iRotationScale.y, lifePercent);
+    float scale = mix(iRotationScale.z, iRotationScale.w, lifePercent);
+
+    float percentage = (frames - 1) * lifePercent;
+    int frame = int(percentage);
+    blend = percentage - frame;
+    offsets = vec4(particleFrameOffset(frame, cols, frameSize), particleFrameOffset(min(frame + 1, frames - 1), cols, frameSize));
+
+    vec3 worldPosition = particleBillboard(iPositionElapsed.xyz, vPos.xy, rotation, scale, view);
+
+    gl_Position = projectionView * vec4(worldPosition, 1.0);
+}
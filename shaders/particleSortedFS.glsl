@@ -0,0 +1,19 @@
+layout (location = 0) out vec4 FragColor;
+
+in vec2 texCoord;
+in float blend;
+in vec4 offsets;
+in vec2 frameSizeInvY;
+flat in float layer;
+
+uniform sampler2DArray atlases;
+
+void main() {
+    vec4 current = texture(atlases, vec3(offsets.xy + texCoord * frameSizeInvY, layer));
+	current.rgb = pow(current.rgb, vec3(2.2));
+
+    vec4 next = texture(atlases, vec3(offsets.zw + texCoord * frameSizeInvY, layer));
+	next.rgb = pow(next.rgb, vec3(2.2));
+
+    FragColor = mix(current, next, blend);
+}
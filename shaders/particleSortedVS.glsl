@@ -0,0 +1,42 @@
+/** Renders particles of several emitters sorted together.
+  * Each particle references the parameters of its emitter's atlas
+  * and the layer of the atlas array containing it. */
+layout (location = 0) in vec3 vPos;
+layout (location = 1) in vec4 iPositionRotation;
+layout (location = 2) in vec4 iScaleFrameLayerEmitter; // x: scale, y: frame, z: atlas layer, w: emitter
+
+const int MAX_SORTED_EMITTERS = 32;
+
+layout (std140) uniform CommonMat {
+    mat4 projection;
+    mat4 view;
+	mat4 projectionView;
+};
+
+// xy: frame size, z: number of frames, w: number of columns
+uniform vec4 atlasParams[MAX_SORTED_EMITTERS];
+
+out vec2 texCoord;
+out float blend;
+out vec4 offsets;
+out vec2 frameSizeInvY;
+flat out float layer;
+
+void main() {
+    texCoord = vPos.xy + 0.5;
+    texCoord.y = 1.0 - texCoord.y;
+
+    vec4 params = atlasParams[int(iScaleFrameLayerEmitter.w)];
+    int frames = int(params.z);
+    int cols = int(params.w);
+
+    float framePosition = iScaleFrameLayerEmitter.y;
+    int frame = int(framePosition);
+    blend = framePosition - frame;
+    offsets = vec4(particleFrameOffset(frame, cols, params.xy), particleFrameOffset(min(frame + 1, frames - 1), cols, params.xy));
+    frameSizeInvY = vec2(params.x, -params.y);
+    layer = iScaleFrameLayerEmitter.z;
+
+    vec3 worldPosition = particleBillboard(iPositionRotation.xyz, vPos.xy, iPositionRotation.w, iScaleFrameLayerEmitter.x, view);
+    gl_Position = projectionView * vec4(worldPosition, 1.0f);
+}
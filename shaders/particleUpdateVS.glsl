@@ -0,0 +1,83 @@
+/** Advances the simulation of the particles of a GPUParticleSimulation.
+  * This shader is used with transform feedback: every vertex is a particle
+  * and the outputs are written into the buffer used for the next frame. */
+layout (location = 0) in vec4 inPositionElapsed;
+layout (location = 1) in vec4 inVelocityDuration;
+layout (location = 2) in vec4 inRotationScale;
+layout (location = 3) in vec2 inGravityScale;
+
+out vec4 outPositionElapsed;
+out vec4 outVelocityDuration;
+out vec4 outRotationScale;
+out vec2 outGravityScale;
+
+uniform float deltaMillis;
+uniform float gravity;
+
+// particles in [spawnStart, spawnStart + spawnCount) (mod maxParticles) are spawned
+uniform int spawnStart;
+uniform int spawnCount;
+uniform int maxParticles;
+uniform uint seed;
+
+// emission parameters (positions already include the emitter position)
+uniform vec3 positionMin;
+uniform vec3 positionMax;
+uniform vec3 velocityMin;
+uniform vec3 velocityMax;
+uniform vec2 durationRange;
+uniform vec2 initialRotationRange;
+uniform vec2 finalRotationRange;
+uniform vec2 initialScaleRange;
+uniform vec2 finalScaleRange;
+uniform vec2 initialGravityRange;
+uniform vec2 finalGravityRange;
+
+uint randomState;
+
+float nextRandom() {
+    // integer hash, good enough for particles
+    randomState = (randomState << 13U) ^ randomState;
+    randomState = randomState * (randomState * randomState * 15731U + 789221U) + 1376312589U;
+    return float(randomState & 0x7fffffffU) / float(0x7fffffff);
+}
+
+float randomIn(vec2 range) {
+    return mix(range.x, range.y, nextRandom());
+}
+
+vec3 randomIn(vec3 minValue, vec3 maxValue) {
+    return mix(minValue, maxValue, vec3(nextRandom(), nextRandom(), nextRandom()));
+}
+
+void main() {
+    vec4 positionElapsed = inPositionElapsed;
+    vec4 velocityDuration = inVelocityDuration;
+    vec4 rotationScale = inRotationScale;
+    vec2 gravityScale = inGravityScale;
+
+    int offset = (gl_VertexID - spawnStart + maxParticles) % maxParticles;
+    if (offset < spawnCount) {
+        randomState = uint(gl_VertexID) * 1973U + seed * 9277U + 26699U;
+        positionElapsed = vec4(randomIn(positionMin, positionMax), 0.0);
+        velocityDuration = vec4(randomIn(velocityMin, velocityMax), randomIn(durationRange));
+        rotationScale = vec4(randomIn(initialRotationRange), randomIn(finalRotationRange),
+                             randomIn(initialScaleRange), randomIn(finalScaleRange));
+        gravityScale = vec2(randomIn(initialGravityRange), randomIn(finalGravityRange));
+    }
+
+    // dead particles are left untouched
+    if (positionElapsed.w < velocityDuration.w) {
+        float deltaSec = deltaMillis / 1000.0;
+        positionElapsed.w += deltaMillis;
+        positionElapsed.xyz += velocityDuration.xyz * deltaSec;
+
+        float lifePercent = positionElapsed.w / velocityDuration.w;
+        velocityDuration.y -= gravity * deltaSec * mix(gravityScale.x, gravityScale.y, lifePercent);
+    }
+
+    outPositionElapsed = positionElapsed;
+    outVelocityDuration = velocityDuration;
+    outRotationScale = rotationScale;
+    outGravityScale = gravityScale;
+}
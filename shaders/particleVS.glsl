@@ -1,7 +1,6 @@
 layout (location = 0) in vec3 vPos;
-layout (location = 1) in mat4 iTransform;
-layout (location = 5) in vec4 iOffsets;
-layout (location = 6) in float iBlendFactor;
+layout (location = 1) in vec4 iPositionRotation;
+layout (location = 2) in vec2 iScaleFrame; // x: scale, y: frame (the fractional part is the blend factor)
 
 layout (std140) uniform CommonMat {
     mat4 projection;
@@ -9,6 +8,10 @@ layout (std140) uniform CommonMat {
 	mat4 projectionView;
 };
 
+uniform int frames;
+uniform int cols;
+uniform vec2 frameSize;
+
 out vec2 texCoord;
 out float blend;
 out vec4 offsets;
@@ -17,8 +20,10 @@ void main() {
     texCoord = vPos.xy + 0.5;
     texCoord.y = 1.0 - texCoord.y;
 
-    blend = iBlendFactor;
-    offsets = iOffsets;
+    int frame = int(iScaleFrame.y);
+    blend = iScaleFrame.y - frame;
+    offsets = vec4(particleFrameOffset(frame, cols, frameSize), particleFrameOffset(min(frame + 1, frames - 1), cols, frameSize));
 
-    gl_Position = projectionView * iTransform * vec4(vPos, 1.0f);
+    vec3 worldPosition = particleBillboard(iPositionRotation.xyz, vPos.xy, iPositionRotation.w, iScaleFrame.x, view);
+    gl_Position = projectionView * vec4(worldPosition, 1.0f);
 }
@@ -5,6 +5,14 @@ layout (std140) uniform Lights {
     Light lights[10];
 };
 
+layout (std140) uniform CommonMat {
+    mat4 projection;
+    mat4 view;
+    mat4 projectionView;
+    vec4 clipPlane;
+    mat4 inverseProjectionView;
+};
+
 layout (std140) uniform Camera {
     vec3 cameraPosition;
     vec3 cameraDirection;
@@ -12,7 +20,7 @@ layout (std140) uniform Camera {
 
 uniform sampler2D DiffuseData;
 uniform sampler2D PBRData;
-uniform sampler2D PositionData;
+uniform sampler2D DepthData;
 uniform sampler2D NormalData;
 
 uniform int lightIndex;
@@ -20,10 +28,10 @@ uniform int lightIndex;
 void main() {
     vec2 texCoord = gl_FragCoord.xy / textureSize(DiffuseData, 0);
 
-    vec3 albedo = texture(DiffuseData, texCoord).rgb;
+    vec3 albedo = pow(texture(DiffuseData, texCoord).rgb, vec3(2.2));
     vec4 data = texture(PBRData, texCoord);
-    vec3 normal = texture(NormalData, texCoord).xyz;
-    vec3 position = texture(PositionData, texCoord).xyz;
+    vec3 normal = decodeNormal(texture(NormalData, texCoord).xy);
+    vec3 position = reconstructPosition(texCoord, texture(DepthData, texCoord).r, inverseProjectionView);
 
     Light light = lights[lightIndex];
 
@@ -31,7 +39,7 @@ void main() {
 
     float inShadow = 0.0;
     if (light.castShadow)
-        inShadow = shadowMapIsInShadow(light.toLightSpace * vec4(position, 1.0), light.direction, normal, distance(cameraPosition, position));
+        inShadow = shadowMapIsInShadow(position, light.direction, normal, dot(position - cameraPosition, cameraDirection));
 
     vec3 color = pbrComputeColor(light, L, 1.0, inShadow, albedo, data.x, data.y, data.z, position, normal, cameraPosition);
 
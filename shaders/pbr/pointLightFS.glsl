@@ -5,6 +5,14 @@ layout (std140) uniform Lights {
     Light lights[10];
 };
 
+layout (std140) uniform CommonMat {
+    mat4 projection;
+    mat4 view;
+    mat4 projectionView;
+    vec4 clipPlane;
+    mat4 inverseProjectionView;
+};
+
 layout (std140) uniform Camera {
     vec3 cameraPosition;
     vec3 cameraDirection;
@@ -12,20 +20,24 @@ layout (std140) uniform Camera {
 
 uniform sampler2D DiffuseData;
 uniform sampler2D PBRData;
-uniform sampler2D PositionData;
+uniform sampler2D DepthData;
 uniform sampler2D NormalData;
 
-uniform int lightIndex;
+flat in int fragLightIndex;
+flat in float fragLightRadius;
 
 void main() {
     vec2 texCoord = gl_FragCoord.xy / textureSize(DiffuseData, 0);
 
-    vec3 albedo = texture(DiffuseData, texCoord).rgb;
+    vec3 albedo = pow(texture(DiffuseData, texCoord).rgb, vec3(2.2));
     vec4 data = texture(PBRData, texCoord);
-    vec3 normal = texture(NormalData, texCoord).xyz;
-    vec3 position = texture(PositionData, texCoord).xyz;
+    vec3 normal = decodeNormal(texture(NormalData, texCoord).xy);
+    vec3 position = reconstructPosition(texCoord, texture(DepthData, texCoord).r, inverseProjectionView);
 
-    Light light = lights[lightIndex];
+    // light volumes drawn by their back faces also cover the fragments in front of them
+    Light light = lights[fragLightIndex];
+    if (distance(position, light.position) > fragLightRadius)
+        discard;
 
     vec3 L = light.position - position;
     float inShadow = 0.0;
@@ -33,7 +45,7 @@ void main() {
     if (light.castShadow)
         inShadow = pointMapIsInShadow(position, light.position, cameraPosition);
 
-    vec3 color = pbrComputeColor(lights[lightIndex], L, -1.0, inShadow, albedo, data.x, data.y, data.z, position, normal, cameraPosition);
+    vec3 color = pbrComputeColor(light, L, -1.0, inShadow, albedo, data.x, data.y, data.z, position, normal, cameraPosition);
 
     FragColor = vec4(color, 1.0);
 }
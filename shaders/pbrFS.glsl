@@ -1,7 +1,6 @@
 layout (location = 0) out vec4 Diffuse;
 layout (location = 1) out vec4 PBRData;
-layout (location = 2) out vec3 Position;
-layout (location = 3) out vec3 Normal;
+layout (location = 2) out vec2 Normal;
 
 struct PBRMaterial {
     sampler2D albedo;
@@ -24,11 +23,10 @@ void main() {
     vec3 normal = (texture(material.normal, texCoord).rgb) * 2.0 - 1.0;
     normal = normalize(tangentToWorldSpace * normal);
 
-	Position = position;
-	Normal = normal;
+	Normal = encodeNormal(normal);
 
+    // stored in gamma space to keep precision in 8 bits, see pbr/directionalLightFS
     Diffuse = texture(material.albedo, texCoord);
-    Diffuse.rgb = pow(Diffuse.rgb, vec3(2.2));
 
     PBRData.x = texture(material.roughness, texCoord).r;
 	PBRData.y = texture(material.metalness, texCoord).r;
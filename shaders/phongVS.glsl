@@ -12,6 +12,9 @@ layout (std140) uniform CommonMat {
 	vec4 clipPlane;
 };
 
+// the depth must match the one of the depth pre-pass (see shadowMapVS)
+invariant gl_Position;
+
 out vec2 texCoord;
 out vec3 position;
 out vec3 normal;
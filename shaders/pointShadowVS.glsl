@@ -1,7 +1,11 @@
 layout (location = 0) in vec3 vPos;
 
 uniform mat4 model;
+uniform mat4 transform; // light space transformation of the face being rendered
+
+out vec4 position;
 
 void main() {
-    gl_Position = model * vec4(vPos, 1.0f);
+    position = model * vec4(vPos, 1.0f);
+    gl_Position = transform * position;
 }
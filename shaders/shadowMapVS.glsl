@@ -1,5 +1,5 @@
 /** This shader is used for when objects are
-  * rendered for shadow mapping */
+  * rendered for shadow mapping and in the depth pre-pass */
 layout (location = 0) in vec3 vPos;
 
 uniform mat4 model;
@@ -9,6 +9,10 @@ layout (std140) uniform CommonMat {
 	mat4 projectionView;
 };
 
+// the position is computed like in the deferred rendering shaders so that the depth is the same
+invariant gl_Position;
+
 void main() {
-    gl_Position = projectionView * model * vec4(vPos, 1.0f);
+    vec3 position = (model * vec4(vPos, 1.0f)).xyz;
+    gl_Position = projectionView * vec4(position, 1.0f);
 }
@@ -1,7 +1,6 @@
 layout (location = 0) out vec4 Diffuse;
 layout (location = 1) out vec4 Specular;
-layout (location = 2) out vec3 Position;
-layout (location = 3) out vec3 Normal;
+layout (location = 2) out vec2 Normal;
 
 in vec4 clipSpaceCoord;
 in vec2 texCoord;
@@ -9,6 +8,9 @@ in vec3 position;
 
 uniform float moveDuDv;
 
+// when true reflections are ray marched in the refraction texture
+uniform bool screenSpaceReflections;
+
 uniform sampler2D reflection;
 uniform sampler2D refraction;
 uniform sampler2D dudvMap;
@@ -27,16 +29,55 @@ layout (std140) uniform Camera {
     vec3 cameraDirection;
 };
 
+layout (std140) uniform CommonMat {
+    mat4 projection;
+    mat4 view;
+	mat4 projectionView;
+};
+
+const int reflectionSteps = 32;
+const float reflectionStepLength = 0.5;
+const float reflectionThickness = 1.0;
+
+float linearDepth(float depth) {
+	return 2.0 * near * far / (far + near - (2.0 * depth - 1.0) * (far - near));
+}
+
+// marches the reflected ray in screen space, if nothing is hit the color at the edge of the screen is used
+vec4 screenSpaceReflection(vec3 origin, vec3 direction) {
+	vec2 lastTexCoord = vec2(0.5);
+	float stepLength = reflectionStepLength;
+	vec3 point = origin;
+
+	for (int i = 0; i < reflectionSteps; ++i) {
+		point += direction * stepLength;
+		stepLength *= 1.15;
+
+		vec4 clip = projectionView * vec4(point, 1.0);
+		if (clip.w <= 0.0) break;
+
+		vec2 texCoord = (clip.xy / clip.w) / 2 + 0.5;
+		if (any(lessThan(texCoord, vec2(0.0))) || any(greaterThan(texCoord, vec2(1.0)))) break;
+		lastTexCoord = texCoord;
+
+		float sceneDepth = linearDepth(texture(depthMap, texCoord).r);
+		if (clip.w > sceneDepth && clip.w - sceneDepth < reflectionThickness * stepLength)
+			return texture(refraction, texCoord);
+	}
+
+	return texture(refraction, lastTexCoord);
+}
+
 void main() {
 	// calculate the texture coordinate for the ndc coordinates of this fragment
+	// the reflection is rendered with a mirrored camera, it is aligned with the screen
 	vec2 ndcTexCoord = (clipSpaceCoord.xy / clipSpaceCoord.w) / 2 + 0.5;
-	vec2 reflectionTexCoord = vec2(ndcTexCoord.x, -ndcTexCoord.y);
+	vec2 reflectionTexCoord = ndcTexCoord;
 	vec2 refractionTexCoord = ndcTexCoord;
 
 	// get ground and water height and compute the depth of the water
-	float height = texture(depthMap, ndcTexCoord).r;
-	float groundHeight = 2.0 * near * far / (far + near - (2.0 * height - 1.0) * (far - near));
-	height = 2.0 * near * far / (far + near - (2.0 * gl_FragCoord.z - 1.0) * (far - near));
+	float groundHeight = linearDepth(texture(depthMap, ndcTexCoord).r);
+	float height = linearDepth(gl_FragCoord.z);
 	float waterDepth = groundHeight - height;
 	waterDepth = clamp(waterDepth / 5.0, 0, 1);
 
@@ -50,14 +91,25 @@ void main() {
 
 
 	reflectionTexCoord += totDistortion;
-	reflectionTexCoord.x = clamp(reflectionTexCoord.x, 0.001, 0.999);
-	reflectionTexCoord.y = clamp(reflectionTexCoord.y, -0.999, -0.001);
+	reflectionTexCoord = clamp(reflectionTexCoord, 0.001, 0.999);
 
 	refractionTexCoord += totDistortion;
 	refractionTexCoord = clamp(refractionTexCoord, 0.001, 0.999);
 
-	vec4 reflectionColor = texture(reflection, reflectionTexCoord);
+	// without clip plane the distorted coordinates can fall on something above the water
+	if (screenSpaceReflections && linearDepth(texture(depthMap, refractionTexCoord).r) < height)
+		refractionTexCoord = ndcTexCoord;
+
 	vec4 refractionColor = texture(refraction, refractionTexCoord);
+	vec4 reflectionColor;
+	if (screenSpaceReflections) {
+		vec3 viewDirection = normalize(position - cameraPosition);
+		vec3 waveNormal = normalize(vec3(totDistortion.x, 1.0, totDistortion.y));
+		reflectionColor = screenSpaceReflection(position, reflect(viewDirection, waveNormal));
+	}
+	else {
+		reflectionColor = texture(reflection, reflectionTexCoord);
+	}
 
 	// Fresnel effect
 	vec3 rayToCamera = normalize(cameraPosition - position);
@@ -70,7 +122,7 @@ void main() {
 	Diffuse = mix(refractionColor, Diffuse, waterDepth);
 
 	// compute specular color and mix it with ground specular
-	Specular = vec4(vec3(1.0) * waterDepth, 128.0);
+	Specular = vec4(vec3(1.0) * waterDepth, encodeShininess(128.0));
 
 	// compute normal and mix it with that of the ground
 	vec4 sampledNormal = texture(normalMap, distortedTexCoords);
@@ -78,9 +130,5 @@ void main() {
 	vec3 normal = vec3(sampledNormal.r * 2 - 1, sampledNormal.b, (sampledNormal.g * 2.0 - 1.0));
 	normal = normalize(normal + vec3(0, 5, 0));
 
-	Normal = normal;
-
-	// position is not mixed with that of the ground since it is not
-	// beneficial
-	Position = position;
+	Normal = encodeNormal(normal);
 }
\ No newline at end of file
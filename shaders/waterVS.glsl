@@ -8,6 +8,9 @@ layout (std140) uniform CommonMat {
 	mat4 projectionView;
 };
 
+// the depth must match the one of the depth pre-pass (see shadowMapVS)
+invariant gl_Position;
+
 out vec4 clipSpaceCoord;
 out vec2 texCoord;
 out vec3 position;
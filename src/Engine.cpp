@@ -1,5 +1,4 @@
 #include "Engine.h"
-#include "timer/Timer.h"
 #include <SDL.h>
 #include <iostream>
 
@@ -12,6 +11,8 @@ RenderSystem Engine::renderSys;
 GameObjectRenderer Engine::gameObjectRenderer;
 ParticleRenderer Engine::particleRenderer;
 UIRenderer Engine::uiRenderer;
+JobSystem Engine::jobSystem;
+FrameScheduler Engine::frameScheduler;
 
 Engine::Engine()
 {
@@ -28,6 +29,8 @@ void Engine::init()
 {
     if (instance == nullptr)
         instance = std::make_unique<Engine>();
+
+    jobSystem.init();
 }
 
 unsigned int frames = 0;
@@ -39,31 +42,31 @@ void Engine::start()
         std::cerr << "Use of uninitialized engine, use init()";
         return;
     }
-    Timer actualTime;
-    actualTime.start();
-    float elapsedMillis;
 
     while (!shouldQuit) {
-        elapsedMillis = actualTime.getMillis();
+        const FrameScheduler::Frame frame = frameScheduler.beginFrame();
 
-		totDeltas += elapsedMillis;
+		totDeltas += frame.frameMillis;
 		frames++;
 
-        actualTime.stop();
-        actualTime.start();
-
-        eventManager.pushEnterFrameEvent(&elapsedMillis);
+        // updates do not depend on the frame rate in FIXED mode
+        for (std::uint32_t i = 0; i < frame.updates; ++i)
+            eventManager.pushEnterFrameEvent(frame.updateMillis);
         eventManager.dispatchEvents();
 
-		eventManager.pushPreRenderEvent(&elapsedMillis);
+		eventManager.pushPreRenderEvent(frame.frameMillis);
 		renderSys.renderScene();
-		eventManager.pushExitFrameEvent(&elapsedMillis);
+		eventManager.pushExitFrameEvent(frame.frameMillis);
+
+        frameScheduler.endFrame();
     }
 
+	gameObjectRenderer.cleanUp();
 	renderSys.cleanUp();
 	gameObjectManager.cleanUp();
 	particleRenderer.cleanUp();
     uiRenderer.cleanUp();
+	jobSystem.cleanUp();
 
 	std::cout << totDeltas / frames << "\n";
 }
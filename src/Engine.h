@@ -7,6 +7,8 @@
 #include "rendering/GameObjectRenderer.h"
 #include "rendering/particle/ParticleRenderer.h"
 #include "rendering/UIRenderer.h"
+#include "jobs/JobSystem.h"
+#include "timer/FrameScheduler.h"
 #include "SDL.h"
 #include <cstdint>
 #include <memory>
@@ -42,6 +44,12 @@ class Engine : public EventListener
         /** Renderer for UI */
         static UIRenderer uiRenderer;
 
+        /** Worker threads shared by all the systems */
+        static JobSystem jobSystem;
+
+        /** Decides the updates of each frame: fixed or variable timestep, frame rate limit */
+        static FrameScheduler frameScheduler;
+
         /**
           * Initializes the engine.
           * This method should be called before any other engine method */
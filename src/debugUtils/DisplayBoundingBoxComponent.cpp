@@ -18,7 +18,7 @@ DisplayBoundingBoxComponent::DisplayBoundingBoxComponent(const GameObjectEH& go,
 	mEnterFrameCrumb = Engine::eventManager.addListenerFor(EventManager::ENTER_FRAME_EVENT, this);
 }
 
-void DisplayBoundingBoxComponent::onEvent(SDL_Event e)
+void DisplayBoundingBoxComponent::onFrameEvent(SDL_EventType, float)
 {
 	auto bb = gameObject->transform.getBoundingBox();
 
@@ -25,7 +25,7 @@ private:
 public:
 	DisplayBoundingBoxComponent(const GameObjectEH& go, const glm::vec3& bbColor = glm::vec3{1.0f, 0.0f, 0.0f});
 
-	virtual void onEvent(SDL_Event e) override;
+	virtual void onFrameEvent(SDL_EventType type, float deltaMillis) override;
 
 	virtual ~DisplayBoundingBoxComponent();
 };
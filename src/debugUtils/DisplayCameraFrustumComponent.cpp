@@ -17,7 +17,7 @@ DisplayCameraFrustumComponent::DisplayCameraFrustumComponent(const GameObjectEH&
 	mEnterFrameCrumb = Engine::eventManager.addListenerFor(EventManager::ENTER_FRAME_EVENT, this);
 }
 
-void DisplayCameraFrustumComponent::onEvent(SDL_Event e)
+void DisplayCameraFrustumComponent::onFrameEvent(SDL_EventType, float)
 {
 	auto cameraComponent = gameObject->getComponent<CameraComponent>();
 	if (!cameraComponent) {
@@ -31,7 +31,7 @@ private:
 public:
 	DisplayCameraFrustumComponent(const GameObjectEH& go, const glm::vec3& color = glm::vec3{ 0.0f, 1.0f, 0.0f });
 
-	virtual void onEvent(SDL_Event e) override;
+	virtual void onFrameEvent(SDL_EventType type, float deltaMillis) override;
 
 	virtual ~DisplayCameraFrustumComponent() = default;
 };
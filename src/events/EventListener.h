@@ -6,7 +6,21 @@
 class EventListener
 {
 public:
-    virtual void onEvent(SDL_Event e) = 0;
+    virtual void onEvent(SDL_Event) {}
+
+    /**
+      * Receives the frame events (EventManager::ENTER_FRAME_EVENT, PRE_RENDER_EVENT and EXIT_FRAME_EVENT).
+      * Listeners called every frame should override it, by default the event is forwarded to onEvent
+      * with a pointer to deltaMillis in user.data1.
+      * @param type the type of the frame event
+      * @param deltaMillis the duration of the update or of the frame */
+    virtual void onFrameEvent(SDL_EventType type, float deltaMillis) {
+        SDL_Event e;
+        SDL_memset(&e, 0, sizeof(e));
+        e.type = type;
+        e.user.data1 = &deltaMillis;
+        onEvent(e);
+    }
 
     virtual ~EventListener(){};
 
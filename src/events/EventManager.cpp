@@ -8,16 +8,13 @@ const SDL_EventType EventManager::PRE_RENDER_EVENT = static_cast<SDL_EventType>(
 const SDL_EventType EventManager::ALL_EVENTS = static_cast<SDL_EventType>(SDL_RegisterEvents(1));
 
 
-EventManager::EventManager()
+EventManager::EventManager() : m_slots(SDL_LASTEVENT + 1, 0)
 {
 }
 
 CrumbPtr EventManager::addListenerFor(SDL_EventType event, EventListener* listener, bool wantCrumb)
 {
-    if (m_toAdd.count(event))
-        m_toAdd.at(event).push_back(listener);
-    else
-        m_toAdd.insert(std::make_pair(event, std::vector<EventListener*>{listener}));
+    m_toAdd.emplace_back(event, listener);
 
     std::unique_ptr<EventListenerCrumb> crumb;
     if (wantCrumb)
@@ -34,10 +31,50 @@ void EventManager::addListenerFor(SDL_EventType event, EventListenerCrumb* exist
 
 void EventManager::removeListenerFor(SDL_EventType event, EventListener* listener)
 {
-    if (m_toRemove.count(event))
-        m_toRemove.at(event).push_back(listener);
-    else
-        m_toRemove.insert(std::make_pair(event, std::vector<EventListener*>{listener}));
+    /* The listener is only marked as removed, the lists may be being iterated */
+    if (auto listeners = getListeners(event)) {
+        auto it = std::find(listeners->begin(), listeners->end(), listener);
+        if (it != listeners->end()) {
+            *it = nullptr;
+            m_hasRemoved = true;
+            return;
+        }
+    }
+
+    /* Not added yet */
+    auto it = std::find(m_toAdd.begin(), m_toAdd.end(), std::make_pair(event, listener));
+    if (it != m_toAdd.end())
+        m_toAdd.erase(it);
+}
+
+void EventManager::postEvent(const SDL_Event& event)
+{
+    m_posted.push(event);
+}
+
+std::vector<EventListener*>* EventManager::getListeners(SDL_EventType type)
+{
+    const std::uint16_t slot = m_slots[type];
+    return slot != 0 ? &m_listeners[slot - 1] : nullptr;
+}
+
+void EventManager::applyChanges()
+{
+    if (m_hasRemoved) {
+        for (auto& listeners : m_listeners)
+            listeners.erase(std::remove(listeners.begin(), listeners.end(), nullptr), listeners.end());
+        m_hasRemoved = false;
+    }
+
+    for (const auto& [type, listener] : m_toAdd) {
+        if (m_slots[type] == 0) {
+            m_listeners.emplace_back();
+            m_slots[type] = static_cast<std::uint16_t>(m_listeners.size());
+        }
+        m_listeners[m_slots[type] - 1].push_back(listener);
+    }
+
+    m_toAdd.clear();
 }
 
 void EventManager::dispatchEvents()
@@ -51,53 +88,52 @@ void EventManager::dispatchEvents()
         dispatchToListeners(EventManager::ALL_EVENTS, event);
     }
 
-    /* Adds the listeners */
-    for (auto it = m_toAdd.begin(); it != m_toAdd.end(); ++it)
-        if (m_event2listeners.count(it->first)) // already has some listeners for this event, append
-            m_event2listeners.at(it->first).insert(m_event2listeners.at(it->first).end(), it->second.begin(), it->second.end());
-        else // No listener for this event, just copy
-            m_event2listeners.insert(std::make_pair(it->first, it->second));
+    /* Dispatches the events posted by other threads */
+    while (m_posted.pop(event)) {
+        SDL_EventType eventType = static_cast<SDL_EventType>(event.type);
+        dispatchToListeners(eventType, event);
+        dispatchToListeners(EventManager::ALL_EVENTS, event);
+    }
 
-    m_toAdd.clear();
+    applyChanges();
 }
 
 void EventManager::dispatchToListeners(SDL_EventType eventType, SDL_Event& event)
 {
-    if (m_event2listeners.count(eventType)) {
-        // List of listeners for this type of event
-        auto& listeners = m_event2listeners[eventType];
-        for (auto it = listeners.begin(); it != listeners.end(); ) {
-            /* Skip a listener if it is removed and removes it */
-            if (m_toRemove.count(eventType)) {
-                auto& removed = m_toRemove[eventType];
-                const auto& listenerToRemove = std::find(removed.begin(), removed.end(), *it);
-                if (listenerToRemove != removed.end()) {
-                    removed.erase(listenerToRemove);
-                    it = listeners.erase(it);
-                    continue;
-                }
-            }
-
-            (*it)->onEvent(event);
-            ++it;
-        }
-    }
+    auto listeners = getListeners(eventType);
+    if (!listeners)
+        return;
+
+    /* Listeners are not added while dispatching, removed ones are nullptr */
+    for (EventListener* listener : *listeners)
+        if (listener)
+            listener->onEvent(event);
 }
 
+void EventManager::pushFrameEvent(SDL_EventType type, float deltaMillis)
+{
+    auto listeners = getListeners(type);
+    if (!listeners)
+        return;
+
+    for (EventListener* listener : *listeners)
+        if (listener)
+            listener->onFrameEvent(type, deltaMillis);
+}
 
-void EventManager::pushEnterFrameEvent(float* deltaMillis)
+void EventManager::pushEnterFrameEvent(float deltaMillis)
 {
-	pushEvent(ENTER_FRAME_EVENT, deltaMillis);
+	pushFrameEvent(ENTER_FRAME_EVENT, deltaMillis);
 }
 
-void EventManager::pushExitFrameEvent(float* deltaMillis)
+void EventManager::pushExitFrameEvent(float deltaMillis)
 {
-	pushEvent(EXIT_FRAME_EVENT, deltaMillis);
+	pushFrameEvent(EXIT_FRAME_EVENT, deltaMillis);
 }
 
-void EventManager::pushPreRenderEvent(float* deltaMillis)
+void EventManager::pushPreRenderEvent(float deltaMillis)
 {
-	pushEvent(PRE_RENDER_EVENT, deltaMillis);
+	pushFrameEvent(PRE_RENDER_EVENT, deltaMillis);
 }
 
 void EventManager::pushEvent(SDL_EventType type, void* data1 /*= nullptr*/, void* data2 /*= nullptr*/)
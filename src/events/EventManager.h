@@ -1,35 +1,52 @@
 #ifndef EVENTMANAGER_H
 #define EVENTMANAGER_H
-#include <map>
+#include <cstdint>
+#include <utility>
 #include <vector>
 #include <SDL.h>
 #include <memory>
 #include "events/EventListener.h"
 #include "events/EventListenerCrumb.h"
+#include "events/MPSCQueue.h"
 
 class EventManager
 {
     friend class Engine;
 
     private:
-        /** m_event2listeners cannot be modified while iterating it. Two other support
-          * maps are used to temporarily store values to add and remove */
-        std::map<SDL_EventType, std::vector<EventListener*>> m_event2listeners;
-        std::map<SDL_EventType, std::vector<EventListener*>> m_toAdd;
-        std::map<SDL_EventType, std::vector<EventListener*>> m_toRemove;
+        /** for each event type the index + 1 of its listeners in m_listeners, 0 if it never had listeners */
+        std::vector<std::uint16_t> m_slots;
+
+        /** Listeners removed while dispatching are set to nullptr, they are erased by applyChanges */
+        std::vector<std::vector<EventListener*>> m_listeners;
+
+        /** listeners added, they start receiving events after the next dispatchEvents */
+        std::vector<std::pair<SDL_EventType, EventListener*>> m_toAdd;
+        bool m_hasRemoved = false;
+
+        /** events posted by any thread */
+        MPSCQueue<SDL_Event> m_posted;
 
         EventManager();
 
-        void pushEnterFrameEvent(float* deltaMillis);
+        void pushEnterFrameEvent(float deltaMillis);
 
-		void pushExitFrameEvent(float* deltaMillis);
+		void pushExitFrameEvent(float deltaMillis);
 
-		void pushPreRenderEvent(float* deltaMillis);
+		void pushPreRenderEvent(float deltaMillis);
+
+		void pushFrameEvent(SDL_EventType type, float deltaMillis);
 
 		void pushEvent(SDL_EventType type, void* data1 = nullptr, void* data2 = nullptr);
 
+		/** @return the listeners of an event type, nullptr if it has none */
+		std::vector<EventListener*>* getListeners(SDL_EventType type);
+
+		/** Erases the removed listeners and adds the new ones */
+		void applyChanges();
+
     public:
-		/** Enter frame event. Emitted every time a new frame begins */
+		/** Enter frame event. Emitted for each update of a frame, see FrameScheduler */
         static const SDL_EventType ENTER_FRAME_EVENT;
 
 		/** Exit frame event. Emitted every time a frame ends */
@@ -53,13 +70,21 @@ class EventManager
 
 		/**
 		 * Removes a listener for a given event.
+		 * The listener does not receive the event anymore, even if it is being dispatched.
 		 * @param event the listener will no more receive notifications for this event.
 		 * @listener the listener
 		 */
         void removeListenerFor(SDL_EventType event, EventListener* listener);
 
         /**
-          * Dispatches all the events from the event queue
+          * Queues an event, dispatched by the next dispatchEvents.
+          * Unlike the other methods, it can be called by any thread (e.g. by jobs of the JobSystem).
+          * @param event the event
+          */
+        void postEvent(const SDL_Event& event);
+
+        /**
+          * Dispatches all the events from the event queue and the posted events
           */
         void dispatchEvents();
 
@@ -0,0 +1,69 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+#include <atomic>
+#include <utility>
+
+/**
+  * Lock-free queue written by many producer threads and read by a single consumer thread.
+  * Producers never wait: a push is a single atomic exchange. A value pushed while the
+  * consumer is popping may only be returned by a following pop.
+  * @tparam T the type of the values, it must be default constructible */
+template <typename T>
+class MPSCQueue
+{
+    private:
+        struct Node {
+            std::atomic<Node*> next{ nullptr };
+            T value;
+        };
+
+        /** the last node pushed, written by the producers */
+        std::atomic<Node*> mHead;
+
+        /** the node before the first value, only used by the consumer */
+        Node* mTail;
+
+    public:
+        MPSCQueue() {
+            Node* stub = new Node{};
+            mHead.store(stub, std::memory_order_relaxed);
+            mTail = stub;
+        }
+
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        /**
+          * Adds a value, it can be called by any thread.
+          * @param value the value to add */
+        void push(T value) {
+            Node* node = new Node{};
+            node->value = std::move(value);
+
+            Node* previous = mHead.exchange(node, std::memory_order_acq_rel);
+            previous->next.store(node, std::memory_order_release);
+        }
+
+        /**
+          * Removes the oldest value, only the consumer thread can call it.
+          * @param value set to the removed value
+          * @return false if the queue is empty */
+        bool pop(T& value) {
+            Node* next = mTail->next.load(std::memory_order_acquire);
+            if (next == nullptr)
+                return false;
+
+            value = std::move(next->value);
+            delete mTail;
+            mTail = next;
+            return true;
+        }
+
+        ~MPSCQueue() {
+            T value;
+            while (pop(value));
+            delete mTail;
+        }
+};
+
+#endif // MPSCQUEUE_H
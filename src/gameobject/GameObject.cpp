@@ -15,6 +15,12 @@ const std::vector<Mesh>& GameObject::getMeshes() const
 	return mMeshes;
 }
 
+void GameObject::setMesh(std::size_t index, const Mesh& mesh)
+{
+	mMeshes[index] = mesh;
+	transform.updateMeshBoundingBox();
+}
+
 const std::vector<MaterialPtr>& GameObject::getMaterials() const
 {
 	return mMaterials;
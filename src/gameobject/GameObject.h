@@ -27,6 +27,13 @@ class GameObject
 		/** the name of this GameObject */
         std::string name = "gameobject";
 
+		/**
+		 * Static GameObjects are not supposed to move or change their meshes.
+		 * Lights whose ShadowCasterMode is STATIC or AUTO cache the shadows casted by static
+		 * GameObjects, call Light::updateShadow() after changing one of them.
+		 */
+		bool isStatic = false;
+
         GameObject() = default;
 
         void addMesh(const Mesh& mesh, const MaterialPtr& material);
@@ -36,6 +43,13 @@ class GameObject
 		 */
 		const std::vector<Mesh>& getMeshes() const;
 
+		/**
+		 * Replaces a Mesh of this GameObject, its material is kept.
+		 * @param index the index of the mesh in getMeshes
+		 * @param mesh the new mesh
+		 */
+		void setMesh(std::size_t index, const Mesh& mesh);
+
 		/**
 		 * @return the materials used by this GameObject
 		 */
@@ -176,7 +176,7 @@ void GameObjectLoader::processMesh(const GameObjectEH& go, aiNode* node, int mes
 	if (needsTangents)
 		computeTangentsAndBitangentSign(mesh, tangents, bitangentSign);
 
-    MeshLoader loader;
+    MeshLoader loader{ GL_TRIANGLES, true };
     loader.loadData(positions.data(), positions.size(), 3);
     loader.loadData(normals.data(), normals.size(), 3);
     loader.loadData(texCoords.data(), texCoords.size(), 2);
@@ -3,6 +3,7 @@
 #include "BoundingBox.h"
 #include "Plane.h"
 #include "Frustum.h"
+#include "Sphere.h"
 
 IntersectionTestResult operator&(IntersectionTestResult r1, IntersectionTestResult r2) {
 	return static_cast<IntersectionTestResult>(static_cast<std::int8_t>(r1) & static_cast<std::int8_t>(r2));
@@ -41,3 +42,22 @@ IntersectionTestResult boxFrustumIntersection(const BoundingBox& box, const Frus
 
 	return result;
 }
+
+IntersectionTestResult boxSphereIntersection(const BoundingBox& box, const Sphere& sphere)
+{
+	const glm::vec3& center = sphere.getCenter();
+	const float squaredRadius = sphere.getRadius() * sphere.getRadius();
+
+	// the point of the box closest to the center of the sphere
+	const glm::vec3 closest = glm::clamp(center, box.getMin(), box.getMax());
+	const glm::vec3 toClosest = closest - center;
+	if (glm::dot(toClosest, toClosest) > squaredRadius)
+		return IntersectionTestResult::OUTSIDE;
+
+	// the vertex of the box farthest from the center of the sphere
+	const glm::vec3 farthest = glm::max(glm::abs(box.getMin() - center), glm::abs(box.getMax() - center));
+	if (glm::dot(farthest, farthest) <= squaredRadius)
+		return IntersectionTestResult::INSIDE;
+
+	return IntersectionTestResult::OVERLAP;
+}
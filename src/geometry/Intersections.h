@@ -10,6 +10,7 @@
 struct Plane;
 struct BoundingBox;
 struct Frustum;
+struct Sphere;
 
 /**
  * The possible results of an intersection test.
@@ -35,4 +36,12 @@ IntersectionTestResult planeBoxIntersection(const Plane& plane, const BoundingBo
  * @param frustum the frustum
  * @return whether the box is outside, inside or it's overlapping the frustum
  */
-IntersectionTestResult boxFrustumIntersection(const BoundingBox& box, const Frustum& frustum);
\ No newline at end of file
+IntersectionTestResult boxFrustumIntersection(const BoundingBox& box, const Frustum& frustum);
+
+/**
+ * Checks if a BoundingBox intersects a Sphere.
+ * @param box the bounding box
+ * @param sphere the sphere
+ * @return whether the box is outside, inside or it's overlapping the sphere
+ */
+IntersectionTestResult boxSphereIntersection(const BoundingBox& box, const Sphere& sphere);
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "Sphere.h"
+
+Sphere::Sphere(const glm::vec3& center, float radius)
+	: mCenter{ center }, mRadius{ radius }
+{
+}
+
+const glm::vec3& Sphere::getCenter() const
+{
+	return mCenter;
+}
+
+float Sphere::getRadius() const
+{
+	return mRadius;
+}
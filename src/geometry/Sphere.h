@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+struct Sphere
+{
+private:
+	glm::vec3 mCenter{ 0.0f };
+	float mRadius = 0.0f;
+
+public:
+	Sphere() = default;
+
+	/**
+	 * Creates a Sphere given its center and its radius.
+	 * @param center the center of the sphere
+	 * @param radius the radius of the sphere
+	 */
+	Sphere(const glm::vec3& center, float radius);
+
+	/**
+	 * @return the center of the Sphere
+	 */
+	const glm::vec3& getCenter() const;
+
+	/**
+	 * @return the radius of the Sphere
+	 */
+	float getRadius() const;
+};
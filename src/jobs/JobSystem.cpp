@@ -0,0 +1,115 @@
+#include "jobs/JobSystem.h"
+#include <algorithm>
+
+void JobSystem::init(std::uint32_t workers)
+{
+    if (!mWorkers.empty())
+        return;
+
+    if (workers == 0) {
+        // hardware_concurrency returns 0 when the number of threads is unknown
+        const unsigned hc = std::thread::hardware_concurrency();
+        workers = hc > 1 ? hc - 1 : 1;
+    }
+
+    mStopping = false;
+    for (std::uint32_t i = 0; i < workers; ++i)
+        mWorkers.emplace_back(&JobSystem::workerLoop, this);
+}
+
+void JobSystem::workerLoop()
+{
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock{ mMutex };
+            mJobAvailable.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+
+            // pending jobs are completed before stopping
+            if (mJobs.empty())
+                return;
+
+            job = std::move(mJobs.front());
+            mJobs.pop();
+        }
+
+        job();
+    }
+}
+
+void JobSystem::push(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock{ mMutex };
+        if (!mWorkers.empty() && !mStopping) {
+            mJobs.push(std::move(job));
+            mJobAvailable.notify_one();
+            return;
+        }
+    }
+
+    // not running: execute on the calling thread
+    job();
+}
+
+bool JobSystem::runPendingJob()
+{
+    std::function<void()> job;
+    {
+        std::lock_guard<std::mutex> lock{ mMutex };
+        if (mJobs.empty())
+            return false;
+
+        job = std::move(mJobs.front());
+        mJobs.pop();
+    }
+
+    job();
+    return true;
+}
+
+void JobSystem::parallelFor(std::size_t count, std::size_t minRangeSize, const std::function<void(std::size_t, std::size_t)>& function)
+{
+    if (count == 0)
+        return;
+
+    std::size_t ranges = std::min(mWorkers.size() + 1, std::max<std::size_t>(1, count / std::max<std::size_t>(1, minRangeSize)));
+    std::size_t rangeSize = (count + ranges - 1) / ranges;
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(ranges);
+    for (std::size_t begin = rangeSize; begin < count; begin += rangeSize) {
+        std::size_t end = std::min(count, begin + rangeSize);
+        pending.push_back(submit([&function, begin, end]() { function(begin, end); }));
+    }
+
+    function(0, std::min(count, rangeSize));
+
+    for (auto& future : pending) {
+        wait(future);
+        future.get();
+    }
+}
+
+std::size_t JobSystem::getWorkersNumber() const
+{
+    return mWorkers.size();
+}
+
+void JobSystem::cleanUp()
+{
+    {
+        std::lock_guard<std::mutex> lock{ mMutex };
+        mStopping = true;
+    }
+    mJobAvailable.notify_all();
+
+    for (auto& worker : mWorkers)
+        worker.join();
+    mWorkers.clear();
+}
+
+JobSystem::~JobSystem()
+{
+    cleanUp();
+}
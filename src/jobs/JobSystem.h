@@ -0,0 +1,97 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+#include <cstdint>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <chrono>
+
+/**
+  * A pool of worker threads shared by the engine.
+  * Jobs are functions executed by the first available worker. Threads
+  * waiting for other jobs run pending jobs in the meanwhile, so jobs can
+  * safely submit (and wait for) other jobs.
+  * @sa Engine::jobSystem */
+class JobSystem
+{
+    friend class Engine;
+
+    private:
+        std::vector<std::thread> mWorkers;
+        std::queue<std::function<void()>> mJobs;
+        std::mutex mMutex;
+        std::condition_variable mJobAvailable;
+        bool mStopping = false;
+
+        void workerLoop();
+
+        /**
+          * Starts the worker threads.
+          * @param workers the number of workers, if 0 one worker per hardware thread but one is used */
+        void init(std::uint32_t workers = 0);
+
+        void cleanUp();
+
+        void push(std::function<void()> job);
+
+    public:
+        JobSystem() = default;
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        /**
+          * Submits a job.
+          * If the job system is not running the job is executed immediately.
+          * @param job the function to execute
+          * @return a future containing the result of the job */
+        template <typename Job>
+        std::future<typename std::invoke_result<Job>::type> submit(Job&& job) {
+            using Result = typename std::invoke_result<Job>::type;
+
+            // std::function must be copyable, packaged_task is not
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Job>(job));
+            std::future<Result> result = task->get_future();
+            push([task]() { (*task)(); });
+
+            return result;
+        }
+
+        /**
+          * Runs a pending job on the calling thread, if any.
+          * @return true if a job was executed */
+        bool runPendingJob();
+
+        /**
+          * Waits for a job, running other pending jobs in the meanwhile.
+          * @param future the future of the job to wait for */
+        template <typename T>
+        void wait(std::future<T>& future) {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (!runPendingJob())
+                    std::this_thread::yield();
+            }
+        }
+
+        /**
+          * Calls function(begin, end) for contiguous ranges covering [0, count) in parallel.
+          * The calling thread processes the first range and returns when all the ranges are done.
+          * @param count the number of elements
+          * @param minRangeSize ranges smaller than this are never created
+          * @param function the function to call for each range */
+        void parallelFor(std::size_t count, std::size_t minRangeSize, const std::function<void(std::size_t, std::size_t)>& function);
+
+        /**
+          * @return the number of worker threads */
+        std::size_t getWorkersNumber() const;
+
+        ~JobSystem();
+};
+
+#endif // JOBSYSTEM_H
@@ -0,0 +1,64 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+  * Lock-free exchange of values between a producer thread and a consumer thread.
+  * The producer writes into the back buffer and publishes it, the consumer reads
+  * the front buffer after acquiring the most recently published one. Neither thread
+  * ever waits for the other: values published but not acquired in time are overwritten.
+  * @tparam T the type of the exchanged values */
+template <typename T>
+class TripleBuffer
+{
+    private:
+        static constexpr std::uint8_t INDEX_MASK = 0x3;
+        static constexpr std::uint8_t NEW_DATA = 0x4;
+
+        std::array<T, 3> mBuffers;
+
+        /** index of the buffer in the middle, NEW_DATA is set if it was published and not acquired yet */
+        std::atomic<std::uint8_t> mMiddle{ 1 };
+
+        /** only used by the producer */
+        std::uint8_t mBack = 0;
+
+        /** only used by the consumer */
+        std::uint8_t mFront = 2;
+
+    public:
+        /**
+          * @return the buffer the producer writes to */
+        T& getBack() {
+            return mBuffers[mBack];
+        }
+
+        /**
+          * Publishes the back buffer, the producer gets a new back buffer. */
+        void publish() {
+            std::uint8_t previous = mMiddle.exchange(mBack | NEW_DATA, std::memory_order_acq_rel);
+            mBack = previous & INDEX_MASK;
+        }
+
+        /**
+          * Makes the last published buffer the front buffer.
+          * @return true if a new buffer was published since the last call */
+        bool acquire() {
+            if (!(mMiddle.load(std::memory_order_acquire) & NEW_DATA))
+                return false;
+
+            std::uint8_t previous = mMiddle.exchange(mFront, std::memory_order_acq_rel);
+            mFront = previous & INDEX_MASK;
+            return true;
+        }
+
+        /**
+          * @return the buffer the consumer reads from */
+        const T& getFront() const {
+            return mBuffers[mFront];
+        }
+};
+
+#endif // TRIPLEBUFFER_H
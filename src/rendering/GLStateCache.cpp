@@ -0,0 +1,267 @@
+#include "rendering/GLStateCache.h"
+#include <algorithm>
+
+GLuint GLStateCache::mProgram = UNKNOWN;
+GLuint GLStateCache::mVertexArray = UNKNOWN;
+GLenum GLStateCache::mActiveTexture = UNKNOWN;
+std::array<std::array<GLuint, GLStateCache::TEXTURE_TARGETS.size()>, GLStateCache::MAX_TEXTURE_UNITS> GLStateCache::mTextures = []() {
+	std::array<std::array<GLuint, TEXTURE_TARGETS.size()>, MAX_TEXTURE_UNITS> textures;
+	for (auto& unit : textures)
+		unit.fill(UNKNOWN);
+	return textures;
+}();
+std::unordered_map<GLenum, bool> GLStateCache::mCapabilities;
+GLuint GLStateCache::mDepthMask = UNKNOWN;
+GLenum GLStateCache::mDepthFunc = UNKNOWN;
+GLenum GLStateCache::mCullFace = UNKNOWN;
+std::array<GLenum, 2> GLStateCache::mBlendFunc{ UNKNOWN, UNKNOWN };
+std::array<GLuint, 3> GLStateCache::mStencilFunc{ UNKNOWN, UNKNOWN, UNKNOWN };
+std::array<GLenum, 3> GLStateCache::mStencilOp{ UNKNOWN, UNKNOWN, UNKNOWN };
+GLuint GLStateCache::mStencilMask = UNKNOWN;
+std::array<GLuint, GLStateCache::MAX_UNIFORM_BUFFERS> GLStateCache::mUniformBuffers = []() {
+	std::array<GLuint, MAX_UNIFORM_BUFFERS> buffers;
+	buffers.fill(UNKNOWN);
+	return buffers;
+}();
+
+GLStateCache::Counters GLStateCache::mCounters;
+GLStateCache::Counters GLStateCache::mLastFrameCounters;
+
+bool GLStateCache::changes(bool changes)
+{
+	if (changes)
+		mCounters.issued++;
+	else
+		mCounters.filtered++;
+
+	return changes;
+}
+
+int GLStateCache::textureTargetIndex(GLenum target)
+{
+	auto it = std::find(TEXTURE_TARGETS.begin(), TEXTURE_TARGETS.end(), target);
+	return it == TEXTURE_TARGETS.end() ? -1 : static_cast<int>(it - TEXTURE_TARGETS.begin());
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+	if (changes(mProgram != program)) {
+		mProgram = program;
+		glUseProgram(program);
+	}
+}
+
+void GLStateCache::bindVertexArray(GLuint vertexArray)
+{
+	if (changes(mVertexArray != vertexArray)) {
+		mVertexArray = vertexArray;
+		glBindVertexArray(vertexArray);
+	}
+}
+
+void GLStateCache::activeTexture(GLenum unit)
+{
+	if (changes(mActiveTexture != unit)) {
+		mActiveTexture = unit;
+		glActiveTexture(unit);
+	}
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+	const int targetIndex = textureTargetIndex(target);
+	const GLuint unit = mActiveTexture - GL_TEXTURE0;
+	if (targetIndex < 0 || mActiveTexture == UNKNOWN || unit >= MAX_TEXTURE_UNITS) {
+		changes(true);
+		glBindTexture(target, texture);
+		return;
+	}
+
+	GLuint& bound = mTextures[unit][targetIndex];
+	if (changes(bound != texture)) {
+		bound = texture;
+		glBindTexture(target, texture);
+	}
+}
+
+void GLStateCache::enable(GLenum capability)
+{
+	auto it = mCapabilities.find(capability);
+	if (changes(it == mCapabilities.end() || !it->second)) {
+		mCapabilities[capability] = true;
+		glEnable(capability);
+	}
+}
+
+void GLStateCache::disable(GLenum capability)
+{
+	auto it = mCapabilities.find(capability);
+	if (changes(it == mCapabilities.end() || it->second)) {
+		mCapabilities[capability] = false;
+		glDisable(capability);
+	}
+}
+
+bool GLStateCache::isEnabled(GLenum capability)
+{
+	auto it = mCapabilities.find(capability);
+	if (it != mCapabilities.end())
+		return it->second;
+
+	const bool enabled = glIsEnabled(capability);
+	mCapabilities[capability] = enabled;
+	return enabled;
+}
+
+void GLStateCache::depthMask(GLboolean mask)
+{
+	if (changes(mDepthMask != mask)) {
+		mDepthMask = mask;
+		glDepthMask(mask);
+	}
+}
+
+void GLStateCache::depthFunc(GLenum func)
+{
+	if (changes(mDepthFunc != func)) {
+		mDepthFunc = func;
+		glDepthFunc(func);
+	}
+}
+
+void GLStateCache::cullFace(GLenum mode)
+{
+	if (changes(mCullFace != mode)) {
+		mCullFace = mode;
+		glCullFace(mode);
+	}
+}
+
+void GLStateCache::blendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	const std::array<GLenum, 2> blendFunc{ sourceFactor, destinationFactor };
+	if (changes(mBlendFunc != blendFunc)) {
+		mBlendFunc = blendFunc;
+		glBlendFunc(sourceFactor, destinationFactor);
+	}
+}
+
+void GLStateCache::stencilFunc(GLenum func, GLint reference, GLuint mask)
+{
+	const std::array<GLuint, 3> stencilFunc{ func, static_cast<GLuint>(reference), mask };
+	if (changes(mStencilFunc != stencilFunc)) {
+		mStencilFunc = stencilFunc;
+		glStencilFunc(func, reference, mask);
+	}
+}
+
+void GLStateCache::stencilOp(GLenum stencilFail, GLenum depthFail, GLenum depthPass)
+{
+	const std::array<GLenum, 3> stencilOp{ stencilFail, depthFail, depthPass };
+	if (changes(mStencilOp != stencilOp)) {
+		mStencilOp = stencilOp;
+		glStencilOp(stencilFail, depthFail, depthPass);
+	}
+}
+
+void GLStateCache::stencilOpSeparate(GLenum face, GLenum stencilFail, GLenum depthFail, GLenum depthPass)
+{
+	changes(true);
+	mStencilOp = { UNKNOWN, UNKNOWN, UNKNOWN };
+	glStencilOpSeparate(face, stencilFail, depthFail, depthPass);
+}
+
+void GLStateCache::stencilMask(GLuint mask)
+{
+	if (changes(mStencilMask != mask)) {
+		mStencilMask = mask;
+		glStencilMask(mask);
+	}
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	if (target != GL_UNIFORM_BUFFER || index >= MAX_UNIFORM_BUFFERS) {
+		changes(true);
+		glBindBufferBase(target, index, buffer);
+		return;
+	}
+
+	if (changes(mUniformBuffers[index] != buffer)) {
+		mUniformBuffers[index] = buffer;
+		glBindBufferBase(target, index, buffer);
+	}
+}
+
+void GLStateCache::deleteTextures(GLsizei n, const GLuint* textures)
+{
+	// deleted textures are unbound from every unit
+	for (auto& unit : mTextures)
+		for (GLuint& bound : unit)
+			if (std::find(textures, textures + n, bound) != textures + n)
+				bound = 0;
+
+	changes(true);
+	glDeleteTextures(n, textures);
+}
+
+void GLStateCache::deleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	// a new buffer with the same name must be bound again
+	for (GLuint& bound : mUniformBuffers)
+		if (std::find(buffers, buffers + n, bound) != buffers + n)
+			bound = UNKNOWN;
+
+	changes(true);
+	glDeleteBuffers(n, buffers);
+}
+
+void GLStateCache::deleteVertexArrays(GLsizei n, const GLuint* vertexArrays)
+{
+	if (std::find(vertexArrays, vertexArrays + n, mVertexArray) != vertexArrays + n)
+		mVertexArray = 0;
+
+	changes(true);
+	glDeleteVertexArrays(n, vertexArrays);
+}
+
+void GLStateCache::deleteProgram(GLuint program)
+{
+	// a program in use is deleted only when it is not used anymore, so it is still bound
+	changes(true);
+	glDeleteProgram(program);
+}
+
+void GLStateCache::countCall()
+{
+	mCounters.issued++;
+}
+
+void GLStateCache::invalidate()
+{
+	mProgram = UNKNOWN;
+	mVertexArray = UNKNOWN;
+	mActiveTexture = UNKNOWN;
+	for (auto& unit : mTextures)
+		unit.fill(UNKNOWN);
+	mCapabilities.clear();
+	mDepthMask = UNKNOWN;
+	mDepthFunc = UNKNOWN;
+	mCullFace = UNKNOWN;
+	mBlendFunc.fill(UNKNOWN);
+	mStencilFunc.fill(UNKNOWN);
+	mStencilOp.fill(UNKNOWN);
+	mStencilMask = UNKNOWN;
+	mUniformBuffers.fill(UNKNOWN);
+}
+
+void GLStateCache::endFrame()
+{
+	mLastFrameCounters = mCounters;
+	mCounters = Counters{};
+}
+
+GLStateCache::Counters GLStateCache::getLastFrameCounters()
+{
+	return mLastFrameCounters;
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <glad/glad.h>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+/**
+ * Shadows the OpenGL state changed by the engine and filters the calls that would not change it.
+ * Every change of the cached state must go through this class, otherwise the cache does not match
+ * the actual state: program, vertex array, texture bindings, capabilities (glEnable/glDisable),
+ * depth, stencil, culling and blending functions and uniform buffer bindings.
+ * It also counts the OpenGL calls of each frame.
+ */
+class GLStateCache
+{
+public:
+	/** OpenGL calls of a frame */
+	struct Counters {
+		/** calls actually issued to OpenGL */
+		std::uint64_t issued = 0;
+
+		/** calls filtered since they would not change the state */
+		std::uint64_t filtered = 0;
+	};
+
+	static constexpr std::uint32_t MAX_TEXTURE_UNITS = 32;
+	static constexpr std::uint32_t MAX_UNIFORM_BUFFERS = 16;
+
+private:
+	/** value of the cached state that is not known */
+	static constexpr GLuint UNKNOWN = 0xFFFFFFFF;
+
+	/** cached texture targets, other targets are not cached */
+	static constexpr std::array<GLenum, 4> TEXTURE_TARGETS{ GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_3D };
+
+	static GLuint mProgram;
+	static GLuint mVertexArray;
+	static GLenum mActiveTexture;
+	static std::array<std::array<GLuint, TEXTURE_TARGETS.size()>, MAX_TEXTURE_UNITS> mTextures;
+	static std::unordered_map<GLenum, bool> mCapabilities;
+	static GLuint mDepthMask;
+	static GLenum mDepthFunc;
+	static GLenum mCullFace;
+	static std::array<GLenum, 2> mBlendFunc;
+	static std::array<GLuint, 3> mStencilFunc;
+	static std::array<GLenum, 3> mStencilOp;
+	static GLuint mStencilMask;
+	static std::array<GLuint, MAX_UNIFORM_BUFFERS> mUniformBuffers;
+
+	static Counters mCounters;
+	static Counters mLastFrameCounters;
+
+	/** counts a call, returns true if it must be issued */
+	static bool changes(bool changes);
+
+	static int textureTargetIndex(GLenum target);
+
+public:
+	GLStateCache() = delete;
+
+	static void useProgram(GLuint program);
+
+	static void bindVertexArray(GLuint vertexArray);
+
+	static void activeTexture(GLenum unit);
+
+	/** binds a texture to the active texture unit */
+	static void bindTexture(GLenum target, GLuint texture);
+
+	static void enable(GLenum capability);
+
+	static void disable(GLenum capability);
+
+	/** @return whether a capability is enabled, it is queried only if unknown */
+	static bool isEnabled(GLenum capability);
+
+	static void depthMask(GLboolean mask);
+
+	static void depthFunc(GLenum func);
+
+	static void cullFace(GLenum mode);
+
+	static void blendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+	static void stencilFunc(GLenum func, GLint reference, GLuint mask);
+
+	static void stencilOp(GLenum stencilFail, GLenum depthFail, GLenum depthPass);
+
+	/** the stencil operations are not cached per face, after this call they are unknown */
+	static void stencilOpSeparate(GLenum face, GLenum stencilFail, GLenum depthFail, GLenum depthPass);
+
+	static void stencilMask(GLuint mask);
+
+	/** only the bindings of GL_UNIFORM_BUFFER are cached */
+	static void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+	/** deletes textures and removes them from the cached bindings */
+	static void deleteTextures(GLsizei n, const GLuint* textures);
+
+	/**
+	 * Deletes buffers and forgets the cached bindings of their names, since the names can be reused.
+	 * Buffers bound with bindBufferBase must be deleted with this method.
+	 */
+	static void deleteBuffers(GLsizei n, const GLuint* buffers);
+
+	static void deleteVertexArrays(GLsizei n, const GLuint* vertexArrays);
+
+	static void deleteProgram(GLuint program);
+
+	/**
+	 * Counts a call that does not go through the cache, e.g. a draw call or a uniform upload.
+	 */
+	static void countCall();
+
+	/**
+	 * Forgets the cached state, to be called after changing it without this class.
+	 */
+	static void invalidate();
+
+	/**
+	 * Ends the current frame for the counters.
+	 */
+	static void endFrame();
+
+	/**
+	 * @return the counters of the last complete frame
+	 */
+	static Counters getLastFrameCounters();
+};
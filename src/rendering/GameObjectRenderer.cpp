@@ -4,56 +4,111 @@
 #include "Engine.h"
 #include "geometry/BoundingBox.h"
 #include "geometry/Frustum.h"
+#include "geometry/Sphere.h"
+#include "geometry/Plane.h"
 #include "cameras/CameraComponent.h"
 #include "geometry/Intersections.h"
+#include "rendering/GLStateCache.h"
 #include <map>
 #include <tuple>
 #include <glad/glad.h>
 #include <unordered_map>
+#include <algorithm>
+#include <cstring>
 
 void GameObjectRenderer::draw(const Mesh* mesh)
 {
-    glBindVertexArray(mesh->mVao);
+    // meshes in the same shared buffers have the same vao, it is unbound by drawMeshes
+    GLStateCache::bindVertexArray(mesh->mVao);
 
     if (mesh->mUsesIndices)
-        glDrawElements(mesh->mDrawMode, mesh->mIndicesNumber, GL_UNSIGNED_INT, (void *)0);
+        glDrawElementsBaseVertex(mesh->mDrawMode, mesh->mIndicesNumber, GL_UNSIGNED_INT,
+            (void *)(mesh->getFirstIndex() * sizeof(std::uint32_t)), mesh->getBaseVertex());
     else
-        glDrawArrays(mesh->mDrawMode, 0, mesh->mVertexNumber);
+        glDrawArrays(mesh->mDrawMode, mesh->getBaseVertex(), mesh->mVertexNumber);
+    GLStateCache::countCall();
+}
 
-    glBindVertexArray(0);
+// floats compare as these unsigned integers
+static std::uint32_t sortableFloat(float value)
+{
+	std::uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
 }
 
 void GameObjectRenderer::drawMeshes(const std::unordered_map<Material*, std::vector<DrawData>>& material2mesh)
 {
-	std::map<float, std::pair<Material*, DrawData>> orderedRender;
+	constexpr std::uint64_t ORDERED_BIT = 1ull << 63;
+	constexpr int SHADER_SHIFT = 47;
+	constexpr int MATERIAL_SHIFT = 31;
+	constexpr std::uint64_t MAX_DEPTH = (1ull << MATERIAL_SHIFT) - 1;
+
+	const GameObjectEH& camera = Engine::renderSys.getCamera();
+	const glm::vec3 cameraPosition = camera->transform.getPosition();
+	const float farPlane = camera->getComponent<CameraComponent>()->getFarPlaneDistance();
+
+	struct DrawCommand {
+		std::uint64_t key;
+		Material* material;
+		const DrawData* data;
+	};
+
+	// a forced material is drawn as usual
+	const bool multiDraw = Engine::renderSys.multiDrawIndirect && !mForcedMaterial;
+
+	std::vector<DrawCommand> commands;
+	std::uint64_t materialIndex = 0;
 	for (const auto&[material, drawData] : material2mesh) {
-		if (material->needsOrderedRendering()) {
-			for (const auto& data : drawData) {
-				float order = material->renderOrder(data.position);
-				orderedRender[order] = std::make_pair(material, data);
+		const bool ordered = material->needsOrderedRendering();
+		const std::int32_t multiDrawMaterial = multiDraw && !ordered ? mMultiDrawRenderer.addMaterial(material) : -1;
+		const std::uint64_t materialKey = (static_cast<std::uint64_t>(material->shader.getId() & 0xFFFF) << SHADER_SHIFT)
+			| ((materialIndex++ & 0xFFFF) << MATERIAL_SHIFT);
+
+		for (const auto& data : drawData) {
+			if (multiDrawMaterial >= 0 && mMultiDrawRenderer.add(multiDrawMaterial, data.mesh, data.toWorld, data.toWorldForNormals))
+				continue;
+
+			std::uint64_t key;
+			if (ordered) {
+				// the highest orders are rendered first
+				key = ORDERED_BIT | (0xFFFFFFFFu - sortableFloat(material->renderOrder(data.position)));
 			}
-		}
-		else {
-			material->use();
-			for (const auto& data : drawData) {
-				material->shader.setMat4(material->getModelLocation(), data.toWorld);
-				material->shader.setMat3(material->getNormalModelLocation(), data.toWorldForNormals);
-				draw(data.mesh);
+			else {
+				const float depth = glm::clamp(glm::distance(cameraPosition, data.position) / farPlane, 0.0f, 1.0f);
+				key = materialKey | static_cast<std::uint64_t>(depth * MAX_DEPTH);
 			}
 
-			material->after();
+			commands.push_back(DrawCommand{ key, material, &data });
 		}
 	}
 
-	// render meshed that need to be rendered in a specific order
-	for (auto ord = orderedRender.rbegin(); ord != orderedRender.rend(); ++ord) {
-		auto& [material, drawData] = ord->second;
-		material->use();
-		material->shader.setMat4(material->getModelLocation(), drawData.toWorld);
-		material->shader.setMat3(material->getNormalModelLocation(), drawData.toWorldForNormals);
-		draw(drawData.mesh);
-		material->after();
+	std::sort(commands.begin(), commands.end(), [](const DrawCommand& lhs, const DrawCommand& rhs) {
+		return lhs.key < rhs.key;
+	});
+
+	if (multiDraw)
+		mMultiDrawRenderer.draw();
+
+	Material* inUse = nullptr;
+	for (const DrawCommand& command : commands) {
+		// meshes that need ordered rendering may change their material between two draws
+		if (command.material != inUse || (command.key & ORDERED_BIT)) {
+			if (inUse)
+				inUse->after();
+
+			inUse = command.material;
+			inUse->use();
+		}
+
+		inUse->shader.setMat4(inUse->getModelLocation(), command.data->toWorld);
+		inUse->shader.setMat3(inUse->getNormalModelLocation(), command.data->toWorldForNormals);
+		draw(command.data->mesh);
 	}
+	GLStateCache::bindVertexArray(0);
+
+	if (inUse)
+		inUse->after();
 }
 
 void GameObjectRenderer::render()
@@ -63,10 +118,35 @@ void GameObjectRenderer::render()
 	std::unordered_map<Material*, std::vector<DrawData>> material2mesh;
 
 	const Frustum cameraFrustum = Engine::renderSys.getCamera()->getComponent<CameraComponent>()->getViewFrutsum();
+	const Frustum& cullingFrustum = mForcedFrustum ? *mForcedFrustum : cameraFrustum;
+
+	// occluders are rasterized only for the view of the camera
+	const OcclusionCuller& occlusionCuller = Engine::renderSys.occlusionCuller;
+	const bool occlusionCulling = !mForcedFrustum && !mForcedSphere && occlusionCuller.isActive();
 	for (auto& go : Engine::gameObjectManager.mGameObjects) {
-		const BoundingBox goBB = go.transform.getBoundingBox();
-		if (goBB.isValid() && boxFrustumIntersection(goBB, cameraFrustum) == IntersectionTestResult::OUTSIDE) {
+		if ((mStaticFilter == StaticFilter::STATIC_ONLY && !go.isStatic) || (mStaticFilter == StaticFilter::DYNAMIC_ONLY && go.isStatic))
 			continue;
+
+		const BoundingBox goBB = go.transform.getBoundingBox();
+		if (goBB.isValid()) {
+			IntersectionTestResult intersection = mForcedSphere ? boxSphereIntersection(goBB, *mForcedSphere)
+				: boxFrustumIntersection(goBB, cullingFrustum);
+
+			if (intersection == IntersectionTestResult::OUTSIDE)
+				continue;
+
+			if (mForcedClipPlane && planeBoxIntersection(*mForcedClipPlane, goBB) == IntersectionTestResult::OUTSIDE)
+				continue;
+
+			if (occlusionCulling && occlusionCuller.isOccluded(goBB))
+				continue;
+
+			if (mDetailCullingSize > 0.0f) {
+				const float size = glm::length(goBB.getDiagonal());
+				const float distance = glm::distance(goBB.getCenter(), mDetailCullingPosition);
+				if (size < distance * mDetailCullingSize)
+					continue;
+			}
 		}
 
 		for (std::size_t meshIndex = 0; meshIndex < go.mMeshes.size(); meshIndex++) {
@@ -79,6 +159,9 @@ void GameObjectRenderer::render()
 			if ((meshMaterial->unSupportedRenderPhases & Engine::renderSys.getRenderPhase()))
 				continue;
 
+			if (mDepthPrePass && (!meshMaterial->inDepthPrePass || meshMaterial->needsOrderedRendering()))
+				continue;
+
 			// use a default material if required
 			meshMaterial = mForcedMaterial ? mForcedMaterial.get() : meshMaterial;
 
@@ -98,7 +181,66 @@ void GameObjectRenderer::render()
 	drawMeshes(material2mesh);
 }
 
+bool GameObjectRenderer::isAnyGameObjectInside(const Frustum& frustum, int phase)
+{
+	for (auto& go : Engine::gameObjectManager.mGameObjects) {
+		const bool rendered = std::any_of(go.mMaterials.begin(), go.mMaterials.end(), [phase](const MaterialPtr& material) {
+			return !(material->unSupportedRenderPhases & phase);
+		});
+
+		if (!rendered)
+			continue;
+
+		const BoundingBox goBB = go.transform.getBoundingBox();
+		if (!goBB.isValid() || boxFrustumIntersection(goBB, frustum) != IntersectionTestResult::OUTSIDE)
+			return true;
+	}
+
+	return false;
+}
+
 void GameObjectRenderer::forceMaterial(const MaterialPtr& material)
 {
 	mForcedMaterial = material;
 }
+
+void GameObjectRenderer::forceFrustum(const Frustum* frustum)
+{
+	mForcedFrustum = frustum;
+}
+
+void GameObjectRenderer::forceSphere(const Sphere* sphere)
+{
+	mForcedSphere = sphere;
+}
+
+void GameObjectRenderer::forceClipPlane(const Plane* plane)
+{
+	mForcedClipPlane = plane;
+}
+
+void GameObjectRenderer::setDetailCulling(const glm::vec3& viewPosition, float minSize)
+{
+	mDetailCullingPosition = viewPosition;
+	mDetailCullingSize = minSize;
+}
+
+void GameObjectRenderer::setStaticFilter(StaticFilter filter)
+{
+	mStaticFilter = filter;
+}
+
+void GameObjectRenderer::setDepthPrePass(bool enabled)
+{
+	mDepthPrePass = enabled;
+}
+
+const MultiDrawRenderer& GameObjectRenderer::getMultiDrawRenderer() const
+{
+	return mMultiDrawRenderer;
+}
+
+void GameObjectRenderer::cleanUp()
+{
+	mMultiDrawRenderer.cleanUp();
+}
@@ -2,6 +2,11 @@
 #define GAMEOBJECTRENDERER_H
 #include "gameobject/GameObject.h"
 #include "rendering/materials/Material.h"
+#include "rendering/MultiDrawRenderer.h"
+
+struct Frustum;
+struct Sphere;
+struct Plane;
 
 /*
 * Add hash and equal to so that they can be
@@ -29,6 +34,14 @@ class GameObjectRenderer
 {
 friend class Engine;
 
+public:
+	/** Which GameObject%s are rendered depending on GameObject::isStatic */
+	enum class StaticFilter {
+		ALL,
+		STATIC_ONLY,
+		DYNAMIC_ONLY
+	};
+
 private:
 	struct DrawData {
 		const Mesh* mesh;
@@ -42,11 +55,46 @@ private:
 	 * This is useful when rendering for shadows and so on */
 	MaterialPtr mForcedMaterial = nullptr;
 
+	/**
+	 * When this frustum is set GameObject%s are culled against it instead of
+	 * the camera frustum. This is useful when rendering for shadows */
+	const Frustum* mForcedFrustum = nullptr;
+
+	/**
+	 * When this sphere is set GameObject%s are culled against it instead of
+	 * the camera frustum. This is useful when rendering for point light shadows */
+	const Sphere* mForcedSphere = nullptr;
+
+	/**
+	 * When this plane is set GameObject%s entirely behind it are culled.
+	 * This is useful when rendering with a clip plane */
+	const Plane* mForcedClipPlane = nullptr;
+
+	StaticFilter mStaticFilter = StaticFilter::ALL;
+
+	/** when true only the meshes whose material allows it are rendered (see Material::inDepthPrePass) */
+	bool mDepthPrePass = false;
+
+	/** GameObject%s that look smaller than this from mDetailCullingPosition are culled, 0 disables it */
+	float mDetailCullingSize = 0.0f;
+	glm::vec3 mDetailCullingPosition{ 0.0f };
+
+	/** draws the meshes of the supported materials when RenderSystem::multiDrawIndirect is set */
+	MultiDrawRenderer mMultiDrawRenderer;
+
     /** Actually renders a Mesh its corresponding material should be in use */
     void draw(const Mesh* mesh);
 
     GameObjectRenderer() = default;
 
+	/**
+	 * Draws the meshes sorted by a 64 bit key. From the most significant bit:
+	 * 1 bit for meshes that need ordered rendering (drawn last), then for the other meshes
+	 * 16 bits of shader, 16 bits of material and 31 bits of quantized distance from the camera,
+	 * so that state changes are minimized and each material is drawn front to back.
+	 * Meshes that need ordered rendering are sorted by Material::renderOrder only.
+	 * When RenderSystem::multiDrawIndirect is set the meshes supported by the MultiDrawRenderer are drawn first by it.
+	 */
 	void drawMeshes(const std::unordered_map<Material*, std::vector<DrawData>>& material2mesh);
 
 public:
@@ -66,6 +114,65 @@ public:
 	 */
 	void forceMaterial(const MaterialPtr& material);
 
+	/**
+	 * Set the frustum used to cull GameObject%s.
+	 * If this frustum is nullptr the view frustum of the camera is used.
+	 * @param frustum the frustum to use for culling, it must be valid until it is replaced (nullptr to disable)
+	 */
+	void forceFrustum(const Frustum* frustum);
+
+	/**
+	 * Set the sphere used to cull GameObject%s.
+	 * If this sphere is nullptr the frustum set with forceFrustum or the view frustum of the camera is used.
+	 * @param sphere the sphere to use for culling, it must be valid until it is replaced (nullptr to disable)
+	 */
+	void forceSphere(const Sphere* sphere);
+
+	/**
+	 * Set a plane used to cull GameObject%s in addition to the frustum.
+	 * @param plane the plane, GameObject%s behind it are culled. It must be valid until it is replaced (nullptr to disable)
+	 */
+	void forceClipPlane(const Plane* plane);
+
+	/**
+	 * Culls the GameObject%s that look too small from a point of view.
+	 * This is a cheap replacement of low detail meshes when rendering secondary views (e.g. water reflections).
+	 * @param viewPosition the point of view
+	 * @param minSize the minimum ratio between the size of the bounding box of a GameObject and its distance from viewPosition (0 to disable)
+	 */
+	void setDetailCulling(const glm::vec3& viewPosition, float minSize);
+
+	/**
+	 * Checks whether a GameObject that would be rendered in a render phase is inside a Frustum.
+	 * @param frustum the frustum
+	 * @param phase the render phase
+	 * @return true if at least a GameObject is inside or overlapping the frustum
+	 */
+	bool isAnyGameObjectInside(const Frustum& frustum, int phase);
+
+	/**
+	 * Renders only static or dynamic GameObject%s.
+	 * @param filter which GameObject%s to render
+	 */
+	void setStaticFilter(StaticFilter filter);
+
+	/**
+	 * Renders only the meshes that can be rendered in a depth pre-pass,
+	 * the ones whose material has Material::inDepthPrePass set and does not need ordered rendering.
+	 * @param enabled true to render only these meshes
+	 */
+	void setDepthPrePass(bool enabled);
+
+	/**
+	 * @return the renderer used when RenderSystem::multiDrawIndirect is set
+	 */
+	const MultiDrawRenderer& getMultiDrawRenderer() const;
+
+	/**
+	 * Deletes the buffers of the MultiDrawRenderer.
+	 */
+	void cleanUp();
+
     virtual ~GameObjectRenderer() = default;
 };
 
@@ -0,0 +1,222 @@
+#include "rendering/MultiDrawRenderer.h"
+#include "rendering/materials/Material.h"
+#include "rendering/RenderSystem.h"
+#include "rendering/GLStateCache.h"
+#include <algorithm>
+#include <numeric>
+
+void MultiDrawRenderer::create()
+{
+	mShader = Shader::loadFromFile(std::vector<std::string>{ "shaders/multiDrawPhongVS.glsl" },
+		std::vector<std::string>{},
+		std::vector<std::string>{ "shaders/GBuffer.glsl", "shaders/multiDrawPhongFS.glsl" });
+	mShader.use();
+	mShader.bindUniformBlock("CommonMat", RenderSystem::COMMON_MAT_UNIFORM_BLOCK_INDEX);
+	mShader.setInt("diffuseMaps", 0);
+	mShader.setInt("specularMaps", 1);
+
+	glGenBuffers(1, &mDrawIdsVbo);
+	glGenBuffers(1, &mCommandsBuffer);
+	glGenBuffers(1, &mDrawsBuffer);
+	glGenBuffers(1, &mMaterialsBuffer);
+}
+
+bool MultiDrawRenderer::isSupported(std::uint32_t arena)
+{
+	static const SharedMeshBuffers::Attribute expected[] = {
+		{ 3, GL_FLOAT, sizeof(float), false },
+		{ 3, GL_FLOAT, sizeof(float), false },
+		{ 2, GL_FLOAT, sizeof(float), false }
+	};
+
+	const std::vector<SharedMeshBuffers::Attribute>& format = SharedMeshBuffers::getFormat(arena);
+	return format.size() >= 3 && std::equal(std::begin(expected), std::end(expected), format.begin());
+}
+
+std::uint32_t MultiDrawRenderer::getVertexArray(std::uint32_t arena)
+{
+	const SharedMeshBuffers::ArenaBuffers buffers = SharedMeshBuffers::getArenaBuffers(arena);
+
+	ArenaVertexArray& vertexArray = mVertexArrays[arena];
+	if (vertexArray.vao != 0 && vertexArray.upToDate && vertexArray.version == buffers.version)
+		return vertexArray.vao;
+
+	if (vertexArray.vao == 0)
+		glGenVertexArrays(1, &vertexArray.vao);
+	GLStateCache::bindVertexArray(vertexArray.vao);
+
+	// the other attributes of the arena (e.g. tangents) are not read
+	const GLint components[] = { 3, 3, 2 };
+	for (GLuint attrib = 0; attrib < 3; ++attrib) {
+		glBindBuffer(GL_ARRAY_BUFFER, (*buffers.vbos)[attrib]);
+		glEnableVertexAttribArray(attrib);
+		glVertexAttribPointer(attrib, components[attrib], GL_FLOAT, GL_FALSE, 0, (void*)0);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, mDrawIdsVbo);
+	glEnableVertexAttribArray(3);
+	glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, 0, (void*)0);
+	glVertexAttribDivisor(3, 1);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.ebo);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	vertexArray.version = buffers.version;
+	vertexArray.upToDate = true;
+
+	return vertexArray.vao;
+}
+
+std::int32_t MultiDrawRenderer::addMaterial(const Material* material)
+{
+	MultiDrawMaterial values;
+	if (!material->getMultiDrawMaterial(values))
+		return -1;
+
+	const TextureArrayPool::Location diffuse = values.diffuseMap ? mTextureArrays.add(values.diffuseMap) : TextureArrayPool::Location{};
+	const TextureArrayPool::Location specular = values.specularMap ? mTextureArrays.add(values.specularMap) : TextureArrayPool::Location{};
+
+	// maps that cannot be copied (e.g. cube maps) are not supported
+	if ((values.diffuseMap && !diffuse.isValid()) || (values.specularMap && !specular.isValid()))
+		return -1;
+
+	mMaterials.push_back(MaterialData{
+		values.diffuseColor, static_cast<float>(diffuse.layer),
+		values.specularColor, static_cast<float>(specular.layer),
+		values.shininess, { 0.0f, 0.0f, 0.0f }
+	});
+	mMaterialArrays.push_back(MaterialArrays{ diffuse.array, specular.array });
+
+	return static_cast<std::int32_t>(mMaterials.size() - 1);
+}
+
+bool MultiDrawRenderer::add(std::int32_t material, const Mesh* mesh, const glm::mat4& toWorld, const glm::mat4& toWorldForNormals)
+{
+	if (!mesh->usesSharedBuffers() || !mesh->mUsesIndices || mesh->mDrawMode != GL_TRIANGLES)
+		return false;
+
+	// the range is read every frame since it changes when the arena is defragmented
+	const SharedMeshBuffers::Allocation& range = SharedMeshBuffers::getAllocation(mesh->mSharedAllocation);
+	if (!isSupported(range.arena))
+		return false;
+
+	const MaterialArrays& arrays = mMaterialArrays[material];
+	auto group = std::find_if(mGroups.begin(), mGroups.end(), [&range, &arrays](const Group& group) {
+		return group.arena == range.arena && group.diffuseArray == arrays.diffuseArray && group.specularArray == arrays.specularArray;
+	});
+	if (group == mGroups.end()) {
+		mGroups.push_back(Group{ range.arena, arrays.diffuseArray, arrays.specularArray, {}, {} });
+		group = mGroups.end() - 1;
+	}
+
+	group->commands.push_back(DrawCommand{ range.indexCount, 1, range.firstIndex, range.baseVertex, 0 });
+	group->draws.push_back(DrawData{ toWorld, toWorldForNormals, static_cast<std::uint32_t>(material), { 0, 0, 0 } });
+
+	return true;
+}
+
+void MultiDrawRenderer::draw()
+{
+	std::vector<DrawCommand> commands;
+	std::vector<DrawData> draws;
+	for (Group& group : mGroups) {
+		// the base instance selects the draw data through the draw ids attribute
+		for (DrawCommand& command : group.commands)
+			command.baseInstance = static_cast<GLuint>(draws.size() + (&command - group.commands.data()));
+
+		commands.insert(commands.end(), group.commands.begin(), group.commands.end());
+		draws.insert(draws.end(), group.draws.begin(), group.draws.end());
+	}
+
+	mLastDrawsNumber = draws.size();
+	mLastCallsNumber = 0;
+
+	if (!draws.empty()) {
+		if (mShader.getId() == 0)
+			create();
+
+		if (static_cast<GLsizeiptr>(draws.size()) > mDrawIdsCapacity) {
+			mDrawIdsCapacity = std::max<GLsizeiptr>(mDrawIdsCapacity * 2, draws.size());
+			std::vector<std::uint32_t> drawIds(mDrawIdsCapacity);
+			std::iota(drawIds.begin(), drawIds.end(), 0);
+
+			glBindBuffer(GL_ARRAY_BUFFER, mDrawIdsVbo);
+			glBufferData(GL_ARRAY_BUFFER, drawIds.size() * sizeof(std::uint32_t), drawIds.data(), GL_STATIC_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			// the vertex arrays are set up again with the new buffer
+			for (auto& [arena, vertexArray] : mVertexArrays)
+				vertexArray.upToDate = false;
+		}
+
+		mTextureArrays.updateMipmaps();
+
+		// buffers are orphaned each frame, the previous frames may still be using them
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, mDrawsBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, draws.size() * sizeof(DrawData), draws.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, mMaterialsBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, mMaterials.size() * sizeof(MaterialData), mMaterials.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAWS_STORAGE_BLOCK_BINDING, mDrawsBuffer);
+		GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIALS_STORAGE_BLOCK_BINDING, mMaterialsBuffer);
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mCommandsBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawCommand), commands.data(), GL_STREAM_DRAW);
+
+		mShader.use();
+
+		std::size_t first = 0;
+		for (const Group& group : mGroups) {
+			if (group.commands.empty()) continue;
+
+			GLStateCache::bindVertexArray(getVertexArray(group.arena));
+			GLStateCache::activeTexture(GL_TEXTURE0);
+			GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, mTextureArrays.getArrayId(group.diffuseArray));
+			GLStateCache::activeTexture(GL_TEXTURE1);
+			GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, mTextureArrays.getArrayId(group.specularArray));
+
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(first * sizeof(DrawCommand)),
+				static_cast<GLsizei>(group.commands.size()), 0);
+			GLStateCache::countCall();
+
+			first += group.commands.size();
+			mLastCallsNumber++;
+		}
+
+		GLStateCache::activeTexture(GL_TEXTURE0);
+		GLStateCache::bindVertexArray(0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
+	mMaterials.clear();
+	mMaterialArrays.clear();
+	mGroups.clear();
+}
+
+std::size_t MultiDrawRenderer::getLastDrawsNumber() const
+{
+	return mLastDrawsNumber;
+}
+
+std::size_t MultiDrawRenderer::getLastCallsNumber() const
+{
+	return mLastCallsNumber;
+}
+
+void MultiDrawRenderer::cleanUp()
+{
+	for (auto& [arena, vertexArray] : mVertexArrays)
+		GLStateCache::deleteVertexArrays(1, &vertexArray.vao);
+	mVertexArrays.clear();
+
+	if (mDrawIdsVbo != 0) {
+		const std::uint32_t buffers[] = { mDrawIdsVbo, mCommandsBuffer, mDrawsBuffer, mMaterialsBuffer };
+		GLStateCache::deleteBuffers(4, buffers);
+	}
+
+	mDrawIdsVbo = mCommandsBuffer = mDrawsBuffer = mMaterialsBuffer = 0;
+	mDrawIdsCapacity = 0;
+
+	mTextureArrays.cleanUp();
+	mShader = Shader();
+}
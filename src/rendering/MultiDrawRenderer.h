@@ -0,0 +1,171 @@
+#pragma once
+#include "rendering/mesh/Mesh.h"
+#include "rendering/mesh/SharedMeshBuffers.h"
+#include "rendering/materials/Shader.h"
+#include "rendering/materials/Texture.h"
+#include "rendering/materials/TextureArrayPool.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Material;
+
+/**
+ * The values of a Material drawn by the MultiDrawRenderer, see Material::getMultiDrawMaterial.
+ * They are the ones of a Blinn-Phong material without bump or parallax mapping.
+ */
+struct MultiDrawMaterial {
+	glm::vec3 diffuseColor{ 1.0f };
+	glm::vec3 specularColor{ 1.0f };
+	float shininess = 32.0f;
+
+	/** multiplied by diffuseColor if valid, fragments where its alpha is below 0.5 are discarded */
+	Texture diffuseMap;
+
+	/** multiplied by specularColor if valid */
+	Texture specularMap;
+};
+
+/**
+ * Draws the meshes of many materials with a few glMultiDrawElementsIndirect calls.
+ * Meshes are read from the arenas of SharedMeshBuffers, textures are copied in texture arrays
+ * (see TextureArrayPool) and every frame the values of the materials and the transformations
+ * of the meshes are uploaded in shader storage buffers indexed by the shader.
+ * A call is issued for each arena and pair of diffuse and specular texture arrays in use, i.e. for each
+ * size of the textures, since an array of samplers cannot be indexed with a different value in each draw.
+ * Only indexed triangle meshes in the shared buffers whose first attributes are positions, normals and
+ * texture coordinates are supported, the others must be drawn as usual.
+ */
+class MultiDrawRenderer
+{
+private:
+	/** layout defined by glMultiDrawElementsIndirect */
+	struct DrawCommand {
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	/** the Draws storage block, std430 */
+	struct DrawData {
+		glm::mat4 model;
+		glm::mat4 normalModel;
+		std::uint32_t material;
+		std::uint32_t padding[3];
+	};
+
+	/** the Materials storage block, std430. Layers are negative when a map is not used */
+	struct MaterialData {
+		glm::vec3 diffuseColor;
+		float diffuseLayer;
+		glm::vec3 specularColor;
+		float specularLayer;
+		float shininess;
+		float padding[3];
+	};
+
+	/** the texture arrays sampled by a material */
+	struct MaterialArrays {
+		std::int32_t diffuseArray;
+		std::int32_t specularArray;
+	};
+
+	/** draws of meshes in the same arena sampling the same texture arrays */
+	struct Group {
+		std::uint32_t arena;
+		std::int32_t diffuseArray;
+		std::int32_t specularArray;
+		std::vector<DrawCommand> commands;
+		std::vector<DrawData> draws;
+	};
+
+	/** a vertex array reading the buffers of an arena and the draw ids */
+	struct ArenaVertexArray {
+		std::uint32_t vao = 0;
+
+		/** the ArenaBuffers::version the vertex array has been set up with */
+		std::uint32_t version = 0;
+		bool upToDate = false;
+	};
+
+	static constexpr GLuint DRAWS_STORAGE_BLOCK_BINDING = 0;
+	static constexpr GLuint MATERIALS_STORAGE_BLOCK_BINDING = 1;
+
+	Shader mShader;
+	TextureArrayPool mTextureArrays;
+
+	/** vertex arrays by arena */
+	std::unordered_map<std::uint32_t, ArenaVertexArray> mVertexArrays;
+
+	/** the instance attribute with the index of each draw, 0, 1, 2... */
+	std::uint32_t mDrawIdsVbo = 0;
+
+	std::uint32_t mCommandsBuffer = 0;
+	std::uint32_t mDrawsBuffer = 0;
+	std::uint32_t mMaterialsBuffer = 0;
+
+	GLsizeiptr mDrawIdsCapacity = 0;
+
+	/** per frame data */
+	std::vector<MaterialData> mMaterials;
+	std::vector<MaterialArrays> mMaterialArrays;
+	std::vector<Group> mGroups;
+
+	std::size_t mLastDrawsNumber = 0;
+	std::size_t mLastCallsNumber = 0;
+
+	void create();
+
+	/** @return the vertex array of an arena, set up again if the buffers of the arena have changed */
+	std::uint32_t getVertexArray(std::uint32_t arena);
+
+	/** @return true if the vertices of an arena start with positions, normals and texture coordinates */
+	static bool isSupported(std::uint32_t arena);
+
+public:
+	MultiDrawRenderer() = default;
+
+	MultiDrawRenderer(const MultiDrawRenderer&) = delete;
+	MultiDrawRenderer& operator=(const MultiDrawRenderer&) = delete;
+
+	/**
+	 * Adds a material for the current frame.
+	 * @param material a material, meshes with equal materials should share it
+	 * @return the index to pass to add, -1 if the material is not supported
+	 */
+	std::int32_t addMaterial(const Material* material);
+
+	/**
+	 * Adds a mesh to draw in the current frame.
+	 * @param material the index returned by addMaterial
+	 * @param mesh the mesh
+	 * @param toWorld model matrix of the mesh
+	 * @param toWorldForNormals matrix transforming the normals of the mesh
+	 * @return false if the mesh is not supported and must be drawn as usual
+	 */
+	bool add(std::int32_t material, const Mesh* mesh, const glm::mat4& toWorld, const glm::mat4& toWorldForNormals);
+
+	/**
+	 * Draws the meshes added in the current frame and starts a new frame.
+	 */
+	void draw();
+
+	/**
+	 * @return the meshes drawn by the last call to draw
+	 */
+	std::size_t getLastDrawsNumber() const;
+
+	/**
+	 * @return the glMultiDrawElementsIndirect calls issued by the last call to draw
+	 */
+	std::size_t getLastCallsNumber() const;
+
+	/**
+	 * Deletes the vertex arrays, the buffers and the textures. The arenas are deleted by SharedMeshBuffers::cleanUp.
+	 */
+	void cleanUp();
+};
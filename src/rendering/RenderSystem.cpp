@@ -3,11 +3,18 @@
 #include "rendering/light/Light.h"
 #include "Engine.h"
 #include "rendering/mesh/MeshLoader.h"
+#include "rendering/mesh/SharedMeshBuffers.h"
 #include "rendering/materials/ShadowMapMaterial.h"
 #include "rendering/mesh/MeshCreator.h"
 #include "rendering/light/DirectionalLight.h"
 #include "debugUtils/debug.h"
 #include "cameras/CameraComponent.h"
+#include "geometry/Frustum.h"
+#include "geometry/Sphere.h"
+#include "geometry/BoundingBox.h"
+#include "geometry/Intersections.h"
+#include "geometry/Plane.h"
+#include "rendering/GLStateCache.h"
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -17,18 +24,49 @@
 #include <iostream>
 #include <memory>
 #include <map>
+#include <numeric>
+#include <array>
+#include <cmath>
 
 #include <nvToolsExt.h>
 
 // is openGL debug enabled
 bool DEBUG = false;
 
+/**
+ * Creates the Frustum corresponding to a clip space, the vertices
+ * are in the same order used by CameraComponent::getViewFrutsum
+ */
+static Frustum frustumFromClipSpace(const glm::mat4& toClipSpace)
+{
+	static const std::array<glm::vec4, 8> ndcVertices{
+		glm::vec4{  1.0f,  1.0f,  1.0f, 1.0f },
+		glm::vec4{ -1.0f, -1.0f,  1.0f, 1.0f },
+		glm::vec4{ -1.0f,  1.0f,  1.0f, 1.0f },
+		glm::vec4{  1.0f, -1.0f,  1.0f, 1.0f },
+
+		glm::vec4{  1.0f,  1.0f, -1.0f, 1.0f },
+		glm::vec4{ -1.0f, -1.0f, -1.0f, 1.0f },
+		glm::vec4{ -1.0f,  1.0f, -1.0f, 1.0f },
+		glm::vec4{  1.0f, -1.0f, -1.0f, 1.0f }
+	};
+
+	const glm::mat4 toWorld = glm::inverse(toClipSpace);
+	std::array<glm::vec3, 8> vertices;
+	std::transform(ndcVertices.begin(), ndcVertices.end(), vertices.begin(), [&toWorld](const glm::vec4& vertex) {
+		glm::vec4 worldVertex = toWorld * vertex;
+		return glm::vec3{ worldVertex } / worldVertex.w;
+	});
+
+	return Frustum{ vertices };
+}
+
 RenderSystem::RenderSystem()
 {
 
 }
 
-void RenderSystem::createWindow(std::uint32_t width, std::uint32_t height)
+void RenderSystem::createWindow(std::uint32_t width, std::uint32_t height, bool headless)
 {
 	if (SDL_Init(SDL_INIT_VIDEO) < 0) {
 		std::cout << "Cannot init SDL " << SDL_GetError() << "\n";
@@ -49,7 +87,9 @@ void RenderSystem::createWindow(std::uint32_t width, std::uint32_t height)
 	//	SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
 	//	SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
 
-	mWindow = SDL_CreateWindow("sre", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL);
+	// a hidden window still has a default framebuffer to render to
+	const Uint32 visibility = headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN;
+	mWindow = SDL_CreateWindow("sre", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, visibility | SDL_WINDOW_OPENGL);
 	if (mWindow == nullptr) {
 		std::cout << "Cannot create window " << SDL_GetError() << "\n";
 		std::terminate();
@@ -57,8 +97,7 @@ void RenderSystem::createWindow(std::uint32_t width, std::uint32_t height)
 
 	SDL_GL_CreateContext(mWindow);
 
-	// Use v-sync
-	//SDL_GL_SetSwapInterval(1);
+	setVSync(mVSync);
 
 	if (!gladLoadGLLoader(SDL_GL_GetProcAddress)) {
 		std::cout << "Failed to initialize GLAD\n";
@@ -68,8 +107,8 @@ void RenderSystem::createWindow(std::uint32_t width, std::uint32_t height)
 	initGL(width, height);
 
 	if (DEBUG) {
-		glEnable(GL_DEBUG_OUTPUT);
-		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		GLStateCache::enable(GL_DEBUG_OUTPUT);
+		GLStateCache::enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
 		glDebugMessageCallback(glDebugOutput, nullptr);
 		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
 	}
@@ -85,6 +124,7 @@ void RenderSystem::createWindow(std::uint32_t width, std::uint32_t height)
 
 	// simple shader for shadow mapping
 	mShadowMapMaterial = std::make_shared<ShadowMapMaterial>();
+	mDepthPrePassMaterial = std::make_shared<ShadowMapMaterial>(true);
 	mPointShadowMaterial = std::make_shared<PointShadowMaterial>();
 
 	// create a default camera
@@ -107,18 +147,19 @@ void RenderSystem::initGL(std::uint32_t width, std::uint32_t height)
 	/* Uniform buffer object set up for common matrices */
 	glGenBuffers(1, &mUboCommonMat);
 	glBindBuffer(GL_UNIFORM_BUFFER, mUboCommonMat);
-	// 3 matrices: view, projection, projection * view and a vec4 for the clipping plane
-	glBufferData(GL_UNIFORM_BUFFER, 3 * sizeof(glm::mat4) + sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
-	glBindBufferBase(GL_UNIFORM_BUFFER, COMMON_MAT_UNIFORM_BLOCK_INDEX, mUboCommonMat);
+	// 3 matrices: view, projection, projection * view, a vec4 for the clipping plane
+	// and the inverse of projection * view to reconstruct positions from depth
+	glBufferData(GL_UNIFORM_BUFFER, 4 * sizeof(glm::mat4) + sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+	GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, COMMON_MAT_UNIFORM_BLOCK_INDEX, mUboCommonMat);
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 
 	/* Uniform buffer object set up for lights */
 	glGenBuffers(1, &mUboLights);
 	glBindBuffer(GL_UNIFORM_BUFFER, mUboLights);
-	// 16 numLights, 208 size of a light array element
-	glBufferData(GL_UNIFORM_BUFFER, 16 + 208 * MAX_LIGHT_NUMBER, nullptr, GL_STREAM_DRAW);
-	glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_UNIFORM_BLOCK_INDEX, mUboLights);
+	// 16 numLights, 128 size of a light array element
+	glBufferData(GL_UNIFORM_BUFFER, 16 + 128 * MAX_LIGHT_NUMBER, nullptr, GL_STREAM_DRAW);
+	GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, LIGHT_UNIFORM_BLOCK_INDEX, mUboLights);
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	/* Uniform buffer object set up for camera */
@@ -127,16 +168,18 @@ void RenderSystem::initGL(std::uint32_t width, std::uint32_t height)
 
 	// size for camera position and direction
 	glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
-	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BLOCK_INDEX, mUboCamera);
+	GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BLOCK_INDEX, mUboCamera);
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	/* General OpenGL settings */
 	glViewport(0, 0, width, height);
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_STENCIL_TEST);
-	glEnable(GL_CULL_FACE);
-	glCullFace(GL_BACK);
+	GLStateCache::enable(GL_DEPTH_TEST);
+	GLStateCache::enable(GL_STENCIL_TEST);
+	GLStateCache::enable(GL_CULL_FACE);
+	GLStateCache::cullFace(GL_BACK);
 	glFrontFace(GL_CCW);
+
+	glGenQueries(1, &mOverdrawQuery);
 }
 
 void RenderSystem::initDeferredRendering()
@@ -144,18 +187,20 @@ void RenderSystem::initDeferredRendering()
 	deferredRenderingFBO.init(getScreenWidth(), getScreenHeight());
 
 	mDirectionalLightDeferred.init({ "shaders/deferred_rendering/directionalLightVS.glsl" },
-		{ "shaders/Light.glsl", "shaders/ShadowMappingCalculation.glsl", "shaders/deferred_rendering/directionalLightFS.glsl" },
-		{ "DiffuseData", "SpecularData", "PositionData", "NormalData", "shadowMap" },
+		{ "shaders/Light.glsl", "shaders/GBuffer.glsl", "shaders/ShadowMappingCalculation.glsl", "shaders/deferred_rendering/directionalLightFS.glsl" },
+		{ "DiffuseData", "SpecularData", "DepthData", "NormalData", "shadowMap" },
 		{
+			{ "CommonMat", RenderSystem::COMMON_MAT_UNIFORM_BLOCK_INDEX },
 			{ "Lights", RenderSystem::LIGHT_UNIFORM_BLOCK_INDEX },
 			{ "Camera", RenderSystem::CAMERA_UNIFORM_BLOCK_INDEX },
 			{ "ShadowMapParams", RenderSystem::SHADOWMAP_UNIFORM_BLOCK_INDEX } 
 		});
 
 	mDirectionalLightDeferredPBR.init({ "shaders/pbr/directionalLightVS.glsl" },
-		{ "shaders/Light.glsl", "shaders/ShadowMappingCalculation.glsl", "shaders/pbr/PBRLightCalculation.glsl", "shaders/pbr/directionalLightFS.glsl" },
-		{ "DiffuseData", "PBRData", "PositionData", "NormalData", "shadowMap" },
+		{ "shaders/Light.glsl", "shaders/GBuffer.glsl", "shaders/ShadowMappingCalculation.glsl", "shaders/pbr/PBRLightCalculation.glsl", "shaders/pbr/directionalLightFS.glsl" },
+		{ "DiffuseData", "PBRData", "DepthData", "NormalData", "shadowMap" },
 		{
+			{ "CommonMat", RenderSystem::COMMON_MAT_UNIFORM_BLOCK_INDEX },
 			{ "Lights", RenderSystem::LIGHT_UNIFORM_BLOCK_INDEX },
 			{ "Camera", RenderSystem::CAMERA_UNIFORM_BLOCK_INDEX },
 			{ "ShadowMapParams", RenderSystem::SHADOWMAP_UNIFORM_BLOCK_INDEX }
@@ -171,17 +216,37 @@ void RenderSystem::initDeferredRendering()
 	mScreenMesh = loader.getMesh(0, 6);
 
 	mPointLightDeferred.init({ "shaders/deferred_rendering/pointLightVS.glsl" },
-		{ "shaders/Light.glsl", "shaders/PointShadowCalculation.glsl", "shaders/deferred_rendering/pointLightFS.glsl" },
-		{ "DiffuseData", "SpecularData", "PositionData", "NormalData", "shadowCube" },
+		{ "shaders/Light.glsl", "shaders/GBuffer.glsl", "shaders/PointShadowCalculation.glsl", "shaders/deferred_rendering/pointLightFS.glsl" },
+		{ "DiffuseData", "SpecularData", "DepthData", "NormalData", "shadowAtlas" },
 		{
+			{ "CommonMat", RenderSystem::COMMON_MAT_UNIFORM_BLOCK_INDEX },
 			{ "Lights", RenderSystem::LIGHT_UNIFORM_BLOCK_INDEX },
 			{ "Camera", RenderSystem::CAMERA_UNIFORM_BLOCK_INDEX },
 		});
 
 	mPointLightDeferredPBR.init({ "shaders/pbr/pointLightVS.glsl" },
-		{ "shaders/Light.glsl", "shaders/PointShadowCalculation.glsl", "shaders/pbr/PBRLightCalculation.glsl", "shaders/pbr/pointLightFS.glsl" },
-		{ "DiffuseData", "PBRData", "PositionData", "NormalData", "shadowCube" }, 
+		{ "shaders/Light.glsl", "shaders/GBuffer.glsl", "shaders/PointShadowCalculation.glsl", "shaders/pbr/PBRLightCalculation.glsl", "shaders/pbr/pointLightFS.glsl" },
+		{ "DiffuseData", "PBRData", "DepthData", "NormalData", "shadowAtlas" },
+		{
+			{ "CommonMat", RenderSystem::COMMON_MAT_UNIFORM_BLOCK_INDEX },
+			{ "Lights", RenderSystem::LIGHT_UNIFORM_BLOCK_INDEX },
+			{ "Camera", RenderSystem::CAMERA_UNIFORM_BLOCK_INDEX },
+		});
+
+	mPointLightBatched.init({ "shaders/Light.glsl", "shaders/deferred_rendering/pointLightVolumeVS.glsl" },
+		{ "shaders/Light.glsl", "shaders/GBuffer.glsl", "shaders/PointShadowCalculation.glsl", "shaders/deferred_rendering/pointLightFS.glsl" },
+		{ "DiffuseData", "SpecularData", "DepthData", "NormalData", "shadowAtlas" },
+		{
+			{ "CommonMat", RenderSystem::COMMON_MAT_UNIFORM_BLOCK_INDEX },
+			{ "Lights", RenderSystem::LIGHT_UNIFORM_BLOCK_INDEX },
+			{ "Camera", RenderSystem::CAMERA_UNIFORM_BLOCK_INDEX },
+		});
+
+	mPointLightBatchedPBR.init({ "shaders/Light.glsl", "shaders/deferred_rendering/pointLightVolumeVS.glsl" },
+		{ "shaders/Light.glsl", "shaders/GBuffer.glsl", "shaders/PointShadowCalculation.glsl", "shaders/pbr/PBRLightCalculation.glsl", "shaders/pbr/pointLightFS.glsl" },
+		{ "DiffuseData", "PBRData", "DepthData", "NormalData", "shadowAtlas" },
 		{
+			{ "CommonMat", RenderSystem::COMMON_MAT_UNIFORM_BLOCK_INDEX },
 			{ "Lights", RenderSystem::LIGHT_UNIFORM_BLOCK_INDEX },
 			{ "Camera", RenderSystem::CAMERA_UNIFORM_BLOCK_INDEX },
 		});
@@ -203,7 +268,7 @@ void RenderSystem::updateLights()
 	glBindBuffer(GL_UNIFORM_BUFFER, mUboLights);
 	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(std::size_t), (void*)&numLight);
 	for (std::size_t i = 0; i < numLight; i++) {
-		int base = 16 + 208 * i;
+		int base = 16 + 128 * i;
 		LightPtr lightComponent = mLights[i]->getComponent<Light>();
 		if (lightComponent == nullptr) continue;
 
@@ -247,24 +312,8 @@ void RenderSystem::updateLights()
 		// spot light angles
 		glBufferSubData(GL_UNIFORM_BUFFER, base + 112, sizeof(glm::vec2), glm::value_ptr(spotAngles));
 
-		// to light space matrix
-		if (castShadow) {
-			// 			glm::mat4 lightProjection = glm::mat4{ 0.0f };
-			// 			lightProjection[0][0] = 2.0f / shadowMappingSettings.width;
-			// 			lightProjection[1][1] = 2.0f / shadowMappingSettings.height;
-			// 			lightProjection[2][2] = -2.0f / shadowMappingSettings.depth;
-			// 			lightProjection[3][3] = 1.0f;
-			glm::mat4 lightProjection = glm::ortho(-shadowMappingSettings.width / 2, shadowMappingSettings.width / 2,
-				-shadowMappingSettings.height / 2, shadowMappingSettings.height / 2,
-				0.1f, shadowMappingSettings.depth);
-
-			glm::mat4 toLightSpace = lightProjection * getViewMatrix(transform);
-
-			glBufferSubData(GL_UNIFORM_BUFFER, base + 128, sizeof(glm::mat4), glm::value_ptr(toLightSpace));
-		}
-
 		// cast shadow
-		glBufferSubData(GL_UNIFORM_BUFFER, base + 192, sizeof(bool), (void *)(&castShadow));
+		glBufferSubData(GL_UNIFORM_BUFFER, base + 120, sizeof(bool), (void *)(&castShadow));
 	}
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
@@ -293,6 +342,10 @@ void RenderSystem::updateMatrices(const glm::mat4* projection, const glm::mat4*
 	glBufferSubData(GL_UNIFORM_BUFFER, 1 * sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(*view));
 	glBufferSubData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(projectionView));
 
+	// after the clipping plane
+	glm::mat4 inverseProjectionView = glm::inverse(projectionView);
+	glBufferSubData(GL_UNIFORM_BUFFER, 3 * sizeof(glm::mat4) + sizeof(glm::vec4), sizeof(glm::mat4), glm::value_ptr(inverseProjectionView));
+
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
@@ -314,12 +367,15 @@ const glm::mat4 RenderSystem::getProjectionMatrix() const
 
 void RenderSystem::prepareRendering(const RenderTarget* target)
 {
+	// moves the meshes in the shared buffers, hence before anything is drawn
+	SharedMeshBuffers::defragmentIfNeeded();
+
 	if (shadowMappingSettings.isShadowRenderingEnabled())
 		renderShadows();
 
 	// view port might be changed during shadow rendering
 	glViewport(0, 0, target->getWidth(), target->getHeight());
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::enable(GL_DEPTH_TEST);
 
 	// clear all the buffers
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
@@ -337,6 +393,8 @@ void RenderSystem::prepareRendering(const RenderTarget* target)
 
 	updateLights();
 	updateCamera();
+
+	occlusionCuller.update(mProjection * view);
 }
 
 void RenderSystem::prepareDeferredRendering()
@@ -346,22 +404,69 @@ void RenderSystem::prepareDeferredRendering()
 
 	// set up the stencil test so that only the parts affected by deferred rendering
 	// are actually lit in the deferred rendering directional light pass pass
-	glEnable(GL_STENCIL_TEST);
-	glStencilFunc(GL_ALWAYS, DEFERRED_STENCIL_MARK, 0xFF);
-	glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-	glStencilMask(0xFF);
+	GLStateCache::enable(GL_STENCIL_TEST);
+	GLStateCache::stencilFunc(GL_ALWAYS, DEFERRED_STENCIL_MARK, 0xFF);
+	GLStateCache::stencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+	GLStateCache::stencilMask(0xFF);
 
 	// clean the buffers of the deferredRenderingFBO
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
 	// blending is disabled
-	glDisable(GL_BLEND);
+	GLStateCache::disable(GL_BLEND);
 }
 
 void RenderSystem::preparePBRRendering()
 {
 	// sets the actual mark on the stencil buffer
-	glStencilFunc(GL_ALWAYS, PBR_STENCIL_MARK, 0xFF);
+	GLStateCache::stencilFunc(GL_ALWAYS, PBR_STENCIL_MARK, 0xFF);
+}
+
+void RenderSystem::renderDepthPrePass(RenderPhase phase)
+{
+	// only depth is written, stencil marks are written while filling the G-buffer
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	GLStateCache::stencilMask(0x00);
+
+	Engine::gameObjectRenderer.forceMaterial(mDepthPrePassMaterial);
+	Engine::gameObjectRenderer.setDepthPrePass(true);
+	render(RenderPhase::DEFERRED_RENDERING | phase);
+	render(RenderPhase::PBR | phase);
+	Engine::gameObjectRenderer.setDepthPrePass(false);
+	Engine::gameObjectRenderer.forceMaterial(nullptr);
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	GLStateCache::stencilMask(0xFF);
+
+	/* LEQUAL and not EQUAL since the meshes left out of the pre-pass
+	 * must be depth tested as usual, the others only pass where they are visible */
+	GLStateCache::depthFunc(GL_LEQUAL);
+}
+
+void RenderSystem::beginOverdrawQuery()
+{
+	if (mOverdrawQueryPending) {
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(mOverdrawQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			return;
+
+		GLuint samples = 0;
+		glGetQueryObjectuiv(mOverdrawQuery, GL_QUERY_RESULT, &samples);
+		const float pixels = static_cast<float>(deferredRenderingFBO.getWidth()) * deferredRenderingFBO.getHeight();
+		mGBufferOverdraw = samples / std::max(pixels, 1.0f);
+	}
+
+	glBeginQuery(GL_SAMPLES_PASSED, mOverdrawQuery);
+	mOverdrawQueryPending = true;
+	mOverdrawQueryActive = true;
+}
+
+void RenderSystem::endOverdrawQuery()
+{
+	if (mOverdrawQueryActive)
+		glEndQuery(GL_SAMPLES_PASSED);
+	mOverdrawQueryActive = false;
 }
 
 void RenderSystem::renderScene(const RenderTarget* target, RenderPhase phase)
@@ -378,12 +483,19 @@ void RenderSystem::renderScene(const RenderTarget* target, RenderPhase phase)
 	prepareDeferredRendering();
 	//nvtxRangePop();
 
+	if (depthPrePass)
+		renderDepthPrePass(phase);
+
 	//nvtxRangePushA("Render deferred");
+	beginOverdrawQuery();
 	render(RenderPhase::DEFERRED_RENDERING | phase);
 	//nvtxRangePop();
 
 	preparePBRRendering();
 	render(RenderPhase::PBR | phase);
+	endOverdrawQuery();
+
+	GLStateCache::depthFunc(GL_LESS);
 
 	// no need to render lights and stuff if render target is not valid
 	if (!targetToUse->isValid()) return;
@@ -392,8 +504,8 @@ void RenderSystem::renderScene(const RenderTarget* target, RenderPhase phase)
 	finalizeDeferredRendering(targetToUse);
 	//nvtxRangePop();
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLStateCache::enable(GL_BLEND);
+	GLStateCache::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	//nvtxRangePushA("Render forward");
 	render(RenderPhase::FORWARD_RENDERING | phase);
 	//nvtxRangePop();
@@ -405,10 +517,15 @@ void RenderSystem::renderScene(const RenderTarget* target, RenderPhase phase)
 	if (target == nullptr) {
 		//nvtxRangePushA("finalize rendering");
 		finalizeRendering();
+
+		if (frameCapture.isCapturing())
+			frameCapture.readFrame(getScreenWidth(), getScreenHeight(), effectTarget.getFbo());
         
         Engine::uiRenderer.render();
 
         SDL_GL_SwapWindow(mWindow);
+        GLStateCache::endFrame();
+        renderTargetPool.endFrame();
 
 		//nvtxRangePop();
 	}
@@ -416,6 +533,75 @@ void RenderSystem::renderScene(const RenderTarget* target, RenderPhase phase)
 	//nvtxRangePop();
 }
 
+void RenderSystem::renderAuxiliaryView(const DeferredRenderingFBO& gBuffer, const RenderTarget* forwardTarget, const glm::mat4& view,
+	const glm::vec4* clipPlane, float detailCulling, RenderPhase phase)
+{
+	updateMatrices(&mProjection, &view);
+
+	const Frustum frustum = frustumFromClipSpace(mProjection * view);
+	Engine::gameObjectRenderer.forceFrustum(&frustum);
+
+	Plane cullingPlane;
+	if (clipPlane) {
+		setClipPlane(*clipPlane);
+		enableClipPlane();
+
+		const float length = glm::length(glm::vec3{ *clipPlane });
+		const glm::vec3 normal = glm::vec3{ *clipPlane } / length;
+		cullingPlane = Plane{ normal, -normal * clipPlane->w / length };
+		Engine::gameObjectRenderer.forceClipPlane(&cullingPlane);
+	}
+
+	const glm::vec3 viewPosition = glm::vec3{ glm::inverse(view)[3] };
+	Engine::gameObjectRenderer.setDetailCulling(viewPosition, detailCulling);
+
+	// mirrored views flip the winding of the triangles
+	const bool mirrored = glm::determinant(glm::mat3{ view }) < 0.0f;
+	if (mirrored)
+		glFrontFace(GL_CW);
+
+	glViewport(0, 0, gBuffer.getWidth(), gBuffer.getHeight());
+	glBindFramebuffer(GL_FRAMEBUFFER, gBuffer.getFBO());
+
+	// no stencil marks are needed since lights are not computed
+	GLStateCache::disable(GL_STENCIL_TEST);
+	GLStateCache::disable(GL_BLEND);
+	GLStateCache::enable(GL_DEPTH_TEST);
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	render(RenderPhase::DEFERRED_RENDERING | phase);
+	render(RenderPhase::PBR | phase);
+
+	if (forwardTarget) {
+		glBindFramebuffer(GL_FRAMEBUFFER, forwardTarget->getFbo());
+		GLStateCache::enable(GL_BLEND);
+		GLStateCache::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		render(RenderPhase::FORWARD_RENDERING | phase);
+		Engine::particleRenderer.render();
+
+		GLStateCache::disable(GL_BLEND);
+	}
+
+	glFrontFace(GL_CCW);
+	if (clipPlane)
+		disableClipPlane();
+
+	Engine::gameObjectRenderer.setDetailCulling(viewPosition, 0.0f);
+	Engine::gameObjectRenderer.forceClipPlane(nullptr);
+	Engine::gameObjectRenderer.forceFrustum(nullptr);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, getScreenWidth(), getScreenHeight());
+
+	// other listeners of the PRE_RENDER event expect the matrices of the camera
+	if (mCamera) {
+		const glm::mat4 cameraView = getViewMatrix(mCamera->transform);
+		updateMatrices(&mProjection, &cameraView);
+	}
+}
+
 void RenderSystem::render(int phase)
 {
 	mRenderPhase = phase;
@@ -443,55 +629,56 @@ void RenderSystem::finalizeDeferredRendering(const RenderTarget* target)
 
 	// we are rendering to a texture now (or screen)
 	// there is no need of using a depth buffer
-	glDisable(GL_DEPTH_TEST);
-	glDepthMask(GL_FALSE);
+	GLStateCache::disable(GL_DEPTH_TEST);
+	GLStateCache::depthMask(GL_FALSE);
 
 	// stop writing into the stencil buffer
-	glStencilMask(0);
-	glDisable(GL_STENCIL_TEST);
+	GLStateCache::stencilMask(0);
+	GLStateCache::disable(GL_STENCIL_TEST);
 
 	// bind texture used by directional and point light passes
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, deferredRenderingFBO.getDiffuseBuffer().getId());
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, deferredRenderingFBO.getAdditionalBuffer().getId());
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, deferredRenderingFBO.getPositionBuffer().getId());
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, deferredRenderingFBO.getNormalBuffer().getId());
+	GLStateCache::activeTexture(GL_TEXTURE0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, deferredRenderingFBO.getDiffuseBuffer().getId());
+	GLStateCache::activeTexture(GL_TEXTURE1);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, deferredRenderingFBO.getAdditionalBuffer().getId());
+	GLStateCache::activeTexture(GL_TEXTURE2);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, deferredRenderingFBO.getDepthBuffer().getId());
+	GLStateCache::activeTexture(GL_TEXTURE3);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, deferredRenderingFBO.getNormalBuffer().getId());
 
 	// perform directional light pass (include shadows)
 	directionalLightPass(DEFERRED_STENCIL_MARK, mDirectionalLightDeferred);
 	directionalLightPass(PBR_STENCIL_MARK, mDirectionalLightDeferredPBR);
 
 	// perform point light pass (include shadows)
-	pointLightPass(DEFERRED_STENCIL_MARK, mPointLightDeferred);
-	pointLightPass(PBR_STENCIL_MARK, mPointLightDeferredPBR);
+	computePointLightVolumes(target);
+	pointLightPass(DEFERRED_STENCIL_MARK, mPointLightDeferred, mPointLightBatched);
+	pointLightPass(PBR_STENCIL_MARK, mPointLightDeferredPBR, mPointLightBatchedPBR);
 
 	// unbind textures
 	for (int i = 3; i >= 0; --i) {
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GLStateCache::activeTexture(GL_TEXTURE0 + i);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 	}
 
-	glDepthMask(GL_TRUE);
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::depthMask(GL_TRUE);
+	GLStateCache::enable(GL_DEPTH_TEST);
 }
 
 void RenderSystem::directionalLightPass(GLuint mark, DeferredLightShader& shaderWrapper)
 {
-	glBindVertexArray(mScreenMesh.mVao);
+	GLStateCache::bindVertexArray(mScreenMesh.mVao);
 
 	// enable stencil test so that this operation is only carried
 	// out for those pixels actually drawn during deferred rendering
-	glEnable(GL_STENCIL_TEST);
-	glStencilFunc(GL_EQUAL, mark, 0xFF);
-	glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+	GLStateCache::enable(GL_STENCIL_TEST);
+	GLStateCache::stencilFunc(GL_EQUAL, mark, 0xFF);
+	GLStateCache::stencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 
 	// for multiple lights
-	glEnable(GL_BLEND);
+	GLStateCache::enable(GL_BLEND);
 	glBlendEquation(GL_FUNC_ADD);
-	glBlendFunc(GL_ONE, GL_ONE);
+	GLStateCache::blendFunc(GL_ONE, GL_ONE);
 
 	shaderWrapper.shader.use();
 
@@ -503,17 +690,21 @@ void RenderSystem::directionalLightPass(GLuint mark, DeferredLightShader& shader
 		// can cast safely now
 		const DirectionalLight* directionalLight = static_cast<const DirectionalLight*>(light.get());
 
-		glActiveTexture(GL_TEXTURE4);
-		glBindTexture(GL_TEXTURE_2D, directionalLight->getShadowMapTarget().getDepthBuffer().getId());
+		const CascadedShadowMap& shadowMap = directionalLight->getShadowMap();
+		if (shadowMap.getId() != 0)
+			shadowMappingSettings.updateCascadesUbo(shadowMap);
+
+		GLStateCache::activeTexture(GL_TEXTURE4);
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, shadowMap.getId());
 
 		shaderWrapper.setLightIndex(i);
 		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void *)0);
 
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
 	}
 
-	glDisable(GL_BLEND);
-	glDisable(GL_STENCIL_TEST);
+	GLStateCache::disable(GL_BLEND);
+	GLStateCache::disable(GL_STENCIL_TEST);
 }
 
 void RenderSystem::stencilPass(int lightIndex, float radius)
@@ -522,15 +713,15 @@ void RenderSystem::stencilPass(int lightIndex, float radius)
 	glClear(GL_STENCIL_BUFFER_BIT);
 
 	// both faces of the sphere must be rendered
-	glDisable(GL_CULL_FACE);
+	GLStateCache::disable(GL_CULL_FACE);
 	// depth test must be enabled
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::enable(GL_DEPTH_TEST);
 
-	glStencilFunc(GL_ALWAYS, 0, 0x00);
+	GLStateCache::stencilFunc(GL_ALWAYS, 0, 0x00);
 	// increment if back face of sphere is behind something
-	glStencilOpSeparate(GL_BACK, GL_REPLACE, GL_INCR_WRAP, GL_KEEP);
+	GLStateCache::stencilOpSeparate(GL_BACK, GL_REPLACE, GL_INCR_WRAP, GL_KEEP);
 	// decrement if front face of sphere is before something
-	glStencilOpSeparate(GL_FRONT, GL_REPLACE, GL_DECR_WRAP, GL_KEEP);
+	GLStateCache::stencilOpSeparate(GL_FRONT, GL_REPLACE, GL_DECR_WRAP, GL_KEEP);
 
 	// do not write this sphere on the color buffer
 	glDrawBuffer(GL_NONE);
@@ -538,57 +729,164 @@ void RenderSystem::stencilPass(int lightIndex, float radius)
 	mPointLightDeferredStencil.setFloat(mPointLightStencilScaleLocation, radius);
 	mPointLightDeferredStencil.setInt(mPointLightStencilLightIndexLocation, lightIndex);
 
-	glBindVertexArray(mPointLightSphere.mVao);
-	glDrawElements(GL_TRIANGLES, mPointLightSphere.mIndicesNumber, GL_UNSIGNED_INT, (void *)0);
+	GLStateCache::bindVertexArray(mPointLightSphere.mVao);
+	glDrawElementsBaseVertex(GL_TRIANGLES, mPointLightSphere.mIndicesNumber, GL_UNSIGNED_INT,
+		(void *)(mPointLightSphere.getFirstIndex() * sizeof(std::uint32_t)), mPointLightSphere.getBaseVertex());
 
 	glDrawBuffer(GL_COLOR_ATTACHMENT0);
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
+	GLStateCache::disable(GL_DEPTH_TEST);
+	GLStateCache::enable(GL_CULL_FACE);
+}
+
+void RenderSystem::computePointLightVolumes(const RenderTarget* target)
+{
+	mPointLightVolumes.clear();
+
+	const glm::mat4 projectionView = mProjection * getViewMatrix(mCamera->transform);
+	const Frustum frustum = frustumFromClipSpace(projectionView);
+
+	const glm::vec2 screenSize{ target->getWidth(), target->getHeight() };
+
+	// only the lights in the lights ubo can be rendered
+	const std::size_t numLights = std::min(MAX_LIGHT_NUMBER, mLights.size());
+	for (std::size_t i = 0; i < numLights; i++) {
+		const auto& light = mLights[i]->getComponent<Light>();
+		if (light->getType() != Light::Type::POINT)
+			continue;
+
+		const PointLight* pointLight = static_cast<const PointLight*>(light.get());
+		const float radius = pointLight->getRadius();
+		const glm::vec3 position = mLights[i]->transform.getPosition();
+		const BoundingBox box{ position - glm::vec3{ radius }, position + glm::vec3{ radius } };
+
+		if (boxFrustumIntersection(box, frustum) == IntersectionTestResult::OUTSIDE)
+			continue;
+
+		// screen rectangle of the box containing the sphere, the whole screen if the box crosses the camera plane
+		glm::vec2 min{ 0.0f };
+		glm::vec2 max{ screenSize };
+		bool crossesCamera = false;
+		glm::vec2 ndcMin{ 1.0f };
+		glm::vec2 ndcMax{ -1.0f };
+		for (int corner = 0; corner < 8; ++corner) {
+			const glm::vec3 offset{ corner & 1 ? radius : -radius, corner & 2 ? radius : -radius, corner & 4 ? radius : -radius };
+			const glm::vec4 clip = projectionView * glm::vec4{ position + offset, 1.0f };
+			if (clip.w <= 0.0f) {
+				crossesCamera = true;
+				break;
+			}
+
+			const glm::vec2 ndc = glm::vec2{ clip } / clip.w;
+			ndcMin = glm::min(ndcMin, ndc);
+			ndcMax = glm::max(ndcMax, ndc);
+		}
+
+		if (!crossesCamera) {
+			min = glm::clamp((ndcMin * 0.5f + 0.5f) * screenSize, glm::vec2{ 0.0f }, screenSize);
+			max = glm::clamp((ndcMax * 0.5f + 0.5f) * screenSize, glm::vec2{ 0.0f }, screenSize);
+		}
+
+		const glm::ivec2 scissorMin{ glm::floor(min) };
+		const glm::ivec2 scissorSize = glm::ivec2{ glm::ceil(max) } - scissorMin;
+		if (scissorSize.x <= 0 || scissorSize.y <= 0)
+			continue;
+
+		PointLightVolume volume;
+		volume.lightIndex = i;
+		volume.radius = radius;
+		volume.scissor = glm::ivec4{ scissorMin, scissorSize };
+		volume.screenCoverage = static_cast<float>(scissorSize.x) * scissorSize.y / (screenSize.x * screenSize.y);
+		volume.castsShadow = light->getShadowCasterMode() != Light::ShadowCasterMode::NO_SHADOWS;
+		mPointLightVolumes.push_back(volume);
+	}
 }
 
-void RenderSystem::pointLightPass(GLuint mark, DeferredLightShader& shaderWrapper)
+void RenderSystem::pointLightPass(GLuint mark, DeferredLightShader& shaderWrapper, DeferredLightShader& batchShaderWrapper)
 {
 	/* This mask prevents the two most significant bits from being deleted 
 	 * This mask is used so that the stencil buffer can be
-	 * cleared without losing the information on pbr vs. blinn-phong */
-	glStencilMask(0x3F);  
+	 * cleared without losing the information on pbr vs. blinn-phong.
+	 * The stencil buffer is cleared by each stencilPass, only inside the scissor rectangle of the light */
+	GLStateCache::stencilMask(0x3F);  
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-	glClear(GL_STENCIL_BUFFER_BIT);
-	glEnable(GL_STENCIL_TEST);
+	GLStateCache::enable(GL_STENCIL_TEST);
 
-	glEnable(GL_BLEND);
+	GLStateCache::enable(GL_BLEND);
 	glBlendEquation(GL_FUNC_ADD);
-	glBlendFunc(GL_ONE, GL_ONE);
+	GLStateCache::blendFunc(GL_ONE, GL_ONE);
 
-	for (std::size_t i = 0; i < mLights.size(); i++) {
-		const auto& light = mLights[i]->getComponent<Light>();
-		if (light->getType() != Light::Type::POINT)
+	std::vector<int> batchedIndices;
+	std::vector<float> batchedRadii;
+
+	GLStateCache::enable(GL_SCISSOR_TEST);
+	for (const PointLightVolume& volume : mPointLightVolumes) {
+		if (!volume.castsShadow && volume.screenCoverage < pointLightBatchingCoverage) {
+			batchedIndices.push_back(static_cast<int>(volume.lightIndex));
+			batchedRadii.push_back(volume.radius);
 			continue;
+		}
 
-		const PointLight* pointLight = static_cast<const PointLight*>(light.get());
+		const PointLight* pointLight = static_cast<const PointLight*>(mLights[volume.lightIndex]->getComponent<Light>().get());
 
-		float radius = pointLight->getRadius();
+		glScissor(volume.scissor.x, volume.scissor.y, volume.scissor.z, volume.scissor.w);
 
-		stencilPass(i, radius);
+		stencilPass(volume.lightIndex, volume.radius);
 
-		glActiveTexture(GL_TEXTURE4);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, pointLight->getPointShadowTarget().getDepthBuffer().getId());
+		GLStateCache::activeTexture(GL_TEXTURE4);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, mPointShadowAtlas.getId());
 
 		/* mark is used to shader only the pixel of this phase. +1 is needed to identify those pixels
 		   that are not inside a light sphere */
-		glStencilFunc(GL_EQUAL, mark + 1, 0xFF);
+		GLStateCache::stencilFunc(GL_EQUAL, mark + 1, 0xFF);
 		shaderWrapper.shader.use();
 
-		shaderWrapper.setLightIndex(i);
-		shaderWrapper.setLightRadius(radius);
-		glBindVertexArray(mScreenMesh.mVao);
-		glDrawElements(GL_TRIANGLES, mPointLightSphere.mIndicesNumber, GL_UNSIGNED_INT, (void *)0);
+		shaderWrapper.setLightIndex(volume.lightIndex);
+		shaderWrapper.setLightRadius(volume.radius);
 
-		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		// normalized regions of the atlas containing the faces of the shadow cube
+		mShadowFaceRects.clear();
+		const float atlasSize = static_cast<float>(std::max(1u, mPointShadowAtlas.getSize()));
+		for (const PointShadowAtlas::Tile& tile : pointLight->mShadowTiles)
+			mShadowFaceRects.push_back(glm::vec4{ tile.x, tile.y, tile.size, tile.size } / atlasSize);
+		shaderWrapper.setShadowFaceRects(mShadowFaceRects);
+		GLStateCache::bindVertexArray(mScreenMesh.mVao);
+		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void *)0);
+
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+	}
+	GLStateCache::disable(GL_SCISSOR_TEST);
+
+	if (!batchedIndices.empty()) {
+		/* small lights without shadows are drawn together without a stencil pass:
+		 * the back faces of their spheres behind the geometry cover the lit pixels, the few pixels
+		 * in front of the sphere are discarded by the fragment shader. Only the bits of the mark are tested */
+		GLStateCache::stencilMask(0x00);
+		GLStateCache::stencilFunc(GL_EQUAL, mark, 0xC0);
+		GLStateCache::stencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+
+		GLStateCache::enable(GL_DEPTH_TEST);
+		GLStateCache::depthFunc(GL_GEQUAL);
+		// back faces beyond the far plane must not be clipped
+		GLStateCache::enable(GL_DEPTH_CLAMP);
+		GLStateCache::cullFace(GL_FRONT);
+
+		batchShaderWrapper.shader.use();
+		batchShaderWrapper.setLightVolumes(batchedIndices, batchedRadii);
+
+		GLStateCache::bindVertexArray(mPointLightSphere.mVao);
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mPointLightSphere.mIndicesNumber, GL_UNSIGNED_INT,
+			(void *)(mPointLightSphere.getFirstIndex() * sizeof(std::uint32_t)), static_cast<GLsizei>(batchedIndices.size()),
+			mPointLightSphere.getBaseVertex());
+
+		GLStateCache::cullFace(GL_BACK);
+		GLStateCache::disable(GL_DEPTH_CLAMP);
+		GLStateCache::depthFunc(GL_LESS);
+		GLStateCache::disable(GL_DEPTH_TEST);
+		GLStateCache::stencilMask(0x3F);
 	}
 
-	glDisable(GL_BLEND);
-	glDisable(GL_STENCIL_TEST);
+	GLStateCache::disable(GL_BLEND);
+	GLStateCache::disable(GL_STENCIL_TEST);
 }
 
 void RenderSystem::finalizeRendering()
@@ -602,92 +900,339 @@ void RenderSystem::finalizeRendering()
 
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
-	glDisable(GL_DEPTH_TEST);
+	GLStateCache::disable(GL_DEPTH_TEST);
 
-	glBindVertexArray(mScreenMesh.mVao);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, effectTarget.getColorBuffer().getId());
+	GLStateCache::bindVertexArray(mScreenMesh.mVao);
+	GLStateCache::activeTexture(GL_TEXTURE0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, effectTarget.getColorBuffer().getId());
 
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, effectTarget.getDepthBuffer().getId());
+	GLStateCache::activeTexture(GL_TEXTURE1);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, effectTarget.getDepthBuffer().getId());
 	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void *)0);
 
-	glEnable(GL_DEPTH_TEST);
+	effectManager.endFrame();
+	GLStateCache::enable(GL_DEPTH_TEST);
 }
 
 void RenderSystem::renderShadows()
 {
+	const glm::mat4 cameraTransform = mCamera->transform.modelToWorld();
+
 	for (const auto& lightGO : mLights) {
 		const auto& light = lightGO->getComponent<Light>();
 
-		if (light->getShadowCasterMode() == Light::ShadowCasterMode::NO_SHADOWS || !light->needsShadowUpdate())  continue;
+		if (light->getShadowCasterMode() == Light::ShadowCasterMode::NO_SHADOWS || light->getType() != Light::Type::DIRECTIONAL) continue;
+
+		DirectionalLight* directionalLight = static_cast<DirectionalLight*>(light.get());
+		CascadedShadowMap& shadowMap = directionalLight->mShadowMap;
+
+		bool needsUpdate = light->needsShadowUpdate();
+		if (needsUpdate)
+			shadowMap.invalidateStaticCache();
 
-		if (light->getType() == Light::Type::DIRECTIONAL)
-			renderDirectionalLightShadows(static_cast<const DirectionalLight*>(light.get()), lightGO->transform);
-		else if (light->getType() == Light::Type::POINT)
-			renderPointLightShadows(static_cast<const PointLight*>(light.get()), lightGO->transform);
+		/* lights caching static shadows are rendered every frame since dynamic casters can move,
+		 * but static casters are only rendered when needed. Cascades follow the camera, they are
+		 * fitted again when it moves */
+		if (needsUpdate || shadowMap.cachesStaticShadows() || shadowMap.mFittedCameraTransform != cameraTransform)
+			renderDirectionalLightShadows(directionalLight, lightGO->transform);
 	}
+
+	renderPointLightShadows();
+
+	mShadowFrame++;
 }
 
-void RenderSystem::renderDirectionalLightShadows(const DirectionalLight* light, const Transform& lightTransform)
+void RenderSystem::renderDirectionalLightShadows(DirectionalLight* light, const Transform& lightTransform)
 {
-	// 	glm::mat4 lightProjection = glm::mat4{ 0.0f };
-	// 	lightProjection[0][0] = 2.0f / shadowMappingSettings.width;
-	// 	lightProjection[1][1] = 2.0f / shadowMappingSettings.height;
-	// 	lightProjection[2][2] = -2.0f / shadowMappingSettings.depth;
-	// 	lightProjection[3][3] = 1.0f;
-	glm::mat4 lightProjection = glm::ortho(-shadowMappingSettings.width / 2, shadowMappingSettings.width / 2,
-		-shadowMappingSettings.height / 2, shadowMappingSettings.height / 2,
-		0.1f, shadowMappingSettings.depth);
+	CascadedShadowMap& shadowMap = light->mShadowMap;
+	const auto camera = mCamera->getComponent<CameraComponent>();
 
-	glm::mat4 lightView = getViewMatrix(lightTransform);
+	const float near = camera->getNearPlaneDistance();
+	const float cameraFar = camera->getFarPlaneDistance();
+	const float far = std::min(cameraFar, shadowMappingSettings.depth);
+	const float lambda = std::clamp(shadowMappingSettings.cascadeSplitLambda, 0.0f, 1.0f);
+	const std::array<glm::vec3, 8> cameraVertices = camera->getViewFrutsum().getVertices();
 
-	updateMatrices(&lightProjection, &lightView);
+	// the light position does not matter, keeping the light space origin fixed makes texel snapping stable
+	const glm::mat4 lightView = mInvertView * glm::transpose(glm::toMat4(lightTransform.getRotation()));
 
 	glViewport(0, 0, shadowMappingSettings.mapWidth, shadowMappingSettings.mapHeight);
-	glBindFramebuffer(GL_FRAMEBUFFER, light->getShadowMapTarget().getFbo());
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_DEPTH_BUFFER_BIT);
 
 	if (shadowMappingSettings.useFastShader)
 		Engine::gameObjectRenderer.forceMaterial(mShadowMapMaterial);
-	render(RenderPhase::SHADOW_MAPPING);
+
+	float sliceNear = near;
+	for (std::uint32_t i = 0; i < shadowMap.mCascadesNumber; ++i) {
+		/* blend of uniform and logarithmic splits: uniform splits waste resolution close
+		 * to the camera, logarithmic ones make the farthest cascades too large */
+		float t = (i + 1) / static_cast<float>(shadowMap.mCascadesNumber);
+		float uniformSplit = near + (far - near) * t;
+		float logSplit = near * std::pow(far / near, t);
+		float sliceFar = glm::mix(uniformSplit, logSplit, lambda);
+
+		// vertices of the slice of the view frustum covered by this cascade
+		std::array<glm::vec3, 8> sliceVertices;
+		glm::vec3 center{ 0.0f };
+		for (std::size_t v = 0; v < 4; ++v) {
+			const glm::vec3 edge = cameraVertices[v] - cameraVertices[v + 4];
+			sliceVertices[v] = cameraVertices[v + 4] + edge * ((sliceFar - near) / (cameraFar - near));
+			sliceVertices[v + 4] = cameraVertices[v + 4] + edge * ((sliceNear - near) / (cameraFar - near));
+			center += sliceVertices[v] + sliceVertices[v + 4];
+		}
+		center /= 8.0f;
+
+		/* a sphere around the slice does not change size when the camera rotates, rounding
+		 * its radius removes floating point noise so the cascade size is really constant */
+		float radius = 0.0f;
+		for (const glm::vec3& vertex : sliceVertices)
+			radius = std::max(radius, glm::distance(center, vertex));
+		radius = std::ceil(radius * 16.0f) / 16.0f;
+
+		// move the cascade by whole texels to stop shadow edges from shimmering when the camera moves
+		glm::vec3 lightSpaceCenter = glm::vec3{ lightView * glm::vec4{ center, 1.0f } };
+		float texelWidth = 2.0f * radius / shadowMappingSettings.mapWidth;
+		float texelHeight = 2.0f * radius / shadowMappingSettings.mapHeight;
+		lightSpaceCenter.x = std::floor(lightSpaceCenter.x / texelWidth) * texelWidth;
+		lightSpaceCenter.y = std::floor(lightSpaceCenter.y / texelHeight) * texelHeight;
+
+		// the box extends towards the light so that casters outside the slice are rendered too
+		glm::mat4 lightProjection = glm::ortho(lightSpaceCenter.x - radius, lightSpaceCenter.x + radius,
+			lightSpaceCenter.y - radius, lightSpaceCenter.y + radius,
+			-lightSpaceCenter.z - radius - shadowMappingSettings.casterDistance, -lightSpaceCenter.z + radius);
+
+		shadowMap.mFarDistances[i] = sliceFar;
+		shadowMap.mToLightSpace[i] = lightProjection * lightView;
+
+		// only the casters of this cascade are rendered
+		const Frustum cascadeFrustum = frustumFromClipSpace(shadowMap.mToLightSpace[i]);
+		Engine::gameObjectRenderer.forceFrustum(&cascadeFrustum);
+
+		updateMatrices(&lightProjection, &lightView);
+
+		if (shadowMap.cachesStaticShadows()) {
+			// the cached layer can be reused until the cascade moves
+			if (!shadowMap.mStaticLayerValid[i] || shadowMap.mStaticToLightSpace[i] != shadowMap.mToLightSpace[i]) {
+				glBindFramebuffer(GL_FRAMEBUFFER, shadowMap.mStaticFbos[i]);
+				glClear(GL_DEPTH_BUFFER_BIT);
+
+				Engine::gameObjectRenderer.setStaticFilter(GameObjectRenderer::StaticFilter::STATIC_ONLY);
+				render(RenderPhase::SHADOW_MAPPING);
+
+				shadowMap.mStaticToLightSpace[i] = shadowMap.mToLightSpace[i];
+				shadowMap.mStaticLayerValid[i] = true;
+			}
+
+			glCopyImageSubData(shadowMap.mStaticDepthArray, GL_TEXTURE_2D_ARRAY, 0, 0, 0, i,
+				shadowMap.mDepthArray, GL_TEXTURE_2D_ARRAY, 0, 0, 0, i,
+				shadowMap.mWidth, shadowMap.mHeight, 1);
+
+			glBindFramebuffer(GL_FRAMEBUFFER, shadowMap.mFbos[i]);
+			Engine::gameObjectRenderer.setStaticFilter(GameObjectRenderer::StaticFilter::DYNAMIC_ONLY);
+			render(RenderPhase::SHADOW_MAPPING);
+		}
+		else {
+			glBindFramebuffer(GL_FRAMEBUFFER, shadowMap.mFbos[i]);
+			glClear(GL_DEPTH_BUFFER_BIT);
+
+			render(RenderPhase::SHADOW_MAPPING);
+		}
+
+		sliceNear = sliceFar;
+	}
+
+	Engine::gameObjectRenderer.forceFrustum(nullptr);
+	Engine::gameObjectRenderer.setStaticFilter(GameObjectRenderer::StaticFilter::ALL);
 	if (shadowMappingSettings.useFastShader)
 		Engine::gameObjectRenderer.forceMaterial(nullptr);
 
+	shadowMap.mFittedCameraTransform = mCamera->transform.modelToWorld();
+
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void RenderSystem::renderPointLightShadows(const PointLight* light, const Transform& lightTransform)
+void RenderSystem::renderPointLightShadows()
 {
-	const glm::vec3& lightPos = lightTransform.getPosition();
-	float aspect = (float)1024 / (float)1024;
-	float near = 1.0f;
-	float farPlane = light->getRadius();
-	glm::mat4 projection = glm::perspective(glm::radians(90.0f), aspect, near, farPlane);
+	// tiles are placed along a Morton curve, which needs a power of two atlas
+	std::uint32_t atlasSize = 1;
+	while (atlasSize < shadowMappingSettings.pointShadowAtlasSize)
+		atlasSize *= 2;
 
-	std::vector<glm::mat4> transforms{
-		projection * glm::lookAt(lightPos, lightPos + glm::vec3(1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0)),
-		projection * glm::lookAt(lightPos, lightPos + glm::vec3(-1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0)),
-		projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0, 1.0, 0.0), glm::vec3(0.0, 0.0, 1.0)),
-		projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0, -1.0, 0.0), glm::vec3(0.0, 0.0, -1.0)),
-		projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0, 0.0, 1.0), glm::vec3(0.0, -1.0, 0.0)),
-		projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0, 0.0, -1.0), glm::vec3(0.0, -1.0, 0.0))
+	if (mPointShadowAtlas.getSize() != atlasSize)
+		mPointShadowAtlas.create(atlasSize);
+
+	const auto camera = mCamera->getComponent<CameraComponent>();
+	const Frustum cameraFrustum = camera->getViewFrutsum();
+	const glm::vec3 cameraPosition = mCamera->transform.getPosition();
+
+	// size in pixels of an object of size 1 at distance 1 from the camera
+	const float pixelsPerUnit = getScreenHeight() / (2.0f * std::tan(camera->getFOV() / 2.0f));
+
+	struct PointShadow {
+		PointLight* light;
+		glm::vec3 position;
+		float radius;
+		float distance;
+		bool needsUpdate;
+
+		std::array<glm::mat4, 6> faceTransforms;
+
+		/** bit mask of the faces that see at least a caster */
+		std::uint32_t faces = 0;
 	};
 
-	mPointShadowMaterial->setTransformations(transforms, farPlane, lightPos);
+	std::vector<PointShadow> shadows;
+	std::vector<PointShadowAtlas::Request> requests;
 
-	Engine::gameObjectRenderer.forceMaterial(mPointShadowMaterial);
+	for (const auto& lightGO : mLights) {
+		const auto& light = lightGO->getComponent<Light>();
+		if (light->getShadowCasterMode() == Light::ShadowCasterMode::NO_SHADOWS || light->getType() != Light::Type::POINT) continue;
+
+		PointLight* pointLight = static_cast<PointLight*>(light.get());
+		PointShadow shadow;
+		shadow.light = pointLight;
+		shadow.position = lightGO->transform.getPosition();
+		shadow.radius = pointLight->getRadius();
+		shadow.distance = glm::distance(cameraPosition, shadow.position);
+		shadow.needsUpdate = light->needsShadowUpdate();
+
+		if (shadow.needsUpdate)
+			pointLight->mStaticShadowsValid = false;
+
+		// lights outside the view do not light anything visible
+		const BoundingBox lightBB{ shadow.position - glm::vec3{ shadow.radius }, shadow.position + glm::vec3{ shadow.radius } };
+		if (boxFrustumIntersection(lightBB, cameraFrustum) == IntersectionTestResult::OUTSIDE) {
+			pointLight->mShadowTiles.fill(PointShadowAtlas::Tile{});
+			continue;
+		}
+
+		const glm::vec3& lightPos = shadow.position;
+		const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 1.0f, shadow.radius);
+		shadow.faceTransforms = {
+			projection * glm::lookAt(lightPos, lightPos + glm::vec3(1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0)),
+			projection * glm::lookAt(lightPos, lightPos + glm::vec3(-1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0)),
+			projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0, 1.0, 0.0), glm::vec3(0.0, 0.0, 1.0)),
+			projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0, -1.0, 0.0), glm::vec3(0.0, 0.0, -1.0)),
+			projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0, 0.0, 1.0), glm::vec3(0.0, -1.0, 0.0)),
+			projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0, 0.0, -1.0), glm::vec3(0.0, -1.0, 0.0))
+		};
+
+		// faces without casters are neither allocated nor rendered
+		std::uint32_t facesNumber = 0;
+		for (std::uint32_t face = 0; face < 6; ++face) {
+			if (Engine::gameObjectRenderer.isAnyGameObjectInside(frustumFromClipSpace(shadow.faceTransforms[face]), RenderPhase::SHADOW_MAPPING)) {
+				shadow.faces |= 1u << face;
+				facesNumber++;
+			}
+		}
+
+		if (facesNumber == 0) {
+			pointLight->mShadowTiles.fill(PointShadowAtlas::Tile{});
+			continue;
+		}
+
+		// the resolution depends on how large the light looks on the screen
+		float screenSize = shadow.radius / std::max(shadow.distance, shadow.radius) * pixelsPerUnit * pointLight->shadowImportance;
+		std::uint32_t tileSize = shadowMappingSettings.pointShadowMinTileSize;
+		while (tileSize < screenSize && tileSize < shadowMappingSettings.pointShadowMaxTileSize)
+			tileSize *= 2;
+
+		shadows.push_back(shadow);
+		requests.push_back({ tileSize, facesNumber });
+	}
+
+	// larger lights first, they are the last ones to lose resolution when the atlas is full
+	std::vector<std::size_t> order(shadows.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&requests](std::size_t a, std::size_t b) {
+		return requests[a].size > requests[b].size;
+	});
+
+	std::vector<PointShadowAtlas::Request> sortedRequests;
+	for (std::size_t index : order)
+		sortedRequests.push_back(requests[index]);
+
+	const auto tiles = mPointShadowAtlas.allocate(sortedRequests, shadowMappingSettings.pointShadowMinTileSize);
 
-	glViewport(0, 0, 1024, 1024); // TODO use settings
-	glBindFramebuffer(GL_FRAMEBUFFER, light->getPointShadowTarget().getFbo());
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_DEPTH_BUFFER_BIT);
+	GLStateCache::enable(GL_SCISSOR_TEST);
+	Engine::gameObjectRenderer.forceMaterial(mPointShadowMaterial);
+
+	const std::uint32_t updateInterval = std::max(1u, shadowMappingSettings.pointShadowFarUpdateInterval);
+	for (std::size_t i = 0; i < order.size(); ++i) {
+		const PointShadow& shadow = shadows[order[i]];
+		PointLight* light = shadow.light;
+
+		std::array<PointShadowAtlas::Tile, 6> faceTiles{};
+		for (std::uint32_t face = 0, tile = 0; face < 6 && tile < tiles[i].size(); ++face)
+			if (shadow.faces & (1u << face))
+				faceTiles[face] = tiles[i][tile++];
+
+		bool tilesChanged = faceTiles != light->mShadowTiles;
+		light->mShadowTiles = faceTiles;
+		if (tilesChanged)
+			light->mStaticShadowsValid = false;
+
+		// dynamic lights always need an update, lights far from the camera are updated less frequently
+		bool mustUpdate = tilesChanged || (shadow.needsUpdate && light->getShadowCasterMode() != Light::ShadowCasterMode::DYNAMIC);
+		if (!mustUpdate && shadow.distance > shadowMappingSettings.pointShadowFarDistance && (mShadowFrame + i) % updateInterval != 0)
+			continue;
+
+		const bool cachesStaticShadows = light->getShadowCasterMode() == Light::ShadowCasterMode::STATIC
+			|| light->getShadowCasterMode() == Light::ShadowCasterMode::AUTO;
+		if (cachesStaticShadows)
+			mPointShadowAtlas.createStaticCache();
+
+		mPointShadowMaterial->setLight(shadow.radius, shadow.position);
+
+		for (std::uint32_t face = 0; face < 6; ++face) {
+			const PointShadowAtlas::Tile& tile = faceTiles[face];
+			if (tile.size == 0) continue;
+
+			mPointShadowMaterial->setFaceTransform(shadow.faceTransforms[face]);
 
-	render(RenderPhase::SHADOW_MAPPING);
+			// only the casters seen by this face are rendered
+			const Frustum faceFrustum = frustumFromClipSpace(shadow.faceTransforms[face]);
+			Engine::gameObjectRenderer.forceFrustum(&faceFrustum);
 
+			glViewport(tile.x, tile.y, tile.size, tile.size);
+			glScissor(tile.x, tile.y, tile.size, tile.size);
+
+			if (cachesStaticShadows) {
+				if (!light->mStaticShadowsValid) {
+					glBindFramebuffer(GL_FRAMEBUFFER, mPointShadowAtlas.mStaticFbo);
+					glClear(GL_DEPTH_BUFFER_BIT);
+
+					Engine::gameObjectRenderer.setStaticFilter(GameObjectRenderer::StaticFilter::STATIC_ONLY);
+					render(RenderPhase::SHADOW_MAPPING);
+				}
+
+				// start from the static casters, then add the dynamic ones
+				glCopyImageSubData(mPointShadowAtlas.mStaticDepth, GL_TEXTURE_2D, 0, tile.x, tile.y, 0,
+					mPointShadowAtlas.mDepth, GL_TEXTURE_2D, 0, tile.x, tile.y, 0,
+					tile.size, tile.size, 1);
+
+				glBindFramebuffer(GL_FRAMEBUFFER, mPointShadowAtlas.mFbo);
+				Engine::gameObjectRenderer.setStaticFilter(GameObjectRenderer::StaticFilter::DYNAMIC_ONLY);
+				render(RenderPhase::SHADOW_MAPPING);
+				Engine::gameObjectRenderer.setStaticFilter(GameObjectRenderer::StaticFilter::ALL);
+			}
+			else {
+				glBindFramebuffer(GL_FRAMEBUFFER, mPointShadowAtlas.mFbo);
+				glClear(GL_DEPTH_BUFFER_BIT);
+
+				render(RenderPhase::SHADOW_MAPPING);
+			}
+		}
+
+		if (cachesStaticShadows)
+			light->mStaticShadowsValid = true;
+	}
+
+	GLStateCache::disable(GL_SCISSOR_TEST);
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	Engine::gameObjectRenderer.forceFrustum(nullptr);
 	Engine::gameObjectRenderer.forceMaterial(nullptr);
 }
 
@@ -701,6 +1246,26 @@ void RenderSystem::addLight(const GameObjectEH& light)
 	mLights.push_back(light);
 }
 
+bool RenderSystem::setVSync(bool enabled)
+{
+	mVSync = enabled;
+	if (mWindow == nullptr)
+		return true;
+
+	if (SDL_GL_SetSwapInterval(enabled ? 1 : 0) < 0) {
+		std::cout << "Cannot set the swap interval " << SDL_GetError() << "\n";
+		mVSync = false;
+		return false;
+	}
+
+	return true;
+}
+
+bool RenderSystem::isVSyncEnabled() const
+{
+	return mVSync;
+}
+
 std::int32_t RenderSystem::getScreenWidth() const
 {
 	std::int32_t w;
@@ -755,14 +1320,19 @@ int RenderSystem::getRenderPhase() const
 	return mRenderPhase;
 }
 
+float RenderSystem::getGBufferOverdraw() const
+{
+	return mGBufferOverdraw;
+}
+
 void RenderSystem::enableClipPlane() const
 {
-	glEnable(GL_CLIP_DISTANCE0);
+	GLStateCache::enable(GL_CLIP_DISTANCE0);
 }
 
 void RenderSystem::disableClipPlane() const
 {
-	glDisable(GL_CLIP_DISTANCE0);
+	GLStateCache::disable(GL_CLIP_DISTANCE0);
 }
 
 void RenderSystem::setClipPlane(const glm::vec4& clipPlane) const
@@ -783,17 +1353,17 @@ void RenderSystem::copyTexture(const Texture& src, RenderTarget& dst, const Shad
 
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	if (clear) glClear(GL_COLOR_BUFFER_BIT);
-	glDisable(GL_DEPTH_TEST);
+	GLStateCache::disable(GL_DEPTH_TEST);
 
-	glBindVertexArray(mScreenMesh.mVao);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, src.getId());
+	GLStateCache::bindVertexArray(mScreenMesh.mVao);
+	GLStateCache::activeTexture(GL_TEXTURE0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, src.getId());
 
 	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void *)0);
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::enable(GL_DEPTH_TEST);
 
 	glViewport(0, 0, getScreenWidth(), getScreenHeight());
 }
@@ -801,20 +1371,29 @@ void RenderSystem::copyTexture(const Texture& src, RenderTarget& dst, const Shad
 void RenderSystem::cleanUp()
 {
 	// Delete uniform buffers
-	glDeleteBuffers(1, &mUboCommonMat);
-	glDeleteBuffers(1, &mUboLights);
+	const std::uint32_t uniformBuffers[] = { mUboCommonMat, mUboLights, mUboCamera };
+	GLStateCache::deleteBuffers(3, uniformBuffers);
+	glDeleteQueries(1, &mOverdrawQuery);
 	mShadowMapMaterial = nullptr;
+	mDepthPrePassMaterial = nullptr;
 	mPointShadowMaterial = nullptr;
+	mPointShadowAtlas.cleanUp();
 
 	effectManager.cleanUp();
+	renderTargetPool.cleanUp();
 
 	// cleans shaders
 	mPointLightDeferred.cleanUp();
 	mPointLightDeferredPBR.cleanUp();
+	mPointLightBatched.cleanUp();
+	mPointLightBatchedPBR.cleanUp();
 	mPointLightDeferredStencil = Shader();
 	mDirectionalLightDeferred.cleanUp();
 	mDirectionalLightDeferredPBR.cleanUp();
 
+	SharedMeshBuffers::cleanUp();
+	frameCapture.cleanUp();
+
 	// Destroys the window and quit SDL
 	SDL_DestroyWindow(mWindow);
 	SDL_Quit();
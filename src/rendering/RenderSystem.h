@@ -15,8 +15,12 @@
 #include "rendering/light/DirectionalLight.h"
 #include "rendering/light/PointLight.h"
 #include "rendering/RenderTarget.h"
+#include "rendering/RenderTargetPool.h"
 #include "rendering/materials/PointShadowMaterial.h"
+#include "rendering/shadow/PointShadowAtlas.h"
 #include "rendering/deferredRendering/DeferredLightShader.h"
+#include "rendering/occlusion/OcclusionCuller.h"
+#include "rendering/capture/FrameCapture.h"
 #include <cstdint>
 #include <vector>
 #include <glad/glad.h>
@@ -43,6 +47,8 @@ private:
 
 	SDL_Window* mWindow = nullptr;
 
+	bool mVSync = false;
+
 	glm::mat4 mProjection{ 1.0f };
 
 	glm::mat4 mInvertView;
@@ -64,9 +70,21 @@ private:
 	// used for rendering meshes for shadow mapping
 	MaterialPtr mShadowMapMaterial;
 
+	// used for rendering meshes in the depth pre-pass, unlike mShadowMapMaterial back faces are culled
+	MaterialPtr mDepthPrePassMaterial;
+
 	// used for rendering meshes with point lights
 	std::shared_ptr<PointShadowMaterial> mPointShadowMaterial;
 
+	/** shadows of all the PointLight%s */
+	PointShadowAtlas mPointShadowAtlas;
+
+	/** normalized regions of the atlas containing the faces of the shadow being drawn, reused by every light */
+	std::vector<glm::vec4> mShadowFaceRects;
+
+	/** number of times shadows have been rendered, used to spread the updates of far PointLight%s */
+	std::uint64_t mShadowFrame = 0;
+
 	/** Shader used to render DirectionalLight's light on normal materials using deferred rendering */
 	DeferredLightShader mDirectionalLightDeferred;
 
@@ -84,6 +102,29 @@ private:
 	/** Shader used to render PointLight's light on PBR materials using deferred rendering */
 	DeferredLightShader mPointLightDeferredPBR;
 
+	/** Shader used to render the light of many small PointLight%s on normal materials with a single draw call */
+	DeferredLightShader mPointLightBatched;
+
+	/** Shader used to render the light of many small PointLight%s on PBR materials with a single draw call */
+	DeferredLightShader mPointLightBatchedPBR;
+
+	/** The part of the screen affected by a visible PointLight */
+	struct PointLightVolume {
+		std::size_t lightIndex;
+		float radius;
+
+		/** x, y, width and height of the screen rectangle containing the sphere of the light */
+		glm::ivec4 scissor;
+
+		/** fraction of the screen covered by the scissor rectangle */
+		float screenCoverage;
+
+		bool castsShadow;
+	};
+
+	/** the PointLight%s intersecting the view frustum, computed once for each frame */
+	std::vector<PointLightVolume> mPointLightVolumes;
+
 	/** The camera used for rendering */
 	GameObjectEH mCamera;
 
@@ -92,6 +133,12 @@ private:
 	/** Current rendering phase */
 	int mRenderPhase;
 
+	/** counts the fragments written to the G-buffer */
+	std::uint32_t mOverdrawQuery = 0;
+	bool mOverdrawQueryPending = false;
+	bool mOverdrawQueryActive = false;
+	float mGBufferOverdraw = 0.0f;
+
 	void initGL(std::uint32_t width, std::uint32_t height);
 
 	void initDeferredRendering();
@@ -114,6 +161,14 @@ private:
 	/** Performs all operations needed by PBR rendering */
 	void preparePBRRendering();
 
+	/** Fills the depth of the G-buffer so that only the visible fragments are shaded */
+	void renderDepthPrePass(RenderPhase phase);
+
+	/** Starts counting the fragments written to the G-buffer, if the previous count has been read */
+	void beginOverdrawQuery();
+
+	void endOverdrawQuery();
+
 	/** Performs all operations needed to finalize deferred rendering: combine g-buffer data */
 	void finalizeDeferredRendering(const RenderTarget* target);
 
@@ -121,16 +176,29 @@ private:
 
 	void stencilPass(int lightIndex, float radius);
 
-	void pointLightPass(GLuint mark, DeferredLightShader& shaderWrapper);
+	/** Culls the PointLight%s outside the view frustum and computes the screen rectangles of the others */
+	void computePointLightVolumes(const RenderTarget* target);
+
+	/**
+	 * Renders the light of the visible PointLight%s.
+	 * Shadowed and large lights are rendered one at a time using the stencil pass, restricted to
+	 * their screen rectangle. The others are rendered together drawing the back faces of their spheres.
+	 */
+	void pointLightPass(GLuint mark, DeferredLightShader& shaderWrapper, DeferredLightShader& batchShaderWrapper);
 
 	void directionalLightPass(GLuint mark, DeferredLightShader& shaderWrapper);
 
 	/** Performs shadow mapping */
 	void renderShadows();
 
-	void renderDirectionalLightShadows(const DirectionalLight* light, const Transform& lightTransform);
+	/** Fits the cascades of a DirectionalLight to the view frustum and renders them */
+	void renderDirectionalLightShadows(DirectionalLight* light, const Transform& lightTransform);
 
-	void renderPointLightShadows(const PointLight* light, const Transform& lightTransform);
+	/**
+	 * Assigns the tiles of the shadow atlas to the PointLight%s and renders their shadows.
+	 * Each face of the shadow cube is rendered only if it sees at least a caster.
+	 */
+	void renderPointLightShadows();
 
 	// private constructor, only the engine can create a render system
 	RenderSystem();
@@ -138,11 +206,29 @@ private:
 	void cleanUp();
 
 public:
-	/** Creates a new window */
-	void createWindow(std::uint32_t width, std::uint32_t height);
+	/**
+	 * Creates a new window.
+	 * @param width the width of the window
+	 * @param height the height of the window
+	 * @param headless if true the window is hidden, e.g. to render images with frameCapture
+	 */
+	void createWindow(std::uint32_t width, std::uint32_t height, bool headless = false);
 
     SDL_Window* getWindow() const { return mWindow; }
 
+	/**
+	 * Synchronizes the buffer swaps with the refresh of the screen.
+	 * It can be called before creating the window. See also FrameScheduler::maxFrameRate.
+	 * @param enabled true to wait for the vertical sync
+	 * @return false if the driver cannot change the swap interval
+	 */
+	bool setVSync(bool enabled);
+
+	/**
+	 * @return true if the buffer swaps wait for the vertical sync
+	 */
+	bool isVSyncEnabled() const;
+
 	/** Maximum number of lights */
 	static constexpr std::size_t MAX_LIGHT_NUMBER = 32;
 
@@ -159,6 +245,9 @@ public:
 
 	static constexpr std::uint32_t SHADOWMAP_UNIFORM_BLOCK_INDEX = 4;
 
+	/** The index of the uniform block with the values of the material being rendered */
+	static constexpr std::uint32_t MATERIAL_UNIFORM_BLOCK_INDEX = 5;
+
 	/** fbo used for deferred rendering */
 	DeferredRenderingFBO deferredRenderingFBO;
 
@@ -171,9 +260,39 @@ public:
 	/** settings for fog */
 	FogSettings fogSettings;
 
+	/** intermediate targets shared by rendering stages and effects */
+	RenderTargetPool renderTargetPool;
+
 	/** The effect manager handles post processing effects */
 	EffectManager effectManager;
 
+	/** culls the GameObject%s hidden by occluders when rendering the scene from the camera */
+	OcclusionCuller occlusionCuller;
+
+	/** saves the frames rendered to the screen, without the UI */
+	FrameCapture frameCapture;
+
+	/**
+	 * PointLight%s without shadows covering a smaller fraction of the screen than this
+	 * are rendered together with a single draw call instead of using a stencil pass each.
+	 * Set it to 0 to render every light with its own stencil pass.
+	 */
+	float pointLightBatchingCoverage = 0.05f;
+
+	/**
+	 * If true the depth of deferred and PBR meshes is rendered before filling the G-buffer,
+	 * so that their materials are computed only once per pixel.
+	 * It is worth it when the scene has much overdraw and expensive materials (see getGBufferOverdraw).
+	 */
+	bool depthPrePass = false;
+
+	/**
+	 * If true the meshes of the materials supported by the MultiDrawRenderer (see Material::getMultiDrawMaterial)
+	 * are drawn with a few glMultiDrawElementsIndirect calls instead of a draw call each.
+	 * It is worth it for scenes with many small meshes, whose draw calls limit the frame rate.
+	 */
+	bool multiDrawIndirect = false;
+
 	// Cannot copy this system, only the engine has an instance
 	RenderSystem(const RenderSystem& rs) = delete;
 	RenderSystem& operator=(const RenderSystem& rs) = delete;
@@ -213,6 +332,12 @@ public:
 	 */
 	int getRenderPhase() const;
 
+	/**
+	 * @return the average number of times each pixel of the G-buffer has been written in a recent frame,
+	 * 1 means that no material has been computed for hidden fragments
+	 */
+	float getGBufferOverdraw() const;
+
 	/**
 	 * Render the current scene.
 	 * @param renderTarget the target onto which the scene is rendered. if nullptr the screen is used.
@@ -220,6 +345,22 @@ public:
 	 */
 	void renderScene(const RenderTarget* target = nullptr, RenderPhase phase = RenderPhase::NONE);
 
+	/**
+	 * Renders the scene from a secondary point of view, e.g. water reflections and refractions.
+	 * This is much cheaper than renderScene: only the G-buffer of the deferred and PBR materials is filled,
+	 * lights are not computed, shadows are not rendered and the lights and camera ubos are not updated.
+	 * The GameObject%s outside the view frustum or behind the clip plane are culled.
+	 * @param gBuffer the G-buffer to render into
+	 * @param forwardTarget if not nullptr forward materials and particles are rendered into this target, its depth buffer
+	 * should be that of gBuffer
+	 * @param view the view matrix, it can be mirrored
+	 * @param clipPlane the clip plane equation or nullptr
+	 * @param detailCulling GameObject%s smaller than this fraction of their distance from the view are culled (0 to disable)
+	 * @param phase specifies which render phase to use
+	 */
+	void renderAuxiliaryView(const DeferredRenderingFBO& gBuffer, const RenderTarget* forwardTarget, const glm::mat4& view,
+		const glm::vec4* clipPlane, float detailCulling = 0.0f, RenderPhase phase = RenderPhase::NONE);
+
 	/** 
 	  * Renders all the GameObject%s to the currently bound RenderTarget.
 	  * renderScene() should always be preferred except for particular cases
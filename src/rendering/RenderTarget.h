@@ -25,6 +25,9 @@ private:
 public:
 	RenderTarget() = default;
 
+	/** the copy shares the FBO, which is deleted with its last copy */
+	RenderTarget(const RenderTarget&) = default;
+
 	/**
 	 * Creates a RenderTarget with a color and a depth buffer.
 	 * @param width the width of the textures
@@ -0,0 +1,63 @@
+#include "rendering/RenderTargetPool.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <iostream>
+
+RenderTarget RenderTargetPool::acquire(std::uint32_t width, std::uint32_t height, std::int32_t internalFormat)
+{
+	for (Entry& entry : mEntries) {
+		if (!entry.inUse && entry.internalFormat == internalFormat
+			&& entry.target.getWidth() == width && entry.target.getHeight() == height) {
+			entry.inUse = true;
+			entry.unusedFrames = 0;
+			return entry.target;
+		}
+	}
+
+	RenderTarget target;
+	target.createWith(
+		Texture::load(nullptr, width, height, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, false, GL_RGBA, GL_FLOAT, internalFormat),
+		Texture{}
+	);
+
+	Entry entry;
+	entry.target = target;
+	entry.internalFormat = internalFormat;
+	entry.inUse = true;
+	mEntries.push_back(entry);
+	return target;
+}
+
+void RenderTargetPool::release(const RenderTarget& target)
+{
+	auto it = std::find_if(mEntries.begin(), mEntries.end(), [&target](const Entry& entry) {
+		return entry.target.getFbo() == target.getFbo();
+	});
+
+	if (it == mEntries.end()) {
+		std::cerr << "Releasing a RenderTarget that does not belong to the pool\n";
+		return;
+	}
+
+	it->inUse = false;
+}
+
+std::size_t RenderTargetPool::getTargetsNumber() const
+{
+	return mEntries.size();
+}
+
+void RenderTargetPool::endFrame()
+{
+	for (Entry& entry : mEntries)
+		entry.unusedFrames++;
+
+	mEntries.erase(std::remove_if(mEntries.begin(), mEntries.end(), [](const Entry& entry) {
+		return !entry.inUse && entry.unusedFrames > MAX_UNUSED_FRAMES;
+	}), mEntries.end());
+}
+
+void RenderTargetPool::cleanUp()
+{
+	mEntries.clear();
+}
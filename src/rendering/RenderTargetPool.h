@@ -0,0 +1,69 @@
+#pragma once
+#include "rendering/RenderTarget.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * A pool of color RenderTarget%s shared by the rendering stages that need intermediate textures
+ * (e.g. post processing effects).
+ * Instead of allocating their own textures, users acquire a target with the required size and format
+ * and release it as soon as its content is no longer needed, so that following stages can reuse it.
+ * Textures of pooled targets use linear filtering and clamp to edge wrapping.
+ * Free targets that are not acquired for a few frames are deleted, e.g. the ones whose size
+ * no longer matches the screen after a resize.
+ */
+class RenderTargetPool
+{
+private:
+	/** frames a free target is kept without being acquired */
+	static constexpr std::uint32_t MAX_UNUSED_FRAMES = 4;
+
+	struct Entry {
+		RenderTarget target;
+		std::int32_t internalFormat = 0;
+		bool inUse = false;
+
+		/** frames ended since the target has been acquired for the last time */
+		std::uint32_t unusedFrames = 0;
+	};
+
+	std::vector<Entry> mEntries;
+
+public:
+	RenderTargetPool() = default;
+
+	RenderTargetPool(const RenderTargetPool&) = delete;
+	RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+	/**
+	 * Acquires a RenderTarget with a color buffer, a new one is created if no free target matches.
+	 * The content of the target is undefined.
+	 * @param width the width of the color buffer
+	 * @param height the height of the color buffer
+	 * @param internalFormat the internal format of the color buffer (e.g. GL_RGB16F)
+	 * @return the target, it must be given back with release
+	 */
+	RenderTarget acquire(std::uint32_t width, std::uint32_t height, std::int32_t internalFormat);
+
+	/**
+	 * Gives back a RenderTarget obtained with acquire.
+	 * @param target the target
+	 */
+	void release(const RenderTarget& target);
+
+	/**
+	 * @return the number of targets allocated by the pool
+	 */
+	std::size_t getTargetsNumber() const;
+
+	/**
+	 * Deletes the free targets not acquired during the last MAX_UNUSED_FRAMES frames.
+	 * Called by the RenderSystem at the end of every frame.
+	 */
+	void endFrame();
+
+	/**
+	 * Deletes all the targets.
+	 */
+	void cleanUp();
+};
@@ -0,0 +1,269 @@
+#include "rendering/capture/FrameCapture.h"
+#include "Engine.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+static constexpr std::uint32_t COLOR_BYTES_PER_PIXEL = 3;
+static constexpr std::uint32_t DEPTH_BYTES_PER_PIXEL = 2;
+
+static std::uint32_t crc32(const std::uint8_t* data, std::size_t size, std::uint32_t crc = 0)
+{
+	static const std::array<std::uint32_t, 256> table = []() {
+		std::array<std::uint32_t, 256> table;
+		for (std::uint32_t i = 0; i < 256; ++i) {
+			std::uint32_t c = i;
+			for (int k = 0; k < 8; ++k)
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			table[i] = c;
+		}
+		return table;
+	}();
+
+	crc = ~crc;
+	for (std::size_t i = 0; i < size; ++i)
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+static void appendBigEndian(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+	out.insert(out.end(), { std::uint8_t(value >> 24), std::uint8_t(value >> 16), std::uint8_t(value >> 8), std::uint8_t(value) });
+}
+
+static void writeChunk(std::ofstream& file, const char* type, const std::vector<std::uint8_t>& data)
+{
+	std::vector<std::uint8_t> chunk;
+	chunk.reserve(data.size() + 12);
+	appendBigEndian(chunk, static_cast<std::uint32_t>(data.size()));
+	chunk.insert(chunk.end(), type, type + 4);
+	chunk.insert(chunk.end(), data.begin(), data.end());
+	appendBigEndian(chunk, crc32(chunk.data() + 4, data.size() + 4));
+
+	file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+/*
+ * Writes a PNG image whose rows are stored bottom to top, as read by glReadPixels.
+ * Pixels are stored without compression: encoding is then as fast as copying, which keeps
+ * up with the render rate, at the price of larger files.
+ */
+static void writePng(const std::string& path, std::uint32_t width, std::uint32_t height, bool depth, const std::uint8_t* pixels)
+{
+	const std::uint32_t bytesPerPixel = depth ? DEPTH_BYTES_PER_PIXEL : COLOR_BYTES_PER_PIXEL;
+	const std::size_t rowSize = width * bytesPerPixel;
+
+	// each row starts with its filter type (0, none)
+	std::vector<std::uint8_t> raw;
+	raw.reserve((rowSize + 1) * height);
+	for (std::uint32_t y = height; y-- > 0;) {
+		const std::uint8_t* row = pixels + y * rowSize;
+		raw.push_back(0);
+		if (depth) {
+			// 16 bit samples are big endian
+			for (std::size_t i = 0; i < rowSize; i += 2)
+				raw.insert(raw.end(), { row[i + 1], row[i] });
+		}
+		else {
+			raw.insert(raw.end(), row, row + rowSize);
+		}
+	}
+
+	// zlib stream made of stored deflate blocks
+	constexpr std::size_t MAX_BLOCK = 0xFFFF;
+	std::vector<std::uint8_t> data{ 0x78, 0x01 };
+	data.reserve(raw.size() + raw.size() / MAX_BLOCK * 5 + 16);
+	std::uint32_t a = 1, b = 0;
+	for (std::size_t offset = 0; offset < raw.size() || offset == 0; offset += MAX_BLOCK) {
+		const std::size_t size = std::min(MAX_BLOCK, raw.size() - offset);
+		const bool last = offset + size == raw.size();
+		data.insert(data.end(), { std::uint8_t(last), std::uint8_t(size), std::uint8_t(size >> 8),
+			std::uint8_t(~size), std::uint8_t(~size >> 8) });
+		data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + size);
+
+		for (std::size_t i = offset; i < offset + size; ++i) {
+			a = (a + raw[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		if (last) break;
+	}
+	appendBigEndian(data, (b << 16) | a);
+
+	std::vector<std::uint8_t> header;
+	appendBigEndian(header, width);
+	appendBigEndian(header, height);
+	// bit depth, color type (gray or RGB), compression, filter and interlace methods
+	header.insert(header.end(), { std::uint8_t(depth ? 16 : 8), std::uint8_t(depth ? 0 : 2), 0, 0, 0 });
+
+	std::ofstream file{ path, std::ios::binary };
+	if (!file) {
+		std::cout << "Cannot write frame " << path << "\n";
+		return;
+	}
+
+	const char signature[] = { '\x89', 'P', 'N', 'G', '\r', '\n', '\x1A', '\n' };
+	file.write(signature, sizeof(signature));
+	writeChunk(file, "IHDR", header);
+	writeChunk(file, "IDAT", data);
+	writeChunk(file, "IEND", {});
+}
+
+// creates a pixel pack buffer of size bytes, or orphans it
+static void allocatePixelBuffer(std::uint32_t& pbo, GLsizeiptr size)
+{
+	if (pbo == 0)
+		glGenBuffers(1, &pbo);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+	glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+}
+
+// copies the content of a pixel pack buffer
+static std::shared_ptr<std::vector<std::uint8_t>> readPixelBuffer(std::uint32_t pbo, GLsizeiptr size)
+{
+	auto pixels = std::make_shared<std::vector<std::uint8_t>>(size);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+	const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+	if (mapped) {
+		std::copy_n(static_cast<const std::uint8_t*>(mapped), size, pixels->begin());
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	return pixels;
+}
+
+void FrameCapture::start(const std::string& pathPrefix, std::uint32_t frames, bool captureDepth)
+{
+	mPathPrefix = pathPrefix;
+	mRemainingFrames = frames;
+	mCaptureDepth = captureDepth;
+	mActive = true;
+}
+
+void FrameCapture::stop()
+{
+	mActive = false;
+}
+
+bool FrameCapture::isCapturing() const
+{
+	return mActive || std::any_of(std::begin(mReadbacks), std::end(mReadbacks), [](const Readback& readback) {
+		return readback.fence != nullptr;
+	});
+}
+
+bool FrameCapture::collect(Readback& readback, bool wait)
+{
+	if (readback.fence == nullptr)
+		return true;
+
+	const GLuint64 timeout = wait ? std::chrono::nanoseconds{ std::chrono::seconds{ 1 } }.count() : 0;
+	const GLenum status = glClientWaitSync(readback.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+	if (status == GL_TIMEOUT_EXPIRED && !wait)
+		return false;
+
+	glDeleteSync(readback.fence);
+	readback.fence = nullptr;
+
+	const GLsizeiptr pixels = static_cast<GLsizeiptr>(readback.width) * readback.height;
+	const std::string path = readback.path;
+	const std::uint32_t width = readback.width;
+	const std::uint32_t height = readback.height;
+
+	auto color = readPixelBuffer(readback.colorPbo, pixels * COLOR_BYTES_PER_PIXEL);
+	mEncodings.push_back(Engine::jobSystem.submit([path, width, height, color]() {
+		writePng(path + ".png", width, height, false, color->data());
+	}));
+
+	if (readback.hasDepth) {
+		auto depth = readPixelBuffer(readback.depthPbo, pixels * DEPTH_BYTES_PER_PIXEL);
+		mEncodings.push_back(Engine::jobSystem.submit([path, width, height, depth]() {
+			writePng(path + "_depth.png", width, height, true, depth->data());
+		}));
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	return true;
+}
+
+void FrameCapture::readFrame(std::uint32_t width, std::uint32_t height, std::uint32_t depthFbo)
+{
+	// frames are saved as soon as their pixels are ready, in the order they have been read
+	for (std::size_t i = 0; i < LATENCY; ++i) {
+		if (!collect(mReadbacks[(mNextReadback + i) % LATENCY], false))
+			break;
+	}
+
+	mEncodings.erase(std::remove_if(mEncodings.begin(), mEncodings.end(), [](const std::future<void>& encoding) {
+		return encoding.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}), mEncodings.end());
+
+	const std::uint64_t frame = mFrame++;
+	if (!mActive)
+		return;
+
+	// the GPU is more than LATENCY frames late, waits for the oldest frame
+	Readback& readback = mReadbacks[mNextReadback];
+	collect(readback, true);
+	mNextReadback = (mNextReadback + 1) % LATENCY;
+
+	const GLsizeiptr pixels = static_cast<GLsizeiptr>(width) * height;
+	if (pixels > readback.colorCapacity) {
+		readback.colorCapacity = pixels;
+		allocatePixelBuffer(readback.colorPbo, readback.colorCapacity * COLOR_BYTES_PER_PIXEL);
+	}
+	if (mCaptureDepth && pixels > readback.depthCapacity) {
+		readback.depthCapacity = pixels;
+		allocatePixelBuffer(readback.depthPbo, readback.depthCapacity * DEPTH_BYTES_PER_PIXEL);
+	}
+
+	// the prefix may change before the frame is collected
+	readback.path = mPathPrefix + std::to_string(frame);
+	readback.width = width;
+	readback.height = height;
+	readback.hasDepth = mCaptureDepth;
+
+	// rows of RGB and depth pixels are not aligned to 4 bytes
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.colorPbo);
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, (void*)0);
+
+	if (mCaptureDepth) {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, depthFbo);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.depthPbo);
+		glReadPixels(0, 0, width, height, GL_DEPTH_COMPONENT, GL_UNSIGNED_SHORT, (void*)0);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	if (mRemainingFrames > 0 && --mRemainingFrames == 0)
+		mActive = false;
+}
+
+void FrameCapture::flush()
+{
+	for (std::size_t i = 0; i < LATENCY; ++i)
+		collect(mReadbacks[(mNextReadback + i) % LATENCY], true);
+
+	for (std::future<void>& encoding : mEncodings)
+		Engine::jobSystem.wait(encoding);
+	mEncodings.clear();
+}
+
+void FrameCapture::cleanUp()
+{
+	mActive = false;
+	flush();
+
+	for (Readback& readback : mReadbacks) {
+		const std::uint32_t buffers[] = { readback.colorPbo, readback.depthPbo };
+		glDeleteBuffers(2, buffers);
+		readback = Readback{};
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+/**
+ * Saves the frames rendered by the RenderSystem as PNG files, e.g. to render thumbnails or
+ * regression images with a headless window (see RenderSystem::createWindow).
+ * Pixels are read into pixel buffer objects and mapped LATENCY frames later, when the GPU
+ * has written them, so capturing does not wait for the frame to be rendered.
+ * The images are encoded by the Engine::jobSystem.
+ */
+class FrameCapture
+{
+	friend class RenderSystem;
+
+public:
+	/** frames between the read of a frame and the copy of its pixels */
+	static constexpr std::size_t LATENCY = 3;
+
+private:
+	/** a frame being read by the GPU */
+	struct Readback {
+		std::uint32_t colorPbo = 0;
+		std::uint32_t depthPbo = 0;
+		GLsync fence = nullptr;
+
+		/** the path of the images, without extension */
+		std::string path;
+		std::uint32_t width = 0;
+		std::uint32_t height = 0;
+		bool hasDepth = false;
+
+		/** pixels each buffer can store, the depth buffer is only grown by captures with depth */
+		GLsizeiptr colorCapacity = 0;
+		GLsizeiptr depthCapacity = 0;
+	};
+
+	Readback mReadbacks[LATENCY];
+	std::size_t mNextReadback = 0;
+
+	std::string mPathPrefix;
+	bool mActive = false;
+
+	/** frames still to read, 0 to read until stop is called */
+	std::uint32_t mRemainingFrames = 0;
+	bool mCaptureDepth = false;
+	std::uint64_t mFrame = 0;
+
+	/** images being encoded */
+	std::vector<std::future<void>> mEncodings;
+
+	/**
+	 * Reads the current frame from the default framebuffer and saves the frames read before whose pixels are ready.
+	 * The RenderSystem calls it after post processing and before rendering the UI, while isCapturing is true.
+	 * @param depthFbo the framebuffer whose depth buffer is read
+	 */
+	void readFrame(std::uint32_t width, std::uint32_t height, std::uint32_t depthFbo);
+
+	/** copies the pixels of a read frame and submits their encoding, waiting for the GPU if wait is true */
+	bool collect(Readback& readback, bool wait);
+
+	void cleanUp();
+
+public:
+	FrameCapture() = default;
+
+	FrameCapture(const FrameCapture&) = delete;
+	FrameCapture& operator=(const FrameCapture&) = delete;
+
+	/**
+	 * Starts saving the rendered frames. Color images are saved as <pathPrefix><frame>.png
+	 * and depth images as 16 bit grayscale <pathPrefix><frame>_depth.png.
+	 * @param pathPrefix the path of the images without frame number and extension
+	 * @param frames the number of frames to capture, 0 to capture until stop is called
+	 * @param captureDepth if true the depth buffer is saved too
+	 */
+	void start(const std::string& pathPrefix, std::uint32_t frames = 1, bool captureDepth = false);
+
+	/**
+	 * Stops capturing. The frames already read are still saved.
+	 */
+	void stop();
+
+	/**
+	 * @return true if frames are being captured or saved
+	 */
+	bool isCapturing() const;
+
+	/**
+	 * Saves the frames already read and waits for their encoding.
+	 */
+	void flush();
+};
@@ -8,8 +8,11 @@ void DeferredLightShader::init(const std::vector<std::string>& vertexShaders,
 	shader = Shader::loadFromFile(vertexShaders, {}, fragmentShaders);
 
 	shader.use();
-	mLightIndexLocation = shader.getLocationOf("lightIndex");
+	mLightIndexLocation = shader.getLocationOf("lightIndex", false);
 	mLightRadiusLocation = shader.getLocationOf("lightRadius", false);
+	mShadowFaceRectsLocation = shader.getLocationOf("shadowFaceRects", false);
+	mLightIndicesLocation = shader.getLocationOf("lightIndices", false);
+	mLightRadiiLocation = shader.getLocationOf("lightRadii", false);
 
 	int pos = 0;
 	for (const auto& name : bufferNames)
@@ -29,6 +32,17 @@ void DeferredLightShader::setLightRadius(float radius) const
 	shader.setFloat(mLightRadiusLocation, radius);
 }
 
+void DeferredLightShader::setShadowFaceRects(const std::vector<glm::vec4>& rects) const
+{
+	shader.setVec4Array(mShadowFaceRectsLocation, rects);
+}
+
+void DeferredLightShader::setLightVolumes(const std::vector<int>& indices, const std::vector<float>& radii) const
+{
+	shader.setIntArray(mLightIndicesLocation, indices);
+	shader.setFloatArray(mLightRadiiLocation, radii);
+}
+
 void DeferredLightShader::cleanUp()
 {
 	shader = Shader();
@@ -3,6 +3,7 @@
 #include <vector>
 #include <map>
 #include <cstdint>
+#include <glm/glm.hpp>
 
 /**
  * A wrapper of the Shader class specialized in deferred rendering of Light%s.
@@ -12,6 +13,9 @@ class DeferredLightShader
 private:
 	std::int32_t mLightIndexLocation = 0;
 	std::int32_t mLightRadiusLocation = 0;
+	std::int32_t mShadowFaceRectsLocation = 0;
+	std::int32_t mLightIndicesLocation = 0;
+	std::int32_t mLightRadiiLocation = 0;
 
 public:
 	/** The shader used */
@@ -34,6 +38,21 @@ public:
 	 */
 	void setLightRadius(float radius) const;
 
+	/**
+	 * Sets the regions of the shadow atlas containing the faces of the shadow cube of a PointLight.
+	 * It has no effect on DirectionalLight%s.
+	 * @param rects offset (xy) and size (zw) of each face in normalized atlas coordinates
+	 */
+	void setShadowFaceRects(const std::vector<glm::vec4>& rects) const;
+
+	/**
+	 * Sets the PointLight%s drawn by an instanced draw call, one for each instance.
+	 * It has an effect only on the shaders drawing light volumes.
+	 * @param indices the indices of the lights in the array of all the lights
+	 * @param radii the radius of each light
+	 */
+	void setLightVolumes(const std::vector<int>& indices, const std::vector<float>& radii) const;
+
 	/** cleans up shader resources */
 	void cleanUp();
 };
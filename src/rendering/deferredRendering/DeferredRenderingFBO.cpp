@@ -6,23 +6,21 @@ void DeferredRenderingFBO::init(std::uint32_t width, std::uint32_t height)
 	mWidth = width;
 	mHeight = height;
 
-	mDiffuseBuffer		= Texture::load(nullptr, width, height, GL_REPEAT, GL_REPEAT, false, GL_RGBA, GL_FLOAT, GL_RGBA16F);
-	mAdditionalBuffer	= Texture::load(nullptr, width, height, GL_REPEAT, GL_REPEAT, false, GL_RGBA, GL_FLOAT, GL_RGBA16F);
-	mPositionBuffer		= Texture::load(nullptr, width, height, GL_REPEAT, GL_REPEAT, false, GL_RGB, GL_FLOAT, GL_RGB16F);
-	mNormalBuffer		= Texture::load(nullptr, width, height, GL_REPEAT, GL_REPEAT, false, GL_RGB, GL_FLOAT, GL_RGB16F);
-	mDepthBuffer		= Texture::load(nullptr, width, height, GL_REPEAT, GL_REPEAT, false, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, GL_DEPTH24_STENCIL8);
+	mDiffuseBuffer		= Texture::load(nullptr, width, height, GL_REPEAT, GL_REPEAT, false, GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA8);
+	mAdditionalBuffer	= Texture::load(nullptr, width, height, GL_REPEAT, GL_REPEAT, false, GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA8);
+	mNormalBuffer		= Texture::load(nullptr, width, height, GL_REPEAT, GL_REPEAT, false, GL_RG, GL_UNSIGNED_SHORT, GL_RG16, GL_NEAREST, GL_NEAREST);
+	mDepthBuffer		= Texture::load(nullptr, width, height, GL_REPEAT, GL_REPEAT, false, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, GL_DEPTH24_STENCIL8, GL_NEAREST, GL_NEAREST);
 
 	glGenFramebuffers(1, &mFbo);
 	glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
 
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mDiffuseBuffer.getId(), 0);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, mAdditionalBuffer.getId(), 0);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, mPositionBuffer.getId(), 0);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, mNormalBuffer.getId(), 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, mNormalBuffer.getId(), 0);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, mDepthBuffer.getId(), 0);
 
-	unsigned int attachments[]{ GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
-	glDrawBuffers(4, attachments);
+	unsigned int attachments[]{ GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glDrawBuffers(3, attachments);
 
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 		std::cout << "Deferred rendering buffer is incomplete\n";
@@ -52,11 +50,6 @@ const Texture& DeferredRenderingFBO::getAdditionalBuffer() const
 	return mAdditionalBuffer;
 }
 
-const Texture& DeferredRenderingFBO::getPositionBuffer() const
-{
-	return mPositionBuffer;
-}
-
 const Texture& DeferredRenderingFBO::getNormalBuffer() const
 {
 	return mNormalBuffer;
@@ -86,7 +79,6 @@ DeferredRenderingFBO& DeferredRenderingFBO::operator=(const DeferredRenderingFBO
 	mFbo = rhs.mFbo;
 	mDiffuseBuffer = rhs.mDiffuseBuffer;
 	mAdditionalBuffer = rhs.mAdditionalBuffer;
-	mPositionBuffer = rhs.mPositionBuffer;
 	mNormalBuffer = rhs.mNormalBuffer;
 	mDepthBuffer = rhs.mDepthBuffer;
 
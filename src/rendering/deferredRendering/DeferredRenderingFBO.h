@@ -6,14 +6,16 @@
 /**
  * Manages the deferred rendering FBO and the Texture%s used
  * as render targets.
+ * The layout is compact to save bandwidth: colors are stored in 8 bits per channel,
+ * normals with an octahedral encoding in two 16 bits channels and positions are not stored
+ * since they can be reconstructed from the depth buffer (see shaders/GBuffer.glsl).
  */
 class DeferredRenderingFBO
 {
 private:
-	std::uint32_t mFbo;
+	std::uint32_t mFbo = 0;
 	Texture mDiffuseBuffer;
 	Texture mAdditionalBuffer;
-	Texture mPositionBuffer;
 	Texture mNormalBuffer;
 	Texture mDepthBuffer;
 
@@ -61,17 +63,12 @@ public:
 	const Texture& getAdditionalBuffer() const;
 
 	/**
-	 * @return the buffer containing world space positions
-	 */
-	const Texture& getPositionBuffer() const;
-
-	/**
-	 * @return the buffer containing world space normals
+	 * @return the buffer containing octahedral encoded world space normals
 	 */
 	const Texture& getNormalBuffer() const;
 
 	/**
-	 * @return the depth buffer
+	 * @return the depth buffer, also used to reconstruct world space positions
 	 */
 	const Texture& getDepthBuffer() const;
 
@@ -1,20 +1,54 @@
 #include "rendering/effects/Bloom.h"
 #include "Engine.h"
+#include "rendering/GLStateCache.h"
+#include <vector>
 
-Bloom::Bloom(float scaleFactor) : Effect{ "bloom", "effects/bloom.glsl" }, mGaussianBlur{ scaleFactor }
+Bloom::Bloom(float scaleFactor, std::uint32_t levels) : Effect{ "bloom", "effects/bloom.glsl" },
+	mScaleFactor{ scaleFactor }, mLevels{ std::max(1u, levels) }
 {
-	mBloom = Texture::load(nullptr, Engine::renderSys.getScreenWidth(), Engine::renderSys.getScreenHeight(), GL_REPEAT, GL_REPEAT, false, GL_RGBA, GL_FLOAT, GL_RGB16F);
+	mDownsampleShader = Shader::loadFromFile(std::vector<std::string>{ "effects/bloomExtractVS.glsl" }, {}, { "effects/bloomDownsampleFS.glsl" });
+	mUpsampleShader = Shader::loadFromFile(std::vector<std::string>{ "effects/bloomExtractVS.glsl" }, {}, { "effects/bloomUpsampleFS.glsl" });
+}
 
-	mTarget.createWith(mBloom, Texture{});
+void Bloom::declarePasses(PostProcessingGraph& graph)
+{
+	using Graph = PostProcessingGraph;
+	RenderSystem& rsys = Engine::renderSys;
 
-	mBloomExtractor = Shader::loadFromFile(std::vector<std::string>{ "effects/bloomExtractVS.glsl" }, {}, { "effects/bloomExtractFS.glsl" });
+	std::vector<Graph::ResourceId> chain;
+	float scale = mScaleFactor;
+	while (chain.size() < mLevels && rsys.getScreenWidth() * scale >= 2.0f && rsys.getScreenHeight() * scale >= 2.0f) {
+		chain.push_back(graph.createTexture(scale, GL_RGB16F));
+		scale /= 2.0f;
+	}
 
-	mBlurredTexture = Engine::renderSys.effectManager.getTexture();
-}
+	if (chain.empty()) return;
 
-void Bloom::onSetup(Shader& postProcessingShader)
-{
-	postProcessingShader.setInt("bloomTexture", mBlurredTexture);
+	// the first downsample extracts the bright parts of the image
+	graph.addPass("bloomExtract", { Graph::SCENE_COLOR }, chain[0], [this](const Graph::PassContext& context) {
+		mDownsampleShader.use();
+		mDownsampleShader.setInt("firstPass", 1);
+		context.draw(mDownsampleShader);
+		mDownsampleShader.use();
+		mDownsampleShader.setInt("firstPass", 0);
+	});
+
+	for (std::size_t i = 1; i < chain.size(); ++i)
+		graph.addPass("bloomDownsample", { chain[i - 1] }, chain[i], [this](const Graph::PassContext& context) {
+			context.draw(mDownsampleShader);
+		});
+
+	// each level is added to the previous one
+	for (std::size_t i = chain.size() - 1; i > 0; --i)
+		graph.addPass("bloomUpsample", { chain[i] }, chain[i - 1], [this](const Graph::PassContext& context) {
+			GLStateCache::enable(GL_BLEND);
+			GLStateCache::blendFunc(GL_ONE, GL_ONE);
+			context.draw(mUpsampleShader);
+			GLStateCache::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			GLStateCache::disable(GL_BLEND);
+		});
+
+	graph.readInFinalPass(chain[0], "bloomTexture");
 }
 
 void Bloom::update(Shader& postProcessingShader)
@@ -24,14 +58,6 @@ void Bloom::update(Shader& postProcessingShader)
 		postProcessingShader.setFloat("_bloom_bloomFactor", mBloomFactor);
 		mNeedsUpdate = false;
 	}
-	RenderSystem& rsys = Engine::renderSys;
-
- 	Engine::renderSys.copyTexture(rsys.effectTarget.getColorBuffer(), mTarget, mBloomExtractor);
-	
-	const auto& blurred = mGaussianBlur.getBlurred(mBloom, 1);
-
-	glActiveTexture(GL_TEXTURE0 + mBlurredTexture);
-	glBindTexture(GL_TEXTURE_2D, blurred.getId());
 }
 
 void Bloom::setBloomFactor(float bloomFactor)
@@ -44,9 +70,3 @@ float Bloom::getBloomFactor() const
 {
 	return mBloomFactor;
 }
-
-Bloom::~Bloom()
-{
-	mBloomExtractor = Shader{};
-	Engine::renderSys.effectManager.releaseTexture(mBlurredTexture);
-}
\ No newline at end of file
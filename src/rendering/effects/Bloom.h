@@ -1,22 +1,24 @@
 #pragma once
 #include "rendering/effects/Effect.h"
 #include "rendering/materials/Texture.h"
-#include "rendering/RenderTarget.h"
-#include "rendering/effects/GaussianBlur.h"
+#include <cstdint>
 
 /**
  * Bloom effect.
  * Areas directly hit by light will look brighter.
+ * The bright parts of the image are progressively downsampled along a chain of half resolution
+ * targets (13 taps filter) and then upsampled back adding each level to the previous one (3x3 tent filter).
+ * The levels of the chain are transient textures of the PostProcessingGraph.
  */
 class Bloom :
 	public Effect
 {
 private:
-	Shader mBloomExtractor;
-	RenderTarget mTarget;
-	Texture mBloom;
-	GaussianBlur mGaussianBlur;
-	int mBlurredTexture = -1;
+	Shader mDownsampleShader;
+	Shader mUpsampleShader;
+
+	float mScaleFactor = 0.5f;
+	std::uint32_t mLevels = 6;
 
 	bool mNeedsUpdate = false;
 	float mBloomFactor = 0.7f;
@@ -24,18 +26,16 @@ private:
 public:
 	/**
 	 * Creates a new bloom effect.
-	 * The scaling factor controls the resolution of the blurring stage (performed to create bloom).
-	 * A value of 1 means that the blurring stage will use a texture that has
-	 * the same resolution as the current window. This will result in a very precise
-	 * bloom effect but the overall bloom won't be very noticeable.
-	 * A lower value (say 0.75f) will create a bloom effect that may have some flickering
-	 * but it will be more noticeable and faster.
+	 * The scaling factor controls the resolution of the first level of the downsampling chain.
+	 * A value of 1 means that the first level has the same resolution as the current window.
+	 * Each level has half the resolution of the previous one, more levels create a wider glow.
 	 * To reduce or amplify the effect of bloom setBloomFactor can also be used.
-	 * @param scaleFactor the scale of the blurring stage used for bloom.
+	 * @param scaleFactor the scale of the first level of the chain used for bloom.
+	 * @param levels the number of levels of the chain.
 	 */
-	Bloom(float scaleFactor = 0.7f);
+	Bloom(float scaleFactor = 0.5f, std::uint32_t levels = 6);
 
-	virtual void onSetup(Shader& postProcessingShader) override;
+	virtual void declarePasses(PostProcessingGraph& graph) override;
 
 	virtual void update(Shader& postProcessingShader) override;
 
@@ -47,7 +47,4 @@ public:
 	void setBloomFactor(float bloomFactor);
 
 	float getBloomFactor() const;
-
-	~Bloom();
 };
-
@@ -15,3 +15,8 @@ const std::string& Effect::getName() const
 {
 	return mName;
 }
+
+bool Effect::isEnabled() const
+{
+	return mEnabled;
+}
@@ -1,12 +1,16 @@
 #pragma once
+#include "rendering/effects/PostProcessingGraph.h"
 #include "rendering/materials/Shader.h"
 #include <string>
 
 class Effect
 {
+	friend class EffectManager;
+
 private:
 	std::string mEffectPath;
 	std::string mName;
+	bool mEnabled = true;
 
 public:
 	/**
@@ -26,6 +30,19 @@ public:
 	 */
 	const std::string& getName() const;
 
+	/**
+	 * @return true if the effect is applied, see EffectManager::setEffectEnabled
+	 */
+	bool isEnabled() const;
+
+	/**
+	 * Called every time the passes of the effects are declared.
+	 * The textures created before the final post processing shader must be declared here
+	 * together with the passes rendering them, instead of being owned by the effect.
+	 * @param graph the graph of the post processing passes
+	 */
+	virtual void declarePasses(PostProcessingGraph& graph) {}
+
 	/**
 	 * Called every time the effect needs to be set up.
 	 */
@@ -4,8 +4,13 @@
 
 void EffectManager::createShader(std::vector<std::shared_ptr<Effect>> effects)
 {
+	// disabled effects still declare their passes so that the graph culls them
+	std::vector<std::shared_ptr<Effect>> allEffects = effects;
+	effects.erase(std::remove_if(effects.begin(), effects.end(), [](const auto& effect) { return !effect->isEnabled(); }), effects.end());
+
 	std::vector<std::string> shaderPaths;
 	shaderPaths.push_back("effects/__postProcessingDeclFS.glsl");
+	shaderPaths.push_back("shaders/GBuffer.glsl");
 	std::transform(effects.begin(), effects.end(), std::back_inserter(shaderPaths), [](auto& elem) { return elem->getEffectPath(); });
 	shaderPaths.push_back("effects/__postProcessingMainFS.glsl");
 
@@ -32,13 +37,21 @@ void EffectManager::createShader(std::vector<std::shared_ptr<Effect>> effects)
 	mPostProcessingShader.setInt(mPostProcessingShader.getLocationOf("screenTexture", false), 0);
 	mPostProcessingShader.setInt(mPostProcessingShader.getLocationOf("depthTexture", false), 1);
 
+	mGraph.clear();
+	for (auto& effect : allEffects) {
+		mGraph.mDeclaringEnabledEffect = effect->isEnabled();
+		effect->declarePasses(mGraph);
+	}
+	mGraph.mDeclaringEnabledEffect = true;
+	mGraph.compile(mPostProcessingShader);
+
 	// call set up phase
+	mPostProcessingShader.use();
 	for (auto& effect : effects)
 		effect->onSetup(mPostProcessingShader);
 }
 
 EffectManager::EffectManager()
-	: mInUseTextures{0, 1} // these textures are always in use for the effects
 {
 
 }
@@ -67,25 +80,24 @@ void EffectManager::disableEffects()
 	createShader({ });
 }
 
-int EffectManager::getTexture()
+void EffectManager::setEffectEnabled(const std::shared_ptr<Effect>& effect, bool enabled)
 {
-	int texture = -1;
-	for (int i = 0; i < 15; ++i) {
-		if (mInUseTextures.find(i) == mInUseTextures.end()) {
-			texture = i;
-			break;
-		}
-	}
-	
-	if (texture != -1)
-		mInUseTextures.insert(texture);
+	if (effect->mEnabled == enabled)
+		return;
 
-	return texture;
+	effect->mEnabled = enabled;
+	rebuild();
 }
 
-void EffectManager::releaseTexture(int texture)
+void EffectManager::rebuild()
 {
-	mInUseTextures.erase(texture);
+	if (mEnabled)
+		createShader(mEffects);
+}
+
+const PostProcessingGraph& EffectManager::getGraph() const
+{
+	return mGraph;
 }
 
 void EffectManager::update()
@@ -95,11 +107,21 @@ void EffectManager::update()
 
 	mPostProcessingShader.use();
 	for (auto& effect : mEffects)
-		effect->update(mPostProcessingShader);
+		if (effect->isEnabled())
+			effect->update(mPostProcessingShader);
+
+	mGraph.execute();
+	mGraph.bindFinalInputs();
+}
+
+void EffectManager::endFrame()
+{
+	mGraph.releaseFinalInputs();
 }
 
 void EffectManager::cleanUp()
 {
+	mGraph.clear();
 	mPostProcessingShader = Shader();
 	mEffects = {};
 }
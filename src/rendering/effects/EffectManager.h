@@ -1,11 +1,11 @@
 #pragma once
 #include "rendering/effects/Effect.h"
+#include "rendering/effects/PostProcessingGraph.h"
 #include "rendering/materials/Shader.h"
 #include <vector>
 #include <utility>
 #include <string.h>
 #include <memory.h>
-#include <set>
 
 class EffectManager
 {
@@ -16,12 +16,16 @@ private:
 
 	Shader mPostProcessingShader;
 
-	std::set<int> mInUseTextures;
+	PostProcessingGraph mGraph;
 
 	std::vector<std::shared_ptr<Effect>> mEffects;
 
+	/** creates the shader of the enabled effects and compiles the graph of the passes of all the effects */
 	void createShader(std::vector<std::shared_ptr<Effect>> effects);
 
+	/** gives back the textures sampled by the post processing shader, called after it has been drawn */
+	void endFrame();
+
 public:
 	EffectManager();
 
@@ -37,9 +41,23 @@ public:
 
 	void disableEffects();
 
-	int getTexture();
-
-	void releaseTexture(int texture);
+	/**
+	 * Enables or disables an effect.
+	 * A disabled effect is removed from the post processing shader and its passes are culled.
+	 * @param effect the effect, previously added
+	 * @param enabled whether the effect must be applied
+	 */
+	void setEffectEnabled(const std::shared_ptr<Effect>& effect, bool enabled);
+
+	/**
+	 * Declares again the passes of the effects, to be called when an effect changes its passes.
+	 */
+	void rebuild();
+
+	/**
+	 * @return the graph of the post processing passes
+	 */
+	const PostProcessingGraph& getGraph() const;
 
 	void update();
 
@@ -1,13 +1,9 @@
 #include "rendering/effects/GodRays.h"
 #include "Engine.h"
 
-GodRays::GodRays(float scaleFactor) : Effect{ "godRays", "effects/godRays.glsl" }
+GodRays::GodRays(float scaleFactor) : Effect{ "godRays", "effects/godRays.glsl" },
+	mScaleFactor{ scaleFactor }
 {
-	auto width = static_cast<std::uint32_t>(Engine::renderSys.getScreenWidth() * scaleFactor);
-	auto height = static_cast<std::uint32_t>(Engine::renderSys.getScreenHeight() * scaleFactor);
-
-	mOcclusionTarget.create(width, height, true, false);
-
 	mOcclusionCreator = Shader::loadFromFile(
 		std::vector<std::string>{"effects/godraysCreateVS.glsl"},
 		{},
@@ -17,8 +13,6 @@ GodRays::GodRays(float scaleFactor) : Effect{ "godRays", "effects/godRays.glsl"
 	mOcclusionCreator.use();
 	mLightScreenPosLocation = mOcclusionCreator.getLocationOf("lightScreenPos");
 	mRadiusLocation = mOcclusionCreator.getLocationOf("radius");
-
-	mBlurredTexture = Engine::renderSys.effectManager.getTexture();
 }
 
 void GodRays::setDensity(float density)
@@ -57,10 +51,21 @@ float GodRays::getWeight() const
 void GodRays::onSetup(Shader& postProcessingShader)
 {
 	postProcessingShader.use();
-	postProcessingShader.setInt("_gr_raysTexture", mBlurredTexture);
 	mLightScreenPosForRadialBlurLocation = postProcessingShader.getLocationOf("_gr_lightScreenPos");
 }
 
+void GodRays::declarePasses(PostProcessingGraph& graph)
+{
+	using Graph = PostProcessingGraph;
+
+	const Graph::ResourceId occlusion = graph.createTexture(mScaleFactor, GL_RGBA16F);
+	graph.addPass("godRaysOcclusion", { Graph::GBUFFER_DEPTH }, occlusion, [this](const Graph::PassContext& context) {
+		context.draw(mOcclusionCreator, true);
+	});
+
+	graph.readInFinalPass(occlusion, "_gr_raysTexture");
+}
+
 void GodRays::update(Shader& postProcessingShader)
 {
 	auto& rsys = Engine::renderSys;
@@ -81,12 +86,6 @@ void GodRays::update(Shader& postProcessingShader)
 	mOcclusionCreator.setVec3(mLightScreenPosLocation, projectedPos);
 	mOcclusionCreator.setFloat(mRadiusLocation, projectedRadius);
 
-	// create the radial blurred image
-	rsys.copyTexture(Engine::renderSys.deferredRenderingFBO.getDepthBuffer(), mOcclusionTarget,   mOcclusionCreator);
-
-	glActiveTexture(GL_TEXTURE0 + mBlurredTexture);
-	glBindTexture(GL_TEXTURE_2D, mOcclusionTarget.getColorBuffer().getId());
-
 	postProcessingShader.use();
 	postProcessingShader.setVec3(mLightScreenPosForRadialBlurLocation, projectedPos);
 	if (mNeedUpdate) {
@@ -97,8 +96,3 @@ void GodRays::update(Shader& postProcessingShader)
 		mNeedUpdate = false;
 	}
 }
-
-GodRays::~GodRays()
-{
-	Engine::renderSys.effectManager.releaseTexture(mBlurredTexture);
-}
\ No newline at end of file
@@ -1,7 +1,6 @@
 #pragma once
 #include "rendering/effects/Effect.h"
 #include "gameobject/GameObjectEH.h"
-#include "rendering/RenderTarget.h"
 #include "rendering/materials/Shader.h"
 
 #include "rendering/effects/GaussianBlur.h"
@@ -13,9 +12,7 @@ class GodRays :
 	public Effect
 {
 private:
-	RenderTarget mOcclusionTarget;
-
-	int mBlurredTexture;
+	float mScaleFactor;
 
 	Shader mOcclusionCreator;
 
@@ -83,8 +80,8 @@ public:
 
 	virtual void onSetup(Shader& postProcessingShader) override;
 
-	virtual void update(Shader& postProcessingShader) override;
+	virtual void declarePasses(PostProcessingGraph& graph) override;
 
-	virtual ~GodRays();
+	virtual void update(Shader& postProcessingShader) override;
 };
 
@@ -6,8 +6,6 @@ MotionBlur::MotionBlur()
 {
 	RenderSystem& rsys = Engine::renderSys;
 	mPrevProjViewMatrix = rsys.getProjectionMatrix() * rsys.getViewMatrix(rsys.getCamera()->transform);
-
-	mPositionTexture = Engine::renderSys.effectManager.getTexture();
 }
 
 void MotionBlur::setBlurFactor(float blurFactor)
@@ -20,7 +18,12 @@ void MotionBlur::onSetup(Shader& postProcessingShader)
 {
 	mPrevProjViewMatrixLocation = postProcessingShader.getLocationOf("_mb_prevProjView");
 	mCurrentProjViewMatrixLocation = postProcessingShader.getLocationOf("_mb_currProjView");
-	postProcessingShader.setInt("_mb_positionTexture", mPositionTexture);
+	mCurrentInverseProjViewMatrixLocation = postProcessingShader.getLocationOf("_mb_currInverseProjView");
+}
+
+void MotionBlur::declarePasses(PostProcessingGraph& graph)
+{
+	graph.readInFinalPass(PostProcessingGraph::GBUFFER_DEPTH, "_mb_depthTexture");
 }
 
 
@@ -38,13 +41,7 @@ void MotionBlur::update(Shader& postProcessingShader)
 	glm::mat4 currProjViewMat = rsys.getProjectionMatrix() * rsys.getViewMatrix(rsys.getCamera()->transform);
 	postProcessingShader.setMat4(mPrevProjViewMatrixLocation, mPrevProjViewMatrix);
 	postProcessingShader.setMat4(mCurrentProjViewMatrixLocation, currProjViewMat);
-	glActiveTexture(GL_TEXTURE0 + mPositionTexture);
-	glBindTexture(GL_TEXTURE_2D, Engine::renderSys.deferredRenderingFBO.getPositionBuffer().getId());
+	postProcessingShader.setMat4(mCurrentInverseProjViewMatrixLocation, glm::inverse(currProjViewMat));
 
 	mPrevProjViewMatrix = currProjViewMat;
 }
-
-MotionBlur::~MotionBlur()
-{
-	Engine::renderSys.effectManager.releaseTexture(mPositionTexture);
-}
\ No newline at end of file
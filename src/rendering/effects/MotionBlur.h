@@ -10,8 +10,7 @@ private:
 	glm::mat4 mPrevProjViewMatrix;
 	std::int32_t mPrevProjViewMatrixLocation = 0;
 	std::int32_t mCurrentProjViewMatrixLocation = 0;
-
-	int mPositionTexture = -1;
+	std::int32_t mCurrentInverseProjViewMatrixLocation = 0;
 
 	float mBlurFactor = 100.0f;
 	bool mBlurNeedsUpdate = false;
@@ -23,8 +22,8 @@ public:
 
 	virtual void onSetup(Shader& postProcessingShader) override;
 
-	virtual void update(Shader& postProcessingShader) override;
+	virtual void declarePasses(PostProcessingGraph& graph) override;
 
-	~MotionBlur();
+	virtual void update(Shader& postProcessingShader) override;
 };
 
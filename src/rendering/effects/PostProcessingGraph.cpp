@@ -0,0 +1,220 @@
+#include "rendering/effects/PostProcessingGraph.h"
+#include "Engine.h"
+#include "rendering/GLStateCache.h"
+#include <algorithm>
+#include <iostream>
+
+PostProcessingGraph::PassContext::PassContext(PostProcessingGraph& graph, std::size_t pass)
+	: mGraph{ graph }, mPass{ pass }
+{
+
+}
+
+const Texture& PostProcessingGraph::PassContext::getInput(std::size_t index) const
+{
+	return mGraph.getTexture(mGraph.mPasses[mPass].inputs[index]);
+}
+
+std::size_t PostProcessingGraph::PassContext::getInputsNumber() const
+{
+	return mGraph.mPasses[mPass].inputs.size();
+}
+
+RenderTarget& PostProcessingGraph::PassContext::getOutput() const
+{
+	return mGraph.getResource(mGraph.mPasses[mPass].output).target;
+}
+
+void PostProcessingGraph::PassContext::draw(const Shader& shader, bool clear) const
+{
+	const std::size_t inputs = getInputsNumber();
+
+	// the first input is bound by copyTexture
+	for (std::size_t i = 1; i < inputs; ++i) {
+		GLStateCache::activeTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+		GLStateCache::bindTexture(GL_TEXTURE_2D, getInput(i).getId());
+	}
+
+	Engine::renderSys.copyTexture(inputs > 0 ? getInput(0) : Texture{}, getOutput(), shader, clear);
+
+	for (std::size_t i = 1; i < inputs; ++i) {
+		GLStateCache::activeTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+	}
+	GLStateCache::activeTexture(GL_TEXTURE0);
+}
+
+bool PostProcessingGraph::isImported(ResourceId id) const
+{
+	return id < IMPORTED_RESOURCES;
+}
+
+PostProcessingGraph::Resource& PostProcessingGraph::getResource(ResourceId id)
+{
+	return mResources[id - IMPORTED_RESOURCES];
+}
+
+const Texture& PostProcessingGraph::getTexture(ResourceId id) const
+{
+	RenderSystem& rsys = Engine::renderSys;
+
+	switch (id) {
+	case SCENE_COLOR:
+		return rsys.effectTarget.getColorBuffer();
+	case SCENE_DEPTH:
+		return rsys.effectTarget.getDepthBuffer();
+	case GBUFFER_DEPTH:
+		return rsys.deferredRenderingFBO.getDepthBuffer();
+	case GBUFFER_NORMAL:
+		return rsys.deferredRenderingFBO.getNormalBuffer();
+	default:
+		return mResources[id - IMPORTED_RESOURCES].target.getColorBuffer();
+	}
+}
+
+PostProcessingGraph::ResourceId PostProcessingGraph::createTexture(float scale, std::int32_t internalFormat)
+{
+	Resource resource;
+	resource.scale = scale;
+	resource.internalFormat = internalFormat;
+	mResources.push_back(resource);
+	return IMPORTED_RESOURCES + static_cast<ResourceId>(mResources.size() - 1);
+}
+
+void PostProcessingGraph::addPass(const std::string& name, const std::vector<ResourceId>& inputs, ResourceId output, const Execute& execute)
+{
+	if (isImported(output)) {
+		std::cout << "Pass " << name << " cannot write a texture of the renderer\n";
+		return;
+	}
+
+	mPasses.push_back(Pass{ name, inputs, output, execute });
+}
+
+void PostProcessingGraph::readInFinalPass(ResourceId resource, const std::string& sampler)
+{
+	if (mDeclaringEnabledEffect)
+		mFinalInputs.push_back(FinalInput{ resource, sampler, -1 });
+}
+
+void PostProcessingGraph::compile(Shader& finalShader)
+{
+	std::vector<bool> needed(IMPORTED_RESOURCES + mResources.size(), false);
+	for (Resource& resource : mResources) {
+		resource.firstUse = NO_PASS;
+		resource.lastUse = NO_PASS;
+		resource.readInFinalPass = false;
+	}
+
+	finalShader.use();
+	std::int32_t unit = FIRST_FINAL_UNIT;
+	for (FinalInput& input : mFinalInputs) {
+		input.unit = unit++;
+		needed[input.resource] = true;
+		if (!isImported(input.resource))
+			getResource(input.resource).readInFinalPass = true;
+
+		/* Explicit use of getLocationOf to avoid uniform not found warnings */
+		finalShader.setInt(finalShader.getLocationOf(input.sampler, false), input.unit);
+	}
+
+	/* a pass is needed only if a needed pass (or the final shader) reads its output.
+	   Passes writing a texture are not assumed to overwrite it, so earlier writers are kept */
+	for (std::size_t i = mPasses.size(); i-- > 0;) {
+		Pass& pass = mPasses[i];
+		pass.culled = !needed[pass.output];
+		if (!pass.culled)
+			for (ResourceId input : pass.inputs)
+				needed[input] = true;
+	}
+
+	for (std::size_t i = 0; i < mPasses.size(); ++i) {
+		const Pass& pass = mPasses[i];
+		if (pass.culled) continue;
+
+		auto use = [this, i](ResourceId id) {
+			if (isImported(id)) return;
+			Resource& resource = getResource(id);
+			if (resource.firstUse == NO_PASS)
+				resource.firstUse = i;
+			resource.lastUse = i;
+		};
+
+		use(pass.output);
+		std::for_each(pass.inputs.begin(), pass.inputs.end(), use);
+	}
+}
+
+void PostProcessingGraph::execute()
+{
+	RenderSystem& rsys = Engine::renderSys;
+	RenderTargetPool& pool = rsys.renderTargetPool;
+
+	// passes enable blending only if they need it
+	const bool blend = GLStateCache::isEnabled(GL_BLEND);
+	GLStateCache::disable(GL_BLEND);
+
+	for (std::size_t i = 0; i < mPasses.size(); ++i) {
+		if (mPasses[i].culled) continue;
+
+		for (Resource& resource : mResources) {
+			if (resource.firstUse == i) {
+				const auto width = static_cast<std::uint32_t>(std::max(1.0f, rsys.getScreenWidth() * resource.scale));
+				const auto height = static_cast<std::uint32_t>(std::max(1.0f, rsys.getScreenHeight() * resource.scale));
+				resource.target = pool.acquire(width, height, resource.internalFormat);
+			}
+		}
+
+		mPasses[i].execute(PassContext{ *this, i });
+
+		for (Resource& resource : mResources) {
+			if (resource.lastUse == i && !resource.readInFinalPass) {
+				pool.release(resource.target);
+				resource.target = RenderTarget{};
+			}
+		}
+	}
+
+	if (blend)
+		GLStateCache::enable(GL_BLEND);
+}
+
+void PostProcessingGraph::bindFinalInputs()
+{
+	for (const FinalInput& input : mFinalInputs) {
+		GLStateCache::activeTexture(GL_TEXTURE0 + input.unit);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, getTexture(input.resource).getId());
+	}
+	GLStateCache::activeTexture(GL_TEXTURE0);
+}
+
+void PostProcessingGraph::releaseFinalInputs()
+{
+	for (const FinalInput& input : mFinalInputs) {
+		GLStateCache::activeTexture(GL_TEXTURE0 + input.unit);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+	}
+	GLStateCache::activeTexture(GL_TEXTURE0);
+
+	for (Resource& resource : mResources) {
+		if (resource.readInFinalPass && resource.target.isValid()) {
+			Engine::renderSys.renderTargetPool.release(resource.target);
+			resource.target = RenderTarget{};
+		}
+	}
+}
+
+void PostProcessingGraph::clear()
+{
+	releaseFinalInputs();
+
+	mResources.clear();
+	mPasses.clear();
+	mFinalInputs.clear();
+	mDeclaringEnabledEffect = true;
+}
+
+std::size_t PostProcessingGraph::getLivePassesNumber() const
+{
+	return std::count_if(mPasses.begin(), mPasses.end(), [](const Pass& pass) { return !pass.culled; });
+}
@@ -0,0 +1,185 @@
+#pragma once
+#include "rendering/RenderTarget.h"
+#include "rendering/materials/Shader.h"
+#include "rendering/materials/Texture.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * The passes rendered by the post processing Effect%s before the final post processing shader.
+ * Effects declare the textures they read and write instead of owning their targets:
+ * when the graph is compiled the passes whose output never reaches the final shader are culled,
+ * transient textures get a lifetime (from the first pass writing them to the last pass reading them)
+ * and the texture units sampled by the final shader are assigned.
+ * Transient textures are acquired from the RenderSystem's RenderTargetPool only for their lifetime,
+ * so the textures of different passes are shared and the memory used does not grow with the number of effects.
+ * The per pixel part of every effect is merged in the single final post processing shader.
+ */
+class PostProcessingGraph
+{
+	friend class EffectManager;
+
+public:
+	/** identifies a texture of the graph */
+	using ResourceId = std::uint32_t;
+
+	/** color buffer of the rendered scene */
+	static constexpr ResourceId SCENE_COLOR = 0;
+
+	/** depth buffer of the rendered scene */
+	static constexpr ResourceId SCENE_DEPTH = 1;
+
+	/** depth buffer of the deferred rendering fbo */
+	static constexpr ResourceId GBUFFER_DEPTH = 2;
+
+	/** normal buffer of the deferred rendering fbo */
+	static constexpr ResourceId GBUFFER_NORMAL = 3;
+
+	class PassContext;
+
+	/** renders a pass, called only if the pass has not been culled */
+	using Execute = std::function<void(const PassContext&)>;
+
+	/**
+	 * What a pass can access while it is executed.
+	 */
+	class PassContext
+	{
+		friend class PostProcessingGraph;
+
+	private:
+		PostProcessingGraph& mGraph;
+		std::size_t mPass;
+
+		PassContext(PostProcessingGraph& graph, std::size_t pass);
+
+	public:
+		/**
+		 * @param index the index of the input in the list given to addPass
+		 * @return the texture of an input
+		 */
+		const Texture& getInput(std::size_t index) const;
+
+		/**
+		 * @return the number of inputs of the pass
+		 */
+		std::size_t getInputsNumber() const;
+
+		/**
+		 * @return the target the pass renders to
+		 */
+		RenderTarget& getOutput() const;
+
+		/**
+		 * Renders a full screen quad on the output of the pass.
+		 * The inputs are bound to consecutive texture units in the order they were declared,
+		 * starting from 0, so the samplers of the shader must use the same order.
+		 * @param shader the shader to use
+		 * @param clear whether the output must be cleared before
+		 */
+		void draw(const Shader& shader, bool clear = false) const;
+	};
+
+private:
+	/** number of the resources produced by the renderer */
+	static constexpr ResourceId IMPORTED_RESOURCES = 4;
+
+	/** units 0 and 1 are used by the final shader for the screen and its depth */
+	static constexpr std::int32_t FIRST_FINAL_UNIT = 2;
+
+	static constexpr std::size_t NO_PASS = static_cast<std::size_t>(-1);
+
+	struct Resource {
+		/** size with respect to the screen */
+		float scale = 1.0f;
+		std::int32_t internalFormat = 0;
+
+		/** first and last live pass using the resource */
+		std::size_t firstUse = NO_PASS;
+		std::size_t lastUse = NO_PASS;
+		bool readInFinalPass = false;
+
+		RenderTarget target;
+	};
+
+	struct Pass {
+		std::string name;
+		std::vector<ResourceId> inputs;
+		ResourceId output;
+		Execute execute;
+		bool culled = false;
+	};
+
+	struct FinalInput {
+		ResourceId resource;
+		std::string sampler;
+		std::int32_t unit;
+	};
+
+	/** transient resources, the id of the i-th one is IMPORTED_RESOURCES + i */
+	std::vector<Resource> mResources;
+	std::vector<Pass> mPasses;
+	std::vector<FinalInput> mFinalInputs;
+
+	/** false while the effect declaring its passes is disabled, its final inputs are ignored */
+	bool mDeclaringEnabledEffect = true;
+
+	bool isImported(ResourceId id) const;
+
+	Resource& getResource(ResourceId id);
+
+	const Texture& getTexture(ResourceId id) const;
+
+	/** culls the passes, computes the lifetimes of the resources and assigns the units of the final inputs */
+	void compile(Shader& finalShader);
+
+	/** renders the passes that have not been culled */
+	void execute();
+
+	/** binds the final inputs to their units, the final shader can then be drawn */
+	void bindFinalInputs();
+
+	/** gives back to the pool the textures read by the final shader */
+	void releaseFinalInputs();
+
+	/** removes all the resources and passes */
+	void clear();
+
+public:
+	PostProcessingGraph() = default;
+
+	PostProcessingGraph(const PostProcessingGraph&) = delete;
+	PostProcessingGraph& operator=(const PostProcessingGraph&) = delete;
+
+	/**
+	 * Declares a transient texture, it exists only from the pass writing it first to the pass reading it last.
+	 * @param scale the size of the texture with respect to the screen
+	 * @param internalFormat the internal format of the texture (e.g. GL_RGB16F)
+	 * @return the id of the texture
+	 */
+	ResourceId createTexture(float scale, std::int32_t internalFormat);
+
+	/**
+	 * Declares a pass. Passes are executed in the order they are added.
+	 * A pass may read and write the same texture (e.g. to blend on it).
+	 * @param name the name of the pass, used for debugging
+	 * @param inputs the textures read by the pass
+	 * @param output the transient texture written by the pass
+	 * @param execute renders the pass
+	 */
+	void addPass(const std::string& name, const std::vector<ResourceId>& inputs, ResourceId output, const Execute& execute);
+
+	/**
+	 * Declares a texture sampled by the final post processing shader.
+	 * @param resource the texture
+	 * @param sampler the name of the sampler uniform in the final shader
+	 */
+	void readInFinalPass(ResourceId resource, const std::string& sampler);
+
+	/**
+	 * @return the number of passes that have not been culled
+	 */
+	std::size_t getLivePassesNumber() const;
+};
@@ -1,37 +1,50 @@
 #include "rendering/effects/SSAO.h"
 #include "Engine.h"
+#include "rendering/GLStateCache.h"
+#include <algorithm>
 
 
 
 SSAO::SSAO() 
 	: Effect{"ssao", "effects/ssao.glsl"}
 {
-	// texture for ssao as an effect
-	mSSAOTextureIndex = Engine::renderSys.effectManager.getTexture();
-	mNoiseTextureIndex = Engine::renderSys.effectManager.getTexture();
-	mNormalTextureIndex = Engine::renderSys.effectManager.getTexture();
-
-	mSSAOCreationTarget.createWith(
-		// only red component is used
-		Texture::load(nullptr, Engine::renderSys.getScreenWidth(), Engine::renderSys.getScreenHeight(), GL_REPEAT, GL_REPEAT, false, GL_RGBA, GL_FLOAT, GL_RED, GL_NEAREST, GL_NEAREST),
-		Texture{}
-	);
-
-
 	std::uniform_real_distribution<float> dist;
 	std::default_random_engine engine;
 
 	createSamples(dist, engine);
 	createNoiseTexture(dist, engine);
 
-	mSSAOCreationShader = Shader::loadFromFile({ "effects/ssaoCreateVS.glsl" }, std::vector<std::string>{}, { "effects/ssaoCreateFS.glsl" }, false);
+	// the units follow the order of the inputs of the passes, the noise comes after them
+	mSSAOCreationShader = Shader::loadFromFile({ "effects/ssaoCreateVS.glsl" }, std::vector<std::string>{}, { "shaders/GBuffer.glsl", "effects/ssaoCreateFS.glsl" }, false);
 
 	mSSAOCreationShader.use();
 	mSSAOCreationShader.bindUniformBlock("CommonMat", Engine::renderSys.COMMON_MAT_UNIFORM_BLOCK_INDEX);
 	mSSAOCreationShader.bindUniformBlock("Camera", Engine::renderSys.CAMERA_UNIFORM_BLOCK_INDEX);
 	mSSAOCreationShader.setVec3Array("samples", mSSAOSamples);
-	mSSAOCreationShader.setInt("NormalData", mNormalTextureIndex);
-	mSSAOCreationShader.setInt("noise", mNoiseTextureIndex);
+	mSSAOCreationShader.setInt("NormalData", 1);
+	mSSAOCreationShader.setInt("depth", 2);
+	mSSAOCreationShader.setInt("noise", 3);
+
+	mDownsampleShader = Shader::loadFromFile({ "effects/ssaoCreateVS.glsl" }, std::vector<std::string>{}, { "shaders/GBuffer.glsl", "effects/ssaoDownsampleFS.glsl" }, false);
+	mDownsampleShader.use();
+	mDownsampleShader.bindUniformBlock("CommonMat", Engine::renderSys.COMMON_MAT_UNIFORM_BLOCK_INDEX);
+	mDownsampleShader.bindUniformBlock("Camera", Engine::renderSys.CAMERA_UNIFORM_BLOCK_INDEX);
+
+	mHorizontalBlurShader = Shader::loadFromFile({ "effects/ssaoCreateVS.glsl" }, std::vector<std::string>{}, { "effects/ssaoBlurFS.glsl" }, false);
+	mHorizontalBlurShader.use();
+	mHorizontalBlurShader.setVec2("direction", glm::vec2{ 1.0f, 0.0f });
+	mHorizontalBlurShader.setInt("blurSize", mBlurSize);
+
+	mVerticalBlurShader = Shader::loadFromFile({ "effects/ssaoCreateVS.glsl" }, std::vector<std::string>{}, { "effects/ssaoBlurFS.glsl" }, false);
+	mVerticalBlurShader.use();
+	mVerticalBlurShader.setVec2("direction", glm::vec2{ 0.0f, 1.0f });
+	mVerticalBlurShader.setInt("blurSize", mBlurSize);
+
+	mUpsampleShader = Shader::loadFromFile({ "effects/ssaoCreateVS.glsl" }, std::vector<std::string>{}, { "shaders/GBuffer.glsl", "effects/ssaoUpsampleFS.glsl" }, false);
+	mUpsampleShader.use();
+	mUpsampleShader.bindUniformBlock("CommonMat", Engine::renderSys.COMMON_MAT_UNIFORM_BLOCK_INDEX);
+	mUpsampleShader.bindUniformBlock("Camera", Engine::renderSys.CAMERA_UNIFORM_BLOCK_INDEX);
+	mUpsampleShader.setInt("DepthData", 1);
 }
 
 void SSAO::createSamples(std::uniform_real_distribution<float>& dist, std::default_random_engine& engine)
@@ -80,9 +93,67 @@ void SSAO::createNoiseTexture(std::uniform_real_distribution<float>& dist, std::
 	mNoiseTexture = Texture::load(noiseData.data(), res, res, GL_REPEAT, GL_REPEAT, false, GL_RGB, GL_FLOAT, GL_RGB16F);
 }
 
-void SSAO::onSetup(Shader& postProcessingShader)
+void SSAO::declarePasses(PostProcessingGraph& graph)
 {
-	postProcessingShader.setInt("_ssao_texture", mSSAOTextureIndex);
+	using Graph = PostProcessingGraph;
+
+	// only the red component is used
+	const Graph::ResourceId occlusion = graph.createTexture(1.0f, GL_R8);
+	graph.readInFinalPass(occlusion, "_ssao_texture");
+
+	if (mResolution != Resolution::FULL) {
+		declareLowResPasses(graph, occlusion);
+		return;
+	}
+
+	graph.addPass("ssao", { Graph::GBUFFER_DEPTH, Graph::GBUFFER_NORMAL }, occlusion, [this](const Graph::PassContext& context) {
+		GLStateCache::activeTexture(GL_TEXTURE3);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, mNoiseTexture.getId());
+
+		context.draw(mSSAOCreationShader, true);
+
+		GLStateCache::activeTexture(GL_TEXTURE3);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+		GLStateCache::activeTexture(GL_TEXTURE0);
+	});
+}
+
+void SSAO::declareLowResPasses(PostProcessingGraph& graph, PostProcessingGraph::ResourceId occlusion)
+{
+	using Graph = PostProcessingGraph;
+	const float scale = 1.0f / static_cast<int>(mResolution);
+
+	// occlusion in the red component, depth in the green one so that blur and upsampling need a single texture
+	const Graph::ResourceId depth = graph.createTexture(scale, GL_R32F);
+	const Graph::ResourceId lowRes = graph.createTexture(scale, GL_RG32F);
+	const Graph::ResourceId lowResBlur = graph.createTexture(scale, GL_RG32F);
+
+	// linear depth at low resolution, all the samples read this small texture
+	graph.addPass("ssaoDownsample", { Graph::GBUFFER_DEPTH }, depth, [this](const Graph::PassContext& context) {
+		context.draw(mDownsampleShader);
+	});
+
+	graph.addPass("ssaoLowRes", { Graph::GBUFFER_DEPTH, Graph::GBUFFER_NORMAL, depth }, lowRes, [this](const Graph::PassContext& context) {
+		mSSAOCreationShader.use();
+		mSSAOCreationShader.setInt("lowResolution", 1);
+		context.draw(mSSAOCreationShader);
+		mSSAOCreationShader.use();
+		mSSAOCreationShader.setInt("lowResolution", 0);
+	});
+
+	// separable depth aware blur
+	graph.addPass("ssaoHorizontalBlur", { lowRes }, lowResBlur, [this](const Graph::PassContext& context) {
+		context.draw(mHorizontalBlurShader);
+	});
+
+	graph.addPass("ssaoVerticalBlur", { lowResBlur }, lowRes, [this](const Graph::PassContext& context) {
+		context.draw(mVerticalBlurShader);
+	});
+
+	// back to full resolution
+	graph.addPass("ssaoUpsample", { lowRes, Graph::GBUFFER_DEPTH }, occlusion, [this](const Graph::PassContext& context) {
+		context.draw(mUpsampleShader);
+	});
 }
 
 void SSAO::update(Shader& postProcessingShader)
@@ -91,28 +162,10 @@ void SSAO::update(Shader& postProcessingShader)
 		mNeedsUpdate = false;
 		postProcessingShader.use();
 		postProcessingShader.setFloat("_ssao_darkenFactor", mDarkenFactor);
-		postProcessingShader.setInt("_ssao_blurSize", mBlurSize);
-	}
 
-	RenderSystem& rsys = Engine::renderSys;
-
-	glActiveTexture(GL_TEXTURE0 + mNormalTextureIndex);
-	glBindTexture(GL_TEXTURE_2D, rsys.deferredRenderingFBO.getNormalBuffer().getId());
-
-	glActiveTexture(GL_TEXTURE0 + mNoiseTextureIndex);
-	glBindTexture(GL_TEXTURE_2D, mNoiseTexture.getId());
-
-	Engine::renderSys.copyTexture(rsys.deferredRenderingFBO.getPositionBuffer(), mSSAOCreationTarget, mSSAOCreationShader);
-
-	// unbind
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	glActiveTexture(GL_TEXTURE0 + mNormalTextureIndex);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	// bind the ssao texture
-	glActiveTexture(GL_TEXTURE0 + mSSAOTextureIndex);
-	glBindTexture(GL_TEXTURE_2D, mSSAOCreationTarget.getColorBuffer().getId());
+		// at low resolution the occlusion is blurred before upsampling
+		postProcessingShader.setInt("_ssao_blurSize", mResolution == Resolution::FULL ? mBlurSize : 0);
+	}
 }
 
 void SSAO::setKernelSize(int size)
@@ -156,6 +209,11 @@ void SSAO::setBlurSize(int size)
 {
 	mBlurSize = size;
 	mNeedsUpdate = true;
+
+	mHorizontalBlurShader.use();
+	mHorizontalBlurShader.setInt("blurSize", size);
+	mVerticalBlurShader.use();
+	mVerticalBlurShader.setInt("blurSize", size);
 }
 
 int SSAO::getBlurSize() const
@@ -163,9 +221,15 @@ int SSAO::getBlurSize() const
 	return mBlurSize;
 }
 
-SSAO::~SSAO()
+void SSAO::setResolution(Resolution resolution)
+{
+	mResolution = resolution;
+	mNeedsUpdate = true;
+
+	Engine::renderSys.effectManager.rebuild();
+}
+
+SSAO::Resolution SSAO::getResolution() const
 {
-	Engine::renderSys.effectManager.releaseTexture(mSSAOTextureIndex);
-	Engine::renderSys.effectManager.releaseTexture(mNoiseTextureIndex);
-	Engine::renderSys.effectManager.releaseTexture(mNormalTextureIndex);
+	return mResolution;
 }
@@ -1,7 +1,6 @@
 #pragma once
 #include "rendering/effects/Effect.h"
 #include "rendering/materials/Texture.h"
-#include "rendering/RenderTarget.h"
 #include "rendering/materials/Shader.h"
 #include <glm/glm.hpp>
 #include <vector>
@@ -9,23 +8,35 @@
 
 /**
  * Screen space ambient occlusion effect.
+ * At full resolution the occlusion is computed for every pixel and blurred by the post processing shader.
+ * At lower resolutions it is computed on a downsampled linear depth buffer with an interleaved rotation
+ * of the samples, blurred with a separable depth aware filter and upsampled preserving the edges.
  */
 class SSAO :
 	public Effect
 {
-private:
-	int mSSAOTextureIndex = -1;
-	int mNoiseTextureIndex = -1;
-	int mNormalTextureIndex = -1;
+public:
+	/** Resolution at which the occlusion is computed */
+	enum class Resolution {
+		FULL = 1,
+		HALF = 2,
+		QUARTER = 4
+	};
 
+private:
 	std::vector<glm::vec3> mSSAOSamples;
 
 	Texture mNoiseTexture;
 
-	RenderTarget mSSAOCreationTarget;
-
 	Shader mSSAOCreationShader;
 
+	Resolution mResolution = Resolution::FULL;
+
+	Shader mDownsampleShader;
+	Shader mHorizontalBlurShader;
+	Shader mVerticalBlurShader;
+	Shader mUpsampleShader;
+
 	bool mNeedsUpdate = false;
 	int mKernelSize = 12;
 	float mRadius = 2.5f;
@@ -36,10 +47,12 @@ private:
 
 	void createNoiseTexture(std::uniform_real_distribution<float>& dist, std::default_random_engine& engine);
 
+	void declareLowResPasses(PostProcessingGraph& graph, PostProcessingGraph::ResourceId occlusion);
+
 public:
 	SSAO();
 
-	virtual void onSetup(Shader& postProcessingShader) override;
+	virtual void declarePasses(PostProcessingGraph& graph) override;
 
 	virtual void update(Shader& postProcessingShader) override;
 
@@ -88,6 +101,7 @@ public:
 	 * Sets the blur size.
 	 * To achieve a more realistic result, a blur effect is applied to the ambient occlusion.
 	 * The size of the blur effect determines how blurry the occlusion will be.
+	 * At low resolution this is the radius, in low resolution pixels, of the depth aware blur.
 	 * @param size the size of the blur effect.
 	 */
 	void setBlurSize(int size);
@@ -97,6 +111,17 @@ public:
 	 */
 	int getBlurSize() const;
 
-	~SSAO();
+	/**
+	 * Sets the resolution at which the occlusion is computed.
+	 * Lower resolutions are much faster, especially on high resolution screens,
+	 * but thin details may lose their occlusion.
+	 * @param resolution the resolution
+	 */
+	void setResolution(Resolution resolution);
+
+	/**
+	 * @return the resolution at which the occlusion is computed
+	 */
+	Resolution getResolution() const;
 };
 
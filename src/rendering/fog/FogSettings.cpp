@@ -1,6 +1,7 @@
 #include "rendering/fog/FogSettings.h"
 #include <glad/glad.h>
 #include "rendering/RenderSystem.h"
+#include "rendering/GLStateCache.h"
 #include <glm/gtc/type_ptr.hpp>
 
 void FogSettings::setFogColor(const glm::vec3& fogColor)
@@ -39,7 +40,7 @@ void FogSettings::init()
 	glBindBuffer(GL_UNIFORM_BUFFER, mFogUbo);
 	// 32 bytes: a vec3 (16) and a vec2 (16)
 	glBufferData(GL_UNIFORM_BUFFER, 32, nullptr, GL_STATIC_DRAW);
-	glBindBufferBase(GL_UNIFORM_BUFFER, RenderSystem::FOG_UNIFORM_BLOCK_INDEX, mFogUbo);
+	GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, RenderSystem::FOG_UNIFORM_BLOCK_INDEX, mFogUbo);
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	updateUbo();
@@ -47,5 +48,5 @@ void FogSettings::init()
 
 FogSettings::~FogSettings()
 {
-	glDeleteBuffers(1, &mFogUbo);
+	GLStateCache::deleteBuffers(1, &mFogUbo);
 }
@@ -8,21 +8,21 @@ DirectionalLight::DirectionalLight(const GameObjectEH& go)
 
 }
 
-const RenderTarget& DirectionalLight::getShadowMapTarget() const
+const CascadedShadowMap& DirectionalLight::getShadowMap() const
 {
-	return mShadowMapTarget;
+	return mShadowMap;
 }
 
 void DirectionalLight::setCastShadowMode(Light::ShadowCasterMode mode)
 {
 	Light::setCastShadowMode(mode);
 
-	if (mode == Light::ShadowCasterMode::NO_SHADOWS)
+	if (mode == Light::ShadowCasterMode::NO_SHADOWS) {
+		mShadowMap.cleanUp();
 		return;
-
-	// destroys the old target if existed
-	mShadowMapTarget = RenderTarget{};
+	}
 
 	ShadowMappingSettings& settings = Engine::renderSys.shadowMappingSettings;
-	mShadowMapTarget.create(settings.mapWidth, settings.mapHeight, false, true);
+	bool cacheStaticShadows = mode == Light::ShadowCasterMode::STATIC || mode == Light::ShadowCasterMode::AUTO;
+	mShadowMap.create(settings.mapWidth, settings.mapHeight, settings.cascadesNumber, cacheStaticShadows);
 }
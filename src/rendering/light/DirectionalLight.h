@@ -1,20 +1,21 @@
 #pragma once
 #include "rendering/light/Light.h"
-#include "rendering/RenderTarget.h"
+#include "rendering/shadow/CascadedShadowMap.h"
 
 class DirectionalLight
 	: public Light
 {
+	friend class RenderSystem;
+
 private:
-	RenderTarget mShadowMapTarget;
+	CascadedShadowMap mShadowMap;
 
 public:
 	DirectionalLight(const GameObjectEH& go);
 
-	const RenderTarget& getShadowMapTarget() const;
+	const CascadedShadowMap& getShadowMap() const;
 
 	virtual void setCastShadowMode(Light::ShadowCasterMode mode) override;
 
 	virtual ~DirectionalLight() = default;
 };
-
@@ -1,6 +1,6 @@
 #include "rendering/light/PointLight.h"
-#include "rendering/materials/Texture.h"
 #include <algorithm>
+#include <cmath>
 
 PointLight::PointLight(const GameObjectEH& go)
 	: Light{ go, Light::Type::POINT }
@@ -24,22 +24,7 @@ void PointLight::setCastShadowMode(ShadowCasterMode mode)
 {
 	Light::setCastShadowMode(mode);
 
-	mPointShadowTarget = RenderTarget{};
-	
-	if (mode == ShadowCasterMode::NO_SHADOWS) return;
-
-	Texture cube = Texture::loadCubemap({ {"front", nullptr }, {"back", nullptr}, {"top", nullptr}, {"bottom", nullptr}, {"left", nullptr}, {"right", nullptr} },
-		1024, 1024,
-		GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE,
-		GL_DEPTH_STENCIL,
-		GL_UNSIGNED_INT_24_8,
-		GL_DEPTH24_STENCIL8
-	);
-
-	mPointShadowTarget.createWith(Texture{}, cube);
-}
-
-const RenderTarget& PointLight::getPointShadowTarget() const
-{
-	return mPointShadowTarget;
+	// tiles are assigned by the RenderSystem when shadows are rendered
+	mShadowTiles.fill(PointShadowAtlas::Tile{});
+	mStaticShadowsValid = false;
 }
@@ -1,23 +1,33 @@
 #pragma once
 #include "rendering/light/Light.h"
 #include "gameobject/GameObjectEH.h"
-#include "rendering/RenderTarget.h"
+#include "rendering/shadow/PointShadowAtlas.h"
+#include <array>
 
 class PointLight :
 	public Light
 {
+	friend class RenderSystem;
+
 private:
-	RenderTarget mPointShadowTarget;
+	/** tile of each face of the shadow cube in the shadow atlas, size 0 if the face is not rendered */
+	std::array<PointShadowAtlas::Tile, 6> mShadowTiles{};
+
+	/** whether the static shadows cached in the atlas are up to date */
+	bool mStaticShadowsValid = false;
 
 public:
+	/**
+	 * Scales the resolution of the shadows of this light.
+	 * Lights with higher importance get more texels of the shadow atlas.
+	 */
+	float shadowImportance = 1.0f;
+
 	PointLight(const GameObjectEH& go);
 
 	float getRadius() const;
 
 	virtual void setCastShadowMode(ShadowCasterMode mode) override;
 
-	const RenderTarget& getPointShadowTarget() const;
-
 	virtual ~PointLight() = default;
 };
-
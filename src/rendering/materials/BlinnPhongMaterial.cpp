@@ -1,6 +1,9 @@
 #include "rendering/materials/BlinnPhongMaterial.h"
 #include "Engine.h"
+#include "rendering/GLStateCache.h"
+#include "rendering/MultiDrawRenderer.h"
 #include <iostream>
+#include <cstring>
 #include <vector>
 #include <functional>
 #include <glm/gtx/hash.hpp>
@@ -16,32 +19,31 @@ std::vector<std::string> getVertexShaders(bool hasBumps, bool isAnimated, bool h
 }
 
 std::vector<std::string> getFragmentShaders(bool hasBumps, bool hasParallax) {
-	if (hasParallax) return { "shaders/parallaxPhongFS.glsl" };
-	if (hasBumps) return { "shaders/bumpedPhongFS.glsl" };
+	if (hasParallax) return { "shaders/GBuffer.glsl", "shaders/parallaxPhongFS.glsl" };
+	if (hasBumps) return { "shaders/GBuffer.glsl", "shaders/bumpedPhongFS.glsl" };
 
-	else return { "shaders/phongFS.glsl" };
+	else return { "shaders/GBuffer.glsl", "shaders/phongFS.glsl" };
 }
 
 BlinnPhongMaterial::BlinnPhongMaterial(bool hasBumps, bool isAnimated, bool hasParallax)
 	: Material{getVertexShaders(hasBumps, isAnimated, hasParallax),
 			   {},
                getFragmentShaders(hasBumps, hasParallax)},
-	 mHasBumps{hasBumps}, mHasParallax{hasParallax}
+	 mHasBumps{hasBumps}, mHasParallax{hasParallax}, mIsAnimated{isAnimated}
 {
 	unSupportedRenderPhases |= (RenderPhase::FORWARD_RENDERING | RenderPhase::PBR);
 
+	// animated vertices and parallax discarded fragments do not match the depth of the pre-pass
+	inDepthPrePass = !isAnimated && !hasParallax;
+
 	shader.use();
 
     shader.bindUniformBlock("CommonMat", RenderSystem::COMMON_MAT_UNIFORM_BLOCK_INDEX);
 	if (hasParallax) // parallax mapping needs the position of the camera
 		shader.bindUniformBlock("Camera", RenderSystem::CAMERA_UNIFORM_BLOCK_INDEX);
 
-	mDiffuseColorLocation		= shader.getLocationOf("material.diffuseColor");
-	mSpecularColorLocation		= shader.getLocationOf("material.specularColor");
-	mShininessLocation			= shader.getLocationOf("material.shininess");
-	mOpacityLocation			= shader.getLocationOf("material.opacity");
-	mUseDiffuseMapLocation		= shader.getLocationOf("material.useDiffuseMap");
-	mUseSpecularMapLocation		= shader.getLocationOf("material.useSpecularMap");
+	shader.bindUniformBlock("BlinnPhongMaterialData", RenderSystem::MATERIAL_UNIFORM_BLOCK_INDEX);
+
 	mBumpMapLocation			= shader.getLocationOf("material.bump", hasBumps); // only used when has bumps is true
 	mParallaxMapLocation		= shader.getLocationOf("material.parallax", hasParallax); // only used when has parallax is true
 	mBonesLocation				= shader.getLocationOf("bones", isAnimated); // only used when animations are available
@@ -51,6 +53,9 @@ void BlinnPhongMaterial::setDiffuseMap(const Texture& texture)
 {
     diffuseMap = texture;
 
+	// texels discarded by the alpha test would still write their depth in the pre-pass
+	inDepthPrePass = !mIsAnimated && !mHasParallax && !diffuseMap.hasAlpha();
+
     diffuseMap.nameInShader = "material.diffuse";
     shader.use();
     shader.setInt(diffuseMap.nameInShader, 0);
@@ -91,46 +96,54 @@ void BlinnPhongMaterial::use()
 {
     shader.use();
 
-    shader.setVec3(mDiffuseColorLocation, diffuseColor);
-    shader.setVec3(mSpecularColorLocation, specularColor);
-    shader.setFloat(mShininessLocation, shininess);
-
-    shader.setFloat(mOpacityLocation, opacity);
+	const UniformData data{
+		diffuseColor, diffuseMap ? 1 : 0,
+		specularColor, specularMap ? 1 : 0,
+		shininess, opacity, { 0.0f, 0.0f }
+	};
+
+	if (mUbo == 0) {
+		glGenBuffers(1, &mUbo);
+		glBindBuffer(GL_UNIFORM_BUFFER, mUbo);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(UniformData), &data, GL_DYNAMIC_DRAW);
+		GLStateCache::countCall();
+		mUploadedData = data;
+	} else if (std::memcmp(&data, &mUploadedData, sizeof(UniformData)) != 0) {
+		glBindBuffer(GL_UNIFORM_BUFFER, mUbo);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UniformData), &data);
+		GLStateCache::countCall();
+		mUploadedData = data;
+	}
+	GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, RenderSystem::MATERIAL_UNIFORM_BLOCK_INDEX, mUbo);
 
 	if (auto sac = skeletalAnimationController.lock()) {
 		sac->updateBones(mBonesLocation, shader);
 	}
 
-    if (diffuseMap) {
-        shader.setInt(mUseDiffuseMapLocation, 1);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diffuseMap.getId());
-    } else
-        shader.setInt(mUseDiffuseMapLocation, 0);
-
-    if (specularMap) {
-        shader.setInt(mUseSpecularMapLocation, 2);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, specularMap.getId());
-    } else
-        shader.setInt(mUseSpecularMapLocation, 0);
-
-	if (mHasBumps && bumpMap) {
-		shader.setInt(mBumpMapLocation, 2);
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, bumpMap.getId());
+	// every unit is bound, missing maps included, so that after() does not need to unbind them
+	// and consecutive materials with the same maps do not change the bindings
+    GLStateCache::activeTexture(GL_TEXTURE0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, diffuseMap.getId());
+
+    GLStateCache::activeTexture(GL_TEXTURE1);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, specularMap.getId());
+
+	if (mHasBumps) {
+		GLStateCache::activeTexture(GL_TEXTURE2);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, bumpMap.getId());
 	}
 
-	if (mHasParallax && parallaxMap) {
-		shader.setInt(mParallaxMapLocation, 3);
-		glActiveTexture(GL_TEXTURE3);
-		glBindTexture(GL_TEXTURE_2D, parallaxMap.getId());
+	if (mHasParallax) {
+		GLStateCache::activeTexture(GL_TEXTURE3);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, parallaxMap.getId());
 	}
 
+	GLStateCache::activeTexture(GL_TEXTURE0);
+
     // disable backface culling
     if (isTwoSided) {
-        glDepthMask(false);
-        glDisable(GL_CULL_FACE);
+        GLStateCache::depthMask(false);
+        GLStateCache::disable(GL_CULL_FACE);
     }
 }
 
@@ -138,22 +151,9 @@ void BlinnPhongMaterial::after()
 {
      // enable backface culling
     if (isTwoSided) {
-        glDepthMask(true);
-        glEnable(GL_CULL_FACE);
+        GLStateCache::depthMask(true);
+        GLStateCache::enable(GL_CULL_FACE);
     }
-
-    // unbind textures
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 bool BlinnPhongMaterial::needsOrderedRendering()
@@ -201,7 +201,17 @@ bool BlinnPhongMaterial::equalsTo(const Material* rhs) const
 		&& opacity == other->opacity;
 }
 
-BlinnPhongMaterial::~BlinnPhongMaterial()
+bool BlinnPhongMaterial::getMultiDrawMaterial(MultiDrawMaterial& material) const
 {
+	if (mHasBumps || mHasParallax || mIsAnimated || isTwoSided || opacity < 1.0f)
+		return false;
 
+	material = MultiDrawMaterial{ diffuseColor, specularColor, shininess, diffuseMap, specularMap };
+	return true;
+}
+
+BlinnPhongMaterial::~BlinnPhongMaterial()
+{
+	if (mUbo != 0)
+		GLStateCache::deleteBuffers(1, &mUbo);
 }
@@ -15,12 +15,23 @@
 class BlinnPhongMaterial : public Material
 {
 private:
-	std::int32_t mDiffuseColorLocation = -1;
-	std::int32_t mSpecularColorLocation = -1;
-	std::int32_t mShininessLocation = -1;
-	std::int32_t mOpacityLocation = -1;
-	std::int32_t mUseDiffuseMapLocation = -1;
-	std::int32_t mUseSpecularMapLocation = -1;
+	/** the BlinnPhongMaterialData uniform block, laid out as std140 */
+	struct UniformData {
+		glm::vec3 diffuseColor;
+		std::int32_t useDiffuseMap;
+		glm::vec3 specularColor;
+		std::int32_t useSpecularMap;
+		float shininess;
+		float opacity;
+		float padding[2];
+	};
+
+	/** uniform buffer with the values of this material, created when the material is used for the first time */
+	std::uint32_t mUbo = 0;
+
+	/** the content of mUbo, the buffer is updated only when a value changes */
+	UniformData mUploadedData{};
+
 	std::int32_t mBumpMapLocation = -1;
 	std::int32_t mParallaxMapLocation = -1;
 	std::int32_t mBonesLocation = -1;
@@ -32,10 +43,14 @@ private:
 
 	bool mHasBumps = false;
 	bool mHasParallax = false;
+	bool mIsAnimated = false;
 
 public:
     BlinnPhongMaterial(bool hasBumps = false, bool isAnimated = false, bool hasParallax = false);
 
+	BlinnPhongMaterial(const BlinnPhongMaterial&) = delete;
+	BlinnPhongMaterial& operator=(const BlinnPhongMaterial&) = delete;
+
 	/**
 	 * Sets the texture used for diffuse color.
 	 * @param texture the texture used for diffuse color
@@ -97,6 +112,9 @@ public:
 	virtual std::size_t hash() const override;
 
 	virtual bool equalsTo(const Material* rhs) const override;
+
+	/** only opaque, one sided materials without bump or parallax mapping and animations are supported */
+	virtual bool getMultiDrawMaterial(MultiDrawMaterial& material) const override;
 };
 
 using BlinnPhongMaterialPtr = std::shared_ptr<BlinnPhongMaterial>;
@@ -7,6 +7,8 @@
 #include <vector>
 #include <glm/common.hpp>
 
+struct MultiDrawMaterial;
+
 /**
   * A Material contains all the properties used to define the appareance of an object */
 class Material
@@ -27,6 +29,11 @@ public:
 	  * wont be rendered during that phase */
 	int unSupportedRenderPhases = RenderPhase::NONE;
 
+	/** Whether the meshes using this material are rendered in the depth pre-pass (see RenderSystem::depthPrePass).
+	  * The pre-pass renders only positions, so it must be false when the shader moves the vertices
+	  * (e.g. skeletal animation) or discards fragments (e.g. alpha tested textures) */
+	bool inDepthPrePass = true;
+
     /** the shader program used to render the mesh using this material */
     Shader shader;
 
@@ -104,6 +111,13 @@ public:
 	 */
 	virtual bool equalsTo(const Material* rhs) const;
 
+	/**
+	 * Describes this material for the MultiDrawRenderer, which draws the meshes of many materials at once.
+	 * @param material filled with the values of this material
+	 * @return false if the meshes of this material cannot be drawn by the MultiDrawRenderer
+	 */
+	virtual bool getMultiDrawMaterial(MultiDrawMaterial& material) const { return false; }
+
     virtual ~Material();
 };
 
@@ -1,9 +1,11 @@
 #include "rendering/materials/MultiTextureBlinnPhongMaterial.h"
 #include "rendering/RenderSystem.h"
+#include "rendering/GLStateCache.h"
 
 MultiTextureBlinnPhongMaterial::MultiTextureBlinnPhongMaterial() :
-	Material{"shaders/bumpedPhongVS.glsl",
-		     "shaders/multiTexturePhongFS.glsl" }
+	Material{ {"shaders/bumpedPhongVS.glsl"},
+		      {},
+		      std::vector<std::string>{ "shaders/GBuffer.glsl", "shaders/multiTexturePhongFS.glsl" } }
 {
 	unSupportedRenderPhases |= RenderPhase::FORWARD_RENDERING;
 
@@ -27,32 +29,32 @@ void MultiTextureBlinnPhongMaterial::use()
 {
 	shader.use();
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, baseTexture.getId());
+	GLStateCache::activeTexture(GL_TEXTURE0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, baseTexture.getId());
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, baseTextureBump.getId());
+	GLStateCache::activeTexture(GL_TEXTURE1);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, baseTextureBump.getId());
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, redTexture.getId());
+	GLStateCache::activeTexture(GL_TEXTURE2);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, redTexture.getId());
 
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, redTextureSpecular.getId());
+	GLStateCache::activeTexture(GL_TEXTURE3);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, redTextureSpecular.getId());
 
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, redTextureBump.getId());
+	GLStateCache::activeTexture(GL_TEXTURE4);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, redTextureBump.getId());
 
-	glActiveTexture(GL_TEXTURE5);
-	glBindTexture(GL_TEXTURE_2D, greenTexture.getId());
+	GLStateCache::activeTexture(GL_TEXTURE5);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, greenTexture.getId());
 
-	glActiveTexture(GL_TEXTURE6);
-	glBindTexture(GL_TEXTURE_2D, greenTextureSpecular.getId());
+	GLStateCache::activeTexture(GL_TEXTURE6);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, greenTextureSpecular.getId());
 
-	glActiveTexture(GL_TEXTURE7);
-	glBindTexture(GL_TEXTURE_2D, greenTextureBump.getId());
+	GLStateCache::activeTexture(GL_TEXTURE7);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, greenTextureBump.getId());
 
-	glActiveTexture(GL_TEXTURE8);
-	glBindTexture(GL_TEXTURE_2D, blendTexture.getId());
+	GLStateCache::activeTexture(GL_TEXTURE8);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, blendTexture.getId());
 
 	shader.setFloat(mRedShininessLocation, redShininess);
 	shader.setFloat(mGreenShininessLocation, greenShininess);
@@ -60,32 +62,32 @@ void MultiTextureBlinnPhongMaterial::use()
 
 void MultiTextureBlinnPhongMaterial::after()
 {
-	glActiveTexture(GL_TEXTURE8);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE8);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE7);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE7);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE6);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE6);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE5);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE5);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE4);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE3);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE2);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE1);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 std::size_t MultiTextureBlinnPhongMaterial::hash() const
@@ -1,9 +1,11 @@
 #include "rendering/materials/MultiTextureLambertMaterial.h"
 #include "rendering/RenderSystem.h"
+#include "rendering/GLStateCache.h"
 
 MultiTextureLambertMaterial::MultiTextureLambertMaterial(Texture base, Texture red, Texture green, Texture blue, Texture blend, float horizontalTiles, float verticalTiles)
-	: Material{ "shaders/phongVS.glsl",
-				"shaders/multiTextureLambertFS.glsl" },
+	: Material{ {"shaders/phongVS.glsl"},
+				{},
+				std::vector<std::string>{ "shaders/GBuffer.glsl", "shaders/multiTextureLambertFS.glsl" } },
 	baseTexture { base }, redTexture{ red }, greenTexture{ green }, blueTexture{ blue }, blendTexture{ blend }
 {
 	unSupportedRenderPhases |= RenderPhase::FORWARD_RENDERING;
@@ -22,20 +24,20 @@ MultiTextureLambertMaterial::MultiTextureLambertMaterial(Texture base, Texture r
 
 void MultiTextureLambertMaterial::use()
 {
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, baseTexture.getId());
+	GLStateCache::activeTexture(GL_TEXTURE0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, baseTexture.getId());
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, redTexture.getId());
+	GLStateCache::activeTexture(GL_TEXTURE1);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, redTexture.getId());
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, greenTexture.getId());
+	GLStateCache::activeTexture(GL_TEXTURE2);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, greenTexture.getId());
 
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, blueTexture.getId());
+	GLStateCache::activeTexture(GL_TEXTURE3);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, blueTexture.getId());
 
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, blendTexture.getId());
+	GLStateCache::activeTexture(GL_TEXTURE4);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, blendTexture.getId());
 
 	shader.use();
 }
@@ -43,20 +45,20 @@ void MultiTextureLambertMaterial::use()
 void MultiTextureLambertMaterial::after()
 {
 	return;
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE4);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE3);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE2);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE1);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 std::size_t MultiTextureLambertMaterial::hash() const
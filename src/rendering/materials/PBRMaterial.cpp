@@ -1,7 +1,8 @@
 #include "rendering/materials/PBRMaterial.h"
+#include "rendering/GLStateCache.h"
 
 PBRMaterial::PBRMaterial()
-	: Material{ {"shaders/bumpedPhongVS.glsl"}, {"shaders/pbrFS.glsl"} }
+	: Material{ {"shaders/bumpedPhongVS.glsl"}, {}, std::vector<std::string>{ "shaders/GBuffer.glsl", "shaders/pbrFS.glsl" } }
 {
 	unSupportedRenderPhases = (RenderPhase::FORWARD_RENDERING | RenderPhase::DEFERRED_RENDERING);
 
@@ -44,27 +45,27 @@ void PBRMaterial::use()
 {
 	shader.use();
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, mAlbedo.getId());
+	GLStateCache::activeTexture(GL_TEXTURE0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, mAlbedo.getId());
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, mNormal.getId());
+	GLStateCache::activeTexture(GL_TEXTURE1);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, mNormal.getId());
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, mRoughness.getId());
+	GLStateCache::activeTexture(GL_TEXTURE2);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, mRoughness.getId());
 
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, mMetalness.getId());
+	GLStateCache::activeTexture(GL_TEXTURE3);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, mMetalness.getId());
 
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, mAO.getId());
+	GLStateCache::activeTexture(GL_TEXTURE4);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, mAO.getId());
 }
 
 void PBRMaterial::after()
 {
 	for (int i = 4; i <= 0; --i) {
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GLStateCache::activeTexture(GL_TEXTURE0 + i);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 	}
 }
 
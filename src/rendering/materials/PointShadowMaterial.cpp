@@ -2,10 +2,10 @@
 #include "Engine.h"
 
 PointShadowMaterial::PointShadowMaterial()
-	: Material{"shaders/pointShadowVS.glsl", "shaders/pointShadowGS.glsl", "shaders/pointShadowFS.glsl"}
+	: Material{"shaders/pointShadowVS.glsl", "shaders/pointShadowFS.glsl"}
 {
 	shader.use();
-	mTransformLocation = shader.getLocationOf("transforms");
+	mTransformLocation = shader.getLocationOf("transform");
 	mFarPlaneLocation = shader.getLocationOf("farPlane");
 	mLightPositionLocation = shader.getLocationOf("lightPos");
 }
@@ -15,11 +15,15 @@ void PointShadowMaterial::use()
 	shader.use(); 
 }
 
-void PointShadowMaterial::setTransformations(const std::vector<glm::mat4>& transforms, float farPlane, const glm::vec3& lightPosition)
+void PointShadowMaterial::setLight(float farPlane, const glm::vec3& lightPosition)
 {
 	shader.use();
-	shader.setMat4Array(mTransformLocation, transforms);
 	shader.setFloat(mFarPlaneLocation, farPlane);
 	shader.setVec3(mLightPositionLocation, lightPosition);
 }
 
+void PointShadowMaterial::setFaceTransform(const glm::mat4& transform)
+{
+	shader.use();
+	shader.setMat4(mTransformLocation, transform);
+}
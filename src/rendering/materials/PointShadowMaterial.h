@@ -1,9 +1,12 @@
 #pragma once
 #include "rendering/materials/Material.h"
-#include <vector>
 #include <glm/glm.hpp>
 #include <cstdint>
 
+/**
+ * Material used to render a face of the shadow cube of a PointLight.
+ * Each face is rendered separately in its own tile of the PointShadowAtlas.
+ */
 class PointShadowMaterial :
 	public Material
 {
@@ -17,9 +20,19 @@ public:
 
 	virtual void use() override;
 
-	void setTransformations(const std::vector<glm::mat4>& transforms, float farPlane, const glm::vec3& lightPosition);
+	/**
+	 * Sets the light being rendered.
+	 * @param farPlane the radius of the light
+	 * @param lightPosition the position of the light
+	 */
+	void setLight(float farPlane, const glm::vec3& lightPosition);
+
+	/**
+	 * Sets the face being rendered.
+	 * @param transform the world to clip space transformation of the face
+	 */
+	void setFaceTransform(const glm::mat4& transform);
 
 	~PointShadowMaterial() = default;
 
 };
-
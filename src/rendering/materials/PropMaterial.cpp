@@ -1,5 +1,6 @@
 #include "rendering/materials/PropMaterial.h"
 #include "Engine.h"
+#include "rendering/GLStateCache.h"
 #include <glm/gtx/hash.hpp>
 
 PropMaterial::PropMaterial(bool wireframe, bool showNormals)
@@ -18,7 +19,7 @@ PropMaterial::PropMaterial(bool wireframe, bool showNormals)
 void PropMaterial::use()
 {
 	if (mWireframe) {
-		glDisable(GL_CULL_FACE);
+		GLStateCache::disable(GL_CULL_FACE);
 		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 	}
     shader.use();
@@ -28,7 +29,7 @@ void PropMaterial::use()
 void PropMaterial::after()
 {
 	if (mWireframe) {
-		glEnable(GL_CULL_FACE);
+		GLStateCache::enable(GL_CULL_FACE);
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 	}
 }
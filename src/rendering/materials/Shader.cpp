@@ -1,4 +1,5 @@
 #include "rendering/materials/Shader.h"
+#include "rendering/GLStateCache.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -67,6 +68,55 @@ Shader Shader::loadFromFile(const std::string & vertexPath, const std::string& g
 	return loadFromFile(std::vector<std::string>{ vertexPath }, std::vector<std::string>{ geometryPath }, std::vector<std::string>{ fragmentPath });
 }
 
+Shader Shader::loadTransformFeedbackFromFile(const std::vector<std::string>& vertexPaths,
+	const std::vector<std::string>& feedbackVaryings,
+	bool cache)
+{
+	std::stringstream cacheName;
+	cacheName << vertexPaths << feedbackVaryings;
+	std::string cacheKey = cacheName.str();
+
+	if (cache) {
+		auto cachedShader = mShaderCache.find(cacheKey);
+		if (cachedShader != mShaderCache.end()) {
+			return cachedShader->second;
+		}
+	}
+
+	std::uint32_t vertexShader = createShaderFromFiles(vertexPaths, GL_VERTEX_SHADER);
+
+	std::uint32_t program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+
+	// varyings must be specified before linking
+	std::vector<const char*> varyings;
+	std::transform(feedbackVaryings.begin(), feedbackVaryings.end(), std::back_inserter(varyings), [](const auto& name) { return name.c_str(); });
+	glTransformFeedbackVaryings(program, static_cast<GLsizei>(varyings.size()), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+
+	glLinkProgram(program);
+	glDeleteShader(vertexShader);
+
+	GLint success = 1;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		char infoLog[512];
+		glGetProgramInfoLog(program, 512, nullptr, infoLog);
+		std::cerr << "linking problem: " << vertexPaths << " " << feedbackVaryings << " :" << infoLog << "\n";
+		return Shader{};
+	}
+
+	Shader shader{ program };
+
+	if (cache) {
+		shader.refCount.onRemove = [cacheKey]() { Shader::mShaderCache.erase(cacheKey); };
+
+		mShaderCache[cacheKey] = shader;
+		mShaderCache[cacheKey].refCount.setWeak();
+	}
+
+	return shader;
+}
+
 Shader Shader::fromCode(const std::vector<std::string>& vertexCode, const std::vector<std::string>& geometryCode, const std::vector<std::string>& fragmentCode)
 {
 	GLint success = 1;
@@ -159,7 +209,7 @@ void Shader::writeDebugShaderToFile(const std::string& source)
 void Shader::cleanUpIfNeeded()
 {
 	if (refCount.shouldCleanUp() && mProgramId != 0)
-		glDeleteProgram(mProgramId);
+		GLStateCache::deleteProgram(mProgramId);
 }
 
 std::uint32_t Shader::createShaderFromFiles(const std::vector<std::string>& paths, GLenum type, bool addVersion)
@@ -233,11 +283,12 @@ void Shader::setFloat(const std::string& name, float value) const
 {
     std::int32_t location = getLocationOf(name);
     if (location != -1)
-        glUniform1f(location, value);
+        setFloat(location, value);
 }
 
 void Shader::setFloat(std::int32_t location, float value) const
 {
+	GLStateCache::countCall();
 	glUniform1f(location, value);
 }
 
@@ -254,11 +305,12 @@ void Shader::setInt(const std::string& name, int value) const
 {
     std::int32_t location = getLocationOf(name);
     if (location != -1)
-        glUniform1i(location, value);
+        setInt(location, value);
 }
 
 void Shader::setInt(std::int32_t location, int value) const
 {
+	GLStateCache::countCall();
 	glUniform1i(location, value);
 }
 
@@ -266,11 +318,12 @@ void Shader::setMat3(const std::string& name, const glm::mat3& value) const
 {
 	std::int32_t location = getLocationOf(name);
 	if (location != -1)
-		glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+		setMat3(location, value);
 }
 
 void Shader::setMat3(std::int32_t location, const glm::mat3& value) const
 {
+	GLStateCache::countCall();
 	glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
@@ -278,11 +331,12 @@ void Shader::setMat4(const std::string& name, const glm::mat4& value) const
 {
     std::int32_t location = getLocationOf(name);
     if (location != -1)
-        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+        setMat4(location, value);
 }
 
 void Shader::setMat4(std::int32_t location, const glm::mat4 & value) const
 {
+	GLStateCache::countCall();
 	glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
@@ -290,11 +344,12 @@ void Shader::setVec3(const std::string& name, const glm::vec3& value) const
 {
     std::int32_t location = getLocationOf(name);
     if (location != -1)
-        glUniform3fv(location, 1, glm::value_ptr(value));
+        setVec3(location, value);
 }
 
 void Shader::setVec3(std::int32_t location, const glm::vec3 & value) const
 {
+	GLStateCache::countCall();
 	glUniform3fv(location, 1, glm::value_ptr(value));
 }
 
@@ -302,11 +357,12 @@ void Shader::setVec2(const std::string & name, const glm::vec2 & value) const
 {
 	std::int32_t location = getLocationOf(name);
 	if (location != -1)
-		glUniform2fv(location, 1, glm::value_ptr(value));
+		setVec2(location, value);
 }
 
 void Shader::setVec2(std::int32_t location, const glm::vec2& value) const
 {
+	GLStateCache::countCall();
 	glUniform2fv(location, 1, glm::value_ptr(value));
 }
 
@@ -314,16 +370,18 @@ void Shader::setMat4Array(const std::string& name, const std::vector<glm::mat4>&
 {
 	std::int32_t location = getLocationOf(name);
 	if (location != -1)
-		glUniformMatrix4fv(location, array.size(), GL_FALSE, glm::value_ptr(*array.data()));
+		setMat4Array(location, array);
 }
 
 void Shader::setMat4Array(std::int32_t location, const std::vector<glm::mat4>& array) const
 {
+	GLStateCache::countCall();
 	glUniformMatrix4fv(location, array.size(), GL_FALSE, glm::value_ptr(*array.data()));
 }
 
 void Shader::setVec3Array(std::int32_t location, const std::vector<glm::vec3>& array) const
 {
+	GLStateCache::countCall();
 	glUniform3fv(location, array.size(), glm::value_ptr(*array.data()));
 }
 
@@ -331,13 +389,31 @@ void Shader::setVec3Array(const std::string& name, const std::vector<glm::vec3>&
 {
 	std::int32_t location = getLocationOf(name);
 	if (location != -1)
-		glUniform3fv(location, array.size(), glm::value_ptr(*array.data()));
+		setVec3Array(location, array);
+}
+
+void Shader::setVec4Array(std::int32_t location, const std::vector<glm::vec4>& array) const
+{
+	GLStateCache::countCall();
+	glUniform4fv(location, array.size(), glm::value_ptr(*array.data()));
+}
+
+void Shader::setIntArray(std::int32_t location, const std::vector<int>& array) const
+{
+	GLStateCache::countCall();
+	glUniform1iv(location, array.size(), array.data());
+}
+
+void Shader::setFloatArray(std::int32_t location, const std::vector<float>& array) const
+{
+	GLStateCache::countCall();
+	glUniform1fv(location, array.size(), array.data());
 }
 
 void Shader::use() const
 {
 	mInUse = mProgramId;
-    glUseProgram(mProgramId);
+    GLStateCache::useProgram(mProgramId);
 }
 
 bool Shader::isValid() const
@@ -41,6 +41,17 @@ public:
 
 	static Shader loadFromFile(const std::string& vertexPath, const std::string& geometryPath, const std::string& fragmentPath);
 
+	/**
+	 * Loads a vertex only program whose outputs are captured by transform feedback.
+	 * Outputs are written interleaved in the order specified by feedbackVaryings.
+	 * @param vertexPaths the files containing the code of the vertex shader
+	 * @param feedbackVaryings the names of the vertex shader outputs to capture
+	 * @param cache whether the program should be cached
+	 */
+	static Shader loadTransformFeedbackFromFile(const std::vector<std::string>& vertexPaths,
+		const std::vector<std::string>& feedbackVaryings,
+		bool cache = true);
+
 	static std::string sourceFromFile(const std::string& path);
 
 	static Shader fromCode(const std::vector<std::string>& vertexCode, const std::vector<std::string>& geometryCode, const std::vector<std::string>& fragmentCode);
@@ -83,6 +94,12 @@ public:
 
 	void setVec3Array(const std::string& name, const std::vector<glm::vec3>& array) const;
 
+	void setVec4Array(std::int32_t location, const std::vector<glm::vec4>& array) const;
+
+	void setIntArray(std::int32_t location, const std::vector<int>& array) const;
+
+	void setFloatArray(std::int32_t location, const std::vector<float>& array) const;
+
 	void bindUniformBlock(const std::string& name, std::uint32_t bindingPoint);
 
 	void use() const;
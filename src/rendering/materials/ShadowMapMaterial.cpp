@@ -1,7 +1,9 @@
 #include "rendering/materials/ShadowMapMaterial.h"
 #include "Engine.h" 
+#include "rendering/GLStateCache.h"
 
-ShadowMapMaterial::ShadowMapMaterial() : Material{"shaders/shadowMapVS.glsl", "shaders/shadowMapFS.glsl"}
+ShadowMapMaterial::ShadowMapMaterial(bool cullFaces)
+	: Material{"shaders/shadowMapVS.glsl", "shaders/shadowMapFS.glsl"}, mCullFaces{cullFaces}
 {
 	shader.bindUniformBlock("CommonMat", Engine::renderSys.COMMON_MAT_UNIFORM_BLOCK_INDEX);
 }
@@ -10,10 +12,12 @@ void ShadowMapMaterial::use()
 {
 	shader.use();
 
-	glDisable(GL_CULL_FACE);
+	if (!mCullFaces)
+		GLStateCache::disable(GL_CULL_FACE);
 }
 
 void ShadowMapMaterial::after()
 {
-	glEnable(GL_CULL_FACE);
+	if (!mCullFaces)
+		GLStateCache::enable(GL_CULL_FACE);
 }
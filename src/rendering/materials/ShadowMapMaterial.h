@@ -2,13 +2,20 @@
 #include "rendering/materials/Material.h"
 
 /**
- * Material used when rendering for Shadow Mapping
+ * Material used when rendering for Shadow Mapping, also used to only write depth in the depth pre-pass
  */
 class ShadowMapMaterial :
 	public Material
 {
+private:
+	bool mCullFaces;
+
 public:
-	ShadowMapMaterial();
+	/**
+	 * @param cullFaces false to render back faces too, as needed by shadow mapping.
+	 * True for the depth pre-pass, which must write the same faces as the G-buffer pass
+	 */
+	ShadowMapMaterial(bool cullFaces = false);
 
 	virtual void use() override;
 
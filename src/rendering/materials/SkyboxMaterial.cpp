@@ -1,5 +1,6 @@
 #include "rendering/materials/SkyboxMaterial.h"
 #include "Engine.h"
+#include "rendering/GLStateCache.h"
 #include <limits>
 
 SkyboxMaterial::SkyboxMaterial(const Texture& cubemap) : 
@@ -19,22 +20,22 @@ void SkyboxMaterial::use()
 {
      shader.use();
 
-     glActiveTexture(GL_TEXTURE0);
-     glBindTexture(GL_TEXTURE_CUBE_MAP, mCubemap.getId());
+     GLStateCache::activeTexture(GL_TEXTURE0);
+     GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, mCubemap.getId());
 
      // because it is the last thing being rendered
      // with the lowest value of depth
-     glDepthFunc(GL_LEQUAL);
+     GLStateCache::depthFunc(GL_LEQUAL);
 
-     glDisable(GL_CULL_FACE);
+     GLStateCache::disable(GL_CULL_FACE);
 }
 
 void SkyboxMaterial::after()
 {
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-    glDepthFunc(GL_LESS);
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    GLStateCache::depthFunc(GL_LESS);
 
-    glEnable(GL_CULL_FACE);
+    GLStateCache::enable(GL_CULL_FACE);
 }
 
 float SkyboxMaterial::renderOrder(const glm::vec3& position)
@@ -1,4 +1,5 @@
 #include "rendering/materials/Texture.h"
+#include "rendering/GLStateCache.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include <iostream>
@@ -24,6 +25,7 @@ Texture Texture::loadFromFile(const std::string& path, int wrapS, int wrapT)
         return texture;
     } else {
         texture = Texture::load(data, width, height, wrapS, wrapT, true, GL_RGBA);
+        texture.mHasAlpha = cmp == 2 || cmp == 4; // stbi converts the image to RGBA
         stbi_image_free(data);
     }
 
@@ -40,9 +42,12 @@ Texture Texture::loadFromMemory(std::uint8_t* data, std::int32_t len, int wrapS,
 
     int width, height, cmp;
     std::uint8_t* convertedData = stbi_load_from_memory(data, len, &width, &height, &cmp, STBI_rgb_alpha);
-    return Texture::load(convertedData, width, height, wrapS, wrapT, true, GL_RGBA);
+    auto texture = Texture::load(convertedData, width, height, wrapS, wrapT, true, GL_RGBA);
+	texture.mHasAlpha = cmp == 2 || cmp == 4; // stbi converts the image to RGBA
 	if (convertedData)
 		stbi_image_free(convertedData);
+
+	return texture;
 }
 
 Texture Texture::loadFromMemoryCached(const std::string& cacheKey, std::uint8_t* data, std::int32_t len, int wrapS, int wrapT)
@@ -75,7 +80,7 @@ Texture Texture::loadCubemapFromFile(const std::map<std::string, std::string>& p
 
     stbi_set_flip_vertically_on_load(false);
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
     int width, height, numCh;
     for (auto typePath = paths.begin(); typePath != paths.end(); ++typePath) {
         int side = 0;
@@ -123,7 +128,7 @@ Texture Texture::loadCubemap(const std::map<std::string, void*>& data, int width
 	std::uint32_t cubemap;
 	glGenTextures(1, &cubemap);
 
-	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+	GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
 	for (auto& [face, data] : data) {
 		int side = 0;
 
@@ -154,7 +159,7 @@ Texture Texture::load(void* data, int width, int height, int wrapS, int wrapT, b
 {
     std::uint32_t texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
 
 	if (internalFormat == GL_REPEAT) internalFormat = format;
     glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, data);
@@ -178,11 +183,12 @@ Texture Texture::load(void* data, int width, int height, int wrapS, int wrapT, b
 		std::cout << "anisotropic filtering not available\n";
 	}
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
     auto tex = Texture{texture};
 	tex.mWidth = width;
 	tex.mHeight = height;
+	tex.mHasAlpha = format == GL_RGBA || format == GL_BGRA;
 
 	return tex;
 }
@@ -195,7 +201,7 @@ Texture::Texture(std::uint32_t id) : mTextureId{id}
 void Texture::cleanUpIfNeeded()
 {
 	if (refCount.shouldCleanUp() && mTextureId != 0) {
-		glDeleteTextures(1, &mTextureId);
+		GLStateCache::deleteTextures(1, &mTextureId);
 		mTextureId = 0;
 	}
 }
@@ -220,6 +226,11 @@ bool Texture::isCubeMap() const
 	return mIsCubeMap;
 }
 
+bool Texture::hasAlpha() const
+{
+	return mHasAlpha;
+}
+
 bool Texture::isValid() const
 {
     return mTextureId != 0;
@@ -240,6 +251,7 @@ Texture& Texture::operator=(const Texture& rhs)
 	mWidth = rhs.mWidth;
 	mHeight = rhs.mHeight;
 	mIsCubeMap = rhs.mIsCubeMap;
+	mHasAlpha = rhs.mHasAlpha;
 
 	refCount = rhs.refCount;
 
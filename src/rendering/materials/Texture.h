@@ -25,6 +25,9 @@ class Texture {
 
 		bool mIsCubeMap = false;
 
+		/** whether the texture has an alpha channel, set for the textures loaded from images and RGBA data */
+		bool mHasAlpha = false;
+
 		void cleanUpIfNeeded();
 
     public:
@@ -33,6 +36,9 @@ class Texture {
           * Use one of the static load* methods to load a texture. */
         Texture() = default;
 
+        /** the copy shares the texture, which is deleted with its last copy */
+        Texture(const Texture&) = default;
+
         /**
           * Loads and returns the texture at a given path.
           * Textures are also cached using their path as the cache key.
@@ -121,6 +127,11 @@ class Texture {
 
 		bool isCubeMap() const;
 
+		/**
+		 * @return whether the image of the texture has an alpha channel, i.e. may have transparent texels
+		 */
+		bool hasAlpha() const;
+
         /**
           * Checks whether this is a valid (usable) texture
           * @return whether the texture is valid or not. */
@@ -0,0 +1,119 @@
+#include "rendering/materials/TextureArrayPool.h"
+#include "rendering/GLStateCache.h"
+#include <algorithm>
+#include <cmath>
+
+// glTexStorage needs sized formats, textures are often created with the unsized ones
+static GLenum sizedFormat(GLenum internalFormat)
+{
+	switch (internalFormat) {
+	case GL_RED: return GL_R8;
+	case GL_RG: return GL_RG8;
+	case GL_RGB: return GL_RGB8;
+	case GL_RGBA: return GL_RGBA8;
+	default: return internalFormat;
+	}
+}
+
+void TextureArrayPool::allocate(TextureArray& array, GLsizei capacity)
+{
+	const GLsizei levels = 1 + static_cast<GLsizei>(std::floor(std::log2(std::max(array.width, array.height))));
+
+	std::uint32_t id;
+	glGenTextures(1, &id);
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, id);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, array.internalFormat, array.width, array.height, capacity);
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	if (GLAD_GL_ARB_texture_filter_anisotropic) {
+		float maxAniso = 0;
+		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxAniso);
+		glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_ANISOTROPY, std::min(maxAniso, 4.0f));
+	}
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	if (array.id != 0) {
+		// only the first level is copied, the others are generated again
+		glCopyImageSubData(array.id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+			id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+			array.width, array.height, array.layers);
+		GLStateCache::deleteTextures(1, &array.id);
+		array.mipmapsDirty = true;
+	}
+
+	array.id = id;
+	array.capacity = capacity;
+}
+
+TextureArrayPool::Location TextureArrayPool::add(const Texture& texture)
+{
+	auto it = mLocations.find(texture.getId());
+	if (it != mLocations.end())
+		return it->second;
+
+	if (!texture.isValid() || texture.isCubeMap())
+		return Location{};
+
+	GLint internalFormat;
+	GLStateCache::bindTexture(GL_TEXTURE_2D, texture.getId());
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+	const GLenum format = sizedFormat(static_cast<GLenum>(internalFormat));
+	auto arrayIt = std::find_if(mArrays.begin(), mArrays.end(), [&texture, format](const TextureArray& array) {
+		return array.width == texture.getWidth() && array.height == texture.getHeight() && array.internalFormat == format;
+	});
+
+	if (arrayIt == mArrays.end()) {
+		mArrays.push_back(TextureArray{ texture.getWidth(), texture.getHeight(), format });
+		arrayIt = mArrays.end() - 1;
+		allocate(*arrayIt, INITIAL_LAYERS);
+	}
+
+	TextureArray& array = *arrayIt;
+	if (array.layers == array.capacity)
+		allocate(array, array.capacity * 2);
+
+	glCopyImageSubData(texture.getId(), GL_TEXTURE_2D, 0, 0, 0, 0,
+		array.id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, array.layers,
+		array.width, array.height, 1);
+	array.mipmapsDirty = true;
+
+	const Location location{ static_cast<std::int32_t>(arrayIt - mArrays.begin()), array.layers++ };
+	mLocations[texture.getId()] = location;
+	mTextures.push_back(texture);
+
+	return location;
+}
+
+void TextureArrayPool::updateMipmaps()
+{
+	for (TextureArray& array : mArrays) {
+		if (!array.mipmapsDirty) continue;
+
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, array.id);
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		array.mipmapsDirty = false;
+	}
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+std::uint32_t TextureArrayPool::getArrayId(std::int32_t array) const
+{
+	return array >= 0 ? mArrays[array].id : 0;
+}
+
+void TextureArrayPool::cleanUp()
+{
+	for (TextureArray& array : mArrays)
+		GLStateCache::deleteTextures(1, &array.id);
+
+	mArrays.clear();
+	mLocations.clear();
+	mTextures.clear();
+}
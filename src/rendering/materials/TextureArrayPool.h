@@ -0,0 +1,83 @@
+#pragma once
+#include "rendering/materials/Texture.h"
+#include <glad/glad.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Copies 2D Texture%s in GL_TEXTURE_2D_ARRAY textures, one for each size and format,
+ * so that meshes with different textures can be drawn together: the shader selects
+ * the layer of the texture instead of binding a different texture.
+ * Arrays are filtered with mipmaps and repeated on both axes, whatever the settings of the copied textures.
+ * The pool keeps the copied textures alive, so that their ids are not reused by other textures.
+ */
+class TextureArrayPool
+{
+public:
+	/** where a texture has been copied */
+	struct Location {
+		/** index of the array, see getArrayId */
+		std::int32_t array = -1;
+
+		std::int32_t layer = -1;
+
+		bool isValid() const { return array >= 0; }
+	};
+
+	/** layers of a new array, arrays are doubled when they are full */
+	static constexpr GLsizei INITIAL_LAYERS = 8;
+
+private:
+	struct TextureArray {
+		GLsizei width;
+		GLsizei height;
+		GLenum internalFormat;
+
+		std::uint32_t id = 0;
+		GLsizei layers = 0;
+		GLsizei capacity = 0;
+
+		/** true if layers have been copied after the mipmaps have been generated */
+		bool mipmapsDirty = false;
+	};
+
+	std::vector<TextureArray> mArrays;
+
+	/** texture id to its location */
+	std::unordered_map<std::uint32_t, Location> mLocations;
+
+	std::vector<Texture> mTextures;
+
+	/** allocates the storage of an array with capacity layers, copying the layers of the previous storage */
+	void allocate(TextureArray& array, GLsizei capacity);
+
+public:
+	TextureArrayPool() = default;
+
+	TextureArrayPool(const TextureArrayPool&) = delete;
+	TextureArrayPool& operator=(const TextureArrayPool&) = delete;
+
+	/**
+	 * Copies a texture in the array of its size, if it has not been copied yet.
+	 * @param texture a valid 2D texture
+	 * @return the location of the texture, invalid for cube maps
+	 */
+	Location add(const Texture& texture);
+
+	/**
+	 * Generates the mipmaps of the arrays changed by add, to be called before sampling them.
+	 */
+	void updateMipmaps();
+
+	/**
+	 * @param array the index of an array (see Location::array)
+	 * @return the id of the GL_TEXTURE_2D_ARRAY texture
+	 */
+	std::uint32_t getArrayId(std::int32_t array) const;
+
+	/**
+	 * Deletes the texture arrays and releases the copied textures.
+	 */
+	void cleanUp();
+};
@@ -3,32 +3,25 @@
 #include "Engine.h"
 #include "rendering/RenderPhase.h"
 #include "cameras/CameraComponent.h"
+#include "rendering/GLStateCache.h"
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
 #include <cmath>
 
 WaterMaterial::WaterMaterial(float waterY, const Texture& dudv, const Texture& normalMap)
-	: Material{"shaders/waterVS.glsl", "shaders/waterFS.glsl"}, mWaterY{ waterY }, mDuDvMap{ dudv },
-	mNormalMap { normalMap }
+	: Material{ {"shaders/waterVS.glsl"}, {}, std::vector<std::string>{ "shaders/GBuffer.glsl", "shaders/waterFS.glsl" } }, mDuDvMap{ dudv }, mNormalMap { normalMap },
+	mWaterY{ waterY }
 {
-	mEmptyReflectionTarget.create(320, 180, false, false);
-	mReflectionFbo.init(320, 180);
-
-	mEmptyRefractionTarget.create(1280, 720, false, false);
-	mRefractionFbo.init(1280, 720);
-
-	/**
-	 * This is a target whose initial color is the diffuse color added by the
-	 * deferred and pbr rendering. On top of that, the result of forward rendering
-	 * and particle rendering is added in another render pass (see renderRefraction)
-	 */
-	mReflectionRarget.createWith(mReflectionFbo.getDiffuseBuffer(), mReflectionFbo.getDepthBuffer());
-
-	mReflectionCamera = Engine::gameObjectManager.createGameObject();
+	setReflectionResolution(320, 180);
+	setRefractionResolution(1280, 720);
 
 	// don't render when rendering for water or shadows
 	unSupportedRenderPhases |= RenderPhase::ALL & ~RenderPhase::DEFERRED_RENDERING;
 
-	mEventCrumb = Engine::eventManager.addListenerFor(EventManager::PRE_RENDER_EVENT, this, true);
+	// waves move with the updates, reflection and refraction are rendered once per frame
+	mEventCrumb = Engine::eventManager.addListenerFor(EventManager::ENTER_FRAME_EVENT, this, true);
+	Engine::eventManager.addListenerFor(EventManager::PRE_RENDER_EVENT, mEventCrumb.get());
 	shader.use();
 	shader.setInt("reflection", 0);
 	shader.setInt("refraction", 1);
@@ -43,37 +36,63 @@ WaterMaterial::WaterMaterial(float waterY, const Texture& dudv, const Texture& n
 	shader.bindUniformBlock("Camera", RenderSystem::CAMERA_UNIFORM_BLOCK_INDEX);
 
 	mMoveDuDvLocation = shader.getLocationOf("moveDuDv");
+	mScreenSpaceReflectionsLocation = shader.getLocationOf("screenSpaceReflections");
 }
 
-void WaterMaterial::onEvent(SDL_Event e)
+void WaterMaterial::setReflectionResolution(std::uint32_t width, std::uint32_t height)
 {
-	float delta = (*(static_cast<float*>(e.user.data1)));
-	mMoveDuDv += waveSpeed * delta / 1000.0f;
-	mMoveDuDv = std::fmod(mMoveDuDv, 1.0f);
+	DeferredRenderingFBO fbo;
+	fbo.init(width, height);
+	mReflectionFbo = fbo;
 
-	auto& renderSys = Engine::renderSys;
-
-	/*
-	 * Do not render shadows now. Just use shadow maps from the last frame,
-	 * it should be good enough! What's more, shadows would not make sense since
-	 * the scene is split due to clipping planes.
+	/**
+	 * This is a target whose initial color is the diffuse color added by the
+	 * deferred and pbr rendering. On top of that, the result of forward rendering
+	 * and particle rendering is added in another render pass (see renderReflection)
 	 */
-	bool enabled = renderSys.shadowMappingSettings.isShadowRenderingEnabled();
-	if (enabled)
-		renderSys.shadowMappingSettings.disableShadowRendering();
+	RenderTarget target;
+	target.createWith(mReflectionFbo.getDiffuseBuffer(), mReflectionFbo.getDepthBuffer());
+	mReflectionRarget = target;
 
-	auto oldDeferredFbo = renderSys.deferredRenderingFBO;
-	renderSys.enableClipPlane();
+	// render it again as soon as possible
+	mFrame = 0;
+}
 
-	renderRefraction();
+void WaterMaterial::setRefractionResolution(std::uint32_t width, std::uint32_t height)
+{
+	DeferredRenderingFBO fbo;
+	fbo.init(width, height);
+	mRefractionFbo = fbo;
 
-	renderReflection();
+	RenderTarget target;
+	target.createWith(mRefractionFbo.getDiffuseBuffer(), mRefractionFbo.getDepthBuffer());
+	mRefractionTarget = target;
 
-	if (enabled)
-		renderSys.shadowMappingSettings.enableShadowRendering();
+	mFrame = 0;
+}
 
-	renderSys.disableClipPlane();
-	renderSys.deferredRenderingFBO = oldDeferredFbo;
+void WaterMaterial::onFrameEvent(SDL_EventType type, float deltaMillis)
+{
+	if (type == EventManager::ENTER_FRAME_EVENT) {
+		mMoveDuDv += waveSpeed * deltaMillis / 1000.0f;
+		mMoveDuDv = std::fmod(mMoveDuDv, 1.0f);
+		return;
+	}
+
+	/*
+	 * Shadows and lights are not computed for reflection and refraction, the diffuse
+	 * colors are good enough since they are distorted by the waves. What's more,
+	 * shadows would not make sense since the scene is split due to clipping planes.
+	 */
+	const glm::mat4 view = Engine::renderSys.getViewMatrix(Engine::renderSys.getCamera()->transform);
+
+	if (mFrame % std::max(1u, refractionUpdateInterval) == 0)
+		renderRefraction(view);
+
+	if (reflectionMode == ReflectionMode::PLANAR && mFrame % std::max(1u, reflectionUpdateInterval) == 0)
+		renderReflection(view);
+
+	mFrame++;
 }
 
 
@@ -99,78 +118,56 @@ bool WaterMaterial::equalsTo(const Material* rhs) const
 		&& mWaterY == other->mWaterY;
 }
 
-void WaterMaterial::renderReflection()
+void WaterMaterial::renderReflection(const glm::mat4& view)
 {
-	GameObjectEH oldCamera = Engine::renderSys.getCamera();
-	mReflectionCamera->transform = oldCamera->transform;
-
-	// temp camera for this stage
-	Engine::renderSys.setCamera(mReflectionCamera);
-
-	Transform& camTransform = mReflectionCamera->transform;
+	// mirrors the scene with respect to the water plane, the winding of triangles is fixed by the render system
+	glm::mat4 mirror = glm::translate(glm::mat4{ 1.0f }, glm::vec3{ 0.0f, 2.0f * mWaterY, 0.0f });
+	mirror = glm::scale(mirror, glm::vec3{ 1.0f, -1.0f, 1.0f });
 
-	// invert the pitch of the camera
-	auto camUp = camTransform.up();
-	auto up = glm::vec3{ 0, 1, 0 };
-	auto cosUp = glm::dot(up, camUp);
-	auto angle = glm::acos(cosUp);
-	float sign = glm::sign(glm::dot(glm::cross(camUp, up), camTransform.right()));
-	camTransform.rotateBy(glm::normalize(glm::angleAxis(sign * 2 * angle, camTransform.right())));
-
-	// put camera under water
-	float offset = camTransform.getPosition().y - mWaterY;
-	camTransform.moveBy(glm::vec3{ 0, - 2 * offset, 0 });
-
-	// render to reflection target
-	Engine::renderSys.deferredRenderingFBO = mReflectionFbo;
-	Engine::renderSys.setClipPlane(glm::vec4{ 0, 1, 0, -mWaterY });
-	Engine::renderSys.renderScene(&mEmptyReflectionTarget, RenderPhase::WATER);
-
-	glBindFramebuffer(GL_FRAMEBUFFER, mReflectionRarget.getFbo());
-	Engine::renderSys.render(RenderPhase::FORWARD_RENDERING | RenderPhase::WATER);
-
-	Engine::particleRenderer.render();
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-	// render particles
-	Engine::particleRenderer.render();
-
-	Engine::renderSys.setCamera(oldCamera);
+	const glm::vec4 clipPlane{ 0, 1, 0, -mWaterY };
+	Engine::renderSys.renderAuxiliaryView(mReflectionFbo, &mReflectionRarget, view * mirror, &clipPlane,
+		reflectionDetailCulling, RenderPhase::WATER);
 }
 
-void WaterMaterial::renderRefraction()
+void WaterMaterial::renderRefraction(const glm::mat4& view)
 {
-	Engine::renderSys.deferredRenderingFBO = mRefractionFbo;
-	Engine::renderSys.setClipPlane(glm::vec4{ 0, -1, 0, mWaterY + 1 });
-	Engine::renderSys.renderScene(&mEmptyRefractionTarget, RenderPhase::WATER);
+	// screen space reflections need what is above the water too
+	if (reflectionMode == ReflectionMode::SCREEN_SPACE) {
+		Engine::renderSys.renderAuxiliaryView(mRefractionFbo, &mRefractionTarget, view, nullptr, 0.0f, RenderPhase::WATER);
+	}
+	else {
+		const glm::vec4 clipPlane{ 0, -1, 0, mWaterY + 1 };
+		Engine::renderSys.renderAuxiliaryView(mRefractionFbo, nullptr, view, &clipPlane, 0.0f, RenderPhase::WATER);
+	}
 }
 
 void WaterMaterial::use()
 {
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, mReflectionRarget.getColorBuffer().getId());
+	GLStateCache::activeTexture(GL_TEXTURE0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, mReflectionRarget.getColorBuffer().getId());
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, mRefractionFbo.getDiffuseBuffer().getId());
+	GLStateCache::activeTexture(GL_TEXTURE1);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, mRefractionFbo.getDiffuseBuffer().getId());
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, mDuDvMap.getId());
+	GLStateCache::activeTexture(GL_TEXTURE2);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, mDuDvMap.getId());
 
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, mNormalMap.getId());
+	GLStateCache::activeTexture(GL_TEXTURE3);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, mNormalMap.getId());
 
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, mRefractionFbo.getDepthBuffer().getId());
+	GLStateCache::activeTexture(GL_TEXTURE4);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, mRefractionFbo.getDepthBuffer().getId());
 
 
 	shader.use();
 	shader.setFloat(mMoveDuDvLocation, mMoveDuDv);
+	shader.setInt(mScreenSpaceReflectionsLocation, reflectionMode == ReflectionMode::SCREEN_SPACE);
 }
 
 void WaterMaterial::after()
 {
 	for (int i = 0; i <= 7; i++) {
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GLStateCache::activeTexture(GL_TEXTURE0 + i);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 	}
 }
\ No newline at end of file
@@ -3,9 +3,9 @@
 #include "rendering/RenderTarget.h"
 #include "events/EventListener.h"
 #include "events/EventListenerCrumb.h"
-#include "gameobject/GameObjectEH.h"
 #include "rendering/deferredRendering/DeferredRenderingFBO.h"
 #include "rendering/materials/Texture.h"
+#include <glm/glm.hpp>
 
 /**
  * Material for water rendering.
@@ -22,38 +22,69 @@
 class WaterMaterial :
 	public Material, public EventListener
 {
+public:
+	/** How reflections are computed */
+	enum class ReflectionMode {
+		/** the scene is rendered again from a camera mirrored by the water plane */
+		PLANAR,
+
+		/**
+		 * reflections are ray marched in the refraction pass, that is rendered without clip plane.
+		 * Only one additional pass is needed but what is not visible on the screen is not reflected
+		 */
+		SCREEN_SPACE
+	};
+
 private:
-	// invalid render target so that lights lights calculations are not carried out (see RenderSystem::renderScene)
-	RenderTarget mEmptyReflectionTarget;
 	DeferredRenderingFBO mReflectionFbo;
-
-	// invalid render target so that lights lights calculations are not carried out
-	RenderTarget mEmptyRefractionTarget;
 	DeferredRenderingFBO mRefractionFbo;
 
 	// render target for forward and particles
 	RenderTarget mReflectionRarget;
 
-	GameObjectEH mReflectionCamera;
+	// render target for forward and particles in the refraction pass, used by screen space reflections
+	RenderTarget mRefractionTarget;
 
 	CrumbPtr mEventCrumb;
 
 	Texture mDuDvMap;
 	std::int32_t mMoveDuDvLocation = 0;
+	std::int32_t mScreenSpaceReflectionsLocation = 0;
 	float mMoveDuDv = 0.0f;
 
 	Texture mNormalMap;
 
 	float mWaterY = 0.0f;
 
-	void renderReflection();
+	/** number of frames rendered, used to skip updates of reflection and refraction */
+	std::uint64_t mFrame = 0;
 
-	void renderRefraction();
+	void renderReflection(const glm::mat4& view);
+
+	void renderRefraction(const glm::mat4& view);
 
 public:
 	/** Speed of the wave movement */
 	float waveSpeed = 0.05f;
 
+	/** How reflections are computed */
+	ReflectionMode reflectionMode = ReflectionMode::PLANAR;
+
+	/** Reflections are rendered once every reflectionUpdateInterval frames, 1 renders them every frame */
+	std::uint32_t reflectionUpdateInterval = 1;
+
+	/**
+	 * Refractions are rendered once every refractionUpdateInterval frames, 1 renders them every frame.
+	 * With ReflectionMode::SCREEN_SPACE reflections are updated together with refractions.
+	 */
+	std::uint32_t refractionUpdateInterval = 1;
+
+	/**
+	 * GameObject%s smaller than this fraction of their distance from the camera are not reflected.
+	 * Reflections are small and distorted, small details are not noticeable (0 reflects everything).
+	 */
+	float reflectionDetailCulling = 0.01f;
+
 	/**
 	 * Creates a new WaterMaterial.
 	 * @param waterY the height of the water (should be the same as the y component of Transform::getPosition)
@@ -62,11 +93,25 @@ public:
 	 */
 	WaterMaterial(float waterY, const Texture& dudvMap, const Texture& normalMap);
 
+	/**
+	 * Sets the resolution of the reflection texture.
+	 * @param width the width of the texture
+	 * @param height the height of the texture
+	 */
+	void setReflectionResolution(std::uint32_t width, std::uint32_t height);
+
+	/**
+	 * Sets the resolution of the refraction texture.
+	 * @param width the width of the texture
+	 * @param height the height of the texture
+	 */
+	void setRefractionResolution(std::uint32_t width, std::uint32_t height);
+
 	virtual void use() override;
 
 	virtual void after() override;
 
-	virtual void onEvent(SDL_Event e) override;
+	virtual void onFrameEvent(SDL_EventType type, float deltaMillis) override;
 
 	virtual std::size_t hash() const override;
 
@@ -1,6 +1,10 @@
 #include "rendering/mesh/Mesh.h"
+#include "rendering/mesh/SharedMeshBuffers.h"
+#include "rendering/GLStateCache.h"
 #include <glad/glad.h>
 
+std::uint32_t Mesh::mLastId = 0;
+
 Mesh::Mesh(std::uint32_t vao) : mVao{vao}
 {
 
@@ -18,14 +22,17 @@ bool Mesh::hasVertexData() const
 
 Mesh& Mesh::operator=(const Mesh& rhs)
 {
-	if (mVao == rhs.mVao) return *this;
+	// meshes in the shared buffers have the same vao
+	if (mId == rhs.mId) return *this;
 
 	cleanUpIfNeeded();
 
+	mId = rhs.mId;
 	mVao = rhs.mVao;
 	mBuffers = rhs.mBuffers;
 
 	mEbo = rhs.mEbo;
+	mSharedAllocation = rhs.mSharedAllocation;
 
 	mUsesIndices = rhs.mUsesIndices;
 
@@ -44,12 +51,18 @@ Mesh& Mesh::operator=(const Mesh& rhs)
 
 void Mesh::cleanUpIfNeeded()
 {
-	if (refCount.shouldCleanUp()) {
+	if (refCount.shouldCleanUp() && mSharedAllocation >= 0) {
+		// the vertex array belongs to the arena
+		SharedMeshBuffers::free(mSharedAllocation);
+		mSharedAllocation = -1;
+		mVao = 0;
+	}
+	else if (refCount.shouldCleanUp()) {
 		for (auto& buffer : mBuffers)
 			glDeleteBuffers(1, &buffer);
 		mBuffers.clear();
 
-		glDeleteVertexArrays(1, &mVao);
+		GLStateCache::deleteVertexArrays(1, &mVao);
 		mVao = 0;
 	}
 }
@@ -64,6 +77,26 @@ std::uint32_t Mesh::getEbo() const
 	return mEbo;
 }
 
+void Mesh::setIndicesNumber(std::uint32_t indicesNumber)
+{
+	mIndicesNumber = indicesNumber;
+}
+
+bool Mesh::usesSharedBuffers() const
+{
+	return mSharedAllocation >= 0;
+}
+
+std::int32_t Mesh::getBaseVertex() const
+{
+	return mSharedAllocation >= 0 ? SharedMeshBuffers::getAllocation(mSharedAllocation).baseVertex : 0;
+}
+
+std::uint32_t Mesh::getFirstIndex() const
+{
+	return mSharedAllocation >= 0 ? SharedMeshBuffers::getAllocation(mSharedAllocation).firstIndex : 0;
+}
+
 Mesh::~Mesh()
 {
 	cleanUpIfNeeded();
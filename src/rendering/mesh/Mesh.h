@@ -25,6 +25,7 @@ class Mesh
     friend class GameObjectRenderer;
     friend class MeshLoader;
 	friend class RenderSystem;
+	friend class MultiDrawRenderer;
 
 	public:
 		RefCount refCount;
@@ -35,12 +36,21 @@ class Mesh
 		BoundingBox boundingBox;
 
     private:
+		/** last id given to a mesh */
+		static std::uint32_t mLastId;
+
+		/** identifies the GPU data of this mesh, copies of a mesh have the same id. 0 for invalid meshes */
+		std::uint32_t mId = 0;
+
         std::uint32_t mVao = 0;
         std::vector<std::uint32_t> mBuffers;
 
 		// useful to change the LOD of a mesh
 		std::uint32_t mEbo = 0;
 
+		/** the allocation of this mesh in the SharedMeshBuffers, -1 if the mesh owns its buffers */
+		std::int32_t mSharedAllocation = -1;
+
         bool mUsesIndices = false;
 
         int mDrawMode = GL_TRIANGLES;
@@ -67,10 +77,36 @@ class Mesh
 		std::uint32_t getVao() const;
 
 		/**
-		 * @return the EBO used to index the vertices of this mesh.
+		 * @return the EBO used to index the vertices of this mesh, 0 for meshes in the SharedMeshBuffers.
 		 */
 		std::uint32_t getEbo() const;
 
+		/**
+		 * Sets the number of indices drawn, e.g. after writing another level of detail in the EBO.
+		 * Copies of this mesh keep drawing their own number of indices.
+		 * @param indicesNumber the number of indices read from the EBO
+		 */
+		void setIndicesNumber(std::uint32_t indicesNumber);
+
+		/**
+		 * @return true if this mesh is stored in the SharedMeshBuffers (see MeshLoader::MeshLoader)
+		 */
+		bool usesSharedBuffers() const;
+
+		/**
+		 * Meshes in the SharedMeshBuffers must be drawn with this base vertex (e.g. glDrawElementsBaseVertex).
+		 * It may change between two frames, do not store it.
+		 * @return the index of the first vertex of this mesh in its vertex buffers
+		 */
+		std::int32_t getBaseVertex() const;
+
+		/**
+		 * Meshes in the SharedMeshBuffers must be drawn starting from this index.
+		 * It may change between two frames, do not store it.
+		 * @return the index of the first index of this mesh in its index buffer
+		 */
+		std::uint32_t getFirstIndex() const;
+
         /**
           * Returns vertex data for this mesh.
           * In case vertex data is not stored in this mesh an empty vector is
@@ -175,7 +175,7 @@ Mesh MeshCreator::cylinder(float radius, std::uint32_t resolution)
 	positions.insert(positions.end(), { 0.0f, -.5f, 0.0f });
 	normals.insert(normals.end(), { 0.0f, 1.0f, 0.0f });
 
-	MeshLoader loader;
+	MeshLoader loader{ GL_TRIANGLES, true };
 	loader.loadData(positions.data(), positions.size(), 3);
 	loader.loadData(normals.data(), normals.size(), 3);
 	loader.loadData(uvs.data(), uvs.size(), 2);
@@ -247,7 +247,7 @@ Mesh MeshCreator::cone(float radius, std::uint32_t resolution)
 	normals.insert(normals.end(), { 0.0f, 1.0f, 0.0f });
 	uvs.insert(uvs.end(), { 0.5f, 0.5f });
 
-	MeshLoader loader;
+	MeshLoader loader{ GL_TRIANGLES, true };
 	loader.loadData(positions.data(), positions.size(), 3);
 	loader.loadData(normals.data(), normals.size(), 3);
 	loader.loadData(uvs.data(), uvs.size(), 2);
@@ -304,7 +304,7 @@ Mesh MeshCreator::sphere(float radius, std::uint32_t sectors, std::uint32_t stac
 		}
 	}
 
-	MeshLoader loader;
+	MeshLoader loader{ GL_TRIANGLES, true };
 	loader.loadData(positions.data(), positions.size(), 3);
 	if (includeNormals)
 		loader.loadData(normals.data(), normals.size(), 3);
@@ -345,7 +345,7 @@ Mesh MeshCreator::plane(bool includeTextureCoordinates, bool includeNormals)
 		2, 0, 3
 	};
 
-	MeshLoader loader;
+	MeshLoader loader{ GL_TRIANGLES, true };
 	loader.loadData(positions.data(), positions.size(), 3);
 	if (includeNormals)
 		loader.loadData(normals.data(), normals.size(), 3);
@@ -1,16 +1,125 @@
 #include "rendering/mesh/MeshLoader.h"
+#include "rendering/mesh/SharedMeshBuffers.h"
+#include "rendering/GLStateCache.h"
 #include <glad/glad.h>
+#include <algorithm>
 
-MeshLoader::MeshLoader(int drawMode) : mDrawMode{drawMode}
+MeshLoader::MeshLoader(int drawMode, bool sharedBuffers) : mDrawMode{drawMode}, mShared{sharedBuffers}
+{
+    mMesh.mId = ++Mesh::mLastId;
+
+    // shared meshes use the vertex array of their arena
+    if (!mShared)
+        createVertexArray();
+}
+
+void MeshLoader::createVertexArray()
 {
     glGenVertexArrays(1, &mMesh.mVao);
-    glBindVertexArray(mMesh.mVao);
+    GLStateCache::bindVertexArray(mMesh.mVao);
+}
+
+bool MeshLoader::defer(const void* data, std::uint32_t componentSize, std::uint32_t size, int dataPerVertex,
+	GLenum bufferType, GLenum dataType, bool integer, bool addToAttribPointer, GLenum usage)
+{
+	if (!mShared || data == nullptr || usage != GL_STATIC_DRAW)
+		return false;
+
+	const bool attribute = bufferType == GL_ARRAY_BUFFER && addToAttribPointer && dataPerVertex > 0;
+	const bool indices = bufferType == GL_ELEMENT_ARRAY_BUFFER && dataType == GL_UNSIGNED_INT && componentSize == sizeof(std::uint32_t)
+		&& std::none_of(mPending.begin(), mPending.end(), [](const PendingData& pending) { return pending.bufferType == GL_ELEMENT_ARRAY_BUFFER; });
+	if (!attribute && !indices)
+		return false;
+
+	const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+	mPending.push_back(PendingData{ std::vector<std::uint8_t>(bytes, bytes + size * componentSize), bufferType, dataPerVertex, dataType, componentSize, integer });
+
+	return true;
+}
+
+void MeshLoader::flushPending()
+{
+	if (!mShared)
+		return;
+
+	mShared = false;
+	createVertexArray();
+
+	for (const PendingData& pending : mPending) {
+		upload(pending.bytes.data(), pending.componentSize, static_cast<std::uint32_t>(pending.bytes.size() / pending.componentSize),
+			pending.dataPerVertex, pending.bufferType, pending.dataType, pending.integer, pending.bufferType == GL_ARRAY_BUFFER, GL_STATIC_DRAW);
+	}
+	mPending.clear();
 }
 
+std::uint32_t MeshLoader::upload(const void* data, std::uint32_t componentSize, std::uint32_t size, int dataPerVertex,
+	GLenum bufferType, GLenum dataType, bool integer, bool addToAttribPointer, GLenum usage)
+{
+	std::uint32_t bo;
+	glGenBuffers(1, &bo);
+	glBindBuffer(bufferType, bo);
+
+	glBufferData(bufferType, size * componentSize, data, usage);
+
+	if (addToAttribPointer) {
+		glEnableVertexAttribArray(mCurrentAttribPointer);
+		if (integer)
+			glVertexAttribIPointer(mCurrentAttribPointer, dataPerVertex, dataType, dataPerVertex * componentSize, (void *)0);
+		else
+			glVertexAttribPointer(mCurrentAttribPointer, dataPerVertex, dataType, GL_FALSE, dataPerVertex * componentSize, (void *)0);
+		mCurrentAttribPointer++;
+	}
+
+	if (bufferType == GL_ELEMENT_ARRAY_BUFFER)
+		mMesh.mEbo = bo;
+
+	mMesh.mBuffers.push_back(bo);
+
+	return bo;
+}
 
 Mesh MeshLoader::getMesh(std::uint32_t vertexNumber, std::uint32_t indexNumber)
 {
-    glBindVertexArray(0);
+	if (mShared && !mPending.empty()) {
+		std::vector<SharedMeshBuffers::Attribute> format;
+		std::vector<const void*> attributes;
+		const std::uint32_t* indices = nullptr;
+		std::uint32_t indexCount = 0;
+		std::uint32_t vertexCount = 0;
+		bool consistent = true;
+
+		for (const PendingData& pending : mPending) {
+			if (pending.bufferType == GL_ELEMENT_ARRAY_BUFFER) {
+				indices = reinterpret_cast<const std::uint32_t*>(pending.bytes.data());
+				indexCount = static_cast<std::uint32_t>(pending.bytes.size() / sizeof(std::uint32_t));
+				continue;
+			}
+
+			const std::uint32_t vertexSize = pending.dataPerVertex * pending.componentSize;
+			const std::uint32_t vertices = static_cast<std::uint32_t>(pending.bytes.size() / vertexSize);
+			consistent = consistent && (format.empty() || vertices == vertexCount);
+			vertexCount = vertices;
+
+			format.push_back(SharedMeshBuffers::Attribute{ pending.dataPerVertex, pending.dataType, pending.componentSize, pending.integer });
+			attributes.push_back(pending.bytes.data());
+		}
+
+		// attributes with a different number of vertices cannot share the base vertex
+		if (consistent && !format.empty()) {
+			mMesh.mSharedAllocation = SharedMeshBuffers::allocate(format, attributes, vertexCount, indices, indexCount);
+			mMesh.mVao = SharedMeshBuffers::getVertexArray(mMesh.mSharedAllocation);
+			mMesh.mVertexNumber = vertexCount;
+			mMesh.mIndicesNumber = indexNumber != 0 ? indexNumber : indexCount;
+			mMesh.mUsesIndices = mMesh.mIndicesNumber != 0;
+			mPending.clear();
+
+			return mMesh;
+		}
+	}
+
+	flushPending();
+
+    GLStateCache::bindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
@@ -24,6 +133,7 @@ Mesh MeshLoader::getMesh(std::uint32_t vertexNumber, std::uint32_t indexNumber)
 Mesh MeshLoader::createMesh(float vertexData[], std::uint32_t numOfVertices, std::uint32_t indices[], std::uint32_t numOfIndices, int drawMode)
 {
     Mesh mesh{0};
+    mesh.mId = ++Mesh::mLastId;
     mesh.mDrawMode = drawMode;
     mesh.mVertexNumber = numOfVertices;
     mesh.mIndicesNumber = numOfIndices;
@@ -37,7 +147,7 @@ Mesh MeshLoader::createMesh(float vertexData[], std::uint32_t numOfVertices, std
     if (numOfIndices != 0)
         glGenBuffers(1, &ebo);
 
-    glBindVertexArray(mesh.mVao);
+    GLStateCache::bindVertexArray(mesh.mVao);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, 8 * numOfVertices * sizeof(float), vertexData, GL_STATIC_DRAW);
 
@@ -57,7 +167,7 @@ Mesh MeshLoader::createMesh(float vertexData[], std::uint32_t numOfVertices, std
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (6 * sizeof(float)));
 
     mesh.mBuffers.insert(mesh.mBuffers.end(), {vbo, ebo});
-    glBindVertexArray(0);
+    GLStateCache::bindVertexArray(0);
 
     return mesh;
 }
@@ -13,6 +13,16 @@
 class MeshLoader
 {
     private:
+		/** data waiting for getMesh to be stored in the SharedMeshBuffers */
+		struct PendingData {
+			std::vector<std::uint8_t> bytes;
+			GLenum bufferType;
+			int dataPerVertex;
+			GLenum dataType;
+			std::uint32_t componentSize;
+			bool integer;
+		};
+
         int mDrawMode;
         std::uint32_t mVao;
         Mesh mMesh;
@@ -20,6 +30,23 @@ class MeshLoader
 
         int mCurrentAttribPointer = 0;
 
+		/** true while the data loaded can be stored in the SharedMeshBuffers */
+		bool mShared;
+		std::vector<PendingData> mPending;
+
+		void createVertexArray();
+
+		/** stores the data in mPending if it can be stored in the shared buffers, returns false otherwise */
+		bool defer(const void* data, std::uint32_t componentSize, std::uint32_t size, int dataPerVertex,
+			GLenum bufferType, GLenum dataType, bool integer, bool addToAttribPointer, GLenum usage);
+
+		/** the mesh cannot use the shared buffers, uploads the pending data in buffers owned by the mesh */
+		void flushPending();
+
+		/** creates a buffer owned by the mesh */
+		std::uint32_t upload(const void* data, std::uint32_t componentSize, std::uint32_t size, int dataPerVertex,
+			GLenum bufferType, GLenum dataType, bool integer, bool addToAttribPointer, GLenum usage);
+
     public:
         /** Creates a new mesh given an array of floats containing packed data.
           * about: vertex position, vertex normal, vertex texture coordinates.
@@ -27,8 +54,13 @@ class MeshLoader
         static Mesh createMesh(float vertexData[], std::uint32_t numOfVertices, std::uint32_t indices[], std::uint32_t numOfIndices, int drawMode = GL_TRIANGLES);
 
         /** Creates a new MeshLoader specifying the draw mode for the Mesh to create
-          * @param drawMode the mode used to draw the created mesh */
-        MeshLoader(int drawMode = GL_TRIANGLES);
+          * @param drawMode the mode used to draw the created mesh
+          * @param sharedBuffers if true the mesh is stored in the SharedMeshBuffers of its vertex format,
+          * as long as all its data is static and has an attrib pointer (or is made of unsigned int indices)
+          * and addAttribPointer is not used. Otherwise the mesh owns its buffers and vertex array as usual.
+          * Meshes whose vertex array or buffers are changed after loading (e.g. to add instanced attributes)
+          * must not use shared buffers, since they are shared with other meshes */
+        MeshLoader(int drawMode = GL_TRIANGLES, bool sharedBuffers = false);
 
         /** Loads vertex description data for the Mesh.
           * @param data an array of data to load.
@@ -37,29 +69,17 @@ class MeshLoader
           * @param bufferType the type of buffer to create (GL_ARRAY_BUFFER, GL_ELEMENT_ARAY_BUFFER, etc)
           * @param dataType the type of the data to load (GL_FLOAT, GL_UNSIGNED_INT, etc).
 		  * @param addToAttribPointer if true an attrib pointer is created for the data provided 
-		  * @param usage the usage (static, stream, etc) */
+		  * @param usage the usage (static, stream, etc)
+		  * @return the created buffer, 0 if the data is stored in the shared buffers */
         template <typename T, typename std::enable_if<std::is_arithmetic<T>::value>::type* = nullptr>
         std::uint32_t loadData(const T* data, std::uint32_t size, int dataPerVertex,
 			GLenum bufferType = GL_ARRAY_BUFFER, GLenum dataType = GL_FLOAT, bool addToAttribPointer = true, GLenum usage = GL_STATIC_DRAW) {
 
-            std::uint32_t bo;
-            glGenBuffers(1, &bo);
-            glBindBuffer(bufferType, bo);
-
-            glBufferData(bufferType, size * sizeof(T), data, usage);
+			if (defer(data, sizeof(T), size, dataPerVertex, bufferType, dataType, false, addToAttribPointer, usage))
+				return 0;
 
-            if (addToAttribPointer) {
-                glEnableVertexAttribArray(mCurrentAttribPointer);
-                glVertexAttribPointer(mCurrentAttribPointer, dataPerVertex, dataType, GL_FALSE, dataPerVertex * sizeof(T), (void *) 0);
-                mCurrentAttribPointer++;
-			}
-			
-			if (bufferType == GL_ELEMENT_ARRAY_BUFFER)
-				mMesh.mEbo = bo;
-
-            mMesh.mBuffers.push_back(bo);
-
-			return bo;
+			flushPending();
+			return upload(data, sizeof(T), size, dataPerVertex, bufferType, dataType, false, addToAttribPointer, usage);
         }
 
 		// template specialization for ints. They should use glVertexAttrib * I * Pointer
@@ -67,32 +87,30 @@ class MeshLoader
 		std::uint32_t loadData<std::int32_t, nullptr>(const std::int32_t* data, std::uint32_t size, int dataPerVertex,
 			GLenum bufferType, GLenum dataType, bool addToAttribPointer, GLenum usage) {
 
-			std::uint32_t bo;
-			glGenBuffers(1, &bo);
-			glBindBuffer(bufferType, bo);
-
-			glBufferData(bufferType, size * sizeof(std::int32_t), data, usage);
+			if (defer(data, sizeof(std::int32_t), size, dataPerVertex, bufferType, dataType, true, addToAttribPointer, usage))
+				return 0;
 
-			if (addToAttribPointer) {
-				glEnableVertexAttribArray(mCurrentAttribPointer);
-				glVertexAttribIPointer(mCurrentAttribPointer, dataPerVertex, dataType, dataPerVertex * sizeof(std::int32_t), (void *)0);
-				mCurrentAttribPointer++;
-			}
-			
-			if (bufferType == GL_ELEMENT_ARRAY_BUFFER)
-				mMesh.mEbo = bo;
-
-			mMesh.mBuffers.push_back(bo);
-
-			return bo;
+			flushPending();
+			return upload(data, sizeof(std::int32_t), size, dataPerVertex, bufferType, dataType, true, addToAttribPointer, usage);
 		}
 
-		int addAttribPointer(GLenum bufferType, std::uint32_t vbo, int stride, int dataPerVertex, GLenum dataType, int offset) {
+		/** Adds an attrib pointer for data already loaded into a buffer.
+		  * The mesh does not use the shared buffers after this call.
+		  * @param bufferType the type of the buffer
+		  * @param vbo the buffer containing the data
+		  * @param stride the distance in bytes between the data of two consecutive vertices (or instances)
+		  * @param dataPerVertex the number of components of the attribute
+		  * @param dataType the type of the components
+		  * @param offset the offset in bytes of the attribute
+		  * @param divisor 1 for per instance data, 0 for per vertex data (interleaved buffers) */
+		int addAttribPointer(GLenum bufferType, std::uint32_t vbo, int stride, int dataPerVertex, GLenum dataType, int offset, std::uint32_t divisor = 1) {
+			flushPending();
+
 			glBindBuffer(bufferType, vbo);
 
 			glEnableVertexAttribArray(mCurrentAttribPointer);
 			glVertexAttribPointer(mCurrentAttribPointer, dataPerVertex, dataType, GL_FALSE, stride, (void *)offset);
-			glVertexAttribDivisor(mCurrentAttribPointer, 1);
+			glVertexAttribDivisor(mCurrentAttribPointer, divisor);
 
 			auto attrib = mCurrentAttribPointer;
 			mCurrentAttribPointer++;
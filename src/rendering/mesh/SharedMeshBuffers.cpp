@@ -0,0 +1,328 @@
+#include "rendering/mesh/SharedMeshBuffers.h"
+#include "rendering/GLStateCache.h"
+#include <algorithm>
+
+std::vector<SharedMeshBuffers::Arena> SharedMeshBuffers::mArenas;
+std::vector<SharedMeshBuffers::Allocation> SharedMeshBuffers::mAllocations;
+std::vector<std::int32_t> SharedMeshBuffers::mFreeAllocations;
+
+// arena of the freed allocations
+static constexpr std::uint32_t NO_ARENA = 0xFFFFFFFF;
+
+bool SharedMeshBuffers::Attribute::operator==(const Attribute& rhs) const
+{
+	return components == rhs.components && type == rhs.type && componentSize == rhs.componentSize && integer == rhs.integer;
+}
+
+GLuint SharedMeshBuffers::RangeAllocator::allocate(GLuint size)
+{
+	if (size == 0)
+		return 0;
+
+	for (auto it = mFree.begin(); it != mFree.end(); ++it) {
+		if (it->second < size) continue;
+
+		const GLuint offset = it->first;
+		const GLuint remaining = it->second - size;
+		mFree.erase(it);
+		if (remaining > 0)
+			mFree[offset + size] = remaining;
+
+		return offset;
+	}
+
+	return FAILED;
+}
+
+void SharedMeshBuffers::RangeAllocator::free(GLuint offset, GLuint size)
+{
+	if (size == 0)
+		return;
+
+	auto it = mFree.emplace(offset, size).first;
+
+	auto next = std::next(it);
+	if (next != mFree.end() && it->first + it->second == next->first) {
+		it->second += next->second;
+		mFree.erase(next);
+	}
+
+	if (it != mFree.begin()) {
+		auto previous = std::prev(it);
+		if (previous->first + previous->second == it->first) {
+			previous->second += it->second;
+			mFree.erase(it);
+		}
+	}
+}
+
+void SharedMeshBuffers::RangeAllocator::grow(GLuint capacity)
+{
+	const GLuint oldCapacity = mCapacity;
+	mCapacity = capacity;
+	free(oldCapacity, capacity - oldCapacity);
+}
+
+void SharedMeshBuffers::RangeAllocator::reset(GLuint capacity, GLuint used)
+{
+	mFree.clear();
+	mCapacity = capacity;
+	if (used < capacity)
+		mFree[used] = capacity - used;
+}
+
+GLuint SharedMeshBuffers::RangeAllocator::getCapacity() const
+{
+	return mCapacity;
+}
+
+std::size_t SharedMeshBuffers::RangeAllocator::getFreeRangesNumber() const
+{
+	return mFree.size();
+}
+
+// creates a buffer of size bytes, copying the first copied bytes of source
+static std::uint32_t createBuffer(GLsizeiptr size, std::uint32_t source, GLsizeiptr copied)
+{
+	std::uint32_t buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+
+	if (source != 0 && copied > 0) {
+		glBindBuffer(GL_COPY_READ_BUFFER, source);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, copied);
+	}
+
+	return buffer;
+}
+
+void SharedMeshBuffers::reallocate(Arena& arena, GLuint vertexCapacity, GLuint indexCapacity)
+{
+	const GLuint oldVertexCapacity = arena.vertices.getCapacity();
+	const GLuint oldIndexCapacity = arena.indices.getCapacity();
+
+	for (std::size_t i = 0; i < arena.format.size(); ++i) {
+		const Attribute& attribute = arena.format[i];
+		const GLsizeiptr vertexSize = attribute.components * attribute.componentSize;
+		const std::uint32_t old = i < arena.vbos.size() ? arena.vbos[i] : 0;
+
+		const std::uint32_t vbo = createBuffer(vertexCapacity * vertexSize, old, oldVertexCapacity * vertexSize);
+		if (old != 0)
+			glDeleteBuffers(1, &old);
+
+		if (i < arena.vbos.size())
+			arena.vbos[i] = vbo;
+		else
+			arena.vbos.push_back(vbo);
+	}
+
+	const std::uint32_t ebo = createBuffer(indexCapacity * sizeof(std::uint32_t), arena.ebo, oldIndexCapacity * sizeof(std::uint32_t));
+	if (arena.ebo != 0)
+		glDeleteBuffers(1, &arena.ebo);
+	arena.ebo = ebo;
+
+	arena.vertices.grow(vertexCapacity);
+	arena.indices.grow(indexCapacity);
+	arena.version++;
+
+	setUpVertexArray(arena);
+}
+
+void SharedMeshBuffers::setUpVertexArray(Arena& arena)
+{
+	if (arena.vao == 0)
+		glGenVertexArrays(1, &arena.vao);
+
+	GLStateCache::bindVertexArray(arena.vao);
+
+	for (std::size_t i = 0; i < arena.format.size(); ++i) {
+		const Attribute& attribute = arena.format[i];
+		const GLuint location = static_cast<GLuint>(i);
+
+		glBindBuffer(GL_ARRAY_BUFFER, arena.vbos[i]);
+		glEnableVertexAttribArray(location);
+		if (attribute.integer)
+			glVertexAttribIPointer(location, attribute.components, attribute.type, 0, (void*)0);
+		else
+			glVertexAttribPointer(location, attribute.components, attribute.type, GL_FALSE, 0, (void*)0);
+	}
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.ebo);
+
+	GLStateCache::bindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+std::int32_t SharedMeshBuffers::allocate(const std::vector<Attribute>& format, const std::vector<const void*>& attributes,
+	GLuint vertexCount, const std::uint32_t* indices, GLuint indexCount)
+{
+	auto arenaIt = std::find_if(mArenas.begin(), mArenas.end(), [&format](const Arena& arena) { return arena.format == format; });
+	if (arenaIt == mArenas.end()) {
+		Arena newArena;
+		newArena.format = format;
+		mArenas.push_back(std::move(newArena));
+		arenaIt = mArenas.end() - 1;
+		reallocate(*arenaIt, std::max(INITIAL_VERTICES, vertexCount), std::max(INITIAL_INDICES, indexCount));
+	}
+	Arena& arena = *arenaIt;
+
+	GLuint baseVertex = arena.vertices.allocate(vertexCount);
+	GLuint firstIndex = arena.indices.allocate(indexCount);
+	if (baseVertex == RangeAllocator::FAILED || firstIndex == RangeAllocator::FAILED) {
+		// the arena is doubled, or more for meshes larger than it
+		if (baseVertex != RangeAllocator::FAILED)
+			arena.vertices.free(baseVertex, vertexCount);
+		if (firstIndex != RangeAllocator::FAILED)
+			arena.indices.free(firstIndex, indexCount);
+
+		const GLuint vertexCapacity = arena.vertices.getCapacity();
+		const GLuint indexCapacity = arena.indices.getCapacity();
+		reallocate(arena, vertexCapacity + std::max(vertexCapacity, vertexCount), indexCapacity + std::max(indexCapacity, indexCount));
+
+		baseVertex = arena.vertices.allocate(vertexCount);
+		firstIndex = arena.indices.allocate(indexCount);
+	}
+
+	for (std::size_t i = 0; i < format.size(); ++i) {
+		const GLsizeiptr vertexSize = format[i].components * format[i].componentSize;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, arena.vbos[i]);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, baseVertex * vertexSize, vertexCount * vertexSize, attributes[i]);
+	}
+
+	if (indexCount > 0) {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, arena.ebo);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, firstIndex * sizeof(std::uint32_t), indexCount * sizeof(std::uint32_t), indices);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	const Allocation allocation{ static_cast<std::uint32_t>(arenaIt - mArenas.begin()), static_cast<GLint>(baseVertex), vertexCount, firstIndex, indexCount };
+	if (mFreeAllocations.empty()) {
+		mAllocations.push_back(allocation);
+		return static_cast<std::int32_t>(mAllocations.size() - 1);
+	}
+
+	const std::int32_t id = mFreeAllocations.back();
+	mFreeAllocations.pop_back();
+	mAllocations[id] = allocation;
+	return id;
+}
+
+void SharedMeshBuffers::free(std::int32_t allocation)
+{
+	// meshes deleted after cleanUp
+	if (allocation < 0 || static_cast<std::size_t>(allocation) >= mAllocations.size())
+		return;
+
+	Allocation& freed = mAllocations[allocation];
+	Arena& arena = mArenas[freed.arena];
+	arena.vertices.free(freed.baseVertex, freed.vertexCount);
+	arena.indices.free(freed.firstIndex, freed.indexCount);
+
+	freed.arena = NO_ARENA;
+	mFreeAllocations.push_back(allocation);
+}
+
+const SharedMeshBuffers::Allocation& SharedMeshBuffers::getAllocation(std::int32_t allocation)
+{
+	return mAllocations[allocation];
+}
+
+std::uint32_t SharedMeshBuffers::getVertexArray(std::int32_t allocation)
+{
+	return mArenas[mAllocations[allocation].arena].vao;
+}
+
+SharedMeshBuffers::ArenaBuffers SharedMeshBuffers::getArenaBuffers(std::uint32_t arena)
+{
+	const Arena& buffers = mArenas[arena];
+	return ArenaBuffers{ buffers.vao, &buffers.vbos, buffers.ebo, buffers.version };
+}
+
+const std::vector<SharedMeshBuffers::Attribute>& SharedMeshBuffers::getFormat(std::uint32_t arena)
+{
+	return mArenas[arena].format;
+}
+
+void SharedMeshBuffers::defragment(std::uint32_t arenaIndex)
+{
+	Arena& arena = mArenas[arenaIndex];
+
+	std::vector<Allocation*> live;
+	for (Allocation& allocation : mAllocations)
+		if (allocation.arena == arenaIndex)
+			live.push_back(&allocation);
+
+	const GLuint vertexCapacity = arena.vertices.getCapacity();
+	const GLuint indexCapacity = arena.indices.getCapacity();
+
+	// the allocations are copied in their order, so that no one moves forward
+	std::sort(live.begin(), live.end(), [](const Allocation* lhs, const Allocation* rhs) { return lhs->baseVertex < rhs->baseVertex; });
+	GLuint usedVertices = 0;
+	for (std::size_t i = 0; i < arena.format.size(); ++i) {
+		const GLsizeiptr vertexSize = arena.format[i].components * arena.format[i].componentSize;
+		const std::uint32_t packed = createBuffer(vertexCapacity * vertexSize, 0, 0);
+		glBindBuffer(GL_COPY_READ_BUFFER, arena.vbos[i]);
+
+		GLuint offset = 0;
+		for (const Allocation* allocation : live) {
+			if (allocation->vertexCount > 0)
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation->baseVertex * vertexSize, offset * vertexSize, allocation->vertexCount * vertexSize);
+			offset += allocation->vertexCount;
+		}
+
+		glDeleteBuffers(1, &arena.vbos[i]);
+		arena.vbos[i] = packed;
+		usedVertices = offset;
+	}
+
+	GLuint offset = 0;
+	for (Allocation* allocation : live) {
+		allocation->baseVertex = static_cast<GLint>(offset);
+		offset += allocation->vertexCount;
+	}
+
+	std::sort(live.begin(), live.end(), [](const Allocation* lhs, const Allocation* rhs) { return lhs->firstIndex < rhs->firstIndex; });
+	const std::uint32_t packedEbo = createBuffer(indexCapacity * sizeof(std::uint32_t), 0, 0);
+	glBindBuffer(GL_COPY_READ_BUFFER, arena.ebo);
+
+	GLuint usedIndices = 0;
+	for (Allocation* allocation : live) {
+		if (allocation->indexCount > 0)
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation->firstIndex * sizeof(std::uint32_t),
+				usedIndices * sizeof(std::uint32_t), allocation->indexCount * sizeof(std::uint32_t));
+		allocation->firstIndex = usedIndices;
+		usedIndices += allocation->indexCount;
+	}
+
+	glDeleteBuffers(1, &arena.ebo);
+	arena.ebo = packedEbo;
+
+	arena.vertices.reset(vertexCapacity, usedVertices);
+	arena.indices.reset(indexCapacity, usedIndices);
+	arena.version++;
+
+	setUpVertexArray(arena);
+}
+
+void SharedMeshBuffers::defragmentIfNeeded()
+{
+	for (std::uint32_t i = 0; i < mArenas.size(); ++i) {
+		const Arena& arena = mArenas[i];
+		if (arena.vertices.getFreeRangesNumber() > MAX_FREE_RANGES || arena.indices.getFreeRangesNumber() > MAX_FREE_RANGES)
+			defragment(i);
+	}
+}
+
+void SharedMeshBuffers::cleanUp()
+{
+	for (Arena& arena : mArenas) {
+		glDeleteBuffers(static_cast<GLsizei>(arena.vbos.size()), arena.vbos.data());
+		glDeleteBuffers(1, &arena.ebo);
+		GLStateCache::deleteVertexArrays(1, &arena.vao);
+	}
+
+	mArenas.clear();
+	mAllocations.clear();
+	mFreeAllocations.clear();
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/**
+ * Large vertex and index buffers shared by the Mesh%es with the same vertex format.
+ * Each format has an arena: a buffer for each attribute, an index buffer and a vertex array,
+ * so that drawing meshes of the same format one after the other does not bind another vertex array.
+ * Meshes are suballocated in the arena (see MeshLoader::MeshLoader) and drawn with their base vertex and first index.
+ * Arenas grow when they are full. Space freed by deleted meshes is reused, and defragment
+ * packs the meshes of an arena when freed ranges are too scattered to be reused.
+ */
+class SharedMeshBuffers
+{
+public:
+	/** an attribute of a vertex format, stored in its own buffer */
+	struct Attribute {
+		GLint components = 0;
+		GLenum type = 0;
+		std::uint32_t componentSize = 0;
+
+		/** true for attributes read with glVertexAttribIPointer */
+		bool integer = false;
+
+		bool operator==(const Attribute& rhs) const;
+	};
+
+	/** the range of a mesh in its arena */
+	struct Allocation {
+		std::uint32_t arena = 0;
+		GLint baseVertex = 0;
+		GLuint vertexCount = 0;
+		GLuint firstIndex = 0;
+		GLuint indexCount = 0;
+	};
+
+	/** the buffers of an arena */
+	struct ArenaBuffers {
+		std::uint32_t vao = 0;
+		const std::vector<std::uint32_t>* vbos = nullptr;
+		std::uint32_t ebo = 0;
+
+		/** incremented each time the buffers are replaced (e.g. when the arena grows) */
+		std::uint32_t version = 0;
+	};
+
+	/** vertices and indices of a new arena */
+	static constexpr GLuint INITIAL_VERTICES = 1 << 16;
+	static constexpr GLuint INITIAL_INDICES = 1 << 18;
+
+	/** an arena is defragmented when it has more free ranges than this */
+	static constexpr std::size_t MAX_FREE_RANGES = 64;
+
+private:
+	/** first fit allocator of ranges, adjacent free ranges are merged */
+	class RangeAllocator {
+		/** offset to size of the free ranges */
+		std::map<GLuint, GLuint> mFree;
+		GLuint mCapacity = 0;
+
+	public:
+		static constexpr GLuint FAILED = 0xFFFFFFFF;
+
+		/** @return the offset of the range, FAILED if there is no free range large enough */
+		GLuint allocate(GLuint size);
+
+		void free(GLuint offset, GLuint size);
+
+		/** adds space at the end */
+		void grow(GLuint capacity);
+
+		/** marks the first used elements as allocated and the rest as free */
+		void reset(GLuint capacity, GLuint used);
+
+		GLuint getCapacity() const;
+
+		std::size_t getFreeRangesNumber() const;
+	};
+
+	struct Arena {
+		std::vector<Attribute> format;
+		std::uint32_t vao = 0;
+		std::vector<std::uint32_t> vbos;
+		std::uint32_t ebo = 0;
+		RangeAllocator vertices;
+		RangeAllocator indices;
+		std::uint32_t version = 0;
+	};
+
+	static std::vector<Arena> mArenas;
+	static std::vector<Allocation> mAllocations;
+
+	/** ids of mAllocations that can be reused */
+	static std::vector<std::int32_t> mFreeAllocations;
+
+	/** creates larger buffers for an arena, copying the content of the previous ones */
+	static void reallocate(Arena& arena, GLuint vertexCapacity, GLuint indexCapacity);
+
+	static void setUpVertexArray(Arena& arena);
+
+	/** moves the meshes of an arena at its beginning, so that the free space is a single range */
+	static void defragment(std::uint32_t arena);
+
+public:
+	SharedMeshBuffers() = delete;
+
+	/**
+	 * Allocates a mesh in the arena of its format and uploads its data.
+	 * @param format the attributes of the vertices, in the order of their locations
+	 * @param attributes the data of each attribute, vertexCount elements each
+	 * @param vertexCount the number of vertices
+	 * @param indices the indices, nullptr for meshes without indices
+	 * @param indexCount the number of indices
+	 * @return the id of the allocation
+	 */
+	static std::int32_t allocate(const std::vector<Attribute>& format, const std::vector<const void*>& attributes,
+		GLuint vertexCount, const std::uint32_t* indices, GLuint indexCount);
+
+	/**
+	 * Frees the range of a deleted mesh.
+	 * @param allocation the id returned by allocate
+	 */
+	static void free(std::int32_t allocation);
+
+	/**
+	 * The range changes when its arena is defragmented, it must not be stored.
+	 * @param allocation the id returned by allocate
+	 * @return the range of the allocation
+	 */
+	static const Allocation& getAllocation(std::int32_t allocation);
+
+	/**
+	 * @param allocation the id returned by allocate
+	 * @return the vertex array of the arena of an allocation, it does not change when the arena grows
+	 */
+	static std::uint32_t getVertexArray(std::int32_t allocation);
+
+	/**
+	 * @param arena the arena of an allocation (see Allocation::arena)
+	 * @return the buffers of the arena, valid until the next allocation
+	 */
+	static ArenaBuffers getArenaBuffers(std::uint32_t arena);
+
+	/**
+	 * @param arena the arena of an allocation (see Allocation::arena)
+	 * @return the format of the arena
+	 */
+	static const std::vector<Attribute>& getFormat(std::uint32_t arena);
+
+	/**
+	 * Packs the meshes of the arenas with more than MAX_FREE_RANGES free ranges.
+	 * The RenderSystem calls it once per frame.
+	 */
+	static void defragmentIfNeeded();
+
+	/**
+	 * Deletes the buffers, the meshes still allocated cannot be drawn anymore.
+	 */
+	static void cleanUp();
+};
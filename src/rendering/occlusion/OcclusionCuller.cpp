@@ -0,0 +1,333 @@
+#include "rendering/occlusion/OcclusionCuller.h"
+#include "gameobject/GameObject.h"
+#include "Engine.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+namespace {
+	// the faces of a box whose i-th corner has x = max if i & 1, y = max if i & 2 and z = max if i & 4
+	constexpr std::array<std::array<int, 4>, 6> BOX_FACES{ {
+		{ 0, 2, 6, 4 }, { 1, 3, 7, 5 },
+		{ 0, 1, 5, 4 }, { 2, 3, 7, 6 },
+		{ 0, 1, 3, 2 }, { 4, 5, 7, 6 }
+	} };
+
+	std::array<glm::vec3, 8> boxCorners(const glm::vec3& min, const glm::vec3& max)
+	{
+		std::array<glm::vec3, 8> corners;
+		for (int i = 0; i < 8; ++i)
+			corners[i] = glm::vec3{ i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z };
+		return corners;
+	}
+
+	// clips a clip space triangle against the near plane (z > -w), producing up to two triangles
+	void clipNear(const std::array<glm::vec4, 3>& triangle, std::vector<std::array<glm::vec4, 3>>& output)
+	{
+		std::array<glm::vec4, 4> polygon;
+		int vertices = 0;
+
+		for (int i = 0; i < 3; ++i) {
+			const glm::vec4& current = triangle[i];
+			const glm::vec4& next = triangle[(i + 1) % 3];
+			const float currentDistance = current.z + current.w;
+			const float nextDistance = next.z + next.w;
+
+			if (currentDistance >= 0.0f)
+				polygon[vertices++] = current;
+			if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+				polygon[vertices++] = glm::mix(current, next, currentDistance / (currentDistance - nextDistance));
+		}
+
+		for (int i = 2; i < vertices; ++i)
+			output.push_back({ polygon[0], polygon[i - 1], polygon[i] });
+	}
+}
+
+OcclusionCuller::OcclusionCuller()
+{
+	std::uint32_t width = WIDTH;
+	std::uint32_t height = HEIGHT;
+	while (true) {
+		mLevels.push_back(Level{ width, height, std::vector<float>(static_cast<std::size_t>(width) * height, 1.0f) });
+		if (width == 1 && height == 1)
+			break;
+
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+	}
+}
+
+void OcclusionCuller::addOccluder(const GameObjectEH& occluder)
+{
+	mOccluders.push_back(Occluder{ occluder, {} });
+}
+
+void OcclusionCuller::addOccluder(const GameObjectEH& occluder, const std::vector<glm::vec3>& vertices, const std::vector<std::uint32_t>& indices)
+{
+	Occluder proxy{ occluder, {} };
+	proxy.triangles.reserve(indices.size());
+	for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+		for (std::size_t v = 0; v < 3; ++v)
+			proxy.triangles.push_back(vertices[indices[i + v]]);
+
+	mOccluders.push_back(std::move(proxy));
+}
+
+void OcclusionCuller::update(const glm::mat4& projectionView)
+{
+	mActive = false;
+	if (!enabled)
+		return;
+
+	mOccluders.erase(std::remove_if(mOccluders.begin(), mOccluders.end(), [](const Occluder& occluder) {
+		return !occluder.gameObject.isValid();
+	}), mOccluders.end());
+
+	// the largest occluders on screen hide the most
+	std::vector<std::pair<float, std::size_t>> candidates;
+	std::vector<glm::mat4> toWorld(mOccluders.size());
+	for (std::size_t i = 0; i < mOccluders.size(); ++i) {
+		const Occluder& occluder = mOccluders[i];
+		GameObject* gameObject = *occluder.gameObject;
+
+		BoundingBox modelBox;
+		if (occluder.triangles.empty()) {
+			for (const Mesh& mesh : gameObject->getMeshes())
+				modelBox.extend(mesh.boundingBox);
+		}
+		else {
+			for (const glm::vec3& vertex : occluder.triangles)
+				modelBox.extend(vertex);
+		}
+
+		if (!modelBox.isValid())
+			continue;
+
+		toWorld[i] = gameObject->transform.modelToWorld();
+
+		glm::vec2 ndcMin{ 1.0f };
+		glm::vec2 ndcMax{ -1.0f };
+		bool crossesNearPlane = false;
+		for (const glm::vec3& corner : boxCorners(modelBox.getMin(), modelBox.getMax())) {
+			const glm::vec4 clip = projectionView * toWorld[i] * glm::vec4{ corner, 1.0f };
+			if (clip.z < -clip.w || clip.w <= 0.0f) {
+				crossesNearPlane = true;
+				break;
+			}
+
+			const glm::vec2 ndc = glm::vec2{ clip } / clip.w;
+			ndcMin = glm::min(ndcMin, ndc);
+			ndcMax = glm::max(ndcMax, ndc);
+		}
+
+		if (crossesNearPlane) {
+			ndcMin = glm::vec2{ -1.0f };
+			ndcMax = glm::vec2{ 1.0f };
+		}
+
+		const glm::vec2 size = glm::clamp(ndcMax, -1.0f, 1.0f) - glm::clamp(ndcMin, -1.0f, 1.0f);
+		if (size.x > 0.0f && size.y > 0.0f)
+			candidates.emplace_back(size.x * size.y, i);
+	}
+
+	const std::size_t selected = std::min(maxOccluders, candidates.size());
+	std::partial_sort(candidates.begin(), candidates.begin() + selected, candidates.end(), [](const auto& lhs, const auto& rhs) {
+		return lhs.first > rhs.first;
+	});
+
+	std::vector<glm::vec3> triangles;
+	for (std::size_t c = 0; c < selected; ++c) {
+		const std::size_t i = candidates[c].second;
+		const Occluder& occluder = mOccluders[i];
+		auto transform = [&toWorld, i](const glm::vec3& vertex) { return glm::vec3{ toWorld[i] * glm::vec4{ vertex, 1.0f } }; };
+
+		if (occluder.triangles.empty()) {
+			BoundingBox modelBox;
+			for (const Mesh& mesh : (*occluder.gameObject)->getMeshes())
+				modelBox.extend(mesh.boundingBox);
+
+			const std::array<glm::vec3, 8> corners = boxCorners(modelBox.getMin(), modelBox.getMax());
+			for (const auto& face : BOX_FACES) {
+				for (int v : { face[0], face[1], face[2], face[0], face[2], face[3] })
+					triangles.push_back(transform(corners[v]));
+			}
+		}
+		else {
+			std::transform(occluder.triangles.begin(), occluder.triangles.end(), std::back_inserter(triangles), transform);
+		}
+	}
+
+	rasterize(projectionView, triangles);
+}
+
+void OcclusionCuller::rasterize(const glm::mat4& projectionView, const std::vector<glm::vec3>& triangles)
+{
+	mProjectionView = projectionView;
+	std::fill(mLevels[0].depth.begin(), mLevels[0].depth.end(), 1.0f);
+
+	std::vector<std::array<glm::vec4, 3>> clipTriangles;
+	clipTriangles.reserve(triangles.size() / 3);
+	for (std::size_t i = 0; i + 2 < triangles.size(); i += 3) {
+		const std::array<glm::vec4, 3> triangle{
+			projectionView * glm::vec4{ triangles[i], 1.0f },
+			projectionView * glm::vec4{ triangles[i + 1], 1.0f },
+			projectionView * glm::vec4{ triangles[i + 2], 1.0f }
+		};
+		clipNear(triangle, clipTriangles);
+	}
+
+	// each worker owns some rows of the depth buffer, so no synchronization is needed
+	Engine::jobSystem.parallelFor(HEIGHT, 8, [this, &clipTriangles](std::size_t begin, std::size_t end) {
+		for (const auto& triangle : clipTriangles)
+			rasterizeTriangle(triangle[0], triangle[1], triangle[2], static_cast<std::uint32_t>(begin), static_cast<std::uint32_t>(end));
+	});
+
+	buildHierarchy();
+	mActive = true;
+}
+
+void OcclusionCuller::rasterizeTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2, std::uint32_t firstRow, std::uint32_t lastRow)
+{
+	auto toScreen = [](const glm::vec4& clip) {
+		const glm::vec3 ndc = glm::vec3{ clip } / clip.w;
+		return glm::vec3{ (ndc.x * 0.5f + 0.5f) * WIDTH, (ndc.y * 0.5f + 0.5f) * HEIGHT, ndc.z * 0.5f + 0.5f };
+	};
+
+	const glm::vec3 p0 = toScreen(v0);
+	const glm::vec3 p1 = toScreen(v1);
+	const glm::vec3 p2 = toScreen(v2);
+
+	float area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+	if (std::abs(area) < 1e-6f)
+		return;
+
+	// pixels whose center is inside the triangle are covered
+	const float minX = std::max(0.0f, std::min({ p0.x, p1.x, p2.x }) - 0.5f);
+	const float maxX = std::min(static_cast<float>(WIDTH) - 1.0f, std::max({ p0.x, p1.x, p2.x }) - 0.5f);
+	const float minY = std::max(static_cast<float>(firstRow), std::min({ p0.y, p1.y, p2.y }) - 0.5f);
+	const float maxY = std::min(static_cast<float>(lastRow) - 1.0f, std::max({ p0.y, p1.y, p2.y }) - 0.5f);
+	if (minX > maxX || minY > maxY)
+		return;
+
+	const auto x0 = static_cast<std::uint32_t>(std::ceil(minX));
+	const auto x1 = static_cast<std::uint32_t>(std::floor(maxX));
+	const auto y0 = static_cast<std::uint32_t>(std::ceil(minY));
+	const auto y1 = static_cast<std::uint32_t>(std::floor(maxY));
+
+	// both windings are rasterized
+	const float sign = area > 0.0f ? 1.0f : -1.0f;
+	area *= sign;
+
+	// edge functions e(x, y) = a * x + b * y + c, positive inside the triangle
+	auto edge = [sign](const glm::vec3& from, const glm::vec3& to) {
+		const float a = (from.y - to.y) * sign;
+		const float b = (to.x - from.x) * sign;
+		return glm::vec3{ a, b, -(a * from.x + b * from.y) };
+	};
+	const glm::vec3 e0 = edge(p1, p2);
+	const glm::vec3 e1 = edge(p2, p0);
+	const glm::vec3 e2 = edge(p0, p1);
+
+	// depth is linear in screen space
+	const glm::vec3 depthPlane = (e0 * p0.z + e1 * p1.z + e2 * p2.z) / area;
+
+	std::vector<float>& depth = mLevels[0].depth;
+	for (std::uint32_t y = y0; y <= y1; ++y) {
+		const float py = y + 0.5f;
+		float* row = depth.data() + static_cast<std::size_t>(y) * WIDTH;
+
+		for (std::uint32_t x = x0; x <= x1; ++x) {
+			const float px = x + 0.5f;
+			const float w0 = e0.x * px + e0.y * py + e0.z;
+			const float w1 = e1.x * px + e1.y * py + e1.z;
+			const float w2 = e2.x * px + e2.y * py + e2.z;
+
+			if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f) {
+				const float z = depthPlane.x * px + depthPlane.y * py + depthPlane.z;
+				row[x] = std::min(row[x], std::max(z, 0.0f));
+			}
+		}
+	}
+}
+
+void OcclusionCuller::buildHierarchy()
+{
+	for (std::size_t l = 1; l < mLevels.size(); ++l) {
+		const Level& source = mLevels[l - 1];
+		Level& level = mLevels[l];
+
+		for (std::uint32_t y = 0; y < level.height; ++y) {
+			const std::uint32_t sy0 = std::min(2 * y, source.height - 1);
+			const std::uint32_t sy1 = std::min(2 * y + 1, source.height - 1);
+
+			for (std::uint32_t x = 0; x < level.width; ++x) {
+				const std::uint32_t sx0 = std::min(2 * x, source.width - 1);
+				const std::uint32_t sx1 = std::min(2 * x + 1, source.width - 1);
+
+				level.depth[y * level.width + x] = std::max({
+					source.depth[sy0 * source.width + sx0], source.depth[sy0 * source.width + sx1],
+					source.depth[sy1 * source.width + sx0], source.depth[sy1 * source.width + sx1]
+				});
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::isOccluded(const BoundingBox& box) const
+{
+	if (!mActive || !box.isValid())
+		return false;
+
+	glm::vec3 ndcMin{ 1.0f };
+	glm::vec3 ndcMax{ -1.0f };
+	for (const glm::vec3& corner : boxCorners(box.getMin(), box.getMax())) {
+		const glm::vec4 clip = mProjectionView * glm::vec4{ corner, 1.0f };
+
+		// boxes crossing the near plane are always visible
+		if (clip.z < -clip.w || clip.w <= 0.0f)
+			return false;
+
+		const glm::vec3 ndc = glm::vec3{ clip } / clip.w;
+		ndcMin = glm::min(ndcMin, ndc);
+		ndcMax = glm::max(ndcMax, ndc);
+	}
+
+	if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f)
+		return false;
+
+	const float boxDepth = ndcMin.z * 0.5f + 0.5f;
+
+	auto toPixel = [](float ndc, std::uint32_t size) {
+		const float pixel = std::floor((ndc * 0.5f + 0.5f) * size);
+		return static_cast<std::uint32_t>(glm::clamp(pixel, 0.0f, static_cast<float>(size - 1)));
+	};
+	const std::uint32_t x0 = toPixel(ndcMin.x, WIDTH);
+	const std::uint32_t x1 = toPixel(ndcMax.x, WIDTH);
+	const std::uint32_t y0 = toPixel(ndcMin.y, HEIGHT);
+	const std::uint32_t y1 = toPixel(ndcMax.y, HEIGHT);
+
+	// the first level where the box covers at most 2x2 texels
+	std::size_t l = 0;
+	while (l + 1 < mLevels.size() && ((x1 >> l) - (x0 >> l) > 1 || (y1 >> l) - (y0 >> l) > 1))
+		++l;
+
+	const Level& level = mLevels[l];
+	for (std::uint32_t y = y0 >> l; y <= (y1 >> l); ++y) {
+		for (std::uint32_t x = x0 >> l; x <= (x1 >> l); ++x) {
+			const std::uint32_t tx = std::min(x, level.width - 1);
+			const std::uint32_t ty = std::min(y, level.height - 1);
+			if (level.depth[ty * level.width + tx] >= boxDepth)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool OcclusionCuller::isActive() const
+{
+	return mActive;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "gameobject/GameObjectEH.h"
+#include "geometry/BoundingBox.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Culls the GameObject%s hidden behind occluders without reading anything back from the GPU.
+ * Every frame the largest occluders on screen are rasterized on the CPU, by the workers of the JobSystem,
+ * in a small depth buffer. A hierarchical depth buffer (each texel stores the farthest depth of the
+ * texels below it) is then built so that a BoundingBox is tested reading only a few texels.
+ * Occluders must be conservative: they should never cover something the rendered meshes do not.
+ */
+class OcclusionCuller
+{
+	friend class RenderSystem;
+
+public:
+	/** size of the depth buffer, the first level of the hierarchy */
+	static constexpr std::uint32_t WIDTH = 256;
+	static constexpr std::uint32_t HEIGHT = 128;
+
+private:
+	struct Occluder {
+		GameObjectEH gameObject;
+
+		/** model space triangles, three vertices each. Empty to use the box of the meshes */
+		std::vector<glm::vec3> triangles;
+	};
+
+	struct Level {
+		std::uint32_t width;
+		std::uint32_t height;
+		std::vector<float> depth;
+	};
+
+	std::vector<Occluder> mOccluders;
+
+	/** mLevels[0] is the depth buffer, depths are in [0, 1] as in OpenGL, 1 where nothing has been rasterized */
+	std::vector<Level> mLevels;
+
+	glm::mat4 mProjectionView{ 1.0f };
+
+	/** true if the occluders have been rasterized for the current view */
+	bool mActive = false;
+
+	/** rasterizes the occluders for the current camera, called by the RenderSystem before rendering the scene */
+	void update(const glm::mat4& projectionView);
+
+	/** rasterizes a clip space triangle in the rows [firstRow, lastRow) of the depth buffer */
+	void rasterizeTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2, std::uint32_t firstRow, std::uint32_t lastRow);
+
+	/** computes the levels of the hierarchy from the depth buffer */
+	void buildHierarchy();
+
+public:
+	/** if false nothing is culled and occluders are not rasterized */
+	bool enabled = false;
+
+	/** maximum number of occluders rasterized each frame, the ones covering the largest part of the screen */
+	std::size_t maxOccluders = 64;
+
+	OcclusionCuller();
+
+	OcclusionCuller(const OcclusionCuller&) = delete;
+	OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+	/**
+	 * Adds an occluder that fills the box containing its meshes, e.g. a building.
+	 * The box is oriented as the GameObject. Occluders are removed when their GameObject is destroyed.
+	 * @param occluder the GameObject hiding what is behind it
+	 */
+	void addOccluder(const GameObjectEH& occluder);
+
+	/**
+	 * Adds an occluder with a low poly proxy of its meshes.
+	 * The proxy must be contained in the meshes of the GameObject.
+	 * @param occluder the GameObject hiding what is behind it
+	 * @param vertices the model space vertices of the proxy
+	 * @param indices three indices of vertices for each triangle of the proxy
+	 */
+	void addOccluder(const GameObjectEH& occluder, const std::vector<glm::vec3>& vertices, const std::vector<std::uint32_t>& indices);
+
+	/**
+	 * Clears the depth buffer and rasterizes some triangles in it.
+	 * It does not need a rendering context, update uses it to rasterize the occluders.
+	 * @param projectionView the matrix from world space to clip space
+	 * @param triangles world space triangles, three vertices each
+	 */
+	void rasterize(const glm::mat4& projectionView, const std::vector<glm::vec3>& triangles);
+
+	/**
+	 * @param box a world space BoundingBox
+	 * @return true if the box is entirely hidden by the rasterized occluders
+	 */
+	bool isOccluded(const BoundingBox& box) const;
+
+	/**
+	 * @return true if the occluders have been rasterized for the current view and isOccluded can be used
+	 */
+	bool isActive() const;
+};
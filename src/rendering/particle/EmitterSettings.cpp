@@ -45,3 +45,47 @@ void EmitterSettings::setUp(const GameObjectEH& go, Particle& p)
 	p.finalGravityScale = randVal(finalGravityScaleMin, finalGravityScaleMax);
 }
 
+std::uint32_t EmitterSettings::setUp(const GameObjectEH& go, ParticlePool& pool, std::uint32_t count)
+{
+	std::uint32_t created = pool.allocate(count);
+	std::uint32_t first = pool.size() - created;
+
+	Transform& transform = go->transform;
+	glm::vec3 minPos = transform.getPosition() + positionOffsetMin;
+	glm::vec3 maxPos = transform.getPosition() + positionOffsetMax;
+
+	glm::vec3 minVel = velocityMin;
+	glm::vec3 maxVel = velocityMax;
+
+	if (followEmitterDirection) {
+		glm::mat3 toUpright = transform.modelToUpright();
+		minVel = toUpright * minVel;
+		maxVel = toUpright * maxVel;
+	}
+
+	for (std::uint32_t i = first; i < first + created; ++i) {
+		pool.durationMillis[i] = randVal(minDuration, maxDuration);
+		pool.elapsedTime[i] = 0.0f;
+
+		glm::vec3 position = randVal(minPos, maxPos);
+		pool.positionX[i] = position.x;
+		pool.positionY[i] = position.y;
+		pool.positionZ[i] = position.z;
+
+		glm::vec3 velocity = randVal(minVel, maxVel);
+		pool.velocityX[i] = velocity.x;
+		pool.velocityY[i] = velocity.y;
+		pool.velocityZ[i] = velocity.z;
+
+		pool.initialRotation[i] = randVal(initialRotationMin, initialRotationMax);
+		pool.finalRotation[i] = randVal(finalRotationMin, finalRotationMax);
+
+		pool.initialScale[i] = randVal(initialScaleMin, initialScaleMax);
+		pool.finalScale[i] = randVal(finalScaleMin, finalScaleMax);
+
+		pool.initialGravityScale[i] = randVal(initialGravityScaleMin, initialGravityScaleMax);
+		pool.finalGravityScale[i] = randVal(finalGravityScaleMin, finalGravityScaleMax);
+	}
+
+	return created;
+}
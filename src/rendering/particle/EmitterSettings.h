@@ -1,8 +1,10 @@
 #pragma once
 #include "Particle.h"
+#include "ParticlePool.h"
 #include "gameobject/GameObjectEH.h"
 #include <glm/glm.hpp>
 #include <glad/glad.h>
+#include <cstdint>
 
 /**
  * Settings for ParticleEmitter%s.
@@ -75,6 +77,16 @@ public:
 	 * @param p the Particle to set up.
 	 */
 	void setUp(const GameObjectEH& go, Particle& p);
+
+	/**
+	 * Sets up a batch of new particles directly in a ParticlePool.
+	 * The emitter Transform is only queried once for the whole batch.
+	 * @param go the emitter GameObject
+	 * @param pool the pool where particles are created.
+	 * @param count the number of particles to create.
+	 * @return the number of particles actually created (the pool may be full).
+	 */
+	std::uint32_t setUp(const GameObjectEH& go, ParticlePool& pool, std::uint32_t count);
 };
 
 
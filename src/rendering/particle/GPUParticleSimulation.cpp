@@ -0,0 +1,154 @@
+#include "GPUParticleSimulation.h"
+#include "gameobject/Transform.h"
+#include "gameobject/GameObject.h"
+#include "rendering/GLStateCache.h"
+#include <glad/glad.h>
+#include <vector>
+#include <algorithm>
+
+GPUParticleSimulation::GPUParticleSimulation(std::uint32_t maxParticles) : mMaxParticles{ maxParticles }
+{
+	// all zeros: elapsed time equal to duration, every slot is dead
+	std::vector<float> initialState(mMaxParticles * FLOATS_PER_PARTICLE, 0.0f);
+
+	glGenBuffers(2, mBuffers);
+	glGenVertexArrays(2, mUpdateVaos);
+	for (int i = 0; i < 2; ++i) {
+		GLStateCache::bindVertexArray(mUpdateVaos[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, mBuffers[i]);
+		glBufferData(GL_ARRAY_BUFFER, initialState.size() * sizeof(float), initialState.data(), GL_DYNAMIC_COPY);
+		setUpAttributes(0, 0);
+	}
+	GLStateCache::bindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	mUpdateShader = Shader::loadTransformFeedbackFromFile({ "shaders/particleUpdateVS.glsl" },
+		{ "outPositionElapsed", "outVelocityDuration", "outRotationScale", "outGravityScale" });
+	mUpdateShader.use();
+	mDeltaMillisLocation = mUpdateShader.getLocationOf("deltaMillis");
+	mGravityLocation = mUpdateShader.getLocationOf("gravity");
+	mSpawnStartLocation = mUpdateShader.getLocationOf("spawnStart");
+	mSpawnCountLocation = mUpdateShader.getLocationOf("spawnCount");
+	mMaxParticlesLocation = mUpdateShader.getLocationOf("maxParticles");
+	mSeedLocation = mUpdateShader.getLocationOf("seed");
+	mPositionMinLocation = mUpdateShader.getLocationOf("positionMin");
+	mPositionMaxLocation = mUpdateShader.getLocationOf("positionMax");
+	mVelocityMinLocation = mUpdateShader.getLocationOf("velocityMin");
+	mVelocityMaxLocation = mUpdateShader.getLocationOf("velocityMax");
+	mDurationRangeLocation = mUpdateShader.getLocationOf("durationRange");
+	mInitialRotationRangeLocation = mUpdateShader.getLocationOf("initialRotationRange");
+	mFinalRotationRangeLocation = mUpdateShader.getLocationOf("finalRotationRange");
+	mInitialScaleRangeLocation = mUpdateShader.getLocationOf("initialScaleRange");
+	mFinalScaleRangeLocation = mUpdateShader.getLocationOf("finalScaleRange");
+	mInitialGravityRangeLocation = mUpdateShader.getLocationOf("initialGravityRange");
+	mFinalGravityRangeLocation = mUpdateShader.getLocationOf("finalGravityRange");
+}
+
+void GPUParticleSimulation::setUpAttributes(std::uint32_t firstAttribute, std::uint32_t divisor)
+{
+	constexpr int stride = FLOATS_PER_PARTICLE * sizeof(float);
+	const int sizes[] = { 4, 4, 4, 2 };
+
+	std::size_t offset = 0;
+	for (std::uint32_t i = 0; i < 4; ++i) {
+		glEnableVertexAttribArray(firstAttribute + i);
+		glVertexAttribPointer(firstAttribute + i, sizes[i], GL_FLOAT, GL_FALSE, stride, (void *)offset);
+		glVertexAttribDivisor(firstAttribute + i, divisor);
+		offset += sizes[i] * sizeof(float);
+	}
+}
+
+void GPUParticleSimulation::uploadSettings(const EmitterSettings& settings, const Transform& emitterTransform)
+{
+	glm::vec3 minVel = settings.velocityMin;
+	glm::vec3 maxVel = settings.velocityMax;
+
+	if (settings.followEmitterDirection) {
+		glm::mat3 toUpright = emitterTransform.modelToUpright();
+		minVel = toUpright * minVel;
+		maxVel = toUpright * maxVel;
+	}
+
+	mUpdateShader.setVec3(mPositionMinLocation, emitterTransform.getPosition() + settings.positionOffsetMin);
+	mUpdateShader.setVec3(mPositionMaxLocation, emitterTransform.getPosition() + settings.positionOffsetMax);
+	mUpdateShader.setVec3(mVelocityMinLocation, minVel);
+	mUpdateShader.setVec3(mVelocityMaxLocation, maxVel);
+	mUpdateShader.setVec2(mDurationRangeLocation, glm::vec2{ settings.minDuration, settings.maxDuration });
+	mUpdateShader.setVec2(mInitialRotationRangeLocation, glm::vec2{ settings.initialRotationMin, settings.initialRotationMax });
+	mUpdateShader.setVec2(mFinalRotationRangeLocation, glm::vec2{ settings.finalRotationMin, settings.finalRotationMax });
+	mUpdateShader.setVec2(mInitialScaleRangeLocation, glm::vec2{ settings.initialScaleMin, settings.initialScaleMax });
+	mUpdateShader.setVec2(mFinalScaleRangeLocation, glm::vec2{ settings.finalScaleMin, settings.finalScaleMax });
+	mUpdateShader.setVec2(mInitialGravityRangeLocation, glm::vec2{ settings.initialGravityScaleMin, settings.initialGravityScaleMax });
+	mUpdateShader.setVec2(mFinalGravityRangeLocation, glm::vec2{ settings.finalGravityScaleMin, settings.finalGravityScaleMax });
+}
+
+void GPUParticleSimulation::update(const EmitterSettings& settings, const Transform& emitterTransform, std::uint32_t toSpawn, float deltaMillis, float gravity)
+{
+	if (mMaxParticles == 0) return;
+
+	toSpawn = std::min(toSpawn, mMaxParticles);
+
+	mUpdateShader.use();
+	uploadSettings(settings, emitterTransform);
+	mUpdateShader.setFloat(mDeltaMillisLocation, deltaMillis);
+	mUpdateShader.setFloat(mGravityLocation, gravity);
+	mUpdateShader.setInt(mSpawnStartLocation, mNextSlot);
+	mUpdateShader.setInt(mSpawnCountLocation, toSpawn);
+	mUpdateShader.setInt(mMaxParticlesLocation, mMaxParticles);
+	glUniform1ui(mSeedLocation, mSeed++);
+
+	mNextSlot = (mNextSlot + toSpawn) % mMaxParticles;
+
+	std::uint32_t next = 1 - mCurrent;
+
+	// no fragment is generated, particles are only written to the next buffer
+	GLStateCache::enable(GL_RASTERIZER_DISCARD);
+	GLStateCache::bindVertexArray(mUpdateVaos[mCurrent]);
+	GLStateCache::bindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, mBuffers[next]);
+
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, mMaxParticles);
+	glEndTransformFeedback();
+
+	GLStateCache::bindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	GLStateCache::bindVertexArray(0);
+	GLStateCache::disable(GL_RASTERIZER_DISCARD);
+
+	mCurrent = next;
+}
+
+void GPUParticleSimulation::emit(const Particle& p)
+{
+	if (mMaxParticles == 0) return;
+
+	float data[FLOATS_PER_PARTICLE]{
+		p.position.x, p.position.y, p.position.z, p.elapsedTime,
+		p.velocity.x, p.velocity.y, p.velocity.z, p.durationMillis,
+		p.initialRotation, p.finalRotation, p.initialScale, p.finalScale,
+		p.initialGravityScale, p.finalGravityScale
+	};
+
+	glBindBuffer(GL_ARRAY_BUFFER, mBuffers[mCurrent]);
+	glBufferSubData(GL_ARRAY_BUFFER, mNextSlot * sizeof(data), sizeof(data), data);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	mNextSlot = (mNextSlot + 1) % mMaxParticles;
+}
+
+void GPUParticleSimulation::bindForRendering(std::uint32_t firstAttribute) const
+{
+	glBindBuffer(GL_ARRAY_BUFFER, mBuffers[mCurrent]);
+	setUpAttributes(firstAttribute, 1);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+std::uint32_t GPUParticleSimulation::getMaxParticles() const
+{
+	return mMaxParticles;
+}
+
+GPUParticleSimulation::~GPUParticleSimulation()
+{
+	GLStateCache::deleteVertexArrays(2, mUpdateVaos);
+	GLStateCache::deleteBuffers(2, mBuffers);
+}
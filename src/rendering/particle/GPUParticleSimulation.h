@@ -0,0 +1,102 @@
+#pragma once
+#include "Particle.h"
+#include "EmitterSettings.h"
+#include "rendering/materials/Shader.h"
+#include <cstdint>
+
+class Transform;
+
+/**
+ * Keeps the state of the Particle%s of a ParticleEmitter in gpu buffers.
+ * Particles are advanced by a transform feedback pass that reads from one
+ * buffer and writes into the other, the two buffers are swapped every update.
+ * New particles are spawned on the gpu from the EmitterSettings, thus the cpu
+ * never touches a single particle.
+ * Particle slots are used as a ring: when more than maxParticles particles are
+ * alive the oldest ones are replaced by the new ones.
+ */
+class GPUParticleSimulation
+{
+private:
+	/* Layout of a particle:
+	 * vec4 position (xyz) and elapsed time (w)
+	 * vec4 velocity (xyz) and duration (w)
+	 * vec4 initial rotation, final rotation, initial scale, final scale
+	 * vec2 initial gravity scale, final gravity scale */
+	static constexpr int FLOATS_PER_PARTICLE = 14;
+
+	std::uint32_t mMaxParticles = 0;
+
+	/** index of the buffer containing the current state */
+	std::uint32_t mCurrent = 0;
+	std::uint32_t mBuffers[2] = { 0, 0 };
+	std::uint32_t mUpdateVaos[2] = { 0, 0 };
+
+	/** next slot used to spawn a particle */
+	std::uint32_t mNextSlot = 0;
+	std::uint32_t mSeed = 0;
+
+	Shader mUpdateShader;
+	std::int32_t mDeltaMillisLocation = -1;
+	std::int32_t mGravityLocation = -1;
+	std::int32_t mSpawnStartLocation = -1;
+	std::int32_t mSpawnCountLocation = -1;
+	std::int32_t mMaxParticlesLocation = -1;
+	std::int32_t mSeedLocation = -1;
+	std::int32_t mPositionMinLocation = -1;
+	std::int32_t mPositionMaxLocation = -1;
+	std::int32_t mVelocityMinLocation = -1;
+	std::int32_t mVelocityMaxLocation = -1;
+	std::int32_t mDurationRangeLocation = -1;
+	std::int32_t mInitialRotationRangeLocation = -1;
+	std::int32_t mFinalRotationRangeLocation = -1;
+	std::int32_t mInitialScaleRangeLocation = -1;
+	std::int32_t mFinalScaleRangeLocation = -1;
+	std::int32_t mInitialGravityRangeLocation = -1;
+	std::int32_t mFinalGravityRangeLocation = -1;
+
+	/** Sets the vertex attributes describing a particle for the buffer currently bound */
+	static void setUpAttributes(std::uint32_t firstAttribute, std::uint32_t divisor);
+
+	void uploadSettings(const EmitterSettings& settings, const Transform& emitterTransform);
+
+public:
+	/**
+	 * Creates a new GPUParticleSimulation.
+	 * @param maxParticles the number of particle slots.
+	 */
+	explicit GPUParticleSimulation(std::uint32_t maxParticles);
+
+	GPUParticleSimulation(const GPUParticleSimulation&) = delete;
+	GPUParticleSimulation& operator=(const GPUParticleSimulation&) = delete;
+
+	/**
+	 * Spawns new particles and advances the simulation.
+	 * @param settings the settings used to spawn new particles.
+	 * @param emitterTransform the transform of the emitter.
+	 * @param toSpawn the number of particles to spawn.
+	 * @param deltaMillis the elapsed time in milliseconds.
+	 * @param gravity the gravity acceleration.
+	 */
+	void update(const EmitterSettings& settings, const Transform& emitterTransform, std::uint32_t toSpawn, float deltaMillis, float gravity);
+
+	/**
+	 * Writes a single Particle in the next free slot.
+	 * @param p the particle to emit.
+	 */
+	void emit(const Particle& p);
+
+	/**
+	 * Binds the buffer containing the current state and sets up per instance
+	 * attributes for it in the currently bound vao.
+	 * @param firstAttribute the location of the first attribute.
+	 */
+	void bindForRendering(std::uint32_t firstAttribute) const;
+
+	/**
+	 * @return the number of particle slots.
+	 */
+	std::uint32_t getMaxParticles() const;
+
+	~GPUParticleSimulation();
+};
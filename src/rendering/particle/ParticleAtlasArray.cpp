@@ -0,0 +1,97 @@
+#include "ParticleAtlasArray.h"
+#include "rendering/GLStateCache.h"
+#include <glad/glad.h>
+#include <algorithm>
+
+void ParticleAtlasArray::create()
+{
+	glGenTextures(1, &mArray);
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, mArray);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, LAYER_SIZE, LAYER_SIZE, MAX_LAYERS, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	glGenFramebuffers(1, &mReadFbo);
+	glGenFramebuffers(1, &mDrawFbo);
+}
+
+void ParticleAtlasArray::copyToLayer(const Texture& atlas, int layer, int width, int height)
+{
+	// the atlas is copied while a scene is being rendered, restore the current fbos
+	GLint oldDrawFbo, oldReadFbo;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &oldDrawFbo);
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &oldReadFbo);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, mReadFbo);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas.getId(), 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mDrawFbo);
+	glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, mArray, 0, layer);
+
+	// frame offsets start from the top of the atlas (see ParticleCalculation.glsl)
+	glBlitFramebuffer(0, 0, atlas.getWidth(), atlas.getHeight(), 0, LAYER_SIZE - height, width, LAYER_SIZE, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, oldDrawFbo);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, oldReadFbo);
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, mArray);
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+int ParticleAtlasArray::add(const Texture& atlas)
+{
+	int layer = getLayer(atlas);
+	if (layer != -1)
+		return layer;
+
+	if (!atlas || mAtlases.size() >= MAX_LAYERS)
+		return -1;
+
+	if (mArray == 0)
+		create();
+
+	const int width = std::min(atlas.getWidth(), LAYER_SIZE);
+	const int height = std::min(atlas.getHeight(), LAYER_SIZE);
+
+	layer = static_cast<int>(mAtlases.size());
+	copyToLayer(atlas, layer, width, height);
+	mAtlases.push_back(atlas);
+	mScales.push_back(glm::vec2{ width, height } / static_cast<float>(LAYER_SIZE));
+
+	return layer;
+}
+
+int ParticleAtlasArray::getLayer(const Texture& atlas) const
+{
+	for (std::size_t i = 0; i < mAtlases.size(); ++i)
+		if (mAtlases[i].getId() == atlas.getId())
+			return static_cast<int>(i);
+
+	return -1;
+}
+
+glm::vec2 ParticleAtlasArray::getScale(int layer) const
+{
+	return mScales[layer];
+}
+
+std::uint32_t ParticleAtlasArray::getId() const
+{
+	return mArray;
+}
+
+void ParticleAtlasArray::cleanUp()
+{
+	if (mArray != 0) {
+		GLStateCache::deleteTextures(1, &mArray);
+		glDeleteFramebuffers(1, &mReadFbo);
+		glDeleteFramebuffers(1, &mDrawFbo);
+		mArray = 0;
+	}
+
+	mAtlases.clear();
+	mScales.clear();
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "rendering/materials/Texture.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+/**
+ * A texture array containing the atlases of several ParticleEmitter%s.
+ * Atlases are copied into a layer when they are added, so that particles
+ * using different atlases can be rendered with a single draw call.
+ * Each atlas keeps its size in the top left corner of its layer, atlases
+ * larger than a layer are shrunk to fit.
+ */
+class ParticleAtlasArray
+{
+public:
+	/** width and height of each layer */
+	static constexpr int LAYER_SIZE = 1024;
+
+	/** maximum number of atlases */
+	static constexpr int MAX_LAYERS = 16;
+
+private:
+	std::uint32_t mArray = 0;
+	std::uint32_t mReadFbo = 0;
+	std::uint32_t mDrawFbo = 0;
+
+	/** atlas stored in each layer. Keeping a copy prevents their id from being reused */
+	std::vector<Texture> mAtlases;
+
+	/** fraction of each layer covered by its atlas */
+	std::vector<glm::vec2> mScales;
+
+	void create();
+
+	void copyToLayer(const Texture& atlas, int layer, int width, int height);
+
+public:
+	ParticleAtlasArray() = default;
+
+	ParticleAtlasArray(const ParticleAtlasArray&) = delete;
+	ParticleAtlasArray& operator=(const ParticleAtlasArray&) = delete;
+
+	/**
+	 * Copies an atlas into a new layer, unless it has already been added.
+	 * @param atlas the atlas.
+	 * @return the layer containing the atlas, -1 if the atlas is invalid or the array is full.
+	 */
+	int add(const Texture& atlas);
+
+	/**
+	 * @param atlas the atlas.
+	 * @return the layer containing the atlas, -1 if it has not been added.
+	 */
+	int getLayer(const Texture& atlas) const;
+
+	/**
+	 * Texture coordinates of an atlas must be multiplied by this scale to sample its layer.
+	 * @param layer the layer.
+	 * @return the fraction of the width and height of the layer covered by its atlas.
+	 */
+	glm::vec2 getScale(int layer) const;
+
+	/**
+	 * @return the id of the texture array.
+	 */
+	std::uint32_t getId() const;
+
+	/**
+	 * Deletes the texture array.
+	 */
+	void cleanUp();
+};
@@ -4,11 +4,13 @@
 #include "Engine.h"
 #include <glm/common.hpp>
 
-ParticleEmitter::ParticleEmitter(const GameObjectEH& go, std::uint32_t maxParticles) : Component{ go }, mMaxParticles{ maxParticles }
+ParticleEmitter::ParticleEmitter(const GameObjectEH& go, std::uint32_t maxParticles, SimulationMode mode)
+	: Component{ go }, mSimulationMode{ mode }, mParticles{ mode == SimulationMode::CPU ? maxParticles : 0 }
 {
 	mCrumb = Engine::eventManager.addListenerFor(EventManager::ENTER_FRAME_EVENT, this, true);
 
-	mParticles.reserve(maxParticles);
+	if (mSimulationMode == SimulationMode::GPU)
+		mGPUSimulation = std::make_unique<GPUParticleSimulation>(maxParticles);
 
 	Engine::particleRenderer.addEmitter(this);
 }
@@ -16,6 +18,7 @@ ParticleEmitter::ParticleEmitter(const GameObjectEH& go, std::uint32_t maxPartic
 void ParticleEmitter::setTextureAtlas(const Texture& texture, int frames, int rows, int cols)
 {
 	mParticleAtlas = texture;
+	Engine::particleRenderer.addAtlas(texture);
 	mFrames = frames;
 	mRows = rows;
 	mCols = cols;
@@ -24,13 +27,19 @@ void ParticleEmitter::setTextureAtlas(const Texture& texture, int frames, int ro
 	mColSize = 1.0f / mCols;
 }
 
+ParticleEmitter::SimulationMode ParticleEmitter::getSimulationMode() const
+{
+	return mSimulationMode;
+}
+
 bool ParticleEmitter::emit(const Particle& p)
 {
-	if (mParticles.size() >= mMaxParticles)
-		return false;
+	if (mSimulationMode == SimulationMode::GPU) {
+		mGPUSimulation->emit(p);
+		return true;
+	}
 
-	mParticles.push_back(p);
-	return true;
+	return mParticles.add(p);
 }
 
 void ParticleEmitter::start(float rate)
@@ -40,50 +49,37 @@ void ParticleEmitter::start(float rate)
 	mElapsedFromLastEmission = 0.0f;
 }
 
-void ParticleEmitter::onEvent(SDL_Event e)
+void ParticleEmitter::onFrameEvent(SDL_EventType, float deltaMillis)
 {
-	float delta = *(static_cast<float*>(e.user.data1));
-	float deltaSec = delta / 1000.0f;
+	float deltaSec = deltaMillis / 1000.0f;
 
 	/* generate new particles */
+	int particlesToEmit = 0;
 	if (mStarted) {
-		int particlesToEmit = static_cast<int>(mElapsedFromLastEmission / mSecondsPerParticle);
+		particlesToEmit = static_cast<int>(mElapsedFromLastEmission / mSecondsPerParticle);
 
 		mElapsedFromLastEmission -= particlesToEmit * mSecondsPerParticle;
-		for (int i = 0; i < particlesToEmit; i++) {
-			
-			Particle p;
-			settings.setUp(gameObject, p);
-			emit(p);
-		}
-
 		mElapsedFromLastEmission += deltaSec;
 	}
 
-	/* update existing particles */
-	auto it = mParticles.begin();
-	while (it != mParticles.end()) {
-		it->elapsedTime += delta;
-
-		Particle& p = *it;
-		p.position += p.velocity * deltaSec;
+	/* particles are spawned and updated on the gpu */
+	if (mSimulationMode == SimulationMode::GPU) {
+		mGPUSimulation->update(settings, gameObject->transform, particlesToEmit, deltaMillis, gravity);
+		return;
+	}
 
-		float lifePercent = p.elapsedTime / p.durationMillis;
-		p.velocity.y -= gravity * deltaSec * glm::mix(p.initialGravityScale, p.finalGravityScale, lifePercent);
+	settings.setUp(gameObject, mParticles, particlesToEmit);
 
-		if (it->elapsedTime > it->durationMillis)
-			it = mParticles.erase(it);
-		else
-			++it;
-	}
+	/* update existing particles and remove dead ones */
+	mParticles.update(deltaMillis, gravity);
 }
 
-const std::vector<Particle>& ParticleEmitter::getParticles() const
+const ParticlePool& ParticleEmitter::getParticles() const
 {
 	return mParticles;
 }
 
-std::vector<Particle>& ParticleEmitter::getParticles()
+ParticlePool& ParticleEmitter::getParticles()
 {
 	return mParticles;
 }
@@ -1,12 +1,15 @@
 #pragma once
 #include "components/Component.h"
 #include "Particle.h"
+#include "ParticlePool.h"
 #include "events/EventListener.h"
 #include "events/EventListenerCrumb.h"
 #include "rendering/materials/Texture.h"
 #include "EmitterSettings.h"
+#include "GPUParticleSimulation.h"
 #include <vector>
 #include <cstdint>
+#include <memory>
 
 /**
  * Emitter for particles.
@@ -16,14 +19,27 @@ class ParticleEmitter :
 {
 	friend class ParticleRenderer;
 
+public:
+	/** Where particles are simulated */
+	enum class SimulationMode {
+		/** particles are simulated on the cpu and uploaded every frame */
+		CPU,
+		/** particles live in gpu buffers and are simulated using transform feedback.
+		 * Particles are not sorted, additive blending works best in this mode */
+		GPU
+	};
+
 private:
 	static constexpr float gravity = 9.8f;
 
  	CrumbPtr mCrumb;
 
-	std::vector<Particle> mParticles;
+	SimulationMode mSimulationMode;
+
+	ParticlePool mParticles;
 
-	std::uint32_t mMaxParticles;
+	/** used instead of mParticles in SimulationMode::GPU */
+	std::unique_ptr<GPUParticleSimulation> mGPUSimulation;
 
 	float mSecondsPerParticle = 0.0f;
 	float mElapsedFromLastEmission = 0.0f;
@@ -44,8 +60,14 @@ public:
 	 * Creates a new ParticleEmitter.
 	 * @param go the GameObject that will emit particles.
 	 * @param maxParticles the maximum number of particles this system can emit.
+	 * @param mode where particles are simulated.
+	 */
+	ParticleEmitter(const GameObjectEH& go, std::uint32_t maxParticles, SimulationMode mode = SimulationMode::CPU);
+
+	/**
+	 * @return where particles of this emitter are simulated.
 	 */
-	ParticleEmitter(const GameObjectEH& go, std::uint32_t maxParticles);
+	SimulationMode getSimulationMode() const;
 
 	/**
 	 * Sets the Texture atlas used by this emitter.
@@ -58,7 +80,10 @@ public:
 
 	/**
 	 * Emits a Particle.
+	 * In SimulationMode::GPU the particle replaces the oldest one if
+	 * there is no free slot.
 	 * @param p the particle to emit.
+	 * @return false if the particle was not emitted because the emitter is full.
 	 */
 	bool emit(const Particle& p);
 
@@ -68,17 +93,17 @@ public:
 	 */
 	void start(float rate);
 
-	virtual void onEvent(SDL_Event e) override;
+	virtual void onFrameEvent(SDL_EventType type, float deltaMillis) override;
 
 	/**
-	 * @return all the particles handled by this emitter
+	 * @return all the particles handled by this emitter (always empty in SimulationMode::GPU)
 	 */
-	const std::vector<Particle>& getParticles() const;
+	const ParticlePool& getParticles() const;
 
 	/**
 	* @return all the particles handled by this emitter
 	*/
-	std::vector<Particle>& getParticles();
+	ParticlePool& getParticles();
 
 	~ParticleEmitter();
 };
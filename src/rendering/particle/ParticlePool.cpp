@@ -0,0 +1,150 @@
+#include "ParticlePool.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define PARTICLE_POOL_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// all the arrays of a pool, used to apply the same operation to every attribute
+static std::vector<float> ParticlePool::* const ATTRIBUTES[] = {
+	&ParticlePool::positionX, &ParticlePool::positionY, &ParticlePool::positionZ,
+	&ParticlePool::velocityX, &ParticlePool::velocityY, &ParticlePool::velocityZ,
+	&ParticlePool::initialGravityScale, &ParticlePool::finalGravityScale,
+	&ParticlePool::initialRotation, &ParticlePool::finalRotation,
+	&ParticlePool::initialScale, &ParticlePool::finalScale,
+	&ParticlePool::durationMillis, &ParticlePool::elapsedTime
+};
+
+ParticlePool::ParticlePool(std::uint32_t capacity) : mCapacity{ capacity }
+{
+	for (auto attribute : ATTRIBUTES)
+		(this->*attribute).resize(capacity);
+}
+
+std::uint32_t ParticlePool::allocate(std::uint32_t count)
+{
+	std::uint32_t allocated = std::min(count, mCapacity - mSize);
+	mSize += allocated;
+
+	return allocated;
+}
+
+bool ParticlePool::add(const Particle& p)
+{
+	if (allocate(1) == 0)
+		return false;
+
+	std::uint32_t i = mSize - 1;
+	positionX[i] = p.position.x;
+	positionY[i] = p.position.y;
+	positionZ[i] = p.position.z;
+	velocityX[i] = p.velocity.x;
+	velocityY[i] = p.velocity.y;
+	velocityZ[i] = p.velocity.z;
+	initialGravityScale[i] = p.initialGravityScale;
+	finalGravityScale[i] = p.finalGravityScale;
+	initialRotation[i] = p.initialRotation;
+	finalRotation[i] = p.finalRotation;
+	initialScale[i] = p.initialScale;
+	finalScale[i] = p.finalScale;
+	durationMillis[i] = p.durationMillis;
+	elapsedTime[i] = p.elapsedTime;
+
+	return true;
+}
+
+Particle ParticlePool::get(std::uint32_t index) const
+{
+	Particle p;
+	p.position = getPosition(index);
+	p.velocity = glm::vec3{ velocityX[index], velocityY[index], velocityZ[index] };
+	p.initialGravityScale = initialGravityScale[index];
+	p.finalGravityScale = finalGravityScale[index];
+	p.initialRotation = initialRotation[index];
+	p.finalRotation = finalRotation[index];
+	p.initialScale = initialScale[index];
+	p.finalScale = finalScale[index];
+	p.durationMillis = durationMillis[index];
+	p.elapsedTime = elapsedTime[index];
+
+	return p;
+}
+
+void ParticlePool::kill(std::uint32_t index)
+{
+	std::uint32_t last = mSize - 1;
+	if (index != last) {
+		for (auto attribute : ATTRIBUTES)
+			(this->*attribute)[index] = (this->*attribute)[last];
+	}
+
+	--mSize;
+}
+
+void ParticlePool::integrate(std::uint32_t begin, std::uint32_t end, float deltaMillis, float deltaSec, float gravity)
+{
+	for (std::uint32_t i = begin; i < end; ++i) {
+		elapsedTime[i] += deltaMillis;
+
+		positionX[i] += velocityX[i] * deltaSec;
+		positionY[i] += velocityY[i] * deltaSec;
+		positionZ[i] += velocityZ[i] * deltaSec;
+
+		float lifePercent = elapsedTime[i] / durationMillis[i];
+		velocityY[i] -= gravity * deltaSec * glm::mix(initialGravityScale[i], finalGravityScale[i], lifePercent);
+	}
+}
+
+void ParticlePool::removeDead()
+{
+	std::uint32_t i = 0;
+	while (i < mSize) {
+		if (elapsedTime[i] > durationMillis[i])
+			kill(i); // the last particle is moved here, check this slot again
+		else
+			++i;
+	}
+}
+
+void ParticlePool::update(float deltaMillis, float gravity)
+{
+	float deltaSec = deltaMillis / 1000.0f;
+	std::uint32_t i = 0;
+
+#ifdef PARTICLE_POOL_USE_SSE
+	const __m128 delta = _mm_set1_ps(deltaMillis);
+	const __m128 dt = _mm_set1_ps(deltaSec);
+	const __m128 gravityDt = _mm_set1_ps(gravity * deltaSec);
+
+	/* four particles at a time, the remaining ones are handled by integrate */
+	for (; i + 4 <= mSize; i += 4) {
+		__m128 elapsed = _mm_add_ps(_mm_loadu_ps(&elapsedTime[i]), delta);
+		_mm_storeu_ps(&elapsedTime[i], elapsed);
+
+		__m128 vx = _mm_loadu_ps(&velocityX[i]);
+		__m128 vy = _mm_loadu_ps(&velocityY[i]);
+		__m128 vz = _mm_loadu_ps(&velocityZ[i]);
+
+		_mm_storeu_ps(&positionX[i], _mm_add_ps(_mm_loadu_ps(&positionX[i]), _mm_mul_ps(vx, dt)));
+		_mm_storeu_ps(&positionY[i], _mm_add_ps(_mm_loadu_ps(&positionY[i]), _mm_mul_ps(vy, dt)));
+		_mm_storeu_ps(&positionZ[i], _mm_add_ps(_mm_loadu_ps(&positionZ[i]), _mm_mul_ps(vz, dt)));
+
+		__m128 lifePercent = _mm_div_ps(elapsed, _mm_loadu_ps(&durationMillis[i]));
+		__m128 initialGravity = _mm_loadu_ps(&initialGravityScale[i]);
+		__m128 finalGravity = _mm_loadu_ps(&finalGravityScale[i]);
+		__m128 gravityScale = _mm_add_ps(initialGravity, _mm_mul_ps(_mm_sub_ps(finalGravity, initialGravity), lifePercent));
+
+		_mm_storeu_ps(&velocityY[i], _mm_sub_ps(vy, _mm_mul_ps(gravityDt, gravityScale)));
+	}
+#endif
+
+	integrate(i, mSize, deltaMillis, deltaSec, gravity);
+
+	removeDead();
+}
+
+void ParticlePool::clear()
+{
+	mSize = 0;
+}
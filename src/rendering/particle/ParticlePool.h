@@ -0,0 +1,122 @@
+#pragma once
+#include "Particle.h"
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+/**
+ * Storage for the Particle%s of a ParticleEmitter.
+ * Particles are stored as a structure of arrays: each attribute lives in
+ * its own contiguous array so that the simulation can process several
+ * particles at once. Dead particles are removed by moving the last
+ * particle in their slot, thus the order of the particles is not preserved.
+ */
+class ParticlePool
+{
+private:
+	std::uint32_t mSize = 0;
+	std::uint32_t mCapacity = 0;
+
+	/** Integrates position and velocity of the particles in [begin, end) one by one */
+	void integrate(std::uint32_t begin, std::uint32_t end, float deltaMillis, float deltaSec, float gravity);
+
+	/** Removes all the particles whose lifetime is over */
+	void removeDead();
+
+public:
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> positionZ;
+
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> velocityZ;
+
+	std::vector<float> initialGravityScale;
+	std::vector<float> finalGravityScale;
+
+	std::vector<float> initialRotation;
+	std::vector<float> finalRotation;
+
+	std::vector<float> initialScale;
+	std::vector<float> finalScale;
+
+	std::vector<float> durationMillis;
+	std::vector<float> elapsedTime;
+
+	/**
+	 * Creates a new ParticlePool.
+	 * @param capacity the maximum number of particles this pool can contain.
+	 */
+	explicit ParticlePool(std::uint32_t capacity = 0);
+
+	/**
+	 * @return the number of alive particles.
+	 */
+	std::uint32_t size() const { return mSize; }
+
+	/**
+	 * @return the maximum number of particles this pool can contain.
+	 */
+	std::uint32_t capacity() const { return mCapacity; }
+
+	/**
+	 * Reserves space for new particles at the end of the pool.
+	 * The caller is responsible for initializing all the attributes of the
+	 * reserved particles.
+	 * @param count the number of particles to reserve.
+	 * @return the number of particles actually reserved (it can be less than
+	 * count if the pool is full). New particles start at size() - returned value.
+	 */
+	std::uint32_t allocate(std::uint32_t count);
+
+	/**
+	 * Adds a Particle to the pool.
+	 * @param p the particle to add.
+	 * @return false if the pool is full, true otherwise.
+	 */
+	bool add(const Particle& p);
+
+	/**
+	 * @param index the index of a particle.
+	 * @return a copy of the particle at index.
+	 */
+	Particle get(std::uint32_t index) const;
+
+	/**
+	 * @param index the index of a particle.
+	 * @return the position of the particle at index.
+	 */
+	glm::vec3 getPosition(std::uint32_t index) const
+	{
+		return glm::vec3{ positionX[index], positionY[index], positionZ[index] };
+	}
+
+	/**
+	 * @param index the index of a particle.
+	 * @return the elapsed fraction [0, 1] of the lifetime of the particle at index.
+	 */
+	float getLifePercent(std::uint32_t index) const
+	{
+		return elapsedTime[index] / durationMillis[index];
+	}
+
+	/**
+	 * Removes a particle. The last particle takes its place.
+	 * @param index the index of the particle to remove.
+	 */
+	void kill(std::uint32_t index);
+
+	/**
+	 * Advances the simulation of all particles and removes those whose
+	 * lifetime is over.
+	 * @param deltaMillis the elapsed time in milliseconds.
+	 * @param gravity the gravity acceleration.
+	 */
+	void update(float deltaMillis, float gravity);
+
+	/**
+	 * Removes all the particles.
+	 */
+	void clear();
+};
@@ -2,23 +2,11 @@
 #include "Engine.h"
 #include "rendering/mesh/MeshLoader.h"
 #include "rendering/mesh/MeshCreator.h"
+#include "rendering/GLStateCache.h"
 #include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-template <class Iterator, class Compare>
-void insertionSort(Iterator begin, Iterator end, Compare cmp) {
-	auto current = begin;
-	while (current != end) {
-		auto swapper = current;
-		while (swapper != begin && cmp(*(swapper - 1), *swapper)) {
-			std::swap(*swapper, *(swapper - 1));
-			swapper--;
-		}
-		current++;
-	}
-}
-
 std::vector<float> positions{
 	.5f, .5f, 0.0f,
 	.5f, -.5f, 0.0f,
@@ -35,9 +23,21 @@ void ParticleRenderer::init()
 {
 	prepareParticleQuad();
 
-	mParticleShader = Shader::loadFromFile(std::vector<std::string>{ "shaders/particleVS.glsl" }, {}, { "shaders/particleFS.glsl" });
+	mParticleShader = Shader::loadFromFile(std::vector<std::string>{ "shaders/ParticleCalculation.glsl", "shaders/particleVS.glsl" }, {}, { "shaders/particleFS.glsl" });
 	mParticleShader.use();
 	mFrameSizeLocation = mParticleShader.getLocationOf("frameSize");
+	mFramesLocation = mParticleShader.getLocationOf("frames");
+	mColsLocation = mParticleShader.getLocationOf("cols");
+
+	mGPUParticleShader = Shader::loadFromFile(std::vector<std::string>{ "shaders/ParticleCalculation.glsl", "shaders/particleGPUVS.glsl" }, {}, { "shaders/particleFS.glsl" });
+	mGPUParticleShader.use();
+	mGPUFrameSizeLocation = mGPUParticleShader.getLocationOf("frameSize");
+	mGPUFramesLocation = mGPUParticleShader.getLocationOf("frames");
+	mGPUColsLocation = mGPUParticleShader.getLocationOf("cols");
+
+	mSortedParticleShader = Shader::loadFromFile(std::vector<std::string>{ "shaders/ParticleCalculation.glsl", "shaders/particleSortedVS.glsl" }, {}, { "shaders/particleSortedFS.glsl" });
+	mSortedParticleShader.use();
+	mAtlasParamsLocation = mSortedParticleShader.getLocationOf("atlasParams");
 }
 
 
@@ -51,164 +51,292 @@ void ParticleRenderer::prepareParticleQuad()
 
 	int stride = FLOATS_PER_PARTICLE * sizeof(float);
 	loader.addAttribPointer(GL_ARRAY_BUFFER, mParticleDataVBO, stride, 4, GL_FLOAT, 0);
-	loader.addAttribPointer(GL_ARRAY_BUFFER, mParticleDataVBO, stride, 4, GL_FLOAT, 4 * sizeof(float));
-	loader.addAttribPointer(GL_ARRAY_BUFFER, mParticleDataVBO, stride, 4, GL_FLOAT, 8 * sizeof(float));
-	loader.addAttribPointer(GL_ARRAY_BUFFER, mParticleDataVBO, stride, 4, GL_FLOAT, 12 * sizeof(float));
+	loader.addAttribPointer(GL_ARRAY_BUFFER, mParticleDataVBO, stride, 2, GL_FLOAT, 4 * sizeof(float));
+
+	mParticleMesh = loader.getMesh(0, indices.size());
 
-	loader.addAttribPointer(GL_ARRAY_BUFFER, mParticleDataVBO, stride, 4, GL_FLOAT, 16 * sizeof(float));
+	// per instance attributes are bound for each emitter, see GPUParticleSimulation::bindForRendering
+	MeshLoader gpuLoader;
+	gpuLoader.loadData(positions.data(), positions.size(), 3);
+	gpuLoader.loadData(indices.data(), indices.size(), 0, GL_ELEMENT_ARRAY_BUFFER, GL_UNSIGNED_INT, false);
+	mGPUParticleMesh = gpuLoader.getMesh(0, indices.size());
 
-	loader.addAttribPointer(GL_ARRAY_BUFFER, mParticleDataVBO, stride, 1, GL_FLOAT, 20 * sizeof(float));
+	MeshLoader sortedLoader;
+	sortedLoader.loadData(positions.data(), positions.size(), 3);
+	sortedLoader.loadData(indices.data(), indices.size(), 0, GL_ELEMENT_ARRAY_BUFFER, GL_UNSIGNED_INT, false);
 
-	mParticleMesh = loader.getMesh(0, indices.size());
+	mSortedParticleDataVBO = sortedLoader.loadData<float>(nullptr, MAX_PARTICLES * FLOATS_PER_SORTED_PARTICLE, 0, GL_ARRAY_BUFFER, GL_FLOAT, false, GL_STREAM_DRAW);
+
+	int sortedStride = FLOATS_PER_SORTED_PARTICLE * sizeof(float);
+	sortedLoader.addAttribPointer(GL_ARRAY_BUFFER, mSortedParticleDataVBO, sortedStride, 4, GL_FLOAT, 0);
+	sortedLoader.addAttribPointer(GL_ARRAY_BUFFER, mSortedParticleDataVBO, sortedStride, 4, GL_FLOAT, 4 * sizeof(float));
+
+	mSortedParticleMesh = sortedLoader.getMesh(0, indices.size());
 }
 
-void ParticleRenderer::updateParticleVBO(const std::vector<float>& data)
+void ParticleRenderer::updateParticleVBO(std::uint32_t vbo, const std::vector<float>& data)
 {
-	glBindBuffer(GL_ARRAY_BUFFER, mParticleDataVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
 	glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), nullptr, GL_STREAM_DRAW);
 	glBufferSubData(GL_ARRAY_BUFFER, 0, data.size() * sizeof(float), data.data());
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void ParticleRenderer::computeInverseViewMatrix()
+void ParticleRenderer::storeParticleData(const ParticlePool& particles, std::uint32_t index, const ParticleEmitter* emitter, std::vector<float>& data)
 {
-	glm::mat4 viewMatrix = Engine::renderSys.getViewMatrix(Engine::renderSys.getCamera()->transform);
+	float lifePercent = particles.getLifePercent(index);
+	float rotation = glm::mix(particles.initialRotation[index], particles.finalRotation[index], lifePercent);
+	float scale = glm::mix(particles.initialScale[index], particles.finalScale[index], lifePercent);
 
-	glm::mat3 counterRotation = glm::transpose(glm::mat3{ viewMatrix });
+	// the integer part is the current frame, the fractional part the blend factor with the next one
+	float frame = (emitter->mFrames - 1) * lifePercent;
 
-	mInverseView = glm::mat4(counterRotation);
-	mInverseView[3][3] = 1.0f;
+	data.insert(data.end(), {
+		particles.positionX[index], particles.positionY[index], particles.positionZ[index], rotation,
+		scale, frame
+	});
 }
 
-void ParticleRenderer::storeModelMatrix(const Particle& p, std::vector<float>& data)
+void ParticleRenderer::addEmitter(ParticleEmitter* emitter)
 {
-	float lifePercent = p.elapsedTime / p.durationMillis;
-	float rotation = glm::mix(p.initialRotation, p.finalRotation, lifePercent);
-	float scale = glm::mix(p.initialScale, p.finalScale, lifePercent);
+	mEmitters.push_back(emitter);
+	addAtlas(emitter->mParticleAtlas);
+}
 
-	glm::mat4 transform = glm::mat4{ 1.0f };
-	float ssin = scale * glm::sin(rotation);
-	float scos = scale * glm::cos(rotation);
+void ParticleRenderer::removeEmitter(const ParticleEmitter* emitter)
+{
+	mEmitters.erase(std::remove(mEmitters.begin(), mEmitters.end(), emitter), mEmitters.end());
+}
 
-	transform[0] = glm::vec4{ scos, ssin, 0, 0 };
-	transform[1] = glm::vec4{ -ssin, scos, 0, 0 };
-	transform[2] = glm::vec4{ 0, 0, scale, 0 };
-	transform[3] = glm::vec4{ p.position, 1.0f };
+void ParticleRenderer::addAtlas(const Texture& atlas)
+{
+	if (atlas && mAtlasArray.getLayer(atlas) == -1)
+		mPendingAtlases.push_back(atlas);
+}
 
-	// TODO avoid this transformation here, it is heavy
-	transform = transform * mInverseView;
+void ParticleRenderer::addPendingAtlases()
+{
+	// the texture array is only created if particles are sorted across emitters
+	for (const Texture& atlas : mPendingAtlases)
+		mAtlasArray.add(atlas);
 
-	data.insert(data.end(), glm::value_ptr(transform), glm::value_ptr(transform) + 16);
+	mPendingAtlases.clear();
 }
 
-
-void ParticleRenderer::storeOffsetsAndBlendFactor(const Particle& p, const ParticleEmitter* emitter, std::vector<float>& data)
+void ParticleRenderer::render()
 {
-	float lifePercentage = p.elapsedTime / p.durationMillis;
-	float percentage = (emitter->mFrames - 1) * lifePercentage;
-	int frame = static_cast<int>(percentage);
-	float blend = percentage - frame;
+	GLStateCache::depthMask(GL_FALSE);
+
+	if (sortAcrossEmitters)
+		addPendingAtlases();
 
-	int col = frame % emitter->mCols;
-	int row = frame / emitter->mCols;
+	mSortedEmitters.clear();
+	for (const auto emitter : mEmitters) {
+		// rendered later, together with the other sorted emitters
+		if (sortAcrossEmitters && canSortAcrossEmitters(emitter)) {
+			mSortedEmitters.push_back(emitter);
+			continue;
+		}
 
-	auto offset = glm::vec4{
-			col * emitter->mColSize,
-			1.0f - row * emitter->mRowSize,
-			col * emitter->mColSize,
-			1.0f - row * emitter->mRowSize,
-	};
+		if (emitter->settings.useAlphaBlending) {
+			GLStateCache::enable(GL_BLEND);
+			GLStateCache::blendFunc(emitter->settings.sfactor, emitter->settings.dfactor);
+		}
+		setUpTextureAtlas(emitter);
 
-	if (frame != emitter->mFrames - 1) {
-		col = (frame + 1) % emitter->mCols;
-		row = (frame + 1) / emitter->mCols;
+		if (emitter->getSimulationMode() == ParticleEmitter::SimulationMode::GPU)
+			renderGPUParticles(emitter);
+		else
+			renderParticles(emitter);
 
-		offset[2] = col * emitter->mColSize;
-		offset[3] = 1.0f - row * emitter->mRowSize;
+		GLStateCache::disable(GL_BLEND);
 	}
 
-	data.insert(data.end(), glm::value_ptr(offset), glm::value_ptr(offset) + 4);
-	data.push_back(blend);
-}
+	if (!mSortedEmitters.empty())
+		renderSortedParticles();
 
-void ParticleRenderer::addEmitter(ParticleEmitter* emitter)
-{
-	mEmitters.push_back(emitter);
+	GLStateCache::depthMask(GL_TRUE);
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+	GLStateCache::bindVertexArray(0);
+
+	GLStateCache::disable(GL_BLEND);
 }
 
-void ParticleRenderer::removeEmitter(const ParticleEmitter* emitter)
+void ParticleRenderer::sortParticles(const ParticlePool& particles)
 {
-	mEmitters.erase(std::remove(mEmitters.begin(), mEmitters.end(), emitter), mEmitters.end());
+	const glm::vec3& camPosition = Engine::renderSys.getCamera()->transform.getPosition();
+
+	mDistances.resize(particles.size());
+	mSortedIndices.resize(particles.size());
+	for (std::uint32_t i = 0; i < particles.size(); ++i) {
+		glm::vec3 toCamera = particles.getPosition(i) - camPosition;
+		mDistances[i] = glm::dot(toCamera, toCamera);
+		mSortedIndices[i] = i;
+	}
+
+	// farthest particles are rendered first
+	std::sort(mSortedIndices.begin(), mSortedIndices.end(), [this](std::uint32_t a, std::uint32_t b) {
+		return mDistances[a] > mDistances[b];
+	});
 }
 
-void ParticleRenderer::render()
+void ParticleRenderer::renderParticles(ParticleEmitter* emitter)
 {
-	computeInverseViewMatrix();
+	const ParticlePool& particles = emitter->getParticles();
 
-	glBindVertexArray(mParticleMesh.getVao());
+	GLStateCache::bindVertexArray(mParticleMesh.getVao());
 	mParticleShader.use();
+	mParticleShader.setVec2(mFrameSizeLocation, glm::vec2{ emitter->mColSize, emitter->mRowSize });
+	mParticleShader.setInt(mFramesLocation, emitter->mFrames);
+	mParticleShader.setInt(mColsLocation, emitter->mCols);
 
-	glDepthMask(GL_FALSE);
+	sortParticles(particles);
 
-	for (const auto emitter : mEmitters) {
-		if (emitter->settings.useAlphaBlending) {
-			glEnable(GL_BLEND);
-			glBlendFunc(emitter->settings.sfactor, emitter->settings.dfactor);
-		}
-		setUpTextureAtlas(emitter);
+	mParticleData.clear();
+	mParticleData.reserve(particles.size() * FLOATS_PER_PARTICLE);
 
-		renderParticles(emitter);
+	for (std::uint32_t index : mSortedIndices)
+		storeParticleData(particles, index, emitter, mParticleData);
 
-		glDisable(GL_BLEND);
-	}
+	updateParticleVBO(mParticleDataVBO, mParticleData);
 
-	glDepthMask(GL_TRUE);
+	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, particles.size());
+}
+
+void ParticleRenderer::renderGPUParticles(ParticleEmitter* emitter)
+{
+	const GPUParticleSimulation& simulation = *emitter->mGPUSimulation;
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::bindVertexArray(mGPUParticleMesh.getVao());
+	simulation.bindForRendering(1);
 
-	glBindVertexArray(0);
+	mGPUParticleShader.use();
+	mGPUParticleShader.setVec2(mGPUFrameSizeLocation, glm::vec2{ emitter->mColSize, emitter->mRowSize });
+	mGPUParticleShader.setInt(mGPUFramesLocation, emitter->mFrames);
+	mGPUParticleShader.setInt(mGPUColsLocation, emitter->mCols);
 
-	glDisable(GL_BLEND);
+	// dead particles are discarded in the vertex shader
+	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, simulation.getMaxParticles());
 }
 
-void ParticleRenderer::renderParticles(ParticleEmitter* emitter)
+bool ParticleRenderer::canSortAcrossEmitters(const ParticleEmitter* emitter) const
 {
-	std::vector<Particle>& particles = emitter->getParticles();
+	return emitter->getSimulationMode() == ParticleEmitter::SimulationMode::CPU
+		&& emitter->settings.useAlphaBlending
+		&& mSortedEmitters.size() < MAX_SORTED_EMITTERS
+		&& mAtlasArray.getLayer(emitter->mParticleAtlas) != -1;
+}
 
-	const glm::vec3& camPosition = Engine::renderSys.getCamera()->transform.getPosition();
+std::uint8_t ParticleRenderer::getBlendGroup(const EmitterSettings& settings)
+{
+	auto blendFunction = std::make_pair(settings.sfactor, settings.dfactor);
+	auto group = std::find(mBlendFunctions.begin(), mBlendFunctions.end(), blendFunction);
+	if (group != mBlendFunctions.end())
+		return static_cast<std::uint8_t>(group - mBlendFunctions.begin());
 
-	insertionSort(particles.begin(), particles.end(), [&camPosition](const auto& p, const auto& p2) {
-		return glm::distance2(p.position, camPosition) < glm::distance2(p2.position, camPosition);
-	});
+	mBlendFunctions.push_back(blendFunction);
+	return static_cast<std::uint8_t>(mBlendFunctions.size() - 1);
+}
+
+void ParticleRenderer::gatherSortedParticles()
+{
+	const Transform& cameraTransform = Engine::renderSys.getCamera()->transform;
+	glm::vec3 camPosition = cameraTransform.getPosition();
+	glm::vec3 camForward = cameraTransform.forward();
+
+	mAtlasParams.clear();
+	mBlendFunctions.clear();
+	mBlendGroups.clear();
+	mUnsortedData.clear();
+	mSortKeys.clear();
+	mSortValues.clear();
+
+	for (std::size_t e = 0; e < mSortedEmitters.size(); ++e) {
+		const ParticleEmitter* emitter = mSortedEmitters[e];
+		const ParticlePool& particles = emitter->getParticles();
+
+		int atlasLayer = mAtlasArray.getLayer(emitter->mParticleAtlas);
+		float layer = static_cast<float>(atlasLayer);
+		std::uint8_t blendGroup = getBlendGroup(emitter->settings);
+
+		// frames are sampled in the part of the layer covered by the atlas
+		glm::vec2 frameSize = glm::vec2{ emitter->mColSize, emitter->mRowSize } * mAtlasArray.getScale(atlasLayer);
+		mAtlasParams.push_back(glm::vec4{ frameSize, emitter->mFrames, emitter->mCols });
+
+		for (std::uint32_t i = 0; i < particles.size(); ++i) {
+			float depth = glm::dot(particles.getPosition(i) - camPosition, camForward);
+
+			// keys are sorted in ascending order, invert them to render far particles first
+			mSortKeys.push_back(~RadixSort::floatToKey(depth));
+			mSortValues.push_back(static_cast<std::uint32_t>(mBlendGroups.size()));
+			mBlendGroups.push_back(blendGroup);
+
+			storeParticleData(particles, i, emitter, mUnsortedData);
+			mUnsortedData.push_back(layer);
+			mUnsortedData.push_back(static_cast<float>(e));
+		}
+	}
+}
 
-	std::vector<float> data;
-	data.reserve(particles.size() * FLOATS_PER_PARTICLE);
+void ParticleRenderer::renderSortedParticles()
+{
+	gatherSortedParticles();
+	if (mSortKeys.empty()) return;
 
-	for (const auto& p : emitter->getParticles()) {
-		storeModelMatrix(p, data);
-		storeOffsetsAndBlendFactor(p, emitter, data);
+	mRadixSort.sort(mSortKeys, mSortValues);
+
+	mParticleData.clear();
+	mParticleData.reserve(mUnsortedData.size());
+	for (std::uint32_t index : mSortValues) {
+		auto particleData = mUnsortedData.begin() + index * FLOATS_PER_SORTED_PARTICLE;
+		mParticleData.insert(mParticleData.end(), particleData, particleData + FLOATS_PER_SORTED_PARTICLE);
 	}
 
-	updateParticleVBO(data);
+	updateParticleVBO(mSortedParticleDataVBO, mParticleData);
 
-	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, particles.size());
+	GLStateCache::bindVertexArray(mSortedParticleMesh.getVao());
+	mSortedParticleShader.use();
+	mSortedParticleShader.setVec4Array(mAtlasParamsLocation, mAtlasParams);
+
+	GLStateCache::activeTexture(GL_TEXTURE0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, mAtlasArray.getId());
+
+	/* one draw call for each run of particles sharing the same blending function */
+	GLStateCache::enable(GL_BLEND);
+	std::size_t count = mSortValues.size();
+	std::size_t first = 0;
+	while (first < count) {
+		std::uint8_t group = mBlendGroups[mSortValues[first]];
+		std::size_t last = first + 1;
+		while (last < count && mBlendGroups[mSortValues[last]] == group)
+			++last;
+
+		GLStateCache::blendFunc(mBlendFunctions[group].first, mBlendFunctions[group].second);
+		glDrawElementsInstancedBaseInstance(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, last - first, first);
+
+		first = last;
+	}
+	GLStateCache::disable(GL_BLEND);
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
 }
 
 void ParticleRenderer::setUpTextureAtlas(const ParticleEmitter* emitter)
 {
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, emitter->mParticleAtlas.getId());
-
-	const Texture& atlas = emitter->mParticleAtlas;
-
-	mParticleShader.setVec2(mFrameSizeLocation, glm::vec2{ emitter->mColSize, emitter->mRowSize });
+	GLStateCache::activeTexture(GL_TEXTURE0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, emitter->mParticleAtlas.getId());
 }
 
 
 void ParticleRenderer::cleanUp()
 {
 	mParticleShader = Shader();
+	mGPUParticleShader = Shader();
+	mSortedParticleShader = Shader();
+	mAtlasArray.cleanUp();
 }
 
 ParticleRenderer::~ParticleRenderer()
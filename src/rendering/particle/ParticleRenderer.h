@@ -1,6 +1,8 @@
 #pragma once
 #include "ParticleEmitter.h"
 #include "Particle.h"
+#include "ParticleAtlasArray.h"
+#include "RadixSort.h"
 #include "rendering/materials/Shader.h"
 #include "rendering/mesh/Mesh.h"
 #include <vector>
@@ -16,34 +18,99 @@ class ParticleRenderer
 {
 private:
 	static constexpr int MAX_PARTICLES = 10000;
-	static constexpr int FLOATS_PER_PARTICLE = 21;
+	/* position and rotation, scale and frame. Particles are rotated towards
+	 * the camera in the vertex shader */
+	static constexpr int FLOATS_PER_PARTICLE = 6;
+
+	/* max number of emitters sorted together, keep in sync with particleSortedVS.glsl */
+	static constexpr int MAX_SORTED_EMITTERS = 32;
+	/* same as FLOATS_PER_PARTICLE plus atlas layer and emitter index */
+	static constexpr int FLOATS_PER_SORTED_PARTICLE = 8;
 
 	std::vector<ParticleEmitter*> mEmitters;
 
 	Shader mParticleShader;
 	std::int32_t mFrameSizeLocation;
+	std::int32_t mFramesLocation;
+	std::int32_t mColsLocation;
 
 	Mesh mParticleMesh;
-	
+
+	/* used to render emitters in ParticleEmitter::SimulationMode::GPU */
+	Shader mGPUParticleShader;
+	std::int32_t mGPUFrameSizeLocation;
+	std::int32_t mGPUFramesLocation;
+	std::int32_t mGPUColsLocation;
+	Mesh mGPUParticleMesh;
+
+	/* used to render the particles of several emitters sorted together */
+	Shader mSortedParticleShader;
+	std::int32_t mAtlasParamsLocation;
+	Mesh mSortedParticleMesh;
+	std::uint32_t mSortedParticleDataVBO = 0;
+	ParticleAtlasArray mAtlasArray;
+	RadixSort mRadixSort;
+
+	/** atlases registered with addAtlas, copied into mAtlasArray the next time particles are sorted across emitters */
+	std::vector<Texture> mPendingAtlases;
+
+	/** emitters whose particles are sorted together in the current frame */
+	std::vector<ParticleEmitter*> mSortedEmitters;
+	/** frame size, number of frames and columns of the atlas of each sorted emitter */
+	std::vector<glm::vec4> mAtlasParams;
+	/** blending functions used by the sorted emitters */
+	std::vector<std::pair<GLenum, GLenum>> mBlendFunctions;
+	/** per particle index in mBlendFunctions (in gathering order) */
+	std::vector<std::uint8_t> mBlendGroups;
+	/** particle data in gathering order */
+	std::vector<float> mUnsortedData;
+	std::vector<std::uint32_t> mSortKeys;
+	std::vector<std::uint32_t> mSortValues;
+
 	std::uint32_t mParticleDataVBO = 0;
 
-	glm::mat4 mInverseView;
+	/** per particle data sent to the gpu, reused across emitters and frames */
+	std::vector<float> mParticleData;
+
+	/** distance from the camera of each particle of the emitter being rendered */
+	std::vector<float> mDistances;
+
+	/** indices of the particles of the emitter being rendered, sorted back to front */
+	std::vector<std::uint32_t> mSortedIndices;
 
 	void renderParticles(ParticleEmitter* emitter);
 
-	void storeModelMatrix(const Particle& p, std::vector<float>& data);
+	void renderGPUParticles(ParticleEmitter* emitter);
+
+	bool canSortAcrossEmitters(const ParticleEmitter* emitter) const;
+
+	void addPendingAtlases();
+
+	std::uint8_t getBlendGroup(const EmitterSettings& settings);
+
+	void gatherSortedParticles();
 
-	void storeOffsetsAndBlendFactor(const Particle& p, const ParticleEmitter* emitter, std::vector<float>& data);
+	void renderSortedParticles();
+
+	void sortParticles(const ParticlePool& particles);
+
+	void storeParticleData(const ParticlePool& particles, std::uint32_t index, const ParticleEmitter* emitter, std::vector<float>& data);
 
 	void setUpTextureAtlas(const ParticleEmitter* emitter);
 
 	void prepareParticleQuad();
 
-	void updateParticleVBO(const std::vector<float>& data);
-
-	void computeInverseViewMatrix();
+	void updateParticleVBO(std::uint32_t vbo, const std::vector<float>& data);
 
 public:
+	/**
+	 * If true, the particles of all the alpha blended emitters simulated on the
+	 * cpu are sorted together, so that overlapping emitters blend correctly.
+	 * Their atlases are copied into a texture array and particles are rendered
+	 * with one draw call per blending function.
+	 */
+	bool sortAcrossEmitters = false;
+
 	ParticleRenderer() = default;
 
 	/**
@@ -66,6 +133,14 @@ public:
 	 */
 	void removeEmitter(const ParticleEmitter* emitter);
 
+	/**
+	 * Registers the atlas of an emitter, so that its particles can be sorted together
+	 * with the ones of other emitters (see sortAcrossEmitters).
+	 * ParticleEmitter%s call this method automatically when their atlas is set.
+	 * @param atlas the atlas.
+	 */
+	void addAtlas(const Texture& atlas);
+
 	/**
 	 * Renders the particles.
 	 */
@@ -0,0 +1,96 @@
+#include "RadixSort.h"
+#include "Engine.h"
+#include <future>
+#include <algorithm>
+#include <cstring>
+
+// runs task(chunk) for every chunk on the job system, the first one on the calling thread
+template <typename Task>
+static void forEachChunk(std::size_t chunks, const Task& task)
+{
+	std::vector<std::future<void>> pending;
+	for (std::size_t c = 1; c < chunks; ++c)
+		pending.push_back(Engine::jobSystem.submit([&task, c]() { task(c); }));
+
+	task(0);
+
+	for (auto& future : pending)
+		Engine::jobSystem.wait(future);
+}
+
+void RadixSort::sort(std::vector<std::uint32_t>& keys, std::vector<std::uint32_t>& values)
+{
+	const std::size_t n = keys.size();
+	if (n < 2) return;
+
+	mTmpKeys.resize(n);
+	mTmpValues.resize(n);
+
+	// one chunk per worker plus one for the calling thread
+	std::size_t maxChunks = Engine::jobSystem.getWorkersNumber() + 1;
+	std::size_t chunks = std::clamp<std::size_t>(n / MIN_CHUNK_SIZE, 1, maxChunks);
+	std::size_t chunkSize = (n + chunks - 1) / chunks;
+	mHistograms.resize(chunks);
+
+	std::uint32_t* srcKeys = keys.data();
+	std::uint32_t* srcValues = values.data();
+	std::uint32_t* dstKeys = mTmpKeys.data();
+	std::uint32_t* dstValues = mTmpValues.data();
+	bool sortedInTmp = false;
+
+	for (std::uint32_t shift = 0; shift < 32; shift += 8) {
+		/* count the occurrences of each digit per chunk */
+		forEachChunk(chunks, [&](std::size_t c) {
+			auto& histogram = mHistograms[c];
+			histogram.fill(0);
+			std::size_t end = std::min(n, (c + 1) * chunkSize);
+			for (std::size_t i = c * chunkSize; i < end; ++i)
+				histogram[(srcKeys[i] >> shift) & 0xFF]++;
+		});
+
+		/* turn counts into the position where each chunk writes each digit.
+		 * Chunks of the same digit are written in order so the sort is stable */
+		std::uint32_t offset = 0;
+		bool singleDigit = false;
+		for (std::size_t digit = 0; digit < 256; ++digit) {
+			std::uint32_t digitStart = offset;
+			for (auto& histogram : mHistograms) {
+				std::uint32_t count = histogram[digit];
+				histogram[digit] = offset;
+				offset += count;
+			}
+			singleDigit |= (offset - digitStart) == n;
+		}
+
+		// all keys have the same digit, nothing to do for this pass
+		if (singleDigit) continue;
+
+		forEachChunk(chunks, [&](std::size_t c) {
+			auto& positions = mHistograms[c];
+			std::size_t end = std::min(n, (c + 1) * chunkSize);
+			for (std::size_t i = c * chunkSize; i < end; ++i) {
+				std::uint32_t position = positions[(srcKeys[i] >> shift) & 0xFF]++;
+				dstKeys[position] = srcKeys[i];
+				dstValues[position] = srcValues[i];
+			}
+		});
+
+		std::swap(srcKeys, dstKeys);
+		std::swap(srcValues, dstValues);
+		sortedInTmp = !sortedInTmp;
+	}
+
+	if (sortedInTmp) {
+		keys.swap(mTmpKeys);
+		values.swap(mTmpValues);
+	}
+}
+
+std::uint32_t RadixSort::floatToKey(float value)
+{
+	std::uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	// negative numbers: reverse their order, positive numbers: put them after the negative ones
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+
+/**
+ * Sorts key/value pairs by key using a least significant digit radix sort.
+ * The sort is stable and runs in linear time. Large inputs are split in
+ * chunks processed in parallel. Scratch memory is kept between calls so
+ * that sorting every frame does not allocate.
+ */
+class RadixSort
+{
+private:
+	/** inputs smaller than this are sorted on the calling thread only */
+	static constexpr std::size_t MIN_CHUNK_SIZE = 32768;
+
+	std::vector<std::uint32_t> mTmpKeys;
+	std::vector<std::uint32_t> mTmpValues;
+
+	/** one histogram (then one offset table) per chunk */
+	std::vector<std::array<std::uint32_t, 256>> mHistograms;
+
+public:
+	/**
+	 * Sorts keys in ascending order, values are moved together with their keys.
+	 * @param keys the keys to sort.
+	 * @param values the values associated to keys (same size as keys).
+	 */
+	void sort(std::vector<std::uint32_t>& keys, std::vector<std::uint32_t>& values);
+
+	/**
+	 * Converts a float into a key so that the order of keys follows the order of the floats.
+	 * @param value the value to convert.
+	 * @return a key for value.
+	 */
+	static std::uint32_t floatToKey(float value);
+};
@@ -0,0 +1,100 @@
+#include "rendering/shadow/CascadedShadowMap.h"
+#include "rendering/GLStateCache.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <iostream>
+
+void CascadedShadowMap::createArray(std::uint32_t& depthArray, std::array<std::uint32_t, MAX_CASCADES>& fbos)
+{
+	glGenTextures(1, &depthArray);
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, mWidth, mHeight, mCascadesNumber, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	glGenFramebuffers(mCascadesNumber, fbos.data());
+	for (std::uint32_t i = 0; i < mCascadesNumber; ++i) {
+		glBindFramebuffer(GL_FRAMEBUFFER, fbos[i]);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, i);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "CascadedShadowMap frame buffer is incomplete\n";
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CascadedShadowMap::invalidateStaticCache()
+{
+	mStaticLayerValid.fill(false);
+}
+
+void CascadedShadowMap::create(std::uint32_t width, std::uint32_t height, std::uint32_t cascadesNumber, bool cacheStaticShadows)
+{
+	cleanUp();
+
+	mWidth = width;
+	mHeight = height;
+	mCascadesNumber = std::clamp<std::uint32_t>(cascadesNumber, 1, MAX_CASCADES);
+
+	createArray(mDepthArray, mFbos);
+	if (cacheStaticShadows)
+		createArray(mStaticDepthArray, mStaticFbos);
+
+	// forces the cascades to be fitted again
+	mFittedCameraTransform = glm::mat4{ 0.0f };
+	invalidateStaticCache();
+}
+
+std::uint32_t CascadedShadowMap::getId() const
+{
+	return mDepthArray;
+}
+
+bool CascadedShadowMap::cachesStaticShadows() const
+{
+	return mStaticDepthArray != 0;
+}
+
+std::uint32_t CascadedShadowMap::getCascadesNumber() const
+{
+	return mCascadesNumber;
+}
+
+float CascadedShadowMap::getFarDistance(std::uint32_t cascade) const
+{
+	return mFarDistances[cascade];
+}
+
+const glm::mat4& CascadedShadowMap::getToLightSpace(std::uint32_t cascade) const
+{
+	return mToLightSpace[cascade];
+}
+
+void CascadedShadowMap::cleanUp()
+{
+	if (mDepthArray != 0) {
+		glDeleteFramebuffers(mCascadesNumber, mFbos.data());
+		GLStateCache::deleteTextures(1, &mDepthArray);
+		mDepthArray = 0;
+		mFbos.fill(0);
+	}
+
+	if (mStaticDepthArray != 0) {
+		glDeleteFramebuffers(mCascadesNumber, mStaticFbos.data());
+		GLStateCache::deleteTextures(1, &mStaticDepthArray);
+		mStaticDepthArray = 0;
+		mStaticFbos.fill(0);
+	}
+
+	mCascadesNumber = 0;
+}
+
+CascadedShadowMap::~CascadedShadowMap()
+{
+	cleanUp();
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+/**
+ * The shadow map of a DirectionalLight.
+ * The view frustum of the camera is split in slices along its depth and each slice
+ * (cascade) is rendered into its own layer of a depth texture array, so that the cascades
+ * close to the camera get more texels per world unit than those far away.
+ * The shadows of static GameObject%s can be cached in a second texture array: each
+ * cascade is then initialized copying its cached layer and only dynamic GameObject%s
+ * are rendered on top of it.
+ * @sa ShadowMappingSettings::cascadesNumber
+ */
+class CascadedShadowMap
+{
+	friend class RenderSystem;
+	friend class ShadowMappingSettings;
+
+public:
+	/** maximum number of cascades */
+	static constexpr std::uint32_t MAX_CASCADES = 4;
+
+private:
+	std::uint32_t mDepthArray = 0;
+
+	/** one fbo for each layer of mDepthArray */
+	std::array<std::uint32_t, MAX_CASCADES> mFbos{};
+
+	std::uint32_t mCascadesNumber = 0;
+
+	/** view space depth at which each cascade ends */
+	std::array<float, MAX_CASCADES> mFarDistances{};
+
+	/** world to light space transformation of each cascade */
+	std::array<glm::mat4, MAX_CASCADES> mToLightSpace;
+
+	/** camera transformation the cascades have been fitted to */
+	glm::mat4 mFittedCameraTransform{ 0.0f };
+
+	/** depth of the static GameObjects only, 0 if static shadows are not cached */
+	std::uint32_t mStaticDepthArray = 0;
+	std::array<std::uint32_t, MAX_CASCADES> mStaticFbos{};
+
+	/** mToLightSpace when each cached layer was rendered */
+	std::array<glm::mat4, MAX_CASCADES> mStaticToLightSpace;
+	std::array<bool, MAX_CASCADES> mStaticLayerValid{};
+
+	std::uint32_t mWidth = 0;
+	std::uint32_t mHeight = 0;
+
+	void createArray(std::uint32_t& depthArray, std::array<std::uint32_t, MAX_CASCADES>& fbos);
+
+	/** forces the cached layers to be rendered again */
+	void invalidateStaticCache();
+
+public:
+	CascadedShadowMap() = default;
+
+	CascadedShadowMap(const CascadedShadowMap&) = delete;
+	CascadedShadowMap& operator=(const CascadedShadowMap&) = delete;
+
+	/**
+	 * Creates the depth texture array, the old one is deleted.
+	 * @param width the width of each cascade
+	 * @param height the height of each cascade
+	 * @param cascadesNumber the number of cascades, at most MAX_CASCADES
+	 * @param cacheStaticShadows whether the shadows of static GameObject%s should be cached
+	 */
+	void create(std::uint32_t width, std::uint32_t height, std::uint32_t cascadesNumber, bool cacheStaticShadows);
+
+	/**
+	 * @return the id of the depth texture array.
+	 */
+	std::uint32_t getId() const;
+
+	/**
+	 * @return true if the shadows of static GameObject%s are cached.
+	 */
+	bool cachesStaticShadows() const;
+
+	/**
+	 * @return the number of cascades.
+	 */
+	std::uint32_t getCascadesNumber() const;
+
+	/**
+	 * @param cascade the index of the cascade
+	 * @return the view space depth at which a cascade ends
+	 */
+	float getFarDistance(std::uint32_t cascade) const;
+
+	/**
+	 * @param cascade the index of the cascade
+	 * @return the world to light space transformation of a cascade
+	 */
+	const glm::mat4& getToLightSpace(std::uint32_t cascade) const;
+
+	/**
+	 * Deletes the depth texture arrays.
+	 */
+	void cleanUp();
+
+	~CascadedShadowMap();
+};
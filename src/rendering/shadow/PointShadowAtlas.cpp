@@ -0,0 +1,152 @@
+#include "rendering/shadow/PointShadowAtlas.h"
+#include "rendering/GLStateCache.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <numeric>
+#include <iostream>
+
+bool PointShadowAtlas::Tile::operator==(const Tile& rhs) const
+{
+	return x == rhs.x && y == rhs.y && size == rhs.size;
+}
+
+bool PointShadowAtlas::Tile::operator!=(const Tile& rhs) const
+{
+	return !(*this == rhs);
+}
+
+// keeps the even bits of a morton code
+static std::uint32_t compactBits(std::uint64_t v)
+{
+	v &= 0x5555555555555555ull;
+	v = (v | (v >> 1)) & 0x3333333333333333ull;
+	v = (v | (v >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+	v = (v | (v >> 4)) & 0x00FF00FF00FF00FFull;
+	v = (v | (v >> 8)) & 0x0000FFFF0000FFFFull;
+	v = (v | (v >> 16)) & 0x00000000FFFFFFFFull;
+	return static_cast<std::uint32_t>(v);
+}
+
+void PointShadowAtlas::createTexture(std::uint32_t& texture, std::uint32_t& fbo)
+{
+	glGenTextures(1, &texture);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, mSize, mSize, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "PointShadowAtlas frame buffer is incomplete\n";
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PointShadowAtlas::createStaticCache()
+{
+	if (mStaticDepth == 0)
+		createTexture(mStaticDepth, mStaticFbo);
+}
+
+void PointShadowAtlas::create(std::uint32_t size)
+{
+	cleanUp();
+
+	mSize = size;
+	createTexture(mDepth, mFbo);
+}
+
+std::vector<std::vector<PointShadowAtlas::Tile>> PointShadowAtlas::allocate(std::vector<Request> requests, std::uint32_t minTileSize) const
+{
+	const std::uint64_t budget = static_cast<std::uint64_t>(mSize) * mSize;
+	minTileSize = std::min(minTileSize, mSize);
+
+	auto usedTexels = [&requests]() {
+		std::uint64_t texels = 0;
+		for (const Request& request : requests)
+			texels += static_cast<std::uint64_t>(request.size) * request.size * request.tiles;
+		return texels;
+	};
+
+	for (Request& request : requests)
+		request.size = std::clamp(request.size, minTileSize, mSize);
+
+	while (usedTexels() > budget) {
+		// halve the largest tiles, on ties the least important ones
+		auto largest = requests.rend();
+		for (auto it = requests.rbegin(); it != requests.rend(); ++it)
+			if (it->tiles > 0 && it->size > minTileSize && (largest == requests.rend() || it->size > largest->size))
+				largest = it;
+
+		if (largest != requests.rend()) {
+			largest->size /= 2;
+			continue;
+		}
+
+		// every tile is as small as possible, drop the least important request
+		auto last = std::find_if(requests.rbegin(), requests.rend(), [](const Request& r) { return r.tiles > 0; });
+		last->tiles = 0;
+	}
+
+	/* power of two tiles placed from the largest to the smallest along a morton curve
+	 * are always aligned to their size and never overlap, so no space is wasted */
+	std::vector<std::size_t> order(requests.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&requests](std::size_t a, std::size_t b) {
+		return requests[a].size > requests[b].size;
+	});
+
+	std::vector<std::vector<Tile>> tiles(requests.size());
+	std::uint64_t offset = 0;
+	for (std::size_t index : order) {
+		const Request& request = requests[index];
+		for (std::uint32_t t = 0; t < request.tiles; ++t) {
+			tiles[index].push_back(Tile{ compactBits(offset), compactBits(offset >> 1), request.size });
+			offset += static_cast<std::uint64_t>(request.size) * request.size;
+		}
+	}
+
+	return tiles;
+}
+
+std::uint32_t PointShadowAtlas::getId() const
+{
+	return mDepth;
+}
+
+std::uint32_t PointShadowAtlas::getSize() const
+{
+	return mSize;
+}
+
+void PointShadowAtlas::cleanUp()
+{
+	if (mDepth != 0) {
+		glDeleteFramebuffers(1, &mFbo);
+		GLStateCache::deleteTextures(1, &mDepth);
+		mDepth = 0;
+		mFbo = 0;
+	}
+
+	if (mStaticDepth != 0) {
+		glDeleteFramebuffers(1, &mStaticFbo);
+		GLStateCache::deleteTextures(1, &mStaticDepth);
+		mStaticDepth = 0;
+		mStaticFbo = 0;
+	}
+
+	mSize = 0;
+}
+
+PointShadowAtlas::~PointShadowAtlas()
+{
+	cleanUp();
+}
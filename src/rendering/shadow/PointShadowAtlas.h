@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * A depth texture shared by the shadows of all the PointLight%s.
+ * Each face of the shadow cube of a PointLight is rendered in a square tile of the atlas.
+ * Tiles are assigned every frame: the size of the atlas is the texel budget for all the
+ * point light shadows and the tiles of the less important lights are shrunk when it is exceeded.
+ * The shadows of static GameObject%s can be cached in a second texture with the same layout.
+ */
+class PointShadowAtlas
+{
+	friend class RenderSystem;
+
+public:
+	/** a square region of the atlas */
+	struct Tile {
+		std::uint32_t x = 0;
+		std::uint32_t y = 0;
+
+		/** side of the tile in texels, 0 if the tile has not been allocated */
+		std::uint32_t size = 0;
+
+		bool operator==(const Tile& rhs) const;
+		bool operator!=(const Tile& rhs) const;
+	};
+
+	/** a set of tiles with the same size, usually the faces of a PointLight */
+	struct Request {
+		/** the preferred size of the tiles, a power of two */
+		std::uint32_t size;
+
+		/** how many tiles are needed */
+		std::uint32_t tiles;
+	};
+
+private:
+	std::uint32_t mSize = 0;
+
+	std::uint32_t mDepth = 0;
+	std::uint32_t mFbo = 0;
+
+	/** depth of the static GameObjects only, created the first time it is needed */
+	std::uint32_t mStaticDepth = 0;
+	std::uint32_t mStaticFbo = 0;
+
+	void createTexture(std::uint32_t& texture, std::uint32_t& fbo);
+
+	/** creates the texture used to cache static shadows if needed */
+	void createStaticCache();
+
+public:
+	PointShadowAtlas() = default;
+
+	PointShadowAtlas(const PointShadowAtlas&) = delete;
+	PointShadowAtlas& operator=(const PointShadowAtlas&) = delete;
+
+	/**
+	 * Creates the atlas, the old one is deleted.
+	 * @param size the width and height of the atlas, a power of two
+	 */
+	void create(std::uint32_t size);
+
+	/**
+	 * Places the tiles of some requests in the atlas.
+	 * When the tiles do not fit, the largest ones are halved until they fit or they reach minTileSize,
+	 * then the tiles of the last requests are dropped.
+	 * @param requests the tiles to place, sorted by decreasing priority
+	 * @param minTileSize the minimum size of a tile, a power of two
+	 * @return the tiles of each request, in the same order. Dropped requests get no tiles.
+	 */
+	std::vector<std::vector<Tile>> allocate(std::vector<Request> requests, std::uint32_t minTileSize) const;
+
+	/**
+	 * @return the id of the depth texture.
+	 */
+	std::uint32_t getId() const;
+
+	/**
+	 * @return the width and height of the atlas.
+	 */
+	std::uint32_t getSize() const;
+
+	/**
+	 * Deletes the atlas.
+	 */
+	void cleanUp();
+
+	~PointShadowAtlas();
+};
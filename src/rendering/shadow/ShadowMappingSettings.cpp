@@ -1,17 +1,18 @@
 #include "rendering/shadow/ShadowMappingSettings.h"
 #include "rendering/RenderSystem.h"
+#include "rendering/GLStateCache.h"
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
 
 
 void ShadowMappingSettings::init()
 {
-	/* Uniform buffer object set up for fog */
+	/* Uniform buffer object set up for shadows */
 	glGenBuffers(1, &mShadowUbo);
 	glBindBuffer(GL_UNIFORM_BUFFER, mShadowUbo);
-	// 16 bytes: a vec3
-	glBufferData(GL_UNIFORM_BUFFER, 16, nullptr, GL_STATIC_DRAW);
-	glBindBufferBase(GL_UNIFORM_BUFFER, RenderSystem::SHADOWMAP_UNIFORM_BLOCK_INDEX, mShadowUbo);
+	// a vec3 and the number of cascades, a vec4 with the far distance of each cascade, a mat4 for each cascade
+	glBufferData(GL_UNIFORM_BUFFER, 32 + sizeof(glm::mat4) * CascadedShadowMap::MAX_CASCADES, nullptr, GL_STREAM_DRAW);
+	GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, RenderSystem::SHADOWMAP_UNIFORM_BLOCK_INDEX, mShadowUbo);
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	updateUbo();
@@ -26,6 +27,18 @@ void ShadowMappingSettings::updateUbo()
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
+void ShadowMappingSettings::updateCascadesUbo(const CascadedShadowMap& shadowMap)
+{
+	float cascadesNumber = static_cast<float>(shadowMap.mCascadesNumber);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, mShadowUbo);
+	glBufferSubData(GL_UNIFORM_BUFFER, 12, sizeof(float), &cascadesNumber);
+	glBufferSubData(GL_UNIFORM_BUFFER, 16, sizeof(float) * CascadedShadowMap::MAX_CASCADES, shadowMap.mFarDistances.data());
+	glBufferSubData(GL_UNIFORM_BUFFER, 32, sizeof(glm::mat4) * shadowMap.mCascadesNumber, shadowMap.mToLightSpace.data());
+
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
 void ShadowMappingSettings::setShadowDistance(float shadowDistance)
 {
 	depth = shadowDistance;
@@ -66,6 +79,6 @@ float ShadowMappingSettings::getShadowStrength() const
 
 ShadowMappingSettings::~ShadowMappingSettings()
 {
-	glDeleteBuffers(1, &mShadowUbo);
+	GLStateCache::deleteBuffers(1, &mShadowUbo);
 }
 
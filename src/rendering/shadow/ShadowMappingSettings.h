@@ -1,13 +1,15 @@
 #pragma once
 
+#include "rendering/shadow/CascadedShadowMap.h"
 #include <glm/glm.hpp>
 #include <cstdint>
 
 /**
  * Basic settings for shadow mapping.
  * This class holds information about the dimension of the shadow map texture
- * and the size of the shadow cuboid. Its depth also defines how far away
- * the shadow is active. However, in order to smooth shadows that are far away,
+ * and how the view frustum is split into the cascades of directional lights.
+ * depth defines how far away from the camera the shadow is active.
+ * However, in order to smooth shadows that are far away,
  * the same information can be changed using setShadowDistance which will also 
  * affect where shadows starts to fade out. This method should only be called when
  * depth changes considerably. To set the range in which shadows fade out
@@ -15,6 +17,8 @@
  */
 class ShadowMappingSettings
 {
+	friend class RenderSystem;
+
 private:
 	std::uint32_t mShadowUbo = 0;
 
@@ -25,23 +29,59 @@ private:
 
 	void updateUbo();
 
+	/** Copies the cascades of a DirectionalLight to the ubo, called by RenderSystem before using them */
+	void updateCascadesUbo(const CascadedShadowMap& shadowMap);
+
 	bool mEnabled = true;
 
 public:
-	/** width of the shadow map texture */
+	/** width of each cascade of the shadow map texture */
 	std::int32_t mapWidth = 1024;
 
-	/** height of the shadow map texture */
+	/** height of each cascade of the shadow map texture */
 	std::int32_t mapHeight = 1024;
 
-	/** width of the shadow box */
-	float width = 75.0f;
+	/** distance from the camera covered by the shadows */
+	float depth = 220.0f;
 
-	/** height of the shadow box */
-	float height = 75.0f;
+	/**
+	 * Number of slices the view frustum is split into for directional lights,
+	 * at most CascadedShadowMap::MAX_CASCADES. Like mapWidth and mapHeight it
+	 * is used when Light::setCastShadowMode is called.
+	 */
+	std::uint32_t cascadesNumber = 3;
 
-	/** depth of the shadow box */
-	float depth = 220.0f;
+	/**
+	 * How the view frustum is split into cascades, in [0, 1].
+	 * 0 splits it uniformly, 1 logarithmically (the cascades close to the camera get smaller).
+	 */
+	float cascadeSplitLambda = 0.75f;
+
+	/**
+	 * How far behind a cascade (towards the light) shadow casters are rendered.
+	 * Objects further away from the cascade do not cast shadows on it.
+	 */
+	float casterDistance = 150.0f;
+
+	/**
+	 * Width and height of the texture shared by the shadows of all the PointLight%s, a power of two
+	 * (other values are rounded up to the next one).
+	 * This is the texel budget of point light shadows: when it is exceeded the faces
+	 * of the least important lights get smaller tiles.
+	 */
+	std::uint32_t pointShadowAtlasSize = 4096;
+
+	/** minimum size of the tile of a face of a PointLight shadow, a power of two */
+	std::uint32_t pointShadowMinTileSize = 64;
+
+	/** maximum size of the tile of a face of a PointLight shadow, a power of two */
+	std::uint32_t pointShadowMaxTileSize = 1024;
+
+	/** PointLight%s farther than this from the camera update their shadows every pointShadowFarUpdateInterval frames */
+	float pointShadowFarDistance = 60.0f;
+
+	/** @see pointShadowFarDistance */
+	std::uint32_t pointShadowFarUpdateInterval = 4;
 
 	/**
 	 * If true, objects use a special and fast shader when
@@ -5,7 +5,7 @@ SkeletralAnimationControllerComponent::SkeletralAnimationControllerComponent(con
 	const std::map<std::string, std::uint32_t>& boneName2index)
 	: Component{ go }, mSkeleton{ skeleton }, mBoneName2Index{ boneName2index }
 {
-
+	mEnterFrameCrumb = Engine::eventManager.addListenerFor(EventManager::ENTER_FRAME_EVENT, this, true);
 }
 
 void SkeletralAnimationControllerComponent::addAnimation(const std::string& name, const SkeletalAnimation& animation)
@@ -25,10 +25,26 @@ SkeletalAnimation* SkeletralAnimationControllerComponent::getAnimation(const std
 
 void SkeletralAnimationControllerComponent::playAnimation(const std::string& name)
 {
-	time.reset();
+	mTime = 0.0f;
 	mCurrentAnimation = name;
 }
 
+float SkeletralAnimationControllerComponent::getTime() const
+{
+	return mTime;
+}
+
+void SkeletralAnimationControllerComponent::setTime(float seconds)
+{
+	mTime = seconds;
+}
+
+void SkeletralAnimationControllerComponent::onFrameEvent(SDL_EventType, float deltaMillis)
+{
+	if (!paused)
+		mTime += deltaMillis / 1000.0f;
+}
+
 const std::map<std::string, std::uint32_t>& SkeletralAnimationControllerComponent::getBoneName2index() const
 {
 	return mBoneName2Index;
@@ -43,7 +59,7 @@ std::vector<glm::mat4> SkeletralAnimationControllerComponent::getTransforms()
 {
 	const SkeletalAnimation& animation = mName2animation[mCurrentAnimation];
 
-	std::vector<glm::mat4> transforms = animation.getAt(time.getSeconds(), mSkeleton);
+	std::vector<glm::mat4> transforms = animation.getAt(mTime, mSkeleton);
 	for (std::size_t i = 0; i < transforms.size(); ++i) {
 		auto& bone = mSkeleton[i];
 		if (bone.parent != -1)
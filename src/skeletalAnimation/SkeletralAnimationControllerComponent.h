@@ -1,8 +1,9 @@
 #pragma once
 #include "components/Component.h"
 #include "skeletalAnimation/Bone.h"
-#include "timer/Timer.h"
 #include "skeletalAnimation/SkeletalAnimation.h"
+#include "events/EventListener.h"
+#include "events/EventListenerCrumb.h"
 #include <vector>
 #include <map>
 #include <cstdint>
@@ -14,14 +15,16 @@
  * To add an animation use addAnimation(). Each animation
  * has its own name so that it can be played using
  * playAnimation().
- * To control the execution of a single animation use the 
- * time instance variable (@see Timer).
+ * The animation advances with the enter frame events, so it follows the
+ * updates of the Engine::frameScheduler (e.g. its virtual clock in
+ * MAX_THROUGHPUT mode). To control the execution of a single animation
+ * use paused and setTime.
  * If a GameObject imported using GameObjectLoader has 
  * an animation, it will be automatically added to this component
  * and its name will be "default".
  */
 class SkeletralAnimationControllerComponent :
-	public Component
+	public Component, public EventListener
 {
 private:
 	std::vector<Bone> mSkeleton;
@@ -31,12 +34,16 @@ private:
 
 	std::string mCurrentAnimation;
 
+	/** time of the current animation in seconds */
+	float mTime = 0.0f;
+
+	CrumbPtr mEnterFrameCrumb;
+
 	std::vector<glm::mat4> getTransforms();
 
 public:
-	/** Current time of animation */
-	Timer time;
-
+	/** when true the current animation does not advance */
+	bool paused = false;
 
 	SkeletralAnimationControllerComponent(const GameObjectEH& go, const std::vector<Bone>& skeleton,
 		const std::map<std::string, std::uint32_t>& boneName2index);
@@ -64,6 +71,22 @@ public:
 	 */
 	void playAnimation(const std::string& name);
 
+	/**
+	 * @return the time of the current animation in seconds
+	 */
+	float getTime() const;
+
+	/**
+	 * Moves the current animation to a given time.
+	 * @param seconds the time in seconds
+	 */
+	void setTime(float seconds);
+
+	/**
+	 * Advances the current animation by the duration of the update.
+	 */
+	virtual void onFrameEvent(SDL_EventType type, float deltaMillis) override;
+
 	/**
 	 * Mapping among external and internal bone representation.
 	 * Bones stored in files have names. The internal representation of 
@@ -0,0 +1,283 @@
+#include "terrain/ChunkedTerrainComponent.h"
+#include "Engine.h"
+#include "events/EventManager.h"
+#include "rendering/mesh/MeshLoader.h"
+#include "cameras/CameraComponent.h"
+#include "geometry/BoundingBox.h"
+#include "geometry/Frustum.h"
+#include "geometry/Intersections.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+ChunkedTerrainComponent::ChunkedTerrainComponent(const GameObjectEH& go, const std::shared_ptr<const TerrainHeightProvider>& heightProvider,
+	const MaterialPtr& material, float width, float depth, std::uint32_t maxLevel,
+	float hTextureTiles, float vTextureTiles, bool includeTangentSpace)
+	: Component{ go }, mHeightProvider{ heightProvider }, mMaterial{ material },
+	mParams{ width, depth, hTextureTiles, vTextureTiles, includeTangentSpace }, mMaxLevel{ maxLevel }
+{
+	mCrumb = Engine::eventManager.addListenerFor(EventManager::ENTER_FRAME_EVENT, this, true);
+
+	createSharedIndices();
+
+	// the root is always needed
+	requestChunk(0, 0, 0);
+}
+
+std::uint64_t ChunkedTerrainComponent::getKey(std::uint32_t level, std::uint32_t x, std::uint32_t z)
+{
+	return (static_cast<std::uint64_t>(level) << 56) | (static_cast<std::uint64_t>(x) << 28) | z;
+}
+
+void ChunkedTerrainComponent::createSharedIndices()
+{
+	const std::uint32_t side = CHUNK_QUADS + 1;
+	const std::uint32_t gridVertices = side * side;
+
+	std::vector<std::uint32_t> indices;
+	indices.reserve(CHUNK_QUADS * CHUNK_QUADS * 6 + 4 * CHUNK_QUADS * 6);
+
+	for (std::uint32_t v = 0; v < CHUNK_QUADS; ++v) {
+		for (std::uint32_t h = 0; h < CHUNK_QUADS; ++h) {
+			indices.insert(indices.end(), {
+				// first tri
+				h + side * v,
+				h + side * (v + 1),
+				h + 1 + side * v,
+
+				// second tri
+				h + 1 + side * v,
+				h + side * (v + 1),
+				h + 1 + side * (v + 1),
+			});
+		}
+	}
+
+	/* skirt vertices are stored after the grid, one row of side vertices per edge:
+	 * v = 0, v = CHUNK_QUADS, h = 0, h = CHUNK_QUADS. Each skirt vertex hangs below
+	 * the grid vertex on the same edge. Triangles face outwards. */
+	auto top = [side](std::uint32_t edge, std::uint32_t i) {
+		switch (edge) {
+		case 0: return i;
+		case 1: return i + side * CHUNK_QUADS;
+		case 2: return side * i;
+		default: return CHUNK_QUADS + side * i;
+		}
+	};
+	auto skirt = [side, gridVertices](std::uint32_t edge, std::uint32_t i) { return gridVertices + edge * side + i; };
+	auto addSkirtQuad = [&indices](std::uint32_t top0, std::uint32_t top1, std::uint32_t bottom0, std::uint32_t bottom1) {
+		indices.insert(indices.end(), { top0, top1, bottom0, top1, bottom1, bottom0 });
+	};
+
+	for (std::uint32_t i = 0; i < CHUNK_QUADS; ++i) {
+		addSkirtQuad(top(0, i), top(0, i + 1), skirt(0, i), skirt(0, i + 1));
+		addSkirtQuad(top(1, i + 1), top(1, i), skirt(1, i + 1), skirt(1, i));
+		addSkirtQuad(top(2, i + 1), top(2, i), skirt(2, i + 1), skirt(2, i));
+		addSkirtQuad(top(3, i), top(3, i + 1), skirt(3, i), skirt(3, i + 1));
+	}
+
+	glGenBuffers(1, &mSharedEbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mSharedEbo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(std::uint32_t) * indices.size(), indices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	mIndicesNumber = static_cast<std::uint32_t>(indices.size());
+}
+
+ChunkedTerrainComponent::ChunkData ChunkedTerrainComponent::generateChunk(const std::shared_ptr<const TerrainHeightProvider>& heightProvider,
+	const ChunkParams& params, std::uint32_t level, std::uint32_t x, std::uint32_t z)
+{
+	const std::uint32_t side = CHUNK_QUADS + 1;
+	const std::size_t vertices = side * side + 4 * side;
+
+	ChunkData data;
+	data.positions.reserve(vertices * 3);
+	data.normals.reserve(vertices * 3);
+	data.uvs.reserve(vertices * 2);
+	if (params.includeTangentSpace)
+		data.tangents.reserve(vertices * 3);
+
+	// size of the chunk as a percentage of the terrain
+	float chunkPercent = 1.0f / (1u << level);
+	float hStart = x * chunkPercent;
+	float vStart = z * chunkPercent;
+
+	float minHeight = std::numeric_limits<float>::max();
+	float maxHeight = std::numeric_limits<float>::lowest();
+
+	for (std::uint32_t v = 0; v <= CHUNK_QUADS; ++v) {
+		float vPercent = vStart + chunkPercent * v / CHUNK_QUADS;
+		float vPos = -(params.depth / 2.0f) + params.depth * vPercent;
+		for (std::uint32_t h = 0; h <= CHUNK_QUADS; ++h) {
+			float hPercent = hStart + chunkPercent * h / CHUNK_QUADS;
+			float hPos = -(params.width / 2.0f) + params.width * hPercent;
+
+			float height = heightProvider->get(hPercent, vPercent);
+			minHeight = std::min(minHeight, height);
+			maxHeight = std::max(maxHeight, height);
+
+			glm::vec3 normal = heightProvider->getNormal(hPercent, vPercent);
+
+			data.positions.insert(data.positions.end(), { hPos, height, vPos });
+			data.normals.insert(data.normals.end(), { normal.x, normal.y, normal.z });
+			data.uvs.insert(data.uvs.end(), { hPercent * params.hTextureTiles, 1 - vPercent * params.vTextureTiles });
+			if (params.includeTangentSpace)
+				data.tangents.insert(data.tangents.end(), { 1.0f, 0.0f, 0.0f });
+		}
+	}
+
+	/* the crack between two chunks of different levels cannot be deeper than the
+	 * height range of the chunk, one more cell of slack covers the finer neighbour */
+	float cellSize = std::max(params.width, params.depth) * chunkPercent / CHUNK_QUADS;
+	float skirtDepth = (maxHeight - minHeight) + cellSize;
+
+	for (std::uint32_t edge = 0; edge < 4; ++edge) {
+		for (std::uint32_t i = 0; i < side; ++i) {
+			std::uint32_t h = (edge == 2) ? 0 : (edge == 3) ? CHUNK_QUADS : i;
+			std::uint32_t v = (edge == 0) ? 0 : (edge == 1) ? CHUNK_QUADS : i;
+			std::size_t top = h + side * v;
+
+			data.positions.insert(data.positions.end(), { data.positions[top * 3], data.positions[top * 3 + 1] - skirtDepth, data.positions[top * 3 + 2] });
+			data.normals.insert(data.normals.end(), { data.normals[top * 3], data.normals[top * 3 + 1], data.normals[top * 3 + 2] });
+			data.uvs.insert(data.uvs.end(), { data.uvs[top * 2], data.uvs[top * 2 + 1] });
+			if (params.includeTangentSpace)
+				data.tangents.insert(data.tangents.end(), { 1.0f, 0.0f, 0.0f });
+		}
+	}
+
+	data.minPoint = glm::vec3{ -(params.width / 2.0f) + params.width * hStart, minHeight - skirtDepth, -(params.depth / 2.0f) + params.depth * vStart };
+	data.maxPoint = glm::vec3{ data.minPoint.x + params.width * chunkPercent, maxHeight, data.minPoint.z + params.depth * chunkPercent };
+
+	return data;
+}
+
+void ChunkedTerrainComponent::collectGeneratedChunks()
+{
+	for (auto it = mPendingChunks.begin(); it != mPendingChunks.end();) {
+		if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			++it;
+			continue;
+		}
+
+		ChunkData data = it->second.get();
+
+		MeshLoader loader;
+		loader.loadData(data.positions.data(), data.positions.size(), 3);
+		loader.loadData(data.normals.data(), data.normals.size(), 3);
+		loader.loadData(data.uvs.data(), data.uvs.size(), 2);
+		if (mParams.includeTangentSpace)
+			loader.loadData(data.tangents.data(), data.tangents.size(), 3);
+
+		// the vao of the loader is bound: use the shared indices. They are not owned by the mesh
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mSharedEbo);
+
+		Chunk& chunk = mChunks[it->first];
+		chunk.mesh = loader.getMesh(static_cast<std::uint32_t>(data.positions.size() / 3), mIndicesNumber);
+		chunk.mesh.boundingBox = BoundingBox{ data.minPoint, data.maxPoint };
+		chunk.lastUsedFrame = mFrame;
+
+		it = mPendingChunks.erase(it);
+	}
+}
+
+void ChunkedTerrainComponent::requestChunk(std::uint32_t level, std::uint32_t x, std::uint32_t z)
+{
+	std::uint64_t key = getKey(level, x, z);
+	if (mPendingChunks.size() >= maxPendingChunks || mPendingChunks.find(key) != mPendingChunks.end())
+		return;
+
+	mPendingChunks[key] = std::async(std::launch::async, &ChunkedTerrainComponent::generateChunk, mHeightProvider, mParams, level, x, z);
+}
+
+void ChunkedTerrainComponent::select(std::uint32_t level, std::uint32_t x, std::uint32_t z, const glm::vec3& localCamPosition,
+	const glm::mat4& toWorld, const Frustum& frustum)
+{
+	Chunk& chunk = mChunks[getKey(level, x, z)];
+	chunk.lastUsedFrame = mFrame;
+
+	const BoundingBox& bounds = chunk.mesh.boundingBox;
+	if (boxFrustumIntersection(bounds.transformed(toWorld), frustum) == IntersectionTestResult::OUTSIDE)
+		return;
+
+	float chunkSize = std::max(mParams.width, mParams.depth) / (1u << level);
+	glm::vec3 closestPoint = glm::clamp(localCamPosition, bounds.getMin(), bounds.getMax());
+
+	if (level < mMaxLevel && glm::distance(localCamPosition, closestPoint) < splitDistance * chunkSize) {
+		bool childrenAvailable = true;
+		for (std::uint32_t child = 0; child < 4; ++child) {
+			std::uint32_t childX = x * 2 + (child & 1);
+			std::uint32_t childZ = z * 2 + (child >> 1);
+			auto it = mChunks.find(getKey(level + 1, childX, childZ));
+			if (it == mChunks.end()) {
+				requestChunk(level + 1, childX, childZ);
+				childrenAvailable = false;
+			}
+			else {
+				// keep it while its siblings are being generated
+				it->second.lastUsedFrame = mFrame;
+			}
+		}
+
+		if (childrenAvailable) {
+			for (std::uint32_t child = 0; child < 4; ++child)
+				select(level + 1, x * 2 + (child & 1), z * 2 + (child >> 1), localCamPosition, toWorld, frustum);
+			return;
+		}
+	}
+
+	mSelectedChunks.push_back(getKey(level, x, z));
+}
+
+void ChunkedTerrainComponent::updateMeshes()
+{
+	if (mSelectedChunks == mRenderedChunks)
+		return;
+
+	gameObject->removeAllMeshes();
+	for (std::uint64_t key : mSelectedChunks)
+		gameObject->addMesh(mChunks[key].mesh, mMaterial);
+
+	std::swap(mSelectedChunks, mRenderedChunks);
+}
+
+void ChunkedTerrainComponent::evictUnusedChunks()
+{
+	if (mChunks.size() <= maxCachedChunks)
+		return;
+
+	std::vector<std::pair<std::uint64_t, std::uint64_t>> unused; // last used frame, key
+	for (const auto& [key, chunk] : mChunks) {
+		if (chunk.lastUsedFrame != mFrame)
+			unused.emplace_back(chunk.lastUsedFrame, key);
+	}
+
+	std::size_t toEvict = std::min(unused.size(), mChunks.size() - maxCachedChunks);
+	std::partial_sort(unused.begin(), unused.begin() + toEvict, unused.end());
+	for (std::size_t i = 0; i < toEvict; ++i)
+		mChunks.erase(unused[i].second);
+}
+
+void ChunkedTerrainComponent::onFrameEvent(SDL_EventType, float)
+{
+	collectGeneratedChunks();
+
+	++mFrame;
+	mSelectedChunks.clear();
+
+	if (mChunks.find(getKey(0, 0, 0)) != mChunks.end()) {
+		GameObjectEH camera = Engine::renderSys.getCamera();
+		glm::mat4 toWorld = gameObject->transform.modelToWorld();
+		glm::vec3 localCamPosition = glm::vec3{ glm::inverse(toWorld) * glm::vec4{ camera->transform.getPosition(), 1.0f } };
+
+		select(0, 0, 0, localCamPosition, toWorld, camera->getComponent<CameraComponent>()->getViewFrutsum());
+	}
+
+	updateMeshes();
+	evictUnusedChunks();
+}
+
+ChunkedTerrainComponent::~ChunkedTerrainComponent()
+{
+	// chunk meshes still reference the indices, the buffer is freed once they are deleted
+	glDeleteBuffers(1, &mSharedEbo);
+}
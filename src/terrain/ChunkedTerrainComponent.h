@@ -0,0 +1,148 @@
+#pragma once
+
+#include "components/Component.h"
+#include "gameobject/GameObjectEH.h"
+#include "events/EventListener.h"
+#include "events/EventListenerCrumb.h"
+#include "rendering/mesh/Mesh.h"
+#include "rendering/materials/Material.h"
+#include "terrain/TerrainHeightProvider.h"
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <future>
+#include <memory>
+#include <glm/glm.hpp>
+
+struct Frustum;
+
+/**
+ * Renders a large terrain as a quadtree of chunks.
+ * Every chunk has the same number of vertices: the root covers the whole terrain
+ * and each level of the quadtree halves the area covered by a chunk, doubling its detail.
+ * Chunks are selected every frame depending on their distance from the camera and
+ * are set as the Mesh%es of the GameObject this component is attached to.
+ * Chunks are generated in the background the first time they are needed and evicted
+ * once they have not been used for a while, so only the chunks around the camera are
+ * kept in memory. A skirt along the edges of each chunk hides the cracks between
+ * neighbouring chunks of different levels.
+ * @sa TerrainGenerator::addChunkedTerrainComponent
+ */
+class ChunkedTerrainComponent : public Component, EventListener
+{
+public:
+	/** number of quads along each side of a chunk */
+	static constexpr std::uint32_t CHUNK_QUADS = 64;
+
+	/** a chunk is split into its children when the camera is closer than splitDistance times its size */
+	float splitDistance = 2.0f;
+
+	/** max number of chunks kept in memory */
+	std::size_t maxCachedChunks = 512;
+
+	/** max number of chunks generated at the same time */
+	std::size_t maxPendingChunks = 8;
+
+private:
+	/** parameters needed to generate a chunk, copied into background jobs */
+	struct ChunkParams {
+		float width;
+		float depth;
+		float hTextureTiles;
+		float vTextureTiles;
+		bool includeTangentSpace;
+	};
+
+	/** vertex data of a chunk generated in the background */
+	struct ChunkData {
+		std::vector<float> positions;
+		std::vector<float> normals;
+		std::vector<float> uvs;
+		std::vector<float> tangents;
+
+		glm::vec3 minPoint;
+		glm::vec3 maxPoint;
+	};
+
+	struct Chunk {
+		Mesh mesh;
+
+		/** the last frame this chunk was selected or needed by a selected chunk */
+		std::uint64_t lastUsedFrame = 0;
+	};
+
+	CrumbPtr mCrumb;
+
+	std::shared_ptr<const TerrainHeightProvider> mHeightProvider;
+	MaterialPtr mMaterial;
+	ChunkParams mParams;
+	std::uint32_t mMaxLevel;
+
+	/** indices of the grid and of the skirts, shared by all the chunks */
+	std::uint32_t mSharedEbo = 0;
+	std::uint32_t mIndicesNumber = 0;
+
+	std::unordered_map<std::uint64_t, Chunk> mChunks;
+	std::unordered_map<std::uint64_t, std::future<ChunkData>> mPendingChunks;
+
+	/** chunks selected in the current frame */
+	std::vector<std::uint64_t> mSelectedChunks;
+
+	/** chunks currently used as meshes of the GameObject */
+	std::vector<std::uint64_t> mRenderedChunks;
+
+	std::uint64_t mFrame = 0;
+
+	static std::uint64_t getKey(std::uint32_t level, std::uint32_t x, std::uint32_t z);
+
+	static ChunkData generateChunk(const std::shared_ptr<const TerrainHeightProvider>& heightProvider,
+		const ChunkParams& params, std::uint32_t level, std::uint32_t x, std::uint32_t z);
+
+	void createSharedIndices();
+
+	/** uploads the chunks whose generation is completed */
+	void collectGeneratedChunks();
+
+	void requestChunk(std::uint32_t level, std::uint32_t x, std::uint32_t z);
+
+	/**
+	 * Selects the chunks to render in the subtree of an available chunk.
+	 * @param level the level of the chunk
+	 * @param x the horizontal index of the chunk in its level
+	 * @param z the vertical index of the chunk in its level
+	 * @param localCamPosition the camera position in the local space of the terrain
+	 * @param toWorld the local to world transformation of the terrain
+	 * @param frustum the view frustum
+	 */
+	void select(std::uint32_t level, std::uint32_t x, std::uint32_t z, const glm::vec3& localCamPosition,
+		const glm::mat4& toWorld, const Frustum& frustum);
+
+	void updateMeshes();
+
+	void evictUnusedChunks();
+
+public:
+	/**
+	 * Creates a new ChunkedTerrainComponent.
+	 * @param go the GameObject used to render the terrain.
+	 * @param heightProvider provides the height of the terrain, it is used from background threads.
+	 * @param material the material of the terrain.
+	 * @param width the width of the terrain.
+	 * @param depth the depth of the terrain.
+	 * @param maxLevel the deepest level of the quadtree. Chunks at this level
+	 * have (CHUNK_QUADS << maxLevel) quads along the side of the terrain.
+	 * @param hTextureTiles how many times the terrain texture is repeated horizontally.
+	 * @param vTextureTiles how many times the terrain texture is repeated vertically.
+	 * @param includeTangentSpace whether tangent space data should be included.
+	 */
+	ChunkedTerrainComponent(const GameObjectEH& go, const std::shared_ptr<const TerrainHeightProvider>& heightProvider,
+		const MaterialPtr& material, float width, float depth, std::uint32_t maxLevel,
+		float hTextureTiles = 40.0f, float vTextureTiles = 40.0f, bool includeTangentSpace = false);
+
+	ChunkedTerrainComponent(const ChunkedTerrainComponent&) = delete;
+	ChunkedTerrainComponent& operator=(const ChunkedTerrainComponent&) = delete;
+
+	virtual void onFrameEvent(SDL_EventType type, float deltaMillis) override;
+
+	~ChunkedTerrainComponent();
+};
@@ -1,10 +1,11 @@
 #include "terrain/GeoMipMappingComponent.h"
 #include "Engine.h"
 #include "events/EventManager.h"
-#include <future>
+#include "rendering/GLStateCache.h"
+#include <chrono>
 
 
-glm::vec2 GeoMipMappingComponent::getPosition(std::uint32_t h, std::uint32_t v)
+glm::vec2 GeoMipMappingComponent::getPosition(std::uint32_t h, std::uint32_t v) const
 {
 	float vPercent = (float)v / mVerticalVertex;
 	float hPercent = (float)h / mHorizontalVertex;
@@ -16,30 +17,24 @@ glm::vec2 GeoMipMappingComponent::getPosition(std::uint32_t h, std::uint32_t v)
 GeoMipMappingComponent::GeoMipMappingComponent(const GameObjectEH& go, float width, float depth, std::uint32_t hVertex, std::uint32_t vVertex)
 	: Component{ go }, mWidth{ width }, mDepth{ depth }, mVerticalVertex{ vVertex }, mHorizontalVertex{ hVertex }
 {
-	Engine::eventManager.addListenerFor(EventManager::ENTER_FRAME_EVENT, this, false);
-
-	// starts async computation
-	mResult = std::async(std::launch::async, [this]() { return geomipmap(); });
+	mCrumb = Engine::eventManager.addListenerFor(EventManager::ENTER_FRAME_EVENT, this, true);
 }
 
-void GeoMipMappingComponent::compute(std::vector<std::uint32_t>& indices, std::uint32_t h, std::uint32_t v, std::uint32_t hOff, std::uint32_t vOff)
+void GeoMipMappingComponent::compute(const ViewSnapshot& view, std::vector<std::uint32_t>& indices, std::uint32_t h, std::uint32_t v, std::uint32_t hOff, std::uint32_t vOff) const
 {
-	auto pos3D = Engine::renderSys.getCamera()->transform.getPosition();
-
-	glm::vec2 camPos = glm::vec2{ pos3D.x, pos3D.z };
 	glm::vec2 topLeft = getPosition(h, v);
 	glm::vec2 bottomRight = getPosition(h + hOff, v + vOff);
 	glm::vec2 center = (topLeft + bottomRight) / 2.0f;
 
-	if (glm::distance(camPos, center) < glm::distance(topLeft, bottomRight) *2  && hOff != 1 && vOff != 1) {
+	if (glm::distance(view.cameraPosition, center) < glm::distance(topLeft, bottomRight) *2  && hOff != 1 && vOff != 1) {
 		std::uint32_t hHalf = hOff / 2;
 		std::uint32_t vHalf = vOff / 2;
 
-		compute(indices, h, v, hHalf, vHalf);
-		compute(indices, h + hHalf, v, hHalf, vHalf);
+		compute(view, indices, h, v, hHalf, vHalf);
+		compute(view, indices, h + hHalf, v, hHalf, vHalf);
 
-		compute(indices, h, v + vHalf, hHalf, vHalf);
-		compute(indices, h + hHalf, v + vHalf, hHalf, vHalf);
+		compute(view, indices, h, v + vHalf, hHalf, vHalf);
+		compute(view, indices, h + hHalf, v + vHalf, hHalf, vHalf);
 	}
 	else {
 		indices.insert(indices.end(), {
@@ -56,32 +51,74 @@ void GeoMipMappingComponent::compute(std::vector<std::uint32_t>& indices, std::u
 	}
 }
 
-std::vector<std::uint32_t> GeoMipMappingComponent::geomipmap()
+void GeoMipMappingComponent::geomipmap(const ViewSnapshot& view)
 {
-	std::vector<std::uint32_t> indices;
+	// the back buffer keeps its capacity, no allocations once it is large enough
+	std::vector<std::uint32_t>& indices = mIndices.getBack();
+	indices.clear();
 
 	std::uint32_t hHalf = mHorizontalVertex / 2;
 	std::uint32_t vHalf = mVerticalVertex / 2;
 
-	compute(indices, 0, 0, hHalf, vHalf);
-	compute(indices, hHalf, 0, hHalf, vHalf);
-	compute(indices, 0, vHalf, hHalf, vHalf);
-	compute(indices, hHalf, vHalf, hHalf, vHalf);
+	compute(view, indices, 0, 0, hHalf, vHalf);
+	compute(view, indices, hHalf, 0, hHalf, vHalf);
+	compute(view, indices, 0, vHalf, hHalf, vHalf);
+	compute(view, indices, hHalf, vHalf, hHalf, vHalf);
 
-	return indices;
+	mIndices.publish();
 }
 
-void GeoMipMappingComponent::onEvent(SDL_Event e)
+bool GeoMipMappingComponent::uploadIndices(const std::vector<std::uint32_t>& indices)
 {
-	if (mResult._Is_ready()) {
-		auto indices = mResult.get();
-		std::uint32_t ebo = gameObject->getMeshes()[0].getEbo();
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(std::uint32_t) * indices.size(), indices.data(), GL_STATIC_DRAW);
+	if (gameObject->getMeshes().empty())
+		return false;
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	Mesh terrain = gameObject->getMeshes()[0];
 
-		mResult = std::async(std::launch::async, [this]() { return geomipmap(); });
+	// binding the ebo changes the bound vao, use the terrain one
+	GLStateCache::bindVertexArray(terrain.getVao());
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, terrain.getEbo());
+
+	// the finest level uses every quad of the grid, allocate it once
+	if (!mEboAllocated) {
+		std::size_t worstCase = static_cast<std::size_t>(mHorizontalVertex) * mVerticalVertex * 6;
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(std::uint32_t) * worstCase, nullptr, GL_DYNAMIC_DRAW);
+		mEboAllocated = true;
 	}
-	
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(std::uint32_t) * indices.size(), indices.data());
+
+	GLStateCache::bindVertexArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	terrain.setIndicesNumber(static_cast<std::uint32_t>(indices.size()));
+	gameObject->setMesh(0, terrain);
+
+	return true;
+}
+
+void GeoMipMappingComponent::onFrameEvent(SDL_EventType, float)
+{
+	// compute the indices again once the terrain mesh is added
+	if (mIndices.acquire() && !uploadIndices(mIndices.getFront()))
+		mLastCameraPosition = glm::vec2{ std::numeric_limits<float>::infinity() };
+
+	bool jobRunning = mJob.valid() && mJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+	if (jobRunning)
+		return;
+
+	// the snapshot is taken on the main thread, the job only sees this copy
+	auto pos3D = Engine::renderSys.getCamera()->transform.getPosition();
+	ViewSnapshot view{ glm::vec2{ pos3D.x, pos3D.z } };
+	if (view.cameraPosition == mLastCameraPosition)
+		return;
+
+	mLastCameraPosition = view.cameraPosition;
+	mJob = Engine::jobSystem.submit([this, view]() { geomipmap(view); });
+}
+
+GeoMipMappingComponent::~GeoMipMappingComponent()
+{
+	// the job uses this component
+	if (mJob.valid())
+		Engine::jobSystem.wait(mJob);
 }
@@ -3,15 +3,37 @@
 #include "components/Component.h"
 #include "gameobject/GameObjectEH.h"
 #include "events/EventListener.h"
+#include "events/EventListenerCrumb.h"
+#include "jobs/TripleBuffer.h"
 #include <cstdint>
 #include <vector>
 #include <glm/glm.hpp>
 #include <future>
-
+#include <limits>
+
+/**
+ * Changes the level of detail of a terrain Mesh depending on the camera position.
+ * Indices are computed in the background from a snapshot of the view taken on the
+ * main thread, so the job never touches engine state. Results are published through
+ * a TripleBuffer and uploaded into an index buffer allocated once for the worst case.
+ */
 class GeoMipMappingComponent : public Component, EventListener
 {
 private:
-	std::future<std::vector<std::uint32_t>> mResult;
+	/** immutable copy of the view state used by a background job */
+	struct ViewSnapshot {
+		glm::vec2 cameraPosition;
+	};
+
+	CrumbPtr mCrumb;
+
+	std::future<void> mJob;
+	TripleBuffer<std::vector<std::uint32_t>> mIndices;
+
+	/** camera position used by the last job */
+	glm::vec2 mLastCameraPosition{ std::numeric_limits<float>::infinity() };
+
+	bool mEboAllocated = false;
 
 	float mWidth;
 	float mDepth;
@@ -19,17 +41,20 @@ private:
 	std::uint32_t mVerticalVertex;
 	std::uint32_t mHorizontalVertex;
 
-	glm::vec2 getPosition(std::uint32_t h, std::uint32_t v);
+	glm::vec2 getPosition(std::uint32_t h, std::uint32_t v) const;
 
-public:
-	GeoMipMappingComponent(const GameObjectEH& go, float width, float depth, std::uint32_t hVertex, std::uint32_t vVertex);
+	void compute(const ViewSnapshot& view, std::vector<std::uint32_t>& indices, std::uint32_t h, std::uint32_t v, std::uint32_t hOff, std::uint32_t vOff) const;
 
-	inline void compute(std::vector<std::uint32_t>& indices, std::uint32_t h, std::uint32_t v, std::uint32_t hOff, std::uint32_t vOff);
+	/** computes the indices for a view and publishes them, runs in the background */
+	void geomipmap(const ViewSnapshot& view);
 
-	std::vector<std::uint32_t> geomipmap();
+	/** @return false if the GameObject has no mesh yet */
+	bool uploadIndices(const std::vector<std::uint32_t>& indices);
 
-	virtual void onEvent(SDL_Event e) override;
+public:
+	GeoMipMappingComponent(const GameObjectEH& go, float width, float depth, std::uint32_t hVertex, std::uint32_t vVertex);
 
-	~GeoMipMappingComponent() = default;
-};
+	virtual void onFrameEvent(SDL_EventType type, float deltaMillis) override;
 
+	~GeoMipMappingComponent();
+};
@@ -1,34 +1,117 @@
 #include "terrain/HeightMapTerrainHeightProvider.h"
 #include <stb_image.h>
 #include <iostream>
+#include <cstring>
 #include <glm/glm.hpp>
+#include <algorithm>
 
-HeightMapTerrainHeightProvider::HeightMapTerrainHeightProvider(const std::string& heightMapPath, float minHeight, float maxHeight)
- : mMinHeight{minHeight}, mMaxHeight{maxHeight}
+HeightMapTerrainHeightProvider::HeightMapTerrainHeightProvider(const std::string& heightMapPath, float minHeight, float maxHeight, Filter filter)
+ : mMinHeight{minHeight}, mMaxHeight{maxHeight}, mFilter{filter}
 {
     stbi_set_flip_vertically_on_load(false);
     int cmp;
-    mHeightData = stbi_load(heightMapPath.c_str(), &mWidth, &mHeight, &cmp, STBI_grey);
-    if (mHeightData == nullptr)
+    if (stbi_is_16_bit(heightMapPath.c_str()))
+        mHeightData16 = stbi_load_16(heightMapPath.c_str(), &mWidth, &mHeight, &cmp, STBI_grey);
+    else
+        mHeightData = stbi_load(heightMapPath.c_str(), &mWidth, &mHeight, &cmp, STBI_grey);
+
+    if (mHeightData == nullptr && mHeightData16 == nullptr)
         std::cerr << "Cannot read height map " << heightMapPath << "\n";
 }
 
-float HeightMapTerrainHeightProvider::get(float x, float z) const
+HeightMapTerrainHeightProvider::HeightMapTerrainHeightProvider(const std::string& rawPath, RawFormat format, int width, int height,
+    float minHeight, float maxHeight, Filter filter, std::size_t cachedTiles)
+ : mMinHeight{minHeight}, mMaxHeight{maxHeight}, mFilter{filter}, mRawFormat{format}
 {
-    if (mHeightData == nullptr)
-        return 0.0f;
+    mRawFile = std::make_unique<MemoryMappedFile>(rawPath);
+
+    std::size_t sampleSize = (format == RawFormat::R16) ? sizeof(std::uint16_t) : sizeof(float);
+    std::size_t expectedSize = static_cast<std::size_t>(width) * height * sampleSize;
+    if (!mRawFile->isOpen() || mRawFile->getSize() < expectedSize) {
+        std::cerr << "Cannot read height map " << rawPath << "\n";
+        mRawFile.reset();
+        return;
+    }
 
+    mWidth = width;
+    mHeight = height;
+    mTileCache = std::make_unique<HeightTileCache>(width, height, [this](int x0, int z0, int tileWidth, int tileHeight, float* samples) {
+        loadRawTile(x0, z0, tileWidth, tileHeight, samples);
+    }, cachedTiles);
+}
+
+void HeightMapTerrainHeightProvider::loadRawTile(int x0, int z0, int width, int height, float* samples) const
+{
+    const std::uint8_t* data = mRawFile->getData();
+    for (int z = z0; z < z0 + height; ++z) {
+        std::size_t rowStart = static_cast<std::size_t>(z) * mWidth + x0;
+        for (int x = 0; x < width; ++x) {
+            if (mRawFormat == RawFormat::R16) {
+                const std::uint8_t* bytes = data + (rowStart + x) * 2;
+                *samples++ = (bytes[0] | (bytes[1] << 8)) / 65535.0f;
+            }
+            else {
+                float value;
+                std::memcpy(&value, data + (rowStart + x) * sizeof(float), sizeof(float));
+                *samples++ = value;
+            }
+        }
+    }
+}
+
+float HeightMapTerrainHeightProvider::sample(int x, int z, HeightTileCache::Cursor& cursor) const
+{
+    x = std::clamp(x, 0, mWidth - 1);
+    z = std::clamp(z, 0, mHeight - 1);
+
+    if (mTileCache)
+        return mTileCache->get(x, z, cursor);
+    if (mHeightData16)
+        return mHeightData16[z * mWidth + x] / 65535.0f;
+    return mHeightData[z * mWidth + x] / 255.0f;
+}
+
+// Catmull-Rom interpolation of four samples
+static float cubic(float s0, float s1, float s2, float s3, float t)
+{
+    return s1 + 0.5f * t * (s2 - s0 + t * (2.0f * s0 - 5.0f * s1 + 4.0f * s2 - s3 + t * (3.0f * (s1 - s2) + s3 - s0)));
+}
+
+float HeightMapTerrainHeightProvider::filteredSample(float x, float z, HeightTileCache::Cursor& cursor) const
+{
     // clamp
-    if (x < 0) x = 0;
-    if (x > 1) x = 1;
+    x = glm::clamp(x, 0.0f, 1.0f) * (mWidth - 1);
+    z = glm::clamp(z, 0.0f, 1.0f) * (mHeight - 1);
+
+    if (mFilter == Filter::NEAREST)
+        return sample(static_cast<int>(x), static_cast<int>(z), cursor);
+
+    int xi = static_cast<int>(x);
+    int zi = static_cast<int>(z);
+    float tx = x - xi;
+    float tz = z - zi;
 
-    if (z < 0) z = 0;
-    if (z > 1) z = 1;
+    if (mFilter == Filter::BILINEAR) {
+        float top = glm::mix(sample(xi, zi, cursor), sample(xi + 1, zi, cursor), tx);
+        float bottom = glm::mix(sample(xi, zi + 1, cursor), sample(xi + 1, zi + 1, cursor), tx);
+        return glm::mix(top, bottom, tz);
+    }
 
-    int zi = static_cast<int>(z * (mHeight - 1));
-    int xi = static_cast<int>(x * (mWidth - 1));
+    float rows[4];
+    for (int i = 0; i < 4; ++i) {
+        int row = zi - 1 + i;
+        rows[i] = cubic(sample(xi - 1, row, cursor), sample(xi, row, cursor), sample(xi + 1, row, cursor), sample(xi + 2, row, cursor), tx);
+    }
+    return cubic(rows[0], rows[1], rows[2], rows[3], tz);
+}
+
+float HeightMapTerrainHeightProvider::get(float x, float z) const
+{
+    if (mWidth == 0)
+        return 0.0f;
 
-    float f = (mHeightData[(zi * mWidth + xi)] / 255.0f);
+    HeightTileCache::Cursor cursor;
+    float f = filteredSample(x, z, cursor);
     return mMaxHeight * f + mMinHeight * (1.0f - f);
 }
 
@@ -42,9 +125,25 @@ glm::vec3 HeightMapTerrainHeightProvider::getNormal(float x, float z) const
     return glm::normalize(glm::vec3{heightL - heightR, 2.0f, heightD - heightU});
 }
 
+void HeightMapTerrainHeightProvider::getRow(float xStart, float xStep, std::uint32_t count, float z, float* heights) const
+{
+    if (mWidth == 0) {
+        std::fill(heights, heights + count, 0.0f);
+        return;
+    }
+
+    // consecutive samples are close to each other: the cursor avoids most cache lookups
+    HeightTileCache::Cursor cursor;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        float f = filteredSample(xStart + xStep * i, z, cursor);
+        heights[i] = mMaxHeight * f + mMinHeight * (1.0f - f);
+    }
+}
+
 HeightMapTerrainHeightProvider::~HeightMapTerrainHeightProvider()
 {
 	if (mHeightData)
 		stbi_image_free(mHeightData);
+	if (mHeightData16)
+		stbi_image_free(mHeightData16);
 }
-
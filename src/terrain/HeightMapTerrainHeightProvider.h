@@ -1,12 +1,33 @@
 #ifndef HEIGHTMAPTERRAINHEIGHTPROVIDER_H
 #define HEIGHTMAPTERRAINHEIGHTPROVIDER_H
 #include "terrain/TerrainHeightProvider.h"
+#include "terrain/HeightTileCache.h"
+#include "terrain/MemoryMappedFile.h"
 #include <cstdint>
 #include <string>
+#include <memory>
 #include <glm/vec3.hpp>
 
+/** Provides the height of a terrain using a height map.
+  * Height maps can be images (8 or 16 bit per sample, loaded in memory) or
+  * raw files. Raw files are memory mapped and read through a HeightTileCache,
+  * so they never need to be entirely loaded in memory. */
 class HeightMapTerrainHeightProvider : public TerrainHeightProvider
 {
+    public:
+        /** how heights between samples are computed */
+        enum class Filter {
+            NEAREST,
+            BILINEAR,
+            BICUBIC
+        };
+
+        /** formats of raw height maps (rows of samples, no header) */
+        enum class RawFormat {
+            R16, ///< unsigned 16 bit little endian samples, 65535 is the max height
+            R32F ///< 32 bit float samples, 1.0 is the max height
+        };
+
     private:
         int mWidth = 0;
         int mHeight = 0;
@@ -14,15 +35,58 @@ class HeightMapTerrainHeightProvider : public TerrainHeightProvider
         float mMinHeight;
         float mMaxHeight;
 
-        std::uint8_t* mHeightData;
+        Filter mFilter;
+
+        /// samples of 8 bit images
+        std::uint8_t* mHeightData = nullptr;
+
+        /// samples of 16 bit images
+        std::uint16_t* mHeightData16 = nullptr;
+
+        /// raw height maps
+        std::unique_ptr<MemoryMappedFile> mRawFile;
+        RawFormat mRawFormat = RawFormat::R16;
+        std::unique_ptr<HeightTileCache> mTileCache;
+
+        void loadRawTile(int x0, int z0, int width, int height, float* samples) const;
+
+        /** @return the sample at the given coordinates (clamped) in [0, 1] */
+        float sample(int x, int z, HeightTileCache::Cursor& cursor) const;
+
+        /** @return the filtered sample at normalized coordinates in [0, 1] */
+        float filteredSample(float x, float z, HeightTileCache::Cursor& cursor) const;
 
     public:
-        HeightMapTerrainHeightProvider(const std::string& heightMapPath, float minHeight = 0.0f, float maxHeight = 1.0f);
+        /**
+          * Creates a height provider from an image.
+          * @param heightMapPath the path of the image, 16 bit pngs keep their precision
+          * @param minHeight the height of black samples
+          * @param maxHeight the height of white samples
+          * @param filter how heights between samples are computed */
+        HeightMapTerrainHeightProvider(const std::string& heightMapPath, float minHeight = 0.0f, float maxHeight = 1.0f, Filter filter = Filter::BILINEAR);
+
+        /**
+          * Creates a height provider from a raw height map.
+          * @param rawPath the path of the raw file
+          * @param format the format of the samples
+          * @param width the number of samples in each row
+          * @param height the number of rows
+          * @param minHeight the height of a 0 sample
+          * @param maxHeight the height of a max sample
+          * @param filter how heights between samples are computed
+          * @param cachedTiles the max number of HeightTileCache::TILE_SIZE tiles kept in memory */
+        HeightMapTerrainHeightProvider(const std::string& rawPath, RawFormat format, int width, int height,
+            float minHeight = 0.0f, float maxHeight = 1.0f, Filter filter = Filter::BILINEAR, std::size_t cachedTiles = 256);
+
+        HeightMapTerrainHeightProvider(const HeightMapTerrainHeightProvider&) = delete;
+        HeightMapTerrainHeightProvider& operator=(const HeightMapTerrainHeightProvider&) = delete;
 
         virtual float get(float x, float z) const override;
 
         virtual glm::vec3 getNormal(float x, float z) const override;
 
+        virtual void getRow(float xStart, float xStep, std::uint32_t count, float z, float* heights) const override;
+
         ~HeightMapTerrainHeightProvider();
 };
 
@@ -0,0 +1,50 @@
+#include "terrain/HeightTileCache.h"
+#include <algorithm>
+
+HeightTileCache::HeightTileCache(int width, int height, const TileLoader& loader, std::size_t maxTiles)
+    : mWidth{ width }, mHeight{ height }, mMaxTiles{ std::max<std::size_t>(1, maxTiles) }, mLoader{ loader }
+{
+
+}
+
+std::shared_ptr<const HeightTileCache::Tile> HeightTileCache::getTile(int tileX, int tileZ) const
+{
+    std::uint64_t key = (static_cast<std::uint64_t>(tileZ) << 32) | static_cast<std::uint32_t>(tileX);
+
+    {
+        std::lock_guard<std::mutex> lock{ mMutex };
+        auto it = mTiles.find(key);
+        if (it != mTiles.end()) {
+            it->second.lastUse = ++mUseCounter;
+            return it->second.tile;
+        }
+    }
+
+    // load without holding the lock, other threads can still read cached tiles
+    auto tile = std::make_shared<Tile>();
+    tile->x0 = tileX * TILE_SIZE;
+    tile->z0 = tileZ * TILE_SIZE;
+    tile->width = std::min(TILE_SIZE, mWidth - tile->x0);
+    int height = std::min(TILE_SIZE, mHeight - tile->z0);
+    tile->samples.resize(static_cast<std::size_t>(tile->width) * height);
+    mLoader(tile->x0, tile->z0, tile->width, height, tile->samples.data());
+
+    std::lock_guard<std::mutex> lock{ mMutex };
+
+    // another thread may have loaded the same tile in the meanwhile
+    auto it = mTiles.find(key);
+    if (it != mTiles.end()) {
+        it->second.lastUse = ++mUseCounter;
+        return it->second.tile;
+    }
+
+    if (mTiles.size() >= mMaxTiles) {
+        auto leastRecentlyUsed = std::min_element(mTiles.begin(), mTiles.end(), [](const auto& a, const auto& b) {
+            return a.second.lastUse < b.second.lastUse;
+        });
+        mTiles.erase(leastRecentlyUsed);
+    }
+
+    mTiles[key] = Entry{ tile, ++mUseCounter };
+    return tile;
+}
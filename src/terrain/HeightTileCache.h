@@ -0,0 +1,91 @@
+#ifndef HEIGHTTILECACHE_H
+#define HEIGHTTILECACHE_H
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+
+/**
+  * Keeps the most recently used square tiles of a heightfield in memory.
+  * Tiles are loaded on demand and the least recently used one is evicted
+  * when the cache is full, so only a small part of a huge heightfield is
+  * ever resident. The cache can be used from several threads.
+  */
+class HeightTileCache
+{
+    public:
+        /** number of samples along each side of a tile */
+        static constexpr int TILE_SIZE = 64;
+
+        struct Tile {
+            /// coordinates of the first sample of the tile
+            int x0;
+            int z0;
+
+            /// number of samples along x (tiles on the border may be smaller)
+            int width;
+
+            std::vector<float> samples;
+        };
+
+        /**
+          * Remembers the last tile used by a sequence of lookups.
+          * A cursor must not be shared between threads. */
+        struct Cursor {
+            std::shared_ptr<const Tile> tile;
+        };
+
+        /**
+          * Fills samples (row by row) with the samples of a region of the heightfield.
+          * Arguments are the x and z coordinates of the region followed by its width and height */
+        using TileLoader = std::function<void(int, int, int, int, float*)>;
+
+    private:
+        struct Entry {
+            std::shared_ptr<const Tile> tile;
+            std::uint64_t lastUse;
+        };
+
+        int mWidth;
+        int mHeight;
+        std::size_t mMaxTiles;
+        TileLoader mLoader;
+
+        mutable std::mutex mMutex;
+        mutable std::unordered_map<std::uint64_t, Entry> mTiles;
+        mutable std::uint64_t mUseCounter = 0;
+
+        std::shared_ptr<const Tile> getTile(int tileX, int tileZ) const;
+
+    public:
+        /**
+          * Creates a new HeightTileCache.
+          * @param width the number of samples of the heightfield along x
+          * @param height the number of samples of the heightfield along z
+          * @param loader loads the samples of a tile, it may be called from several threads
+          * @param maxTiles the max number of tiles kept in memory */
+        HeightTileCache(int width, int height, const TileLoader& loader, std::size_t maxTiles = 256);
+
+        HeightTileCache(const HeightTileCache&) = delete;
+        HeightTileCache& operator=(const HeightTileCache&) = delete;
+
+        /**
+          * Returns a sample of the heightfield.
+          * @param x the x coordinate of the sample, in [0, width)
+          * @param z the z coordinate of the sample, in [0, height)
+          * @param cursor the cursor of the calling thread
+          * @return the sample */
+        float get(int x, int z, Cursor& cursor) const {
+            const Tile* tile = cursor.tile.get();
+            if (tile == nullptr || x < tile->x0 || z < tile->z0 || x >= tile->x0 + TILE_SIZE || z >= tile->z0 + TILE_SIZE) {
+                cursor.tile = getTile(x / TILE_SIZE, z / TILE_SIZE);
+                tile = cursor.tile.get();
+            }
+
+            return tile->samples[(z - tile->z0) * tile->width + (x - tile->x0)];
+        }
+};
+
+#endif // HEIGHTTILECACHE_H
@@ -0,0 +1,85 @@
+#include "terrain/MemoryMappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MemoryMappedFile::MemoryMappedFile(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+    mFile = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        return;
+
+    mMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mMapping == nullptr)
+        return;
+
+    mData = static_cast<const std::uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+    if (mData != nullptr)
+        mSize = static_cast<std::size_t>(size.QuadPart);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (mData)
+        UnmapViewOfFile(mData);
+    if (mMapping)
+        CloseHandle(mMapping);
+    if (mFile)
+        CloseHandle(mFile);
+}
+#else
+MemoryMappedFile::MemoryMappedFile(const std::string& path)
+{
+    mFile = open(path.c_str(), O_RDONLY);
+    if (mFile == -1)
+        return;
+
+    struct stat info;
+    if (fstat(mFile, &info) != 0 || info.st_size == 0)
+        return;
+
+    void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, mFile, 0);
+    if (data == MAP_FAILED)
+        return;
+
+    mData = static_cast<const std::uint8_t*>(data);
+    mSize = static_cast<std::size_t>(info.st_size);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (mData)
+        munmap(const_cast<std::uint8_t*>(mData), mSize);
+    if (mFile != -1)
+        close(mFile);
+}
+#endif
+
+bool MemoryMappedFile::isOpen() const
+{
+    return mData != nullptr;
+}
+
+const std::uint8_t* MemoryMappedFile::getData() const
+{
+    return mData;
+}
+
+std::size_t MemoryMappedFile::getSize() const
+{
+    return mSize;
+}
@@ -0,0 +1,49 @@
+#ifndef MEMORYMAPPEDFILE_H
+#define MEMORYMAPPEDFILE_H
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/**
+  * A read only view of a file mapped in memory.
+  * Pages are loaded by the operating system when they are accessed,
+  * so files larger than the available memory can be read. */
+class MemoryMappedFile
+{
+    private:
+        const std::uint8_t* mData = nullptr;
+        std::size_t mSize = 0;
+
+#ifdef _WIN32
+        void* mFile = nullptr;
+        void* mMapping = nullptr;
+#else
+        int mFile = -1;
+#endif
+
+    public:
+        /**
+          * Maps a file.
+          * @param path the path of the file
+          * @sa isOpen */
+        explicit MemoryMappedFile(const std::string& path);
+
+        MemoryMappedFile(const MemoryMappedFile&) = delete;
+        MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+        /**
+          * @return whether the file was mapped successfully */
+        bool isOpen() const;
+
+        /**
+          * @return the content of the file */
+        const std::uint8_t* getData() const;
+
+        /**
+          * @return the size of the file in bytes */
+        std::size_t getSize() const;
+
+        ~MemoryMappedFile();
+};
+
+#endif // MEMORYMAPPEDFILE_H
@@ -1,8 +1,10 @@
 #include "terrain/TerrainGenerator.h"
 #include "rendering/mesh/MeshLoader.h"
+#include "Engine.h"
 #include <vector>
-#include <glm/common.hpp>
+#include <glm/glm.hpp>
 #include <memory.h>
+#include <algorithm>
 
 TerrainGenerator::TerrainGenerator(std::uint32_t hVertex, std::uint32_t vVertex, std::uint32_t width, std::uint32_t depth)
     : mHVertex{hVertex}, mVVertex{vVertex}, mWidth{width}, mDepth{depth}
@@ -18,49 +20,94 @@ void TerrainGenerator::setTextureTilesNumber(float horizontal, float vertical)
 
 Mesh TerrainGenerator::createTerrain(const TerrainHeightProvider& heightProvider)
 {
-    std::vector<float> positions;
-    std::vector<float> normals;
-    std::vector<float> uvs;
-	std::vector<float> tangents;
-
-    std::vector<std::uint32_t> indices;
-
-    for (std::uint32_t v = 0; v <= mVVertex; ++v) {
-        float vPercent = (float) v / mVVertex;
-        float vPos = -(mDepth / 2.0f) + mDepth * vPercent;
-        for (std::uint32_t h = 0; h <= mHVertex; ++h) {
-            float hPercent = (float) h / mHVertex;
-            float hPos = -(mWidth / 2.0f) + mWidth * hPercent;
-
-            positions.insert(positions.end(), {hPos, heightProvider.get(hPercent, vPercent), vPos});
-			tangents.insert(tangents.end(), { 1.0f, 0.0f, 0.0f });
-
-            glm::vec3 normal = heightProvider.getNormal(hPercent, vPercent);
-            normals.insert(normals.end(), {normal.x, normal.y, normal.z});
-            uvs.insert(uvs.end(), {hPercent * mHTerrainTexutreTiles, 1 - vPercent * mVTerrainTextureTiles});
-
-            if (v != mVVertex && h != mHVertex) {
-                indices.insert(indices.end(), {
-                               // first tri
-                               h + (mHVertex + 1) * v,
-                               h + (mHVertex + 1) * (v + 1),
-                               h + 1 + (mHVertex + 1) * v,
-
-                               // second tri
-                               h + 1 + (mHVertex + 1) * v,
-                               h + (mHVertex + 1) * (v + 1),
-                               h + 1 + (mHVertex + 1) * (v + 1),
-                            });
+    const std::uint32_t columns = mHVertex + 1;
+    const std::uint32_t rows = mVVertex + 1;
+
+    // interleaved: position, normal, uv and (optionally) tangent
+    const std::uint32_t floatsPerVertex = mIncludeTangentSpace ? 11 : 8;
+
+    // heights are sampled once, normals are computed from the sampled grid
+    std::vector<float> heights(static_cast<std::size_t>(columns) * rows);
+    Engine::jobSystem.parallelFor(rows, ROWS_PER_JOB, [&](std::size_t begin, std::size_t end) {
+        heightProvider.getBlock(0.0f, 1.0f / mHVertex, columns, (float) begin / mVVertex, 1.0f / mVVertex,
+            static_cast<std::uint32_t>(end - begin), heights.data() + begin * columns);
+    });
+
+    float hSpacing = (float) mWidth / mHVertex;
+    float vSpacing = (float) mDepth / mVVertex;
+
+    std::vector<float> vertices(static_cast<std::size_t>(columns) * rows * floatsPerVertex);
+    Engine::jobSystem.parallelFor(rows, ROWS_PER_JOB, [&](std::size_t begin, std::size_t end) {
+        for (std::uint32_t v = static_cast<std::uint32_t>(begin); v < end; ++v) {
+            float vPercent = (float) v / mVVertex;
+            float vPos = -(mDepth / 2.0f) + mDepth * vPercent;
+
+            // central differences, one sided on the borders
+            std::uint32_t down = (v == 0) ? v : v - 1;
+            std::uint32_t up = (v == mVVertex) ? v : v + 1;
+            float vDistance = (up - down) * vSpacing;
+            const float* row = heights.data() + static_cast<std::size_t>(v) * columns;
+            const float* rowDown = heights.data() + static_cast<std::size_t>(down) * columns;
+            const float* rowUp = heights.data() + static_cast<std::size_t>(up) * columns;
+
+            float* vertex = vertices.data() + static_cast<std::size_t>(v) * columns * floatsPerVertex;
+            for (std::uint32_t h = 0; h <= mHVertex; ++h) {
+                float hPercent = (float) h / mHVertex;
+                float hPos = -(mWidth / 2.0f) + mWidth * hPercent;
+
+                std::uint32_t left = (h == 0) ? h : h - 1;
+                std::uint32_t right = (h == mHVertex) ? h : h + 1;
+                float hDistance = (right - left) * hSpacing;
+                glm::vec3 normal = glm::normalize(glm::vec3{ (row[left] - row[right]) / hDistance, 1.0f, (rowDown[h] - rowUp[h]) / vDistance });
+
+                vertex[0] = hPos;
+                vertex[1] = row[h];
+                vertex[2] = vPos;
+                vertex[3] = normal.x;
+                vertex[4] = normal.y;
+                vertex[5] = normal.z;
+                vertex[6] = hPercent * mHTerrainTexutreTiles;
+                vertex[7] = 1 - vPercent * mVTerrainTextureTiles;
+                if (mIncludeTangentSpace) {
+                    vertex[8] = 1.0f;
+                    vertex[9] = 0.0f;
+                    vertex[10] = 0.0f;
+                }
+
+                vertex += floatsPerVertex;
+            }
+        }
+    });
+
+    std::vector<std::uint32_t> indices(static_cast<std::size_t>(mHVertex) * mVVertex * 6);
+    Engine::jobSystem.parallelFor(mVVertex, ROWS_PER_JOB, [&](std::size_t begin, std::size_t end) {
+        for (std::uint32_t v = static_cast<std::uint32_t>(begin); v < end; ++v) {
+            std::uint32_t* index = indices.data() + static_cast<std::size_t>(v) * mHVertex * 6;
+            for (std::uint32_t h = 0; h < mHVertex; ++h) {
+                // first tri
+                index[0] = h + columns * v;
+                index[1] = h + columns * (v + 1);
+                index[2] = h + 1 + columns * v;
+
+                // second tri
+                index[3] = h + 1 + columns * v;
+                index[4] = h + columns * (v + 1);
+                index[5] = h + 1 + columns * (v + 1);
+
+                index += 6;
             }
         }
-    }
+    });
 
     MeshLoader loader;
-    loader.loadData(positions.data(), positions.size(), 3);
-    loader.loadData(normals.data(), normals.size(), 3);
-    loader.loadData(uvs.data(), uvs.size(), 2);
+    std::uint32_t vbo = loader.loadData(vertices.data(), vertices.size(), floatsPerVertex, GL_ARRAY_BUFFER, GL_FLOAT, false);
+
+    int stride = floatsPerVertex * sizeof(float);
+    loader.addAttribPointer(GL_ARRAY_BUFFER, vbo, stride, 3, GL_FLOAT, 0, 0);
+    loader.addAttribPointer(GL_ARRAY_BUFFER, vbo, stride, 3, GL_FLOAT, 3 * sizeof(float), 0);
+    loader.addAttribPointer(GL_ARRAY_BUFFER, vbo, stride, 2, GL_FLOAT, 6 * sizeof(float), 0);
 	if (mIncludeTangentSpace)
-		loader.loadData(tangents.data(), tangents.size(), 3);
+		loader.addAttribPointer(GL_ARRAY_BUFFER, vbo, stride, 3, GL_FLOAT, 8 * sizeof(float), 0);
     loader.loadData(indices.data(), indices.size(), 0, GL_ELEMENT_ARRAY_BUFFER, GL_UNSIGNED_INT, false);
 
     return loader.getMesh(0, indices.size());
@@ -77,3 +124,14 @@ void TerrainGenerator::addGeoMipMapComponent(const GameObjectEH & go)
 	go->addComponent(component);
 }
 
+
+void TerrainGenerator::addChunkedTerrainComponent(const GameObjectEH& go, const std::shared_ptr<const TerrainHeightProvider>& heightProvider, const MaterialPtr& material)
+{
+	std::uint32_t maxLevel = 0;
+	while ((ChunkedTerrainComponent::CHUNK_QUADS << maxLevel) < std::max(mHVertex, mVVertex))
+		++maxLevel;
+
+	auto component = std::make_shared<ChunkedTerrainComponent>(go, heightProvider, material, (float)mWidth, (float)mDepth, maxLevel,
+		mHTerrainTexutreTiles, mVTerrainTextureTiles, mIncludeTangentSpace);
+	go->addComponent(component);
+}
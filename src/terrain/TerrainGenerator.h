@@ -4,7 +4,10 @@
 #include "rendering/mesh/Mesh.h"
 #include "terrain/TerrainHeightProvider.h"
 #include "terrain/GeoMipMappingComponent.h"
+#include "terrain/ChunkedTerrainComponent.h"
+#include "rendering/materials/Material.h"
 #include <cstdint>
+#include <memory>
 
 /** Generates Mesh%es that can be used as terrain.
   * It is possible to specify the width and the depth of
@@ -16,6 +19,9 @@
 class TerrainGenerator
 {
 private:
+    /// minimum number of rows generated by a single job
+    static constexpr std::uint32_t ROWS_PER_JOB = 16;
+
     /// number of Horizontal vertices
     std::uint32_t mHVertex;
 
@@ -34,7 +40,7 @@ private:
     /// how many times the terrain texture is repeated vertically
     float mVTerrainTextureTiles = 40;
 
-	bool mIncludeTangentSpace;
+	bool mIncludeTangentSpace = false;
 
 public:
 	/**
@@ -55,6 +61,7 @@ public:
 
 	/**
 	 * Creates the terrain Mesh.
+	 * Rows are generated in parallel on the Engine::jobSystem.
 	 * @param heightProvider a TerrainHeightProvider that specifies the height of the terrain.
 	 * @return the terrain Mesh
 	 */
@@ -68,6 +75,17 @@ public:
 
 	void addGeoMipMapComponent(const GameObjectEH& go);
 
+	/**
+	 * Adds a ChunkedTerrainComponent to a GameObject.
+	 * Instead of creating a single Mesh, the terrain is split in chunks that are generated
+	 * and rendered depending on their distance from the camera. The deepest chunks have at
+	 * least the number of horizontal and vertical vertices of this generator.
+	 * @param go the GameObject used to render the terrain.
+	 * @param heightProvider a TerrainHeightProvider that specifies the height of the terrain.
+	 * @param material the material of the terrain.
+	 */
+	void addChunkedTerrainComponent(const GameObjectEH& go, const std::shared_ptr<const TerrainHeightProvider>& heightProvider, const MaterialPtr& material);
+
 	virtual ~TerrainGenerator() = default;
 };
 
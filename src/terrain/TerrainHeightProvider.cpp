@@ -5,6 +5,18 @@ TerrainHeightProvider::TerrainHeightProvider()
     //ctor
 }
 
+void TerrainHeightProvider::getRow(float xStart, float xStep, std::uint32_t count, float z, float* heights) const
+{
+    for (std::uint32_t i = 0; i < count; ++i)
+        heights[i] = get(xStart + xStep * i, z);
+}
+
+void TerrainHeightProvider::getBlock(float xStart, float xStep, std::uint32_t columns, float zStart, float zStep, std::uint32_t rows, float* heights) const
+{
+    for (std::uint32_t row = 0; row < rows; ++row)
+        getRow(xStart, xStep, columns, zStart + zStep * row, heights + static_cast<std::size_t>(row) * columns);
+}
+
 TerrainHeightProvider::~TerrainHeightProvider()
 {
     //dtor
@@ -1,7 +1,11 @@
 #ifndef TERRAINHEIGHTPROVIDER_H
 #define TERRAINHEIGHTPROVIDER_H
 #include <glm/vec3.hpp>
+#include <cstdint>
 
+/** Provides the height of a terrain.
+  * Coordinates are normalized: (0, 0) and (1, 1) are opposite corners of the terrain.
+  * Implementations must be safe to call from several threads at the same time. */
 class TerrainHeightProvider
 {
     public:
@@ -11,6 +15,26 @@ class TerrainHeightProvider
 
         virtual glm::vec3 getNormal(float x, float z) const = 0;
 
+        /** Samples the height along a row.
+          * The default implementation calls get for each sample, subclasses
+          * can override it to avoid a virtual call per sample.
+          * @param xStart the x coordinate of the first sample
+          * @param xStep the distance between two samples
+          * @param count the number of samples
+          * @param z the z coordinate of the row
+          * @param heights receives count heights */
+        virtual void getRow(float xStart, float xStep, std::uint32_t count, float z, float* heights) const;
+
+        /** Samples the height on a grid, one row after the other.
+          * @param xStart the x coordinate of the first column
+          * @param xStep the distance between two columns
+          * @param columns the number of columns
+          * @param zStart the z coordinate of the first row
+          * @param zStep the distance between two rows
+          * @param rows the number of rows
+          * @param heights receives columns * rows heights */
+        virtual void getBlock(float xStart, float xStep, std::uint32_t columns, float zStart, float zStep, std::uint32_t rows, float* heights) const;
+
         virtual ~TerrainHeightProvider();
 };
 
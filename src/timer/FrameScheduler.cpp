@@ -0,0 +1,78 @@
+#include "timer/FrameScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+FrameScheduler::Frame FrameScheduler::beginFrame()
+{
+    const Uint64 now = SDL_GetPerformanceCounter();
+    const double realMillis = mFrameStart != 0 ? (now - mFrameStart) * 1000.0 / SDL_GetPerformanceFrequency() : 0.0;
+    mFrameStart = now;
+
+    const double updateMillis = getUpdateMillis();
+
+    switch (mode) {
+    case Mode::FIXED: {
+        mAccumulator += realMillis;
+
+        std::uint32_t updates = static_cast<std::uint32_t>(mAccumulator / updateMillis);
+        if (updates > maxUpdatesPerFrame) {
+            // the updates cannot keep up, the time that cannot be simulated is dropped
+            updates = maxUpdatesPerFrame;
+            mAccumulator = std::fmod(mAccumulator, updateMillis) + updates * updateMillis;
+        }
+
+        mAccumulator -= updates * updateMillis;
+        mInterpolationAlpha = static_cast<float>(mAccumulator / updateMillis);
+
+        return Frame{ updates, static_cast<float>(updateMillis), static_cast<float>(realMillis) };
+    }
+
+    case Mode::MAX_THROUGHPUT:
+        mAccumulator = 0.0;
+        mInterpolationAlpha = 0.0f;
+        mVirtualMillis += updateMillis;
+
+        return Frame{ 1, static_cast<float>(updateMillis), static_cast<float>(updateMillis) };
+
+    default:
+        mAccumulator = 0.0;
+        mInterpolationAlpha = 0.0f;
+
+        return Frame{ 1, static_cast<float>(realMillis), static_cast<float>(realMillis) };
+    }
+}
+
+void FrameScheduler::endFrame()
+{
+    if (maxFrameRate <= 0.0f || mode == Mode::MAX_THROUGHPUT)
+        return;
+
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    const Uint64 frameEnd = mFrameStart + static_cast<Uint64>(frequency / maxFrameRate);
+
+    // SDL_Delay may sleep a couple of milliseconds more than asked, the rest of the frame is spent spinning
+    while (true) {
+        const Uint64 now = SDL_GetPerformanceCounter();
+        if (now >= frameEnd)
+            break;
+
+        const Uint64 remainingMillis = (frameEnd - now) * 1000 / frequency;
+        if (remainingMillis > 2)
+            SDL_Delay(static_cast<Uint32>(remainingMillis - 2));
+    }
+}
+
+float FrameScheduler::getInterpolationAlpha() const
+{
+    return mInterpolationAlpha;
+}
+
+float FrameScheduler::getUpdateMillis() const
+{
+    return 1000.0f / std::max(updateRate, 1.0f);
+}
+
+double FrameScheduler::getVirtualMillis() const
+{
+    return mVirtualMillis;
+}
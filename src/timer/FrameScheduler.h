@@ -0,0 +1,89 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+#include <cstdint>
+#include <SDL.h>
+
+/**
+  * Decides how much time each frame simulates.
+  * The Engine pushes an enter frame event for each update of a frame, with the duration of the
+  * update, and pre render and exit frame events with the duration of the frame.
+  * @sa Engine::frameScheduler */
+class FrameScheduler
+{
+    friend class Engine;
+
+    public:
+        enum class Mode {
+            /** a single update per frame, lasting the real time elapsed since the previous frame */
+            VARIABLE,
+
+            /** updates last 1 / updateRate seconds, as many as the real time elapsed allows */
+            FIXED,
+
+            /** frames are rendered as fast as possible, each one simulating a single fixed update.
+              * Time runs faster or slower than real time, e.g. for offline rendering */
+            MAX_THROUGHPUT
+        };
+
+        /** the updates and durations of a frame */
+        struct Frame {
+            std::uint32_t updates;
+
+            /** the duration of each update */
+            float updateMillis;
+
+            /** the time elapsed since the previous frame, real or virtual in MAX_THROUGHPUT mode */
+            float frameMillis;
+        };
+
+    private:
+        Uint64 mFrameStart = 0;
+        double mAccumulator = 0.0;
+        double mVirtualMillis = 0.0;
+        float mInterpolationAlpha = 0.0f;
+
+        /** computes the updates of a new frame */
+        Frame beginFrame();
+
+        /** waits for the end of the frame if the frame rate is limited */
+        void endFrame();
+
+    public:
+        Mode mode = Mode::VARIABLE;
+
+        /** updates per second of FIXED and MAX_THROUGHPUT modes */
+        float updateRate = 60.0f;
+
+        /**
+          * Updates computed by a frame in FIXED mode at most. When updates take longer than the time
+          * they simulate, the time that cannot be simulated is dropped instead of accumulating
+          * more and more updates in the following frames. */
+        std::uint32_t maxUpdatesPerFrame = 5;
+
+        /** frames per second at most, 0 for no limit. Ignored in MAX_THROUGHPUT mode */
+        float maxFrameRate = 0.0f;
+
+        FrameScheduler() = default;
+
+        FrameScheduler(const FrameScheduler&) = delete;
+        FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+        /**
+          * In FIXED mode the rendered frame falls between the last update and the next one.
+          * Interpolating the previous and current states of the last update with this factor
+          * gives smooth motion when the frame rate is higher than the update rate.
+          * @return the fraction of an update elapsed after the last one, 0 in the other modes */
+        float getInterpolationAlpha() const;
+
+        /**
+          * @return the duration of an update in FIXED and MAX_THROUGHPUT modes
+          */
+        float getUpdateMillis() const;
+
+        /**
+          * @return the time simulated in MAX_THROUGHPUT mode
+          */
+        double getVirtualMillis() const;
+};
+
+#endif // FRAMESCHEDULER_H
@@ -27,8 +27,6 @@ int main(int argc, char* argv[]) {
 
 	Engine::renderSys.effectManager.enableEffects();
 	Engine::renderSys.shadowMappingSettings.useFastShader = true;
-	Engine::renderSys.shadowMappingSettings.width = 300;
-	Engine::renderSys.shadowMappingSettings.height = 300;
 
     auto camera = Engine::gameObjectManager.createGameObject();
     camera->name = "camera";
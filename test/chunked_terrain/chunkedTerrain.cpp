@@ -0,0 +1,65 @@
+#include "Engine.h"
+#include "rendering/materials/BlinnPhongMaterial.h"
+#include "rendering/materials/SkyboxMaterial.h"
+#include "cameras/FreeCameraComponent.h"
+#include "cameras/CameraComponent.h"
+#include "rendering/light/DirectionalLight.h"
+#include "rendering/mesh/MeshCreator.h"
+#include "terrain/TerrainGenerator.h"
+#include "terrain/HeightMapTerrainHeightProvider.h"
+
+#include "../test/runTest.h"
+
+#include <memory>
+
+#ifdef chunkedTerrain
+int main(int argc, char* argv[]) {
+	Engine::init();
+
+	Engine::renderSys.createWindow(1280, 720);
+
+	auto camera = Engine::gameObjectManager.createGameObject();
+	camera->name = "camera";
+	camera->transform.moveBy(glm::vec3{ 0.0f, 50.0f, 0.0f });
+
+	// the terrain is large: use a far plane farther than the default one
+	camera->addComponent(std::make_shared<CameraComponent>(camera, 0.785f, 0.1f, 10000.0f));
+	camera->addComponent(std::make_shared<FreeCameraComponent>(camera));
+
+	Engine::renderSys.setCamera(camera);
+
+	MaterialPtr phong = BlinnPhongMaterialBuilder()
+		.setDiffuseMap("test_data/terrain/grass.jpg")
+		.build();
+
+	// a 16k x 16k terrain: only the chunks around the camera are kept in memory
+	auto hProvider = std::make_shared<HeightMapTerrainHeightProvider>("test_data/terrain/heightmap_2.png", -200, 200);
+	TerrainGenerator generator{ 16384, 16384, 16000, 16000 };
+	generator.setTextureTilesNumber(2000, 2000);
+
+	auto terrain = Engine::gameObjectManager.createGameObject();
+	terrain->name = "terrain";
+	generator.addChunkedTerrainComponent(terrain, hProvider, phong);
+
+	auto skyTexture = Texture::loadCubemapFromFile({
+					{"front", "test_data/skybox/front.tga"},
+					{"back", "test_data/skybox/back.tga"},
+					{"top", "test_data/skybox/top.tga"},
+					{"bottom", "test_data/skybox/bottom.tga"},
+					{"left", "test_data/skybox/left.tga"},
+					{"right", "test_data/skybox/right.tga"},
+		});
+	Engine::gameObjectManager.createGameObject(MeshCreator::cube(), std::make_shared<SkyboxMaterial>(skyTexture));
+
+	auto sun = Engine::gameObjectManager.createGameObject();
+	sun->name = "sun";
+	sun->addComponent(std::make_shared<DirectionalLight>(sun));
+	sun->transform.rotateBy(glm::angleAxis(glm::radians(55.0f), sun->transform.right()));
+	Engine::renderSys.addLight(sun);
+	sun->getComponent<Light>()->setCastShadowMode(Light::ShadowCasterMode::NO_SHADOWS);
+
+	Engine::start();
+
+	return 0;
+}
+#endif
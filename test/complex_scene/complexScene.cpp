@@ -18,6 +18,9 @@
 #include "rendering/effects/SSAO.h"
 
 #include "rendering/materials/WaterMaterial.h"
+#include "rendering/GLStateCache.h"
+
+#include <imgui/imgui.h>
 
 #include <iostream>
 
@@ -64,7 +67,9 @@ int main(int argc, char* argv[]) {
  	Engine::renderSys.createWindow(1280, 720);
 // 	Engine::renderSys.effectManager.addEffect(std::make_shared<FXAA>());
 // 	Engine::renderSys.effectManager.addEffect(std::make_shared<MotionBlur>());
-    Engine::renderSys.effectManager.addEffect(std::make_shared<SSAO>());
+    auto ssao = std::make_shared<SSAO>();
+    ssao->setResolution(SSAO::Resolution::HALF);
+    Engine::renderSys.effectManager.addEffect(ssao);
 // 	Engine::renderSys.effectManager.addEffect(std::make_shared<Bloom>());
     auto gammaPost = std::make_shared<GammaCorrection>();
     gammaPost->setGamma(1.8f);
@@ -73,8 +78,6 @@ int main(int argc, char* argv[]) {
 
  	Engine::renderSys.effectManager.enableEffects();
 	Engine::renderSys.shadowMappingSettings.useFastShader = true;
-	Engine::renderSys.shadowMappingSettings.width = 500;
-	Engine::renderSys.shadowMappingSettings.height = 500;
 	Engine::renderSys.shadowMappingSettings.setShadowStrength(1.0f);
 	Engine::renderSys.shadowMappingSettings.setShadowDistance(500);
 
@@ -166,6 +169,45 @@ int main(int argc, char* argv[]) {
 	gizmo2->transform.setLocalRotation(glm::quat{ 1.0f, 0.0f, 0.0f, 0.0f });
 	gizmo2->transform.setPosition(fakeSun->transform.getPosition());
 
+	Engine::uiRenderer.setDebugUIDrawer([]() {
+		static float overdraw[120]{};
+		static int offset = 0;
+		overdraw[offset] = Engine::renderSys.getGBufferOverdraw();
+		offset = (offset + 1) % IM_ARRAYSIZE(overdraw);
+
+		ImGui::Begin("G-buffer overdraw");
+		ImGui::Checkbox("Depth pre-pass", &Engine::renderSys.depthPrePass);
+		ImGui::Text("Fragments per pixel: %.2f", Engine::renderSys.getGBufferOverdraw());
+		ImGui::PlotLines("##overdraw", overdraw, IM_ARRAYSIZE(overdraw), offset, nullptr, 0.0f, 4.0f, ImVec2{ 0.0f, 60.0f });
+		ImGui::End();
+
+		const GLStateCache::Counters calls = GLStateCache::getLastFrameCounters();
+		ImGui::Begin("GL calls");
+		ImGui::Checkbox("Multi-draw indirect", &Engine::renderSys.multiDrawIndirect);
+		ImGui::Text("Multi-draw: %zu meshes in %zu calls", Engine::gameObjectRenderer.getMultiDrawRenderer().getLastDrawsNumber(),
+			Engine::gameObjectRenderer.getMultiDrawRenderer().getLastCallsNumber());
+		ImGui::Text("Issued: %llu", static_cast<unsigned long long>(calls.issued));
+		ImGui::Text("Filtered: %llu", static_cast<unsigned long long>(calls.filtered));
+		ImGui::End();
+
+		ImGui::Begin("Timing");
+		const char* modes[] = { "Variable", "Fixed", "Max throughput" };
+		int mode = static_cast<int>(Engine::frameScheduler.mode);
+		if (ImGui::Combo("Timestep", &mode, modes, IM_ARRAYSIZE(modes)))
+			Engine::frameScheduler.mode = static_cast<FrameScheduler::Mode>(mode);
+		ImGui::SliderFloat("Update rate", &Engine::frameScheduler.updateRate, 10.0f, 240.0f);
+		ImGui::SliderFloat("Max frame rate", &Engine::frameScheduler.maxFrameRate, 0.0f, 240.0f);
+		bool vSync = Engine::renderSys.isVSyncEnabled();
+		if (ImGui::Checkbox("V-sync", &vSync))
+			Engine::renderSys.setVSync(vSync);
+		ImGui::End();
+
+		ImGui::Begin("Capture");
+		if (ImGui::Button("Capture frame"))
+			Engine::renderSys.frameCapture.start("frame", 1, true);
+		ImGui::End();
+	});
+
     Engine::start();
 
     return 0;
@@ -13,7 +13,6 @@
 #include "resourceManagment/RefCount.h"
 #include "rendering/effects/FXAA.h"
 #include "rendering/materials/MultiTextureBlinnPhongMaterial.h"
-#include "rendering/shadow/ShadowOnVisibleSceneComponent.h"
 
 #include "rendering/light/DirectionalLight.h"
 #include "rendering/light/PointLight.h"
@@ -105,7 +104,6 @@ int main(int argc, char* argv[]) {
 	light3->getComponent<Light>()->specularColor = glm::vec3{ 1.0f, 1.0f, 1.0f };
 	light3->getComponent<Light>()->innerAngle = glm::radians(25.0f);
 	light3->getComponent<Light>()->outerAngle = glm::radians(28.0f);
-	light3->addComponent(std::make_shared<ShadowOnVisibleSceneComponent>(light3));
 	light3->transform.scaleBy(glm::vec3{ 0.2f, 0.2f, 0.2f });
 
     auto light = Engine::gameObjectManager.createGameObject(MeshCreator::cube(), std::make_shared<PropMaterial>());
@@ -65,8 +65,6 @@ int main(int argc, char* argv[]) {
 
  	Engine::renderSys.effectManager.enableEffects();
 	Engine::renderSys.shadowMappingSettings.useFastShader = true;
-	Engine::renderSys.shadowMappingSettings.width = 500;
-	Engine::renderSys.shadowMappingSettings.height = 500;
 	Engine::renderSys.shadowMappingSettings.setShadowStrength(1.0f);
 	Engine::renderSys.shadowMappingSettings.setShadowDistance(500);
 
@@ -21,4 +21,5 @@
 //#define pbrTest 
 //#define complexScene
 //#define godRaysTest
+//#define chunkedTerrain
 #define boundingBox
@@ -15,7 +15,6 @@
 #include "rendering/effects/GammaCorrection.h"
 #include "rendering/effects/FXAA.h"
 #include "rendering/materials/MultiTextureLambertMaterial.h"
-#include "rendering/shadow/ShadowOnVisibleSceneComponent.h"
 
 #include "../test/runTest.h"
 
@@ -68,6 +67,7 @@ int main(int argc, char* argv[]) {
 	HeightMapTerrainHeightProvider hProvider{ "test_data/terrain/heightmap_2.png", 0, 0 };
 	TerrainGenerator generator{ 512, 512, 1000, 1000 };
 	auto terrain = Engine::gameObjectManager.createGameObject(generator.createTerrain(hProvider), multiTextured);
+	terrain->isStatic = true;
 
 	Engine::renderSys.effectManager.enableEffects();
 	Engine::renderSys.effectManager.addEffect(std::make_shared<FXAA>());
@@ -90,7 +90,6 @@ int main(int argc, char* argv[]) {
 	light->transform.rotateBy(glm::angleAxis(glm::radians(15.0f), glm::vec3{ 0.0f, 1.0f, 0.0f }));
 	
 	light->getComponent<Light>()->setCastShadowMode(Light::ShadowCasterMode::STATIC);
-	light->addComponent(std::make_shared<ShadowOnVisibleSceneComponent>(light));
 
     Engine::start();
 
@@ -16,7 +16,6 @@
 #include "rendering/effects/GammaCorrection.h"
 #include "rendering/effects/FXAA.h"
 #include "rendering/materials/MultiTextureLambertMaterial.h"
-#include "rendering/shadow/ShadowOnVisibleSceneComponent.h"
 #include "skeletalAnimation/SkeletalAnimationLoader.h"
 #include "skeletalAnimation/SkeletralAnimationControllerComponent.h"
 
@@ -102,7 +101,6 @@ int main(int argc, char* argv[]) {
 	
 
 	light->getComponent<Light>()->setCastShadowMode(Light::ShadowCasterMode::DYNAMIC);
-	light->addComponent(std::make_shared<ShadowOnVisibleSceneComponent>(light));
 
 
     Engine::start();
@@ -13,7 +13,6 @@
 #include "resourceManagment/RefCount.h"
 #include "rendering/effects/FXAA.h"
 #include "rendering/materials/MultiTextureBlinnPhongMaterial.h"
-#include "rendering/shadow/ShadowOnVisibleSceneComponent.h"
 #include "rendering/materials/WaterMaterial.h"
 #include "rendering/light/PointLight.h"
 #include "../test/runTest.h"
@@ -42,9 +41,11 @@ int main(int argc, char* argv[]) {
     camera->addComponent(cam);
     camera->transform.setRotation(glm::quat{glm::vec3{0, glm::radians(180.0f), 0}});
 
-	auto water = Engine::gameObjectManager.createGameObject(MeshCreator::plane(),
-		std::make_shared<WaterMaterial>(-5.0f, Texture::loadFromFile("test_data/water/dudv.png"),
-			Texture::loadFromFile("test_data/water/normal.png")));
+	auto waterMaterial = std::make_shared<WaterMaterial>(-5.0f, Texture::loadFromFile("test_data/water/dudv.png"),
+		Texture::loadFromFile("test_data/water/normal.png"));
+	waterMaterial->setReflectionResolution(640, 360);
+	waterMaterial->reflectionUpdateInterval = 2;
+	auto water = Engine::gameObjectManager.createGameObject(MeshCreator::plane(), waterMaterial);
 
 	water->transform.moveBy(glm::vec3{ 35, -5, -5 });
 	water->transform.scaleBy(glm::vec3{ 90.0f });
@@ -119,7 +120,6 @@ int main(int argc, char* argv[]) {
 	light3->getComponent<Light>()->specularColor = glm::vec3{ 230, 230, 230 } / 255.0f;
 	light3->getComponent<Light>()->innerAngle = glm::radians(25.0f);
 	light3->getComponent<Light>()->outerAngle = glm::radians(28.0f);
-	light3->addComponent(std::make_shared<ShadowOnVisibleSceneComponent>(light3));
 	light3->transform.scaleBy(glm::vec3{ 0.2f, 0.2f, 0.2f });
 
     auto gizmo = MeshCreator::axisGizmo();